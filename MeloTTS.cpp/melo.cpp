@@ -65,6 +65,13 @@ int main(int argc, char** argv) {
 
     std::filesystem::path input_path = args.input_file;
     std::string output_filename = args.output_filename;
+    const auto output_format = melo::WaveWriter::parse_format(args.output_format);
+    const bool to_stdout = output_filename == melo::WaveWriter::STDOUT_PATH;
+    static_assert(Args::model_rate == melo::TTS::sampling_rate_, "parse_args validates --output_rate for the model");
+    const int32_t output_rate = args.output_rate > 0 ? args.output_rate : melo::TTS::sampling_rate_;
+    // stdout carries the audio, so the logs go to stderr
+    if (to_stdout)
+        std::cout.rdbuf(std::cerr.rdbuf());
 
     // Init core
     std::unique_ptr<ov::Core> core_ptr = std::make_unique<ov::Core>();
@@ -79,9 +86,14 @@ int main(int argc, char** argv) {
 #ifdef USE_DEEPFILTERNET
                     args.nf_ir_path,
                     args.nf_device,
-                    args.disable_nf
+                    args.disable_nf,
 #endif
-    );
+                    nullptr,
+                    args.tts_streams,
+                    args.tts_chunk_ms,
+                    args.g2p_prewarm_words);
+    if (args.front_end_threads > 0)
+        model.set_front_end_pool(std::make_shared<melo::WorkStealingPool>(args.front_end_threads));
     
     auto initTime = get_duration_ms_till_now(startTime);
     std::cout << "model init time is" << initTime << " ms" << std::endl;
@@ -90,8 +102,17 @@ int main(int argc, char** argv) {
     // TODO: make speaker id in args
     for (auto& [speaker_id, style_name] : melo::TTS::speaker_ids.at(args.language)) {
         startTime = Time::now();
-        model.tts_to_file(texts, std::format("{}_{}.wav", output_filename, style_name), speaker_id, args.speed);
+        const std::string path =
+            to_stdout ? output_filename
+                      : std::format("{}_{}.{}", output_filename, style_name, melo::WaveWriter::extension(output_format));
+        melo::WaveWriter writer(path, output_rate, output_format, args.convert_options);
+        model.tts_to_file(texts, writer, speaker_id, args.speed);
+        writer.close();
         auto inferTime = get_duration_ms_till_now(startTime);
+        std::cout << "write audio to " << path << std::endl;
         std::cout << "model infer time:" << inferTime << " ms" << std::endl;
+        // only one stream can be written to stdout
+        if (to_stdout)
+            break;
     }
 }
@@ -0,0 +1,481 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// melo_server: loads the models once and serves synthesis over a Unix domain socket and a localhost HTTP port.
+//
+//   GET  /health                                         -> 200 application/json
+//   POST /tts?speaker=0&speed=1.0&format=wav&rate=16000  -> 200 chunked audio, body: UTF-8 text, one or more lines
+//            &priority=interactive|bulk&deadline_ms=300
+//
+// The audio is streamed as every sentence is synthesized. Requests wait in arrival order for one of --workers
+// models; when --max_queue requests are waiting already, the answer is 503. With --max_batch above 1 the workers share
+// one BERT and TTS model and the sentences of concurrent requests are batched, see BatchScheduler.
+// Interactive requests are served before bulk ones, then by the earliest deadline: when waiting for a worker and, with
+// --max_batch, sentence by sentence. A request whose client disconnects is cancelled at its next stage.
+// A request for the same text and parameters as one running already joins it and streams the same audio.
+//   curl --unix-socket melo.sock -X POST --data-binary @inputs_en.txt "http://localhost/tts?speed=1.0" -o out.wav
+#include <pthread.h>
+#include <signal.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "parse_args.h"
+#include "server/lease_pool.h"
+#include "server/single_flight.h"
+#include "server/socket_server.h"
+#include "tts.h"
+#include "utils.h"
+
+namespace {
+struct ServerArgs {
+    std::string socket_path = "melo.sock";  // empty: no Unix socket
+    std::string host = "127.0.0.1";
+    int port = 8080;  // 0: no TCP socket
+    size_t workers = 1;
+    size_t max_queue = 16;
+    size_t max_batch = 1;      // 1: every worker has models of its own
+    double batch_wait_ms = 10;
+    size_t max_connections = 256;
+};
+
+void server_usage(const std::string& prog) {
+    std::cout << "Usage: " << prog << " [server options] [options]\n"
+              << "\n"
+              << "server options:\n"
+              << "  --socket                Specifies the Unix domain socket to listen on, \"\" for none (default: "
+                 "melo.sock).\n"
+              << "  --host                  Specifies the address of the HTTP listener (default: 127.0.0.1).\n"
+              << "  --port                  Specifies the port of the HTTP listener, 0 for none (default: 8080).\n"
+              << "  --workers               Specifies the number of models loaded, i.e. the requests synthesized at "
+                 "the same time (default: 1).\n"
+              << "  --max_queue             Specifies the number of requests that may wait for a model before the "
+                 "server answers 503 (default: 16).\n"
+              << "  --max_batch             Specifies the sentences of concurrent requests run together on one model "
+                 "shared by the workers, which should be at least as many; 1 gives every worker models of its own "
+                 "(default: 1).\n"
+              << "  --batch_wait_ms         Specifies how long a sentence may wait for others to fill a batch, the "
+                 "latency traded for throughput (default: 10).\n"
+              << "  --max_connections       Specifies the connections served at a time, the requests that joined an "
+                 "identical one running already included (default: 256).\n"
+              << "\n"
+              << "--speed, --output_format and --output_rate below are the defaults of the requests.\n";
+}
+
+// take the server options out of argv, the rest is for parse_args
+std::vector<std::string> split_server_args(int argc, char** argv, ServerArgs& server_args) {
+    std::vector<std::string> rest{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc)
+                throw std::runtime_error("Missing the value of " + arg);
+            return argv[++i];
+        };
+        if (arg == "-h" || arg == "--help") {
+            server_usage(argv[0]);
+            rest.push_back(arg);
+        } else if (arg == "--socket") {
+            server_args.socket_path = value();
+        } else if (arg == "--host") {
+            server_args.host = value();
+        } else if (arg == "--port") {
+            server_args.port = std::stoi(value());
+        } else if (arg == "--workers") {
+            server_args.workers = std::max(std::stoi(value()), 1);
+        } else if (arg == "--max_queue") {
+            server_args.max_queue = std::max(std::stoi(value()), 0);
+        } else if (arg == "--max_batch") {
+            server_args.max_batch = std::max(std::stoi(value()), 1);
+        } else if (arg == "--batch_wait_ms") {
+            server_args.batch_wait_ms = std::max(std::stod(value()), 0.0);
+        } else if (arg == "--max_connections") {
+            server_args.max_connections = std::max(std::stoi(value()), 1);
+        } else {
+            rest.push_back(arg);
+        }
+    }
+    return rest;
+}
+
+std::vector<std::string> split_lines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+// calls on_close once the client closes the connection, until destroyed
+class DisconnectWatcher {
+public:
+    DisconnectWatcher(melo::Connection& connection, std::function<void()> on_close)
+        : _thread([this, &connection, on_close = std::move(on_close)] {
+              while (!_done.load()) {
+                  if (connection.peer_closed(POLL_MS)) {
+                      on_close();
+                      return;
+                  }
+              }
+          }) {}
+    ~DisconnectWatcher() {
+        _done = true;
+        _thread.join();
+    }
+
+private:
+    static constexpr int POLL_MS = 50;
+    std::atomic<bool> _done{false};
+    std::thread _thread;
+};
+
+// the requests for the same text, speaker, speed and output share one synthesis
+std::string flight_key(const std::vector<std::string>& texts,
+                       int speaker_id,
+                       float speed,
+                       int32_t rate,
+                       melo::WaveWriter::Format format) {
+    std::ostringstream key;
+    key << speaker_id << ' ' << speed << ' ' << rate << ' ' << static_cast<int>(format) << '\n';
+    // whitespace runs count as one space, empty lines do not count
+    for (const auto& text : texts) {
+        std::istringstream words(text);
+        std::string word;
+        const char* separator = "";
+        bool any = false;
+        while (words >> word) {
+            key << separator << word;
+            separator = " ";
+            any = true;
+        }
+        if (any)
+            key << '\n';
+    }
+    return key.str();
+}
+
+class Service {
+public:
+    Service(melo::LeasePool<melo::TTS>& pool, const Args& args, std::shared_ptr<melo::BatchScheduler> scheduler)
+        : _pool(pool),
+          _args(args),
+          _scheduler(std::move(scheduler)) {}
+
+    void handle(melo::Connection& connection) {
+        try {
+            const melo::http::Request request = connection.read_request();
+            if (request.path == "/health") {
+                if (request.method != "GET")
+                    throw melo::http::Error(405, "use GET");
+                health(connection);
+            } else if (request.path == "/tts") {
+                if (request.method != "POST")
+                    throw melo::http::Error(405, "use POST with the text as the body");
+                synthesize(connection, request);
+            } else {
+                throw melo::http::Error(404, "unknown path " + request.path);
+            }
+        } catch (const melo::http::Error& e) {
+            connection.respond(e.status(), "text/plain", std::string(e.what()) + "\n");
+        }
+    }
+
+private:
+    void health(melo::Connection& connection) {
+        std::ostringstream json;
+        json << "{\"status\":\"ok\",\"language\":\"" << _args.language << "\",\"speakers\":[";
+        const char* separator = "";
+        for (const auto& [speaker_id, style_name] : melo::TTS::speaker_ids.at(_args.language)) {
+            json << separator << "{\"id\":" << speaker_id << ",\"name\":\"" << style_name << "\"}";
+            separator = ",";
+        }
+        json << "],\"workers\":" << _pool.size() << ",\"busy\":" << _pool.num_busy()
+             << ",\"queued\":" << _pool.num_waiting() << ",\"max_queue\":" << _pool.max_queue()
+             << ",\"in_flight\":" << _flights.size() << ",\"coalesced\":" << _flights.num_coalesced();
+        if (_scheduler) {
+            const auto bert = _scheduler->bert_stats();
+            const auto tts = _scheduler->tts_stats();
+            json << ",\"max_batch\":" << _scheduler->options().max_batch << ",\"bert_batches\":" << bert.num_batches
+                 << ",\"bert_sentences\":" << bert.num_items << ",\"tts_batches\":" << tts.num_batches
+                 << ",\"tts_sentences\":" << tts.num_items;
+        }
+        json << "}\n";
+        connection.respond(200, "application/json", json.str());
+    }
+
+    void synthesize(melo::Connection& connection, const melo::http::Request& request) {
+        const auto& speakers = melo::TTS::speaker_ids.at(_args.language);
+        int speaker_id = speakers.begin()->first;
+        float speed = _args.speed;
+        int32_t rate = _args.output_rate > 0 ? _args.output_rate : melo::TTS::sampling_rate_;
+        auto format = melo::WaveWriter::parse_format(_args.output_format);
+        melo::RequestControl control;
+        try {
+            if (auto value = request.param("speaker"))
+                speaker_id = std::stoi(*value);
+            if (auto value = request.param("speed"))
+                speed = std::stof(*value);
+            if (auto value = request.param("rate"))
+                rate = std::stoi(*value);
+            if (auto value = request.param("format"))
+                format = melo::WaveWriter::parse_format(*value);
+            if (auto value = request.param("priority")) {
+                if (*value == "interactive")
+                    control.priority = melo::Priority::Interactive;
+                else if (*value == "bulk")
+                    control.priority = melo::Priority::Bulk;
+                else
+                    throw std::invalid_argument("priority is interactive or bulk");
+            }
+            if (auto value = request.param("deadline_ms"))
+                control.deadline = melo::RequestControl::Clock::now() + std::chrono::milliseconds(std::stoi(*value));
+        } catch (const std::exception& e) {
+            throw melo::http::Error(400, std::string("invalid parameter: ") + e.what());
+        }
+        if (!speakers.count(speaker_id))
+            throw melo::http::Error(400, "unknown speaker " + std::to_string(speaker_id));
+        if (!(speed > 0.1f && speed < 10.0f))
+            throw melo::http::Error(400, "speed must be in (0.1, 10)");
+        if (rate < Args::min_output_rate || rate > Args::max_output_rate)
+            throw melo::http::Error(400, "rate must be in [1000, 192000]");
+        if (!melo::Resampler::supports(melo::TTS::sampling_rate_, rate))
+            throw melo::http::Error(400, "the audio cannot be resampled to " + std::to_string(rate) + " Hz");
+        const std::vector<std::string> texts = split_lines(request.body);
+        if (request.body.find_first_not_of(" \t\r\n") == std::string::npos)
+            throw melo::http::Error(400, "the body is the text to synthesize and must not be empty");
+
+        const std::string key = flight_key(texts, speaker_id, speed, rate, format);
+        bool leader = false;
+        std::shared_ptr<melo::Broadcast> flight = _flights.join(key, leader);
+        // the leader sends what it synthesizes itself, only the requests that joined read the broadcast
+        melo::Broadcast::Listener listener(flight, !leader);
+        DisconnectWatcher watcher(connection, [&listener] { listener.leave(); });
+        const bool is_wav = format == melo::WaveWriter::Format::Wav;
+        const melo::http::Headers headers{{"Content-Type", is_wav ? "audio/wav" : "application/octet-stream"},
+                                          {"X-Sample-Rate", std::to_string(rate)},
+                                          {"X-Sample-Format", "s16le"},
+                                          {"Cache-Control", "no-store"}};
+        if (!leader) {
+            follow(connection, *flight, listener, headers);
+            return;
+        }
+
+        // Synthesize for every listener of the flight: the client of this request is one of them, and the synthesis is
+        // cancelled only once all of them have gone
+        bool landed = false;
+        auto land = [&](bool ok, int status) {
+            if (std::exchange(landed, true))
+                return;
+            _flights.land(key, flight);
+            flight->finish(ok, status);
+        };
+        struct Landing {
+            std::function<void()> land;
+            ~Landing() {
+                land();
+            }
+        } landing{[&] { land(false, 500); }};
+
+        control.token = flight->token();
+        // the queue is left as soon as the clients disconnect
+        bool cancelled = false;
+        auto lease = [&]() -> decltype(_pool.acquire(control)) {
+            try {
+                return _pool.acquire(control);
+            } catch (const melo::Cancelled&) {
+                cancelled = true;
+                return std::nullopt;
+            }
+        }();
+        if (cancelled) {
+            std::cout << "[INFO] melo_server: the clients disconnected while queued" << std::endl;
+            return;
+        }
+        if (!lease) {
+            land(false, 503);
+            connection.respond(503, "text/plain", "all workers are busy and the queue is full\n", {{"Retry-After", "1"}});
+            return;
+        }
+
+        bool sending = connection.begin_chunked(200, headers);
+        if (!sending)
+            listener.leave();
+        auto start_time = Time::now();
+        melo::WaveWriter writer(
+            [&](const void* data, size_t size) {
+                auto chunk = std::make_shared<const std::string>(static_cast<const char*>(data), size);
+                flight->publish(chunk);
+                if (sending && !(sending = connection.send_chunk(*chunk)))
+                    listener.leave();
+                return true;  // the other listeners may still read
+            },
+            rate,
+            format,
+            _args.convert_options);
+        try {
+            (*lease)->tts_to_file(texts, writer, speaker_id, speed, 0.2f, 0.6f, 0.8f, control);
+        } catch (const melo::Cancelled& e) {
+            std::cout << "[INFO] melo_server: the clients disconnected, " << e.what() << std::endl;
+            return;
+        }
+        const size_t num_samples = writer.num_samples();
+        writer.close();
+        land(true, 200);
+        if (sending && connection.end_chunked()) {
+            std::cout << "[INFO] melo_server: " << request.body.size() << " bytes of text, "
+                      << static_cast<double>(num_samples) / rate << " s of audio in "
+                      << get_duration_ms_till_now(start_time) << " ms" << std::endl;
+        } else {
+            std::cout << "[INFO] melo_server: the client disconnected" << std::endl;
+        }
+    }
+
+    // stream the synthesis an identical request runs already
+    void follow(melo::Connection& connection,
+                melo::Broadcast& flight,
+                melo::Broadcast::Listener& listener,
+                const melo::http::Headers& headers) {
+        melo::Broadcast::Chunk chunk;
+        size_t index = 0;
+        bool more = flight.read(index, chunk, listener);
+        if (!more && listener.fell_behind()) {
+            connection.respond(503, "text/plain", "the synthesis this request joined has gone too far ahead\n");
+            return;
+        }
+        if (!more && !listener.has_left() && !flight.ok()) {
+            connection.respond(flight.status(), "text/plain", "the synthesis this request joined has failed\n");
+            return;
+        }
+        if (!connection.begin_chunked(200, headers))
+            return;
+        for (; more; more = flight.read(++index, chunk, listener)) {
+            if (!connection.send_chunk(*chunk))
+                break;
+        }
+        // a failed flight, or a client that fell too far behind it, ends without the last chunk, which tells the client
+        // that the audio is incomplete
+        if (!listener.has_left() && !listener.fell_behind() && !connection.is_broken() && flight.ok() &&
+            connection.end_chunked())
+            std::cout << "[INFO] melo_server: joined a running synthesis, " << index << " chunks" << std::endl;
+        else if (listener.fell_behind())
+            std::cout << "[INFO] melo_server: a request that joined a running synthesis fell behind it, cut off after "
+                      << index << " chunks" << std::endl;
+        else
+            std::cout << "[INFO] melo_server: a request that joined a running synthesis ended early" << std::endl;
+    }
+
+    melo::LeasePool<melo::TTS>& _pool;
+    const Args& _args;
+    std::shared_ptr<melo::BatchScheduler> _scheduler;
+    melo::SingleFlight<std::string> _flights;
+};
+}  // namespace
+
+int main(int argc, char** argv) {
+    // SIGINT and SIGTERM are blocked in every thread and taken by sigwait below; a closed client must not kill us
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    ConfigureOneDNNCache();
+    SetOneDNN_CPU_MAX_ISA();
+    ServerArgs server_args;
+    Args args = parse_args(split_server_args(argc, argv, server_args));
+    if (server_args.socket_path.empty() && server_args.port == 0)
+        throw std::runtime_error("Neither --socket nor --port is set");
+
+    std::unique_ptr<ov::Core> core_ptr = std::make_unique<ov::Core>();
+    auto startTime = Time::now();
+    std::shared_ptr<melo::BatchScheduler> scheduler;
+    if (server_args.max_batch > 1) {
+        scheduler = melo::TTS::make_batch_scheduler(
+            core_ptr,
+            args.model_dir,
+            args.language,
+            args.tts_device,
+            args.quantize,
+            args.bert_device,
+            args.disable_bert,
+            {server_args.max_batch,
+             std::chrono::microseconds(static_cast<int64_t>(server_args.batch_wait_ms * 1000))});
+    }
+    // one front end pool for every worker, its threads take the sentences of whichever requests are running
+    std::shared_ptr<melo::WorkStealingPool> front_end_pool;
+    if (args.front_end_threads > 0)
+        front_end_pool = std::make_shared<melo::WorkStealingPool>(args.front_end_threads);
+    std::vector<std::unique_ptr<melo::TTS>> models;
+    for (size_t i = 0; i < server_args.workers; ++i) {
+        models.push_back(std::make_unique<melo::TTS>(core_ptr,
+                                                     args.model_dir,
+                                                     args.language,
+                                                     args.tts_device,
+                                                     args.quantize,
+                                                     args.bert_device,
+                                                     args.disable_bert,
+#ifdef USE_DEEPFILTERNET
+                                                     args.nf_ir_path,
+                                                     args.nf_device,
+                                                     args.disable_nf,
+#endif
+                                                     scheduler,
+                                                     args.tts_streams,
+                                                     args.tts_chunk_ms,
+                                                     args.g2p_prewarm_words));
+        models.back()->set_front_end_pool(front_end_pool);
+    }
+    std::cout << "model init time is" << get_duration_ms_till_now(startTime) << " ms" << std::endl;
+
+    melo::LeasePool<melo::TTS> pool(std::move(models), server_args.max_queue);
+    Service service(pool, args, scheduler);
+    // a few connections above the synthesis ones are left for /health
+    melo::SocketServer server(
+        [&](melo::Connection& connection) { service.handle(connection); },
+        std::max(server_args.max_connections, server_args.workers + server_args.max_queue + 8));
+    if (!server_args.socket_path.empty())
+        server.listen_unix(server_args.socket_path);
+    if (server_args.port > 0)
+        server.listen_tcp(server_args.host, static_cast<uint16_t>(server_args.port));
+
+    std::thread signal_thread([&] {
+        int signal_number = 0;
+        sigwait(&stop_signals, &signal_number);
+        std::cout << "[INFO] melo_server: signal " << signal_number << ", finishing the open requests" << std::endl;
+        server.stop();
+    });
+    server.run();
+    signal_thread.join();
+    return EXIT_SUCCESS;
+}
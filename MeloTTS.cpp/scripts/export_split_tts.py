@@ -0,0 +1,135 @@
+"""
+Export the MeloTTS VITS model as three OpenVINO IRs instead of one graph from phones to waveform, so that the C++
+pipeline can decode the audio of a sentence chunk by chunk (--tts_chunk_ms):
+
+    <stem>_encoder.xml  text encoder + duration predictor, expanded to frames and sampled: the inputs of the whole
+                        model -> z_p [1, 192, frames], g [1, 256, 1]
+    <stem>_flow.xml     reverse flow: z_p, g -> z [1, 192, frames]
+    <stem>_decoder.xml  HiFi-GAN decoder: z [1, 192, window], g -> audio [1, 1, window * 512]
+
+<stem> is the name of the whole model the C++ code looks for, e.g. tts_zn_mix_en_int8 or tts_en. The IRs are written
+next to it in the folder given by --ov_path, which is usually the ov_models folder.
+
+    python export_split_tts.py --language ZH --ov_path ../ov_models --quantize
+"""
+import argparse
+from pathlib import Path
+
+import nncf
+import openvino as ov
+import torch
+import torch.nn as nn
+from melo import commons
+from melo.api import TTS
+
+
+class EncoderDuration(nn.Module):
+    """SynthesizerTrn.infer up to the prior sample, with the inputs of the whole exported model"""
+
+    def __init__(self, model):
+        super().__init__()
+        self.model = model
+
+    def forward(self, x, x_lengths, sid, tone, language, bert, ja_bert, noise_scale, length_scale, noise_scale_w,
+                sdp_ratio):
+        model = self.model
+        g = model.emb_g(sid).unsqueeze(-1)  # [b, h, 1]
+        g_p = None if model.use_vc else g
+        x, m_p, logs_p, x_mask = model.enc_p(x, x_lengths, tone, language, bert, ja_bert, g=g_p)
+        logw = model.sdp(x, x_mask, g=g, reverse=True, noise_scale=noise_scale_w) * sdp_ratio + model.dp(
+            x, x_mask, g=g) * (1 - sdp_ratio)
+        w = torch.exp(logw) * x_mask * length_scale
+        w_ceil = torch.ceil(w)
+        y_lengths = torch.clamp_min(torch.sum(w_ceil, [1, 2]), 1).long()
+        y_mask = torch.unsqueeze(commons.sequence_mask(y_lengths, None), 1).to(x_mask.dtype)
+        attn_mask = torch.unsqueeze(x_mask, 2) * torch.unsqueeze(y_mask, -1)
+        attn = commons.generate_path(w_ceil, attn_mask)
+        m_p = torch.matmul(attn.squeeze(1), m_p.transpose(1, 2)).transpose(1, 2)  # [b, d, t']
+        logs_p = torch.matmul(attn.squeeze(1), logs_p.transpose(1, 2)).transpose(1, 2)
+        z_p = m_p + torch.randn_like(m_p) * torch.exp(logs_p) * noise_scale
+        return z_p, g
+
+
+class Flow(nn.Module):
+    """the reverse flow over all frames of a sentence, the batch of one has no padded frames"""
+
+    def __init__(self, model):
+        super().__init__()
+        self.model = model
+
+    def forward(self, z_p, g):
+        y_mask = torch.ones_like(z_p[:, :1, :])
+        return self.model.flow(z_p, y_mask, g=g, reverse=True)
+
+
+class Decoder(nn.Module):
+    """the vocoder, run by the C++ code over windows of the frames with some context on either side"""
+
+    def __init__(self, model):
+        super().__init__()
+        self.model = model
+
+    def forward(self, z, g):
+        return self.model.dec(z, g=g)
+
+
+def convert(module, example_input, input_names, output_names):
+    ov_model = ov.convert_model(module, example_input=example_input)
+    for port, name in zip(ov_model.inputs, input_names):
+        port.get_tensor().set_names({name})
+    for port, name in zip(ov_model.outputs, output_names):
+        port.get_tensor().set_names({name})
+    return ov_model
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Export the split MeloTTS model for chunked decoding")
+    parser.add_argument("--language", default="ZH", choices=["ZH", "EN"])
+    parser.add_argument("--ov_path", default="../ov_models")
+    parser.add_argument("--quantize", action="store_true", help="int8 weights, the <stem>_int8 models")
+    parser.add_argument("--frames", type=int, default=64, help="latent frames of the example input")
+    args = parser.parse_args()
+
+    tts = TTS(language=args.language, device="cpu")
+    model = tts.model
+    stem = "tts_zn_mix_en" if args.language == "ZH" else "tts_en"
+    if args.quantize:
+        stem += "_int8"
+
+    num_phones = 32
+    inter_channels = tts.hps.model.inter_channels
+    gin_channels = tts.hps.model.gin_channels
+    encoder_input = (
+        torch.randint(1, len(tts.hps.symbols), (1, num_phones), dtype=torch.int64),  # phones
+        torch.tensor([num_phones], dtype=torch.int64),  # phones_length
+        torch.tensor([1], dtype=torch.int64),  # speakers
+        torch.zeros(1, num_phones, dtype=torch.int64),  # tones
+        torch.zeros(1, num_phones, dtype=torch.int64),  # lang_ids
+        torch.zeros(1, 1024, num_phones),  # bert
+        torch.randn(1, 768, num_phones),  # ja_bert
+        torch.tensor([0.6]),  # noise_scale
+        torch.tensor([1.0]),  # length_scale
+        torch.tensor([0.8]),  # noise_scale_w
+        torch.tensor([0.2]),  # sdp_ratio
+    )
+    encoder_names = ["phones", "phones_length", "speakers", "tones", "lang_ids", "bert", "ja_bert", "noise_scale",
+                     "length_scale", "noise_scale_w", "sdp_ratio"]
+    z = torch.randn(1, inter_channels, args.frames)
+    g = torch.randn(1, gin_channels, 1)
+
+    with torch.no_grad():
+        models = {
+            "encoder": convert(EncoderDuration(model), encoder_input, encoder_names, ["z_p", "g"]),
+            "flow": convert(Flow(model), (z, g), ["z_p", "g"], ["z"]),
+            "decoder": convert(Decoder(model), (z, g), ["z", "g"], ["audio"]),
+        }
+    for part, ov_model in models.items():
+        if args.quantize:
+            ov_model = nncf.compress_weights(ov_model)
+        path = Path(args.ov_path) / f"{stem}_{part}.xml"
+        ov.save_model(ov_model, path)
+        print(f"save {part} model in {path}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,52 @@
+"""
+Write the WordPiece vocabulary of an OpenVINO tokenizer folder as the Hugging Face vocab.txt (one token per line,
+id = line number), so that OpenVinoTokenizer segments words natively (see src/wordpiece_tokenizer.h) instead of an
+encode + decode round trip through the tokenizer graphs.
+
+The vocabulary is read from the detokenizer IR: the u8 constant unpacked by StringTensorUnpack holds the strings
+packed as [count: i32][offsets: i32 x (count + 1)][utf-8 bytes]. Only the standard library is needed.
+
+    python export_vocab.py --tokenizer_dir ../ov_models/bert-base-uncased
+"""
+import argparse
+import struct
+import xml.etree.ElementTree as ET
+from pathlib import Path
+
+
+def packed_vocab_constant(xml_path):
+    """offset and size in the .bin of the constant that feeds StringTensorUnpack"""
+    net = ET.parse(xml_path).getroot()
+    layers = {layer.get("id"): layer for layer in net.iter("layer")}
+    unpack = next(layer for layer in layers.values() if layer.get("type") == "StringTensorUnpack")
+    edge = next(edge for edge in net.iter("edge") if edge.get("to-layer") == unpack.get("id"))
+    data = layers[edge.get("from-layer")].find("data")
+    return int(data.get("offset")), int(data.get("size"))
+
+
+def read_vocab(tokenizer_dir):
+    offset, size = packed_vocab_constant(tokenizer_dir / "openvino_detokenizer.xml")
+    packed = (tokenizer_dir / "openvino_detokenizer.bin").read_bytes()[offset:offset + size]
+    count = struct.unpack_from("<i", packed, 0)[0]
+    offsets = struct.unpack_from(f"<{count + 1}i", packed, 4)
+    chars = packed[4 * (count + 2):]
+    return [chars[offsets[i]:offsets[i + 1]].decode("utf-8") for i in range(count)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Export vocab.txt from the detokenizer IR of a WordPiece tokenizer")
+    parser.add_argument("--tokenizer_dir", default="../ov_models/bert-base-uncased")
+    parser.add_argument("--output", default=None, help="default: vocab.txt in --tokenizer_dir")
+    args = parser.parse_args()
+
+    tokenizer_dir = Path(args.tokenizer_dir)
+    vocab = read_vocab(tokenizer_dir)
+    if any("\n" in token or "\r" in token for token in vocab):
+        raise ValueError("a token contains a line break and cannot be written one per line")
+    output = Path(args.output) if args.output else tokenizer_dir / "vocab.txt"
+    output.write_text("".join(token + "\n" for token in vocab), encoding="utf-8")
+    print(f"save {len(vocab)} tokens in {output}")
+
+
+if __name__ == "__main__":
+    main()
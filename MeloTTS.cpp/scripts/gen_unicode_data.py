@@ -0,0 +1,104 @@
+"""
+Generate src/unicode_data_tables.inc, the Unicode tables of src/unicode_data.cpp, from the unicodedata module of
+Python. They are what BERT's BasicTokenizer asks unicodedata for:
+
+    PUNCTUATION    ranges of the categories P*
+    WHITESPACE     ranges of the categories Zs, Zl and Zp (the last two are split on by str.split())
+    CONTROL        ranges of the categories C*, unassigned code points included as in transformers
+    NONSPACING     ranges of the category Mn, dropped when accents are stripped
+    NORMALIZED     code point -> UTF-8 of lower() + NFD without Mn, for every code point that changes, except the
+                   Hangul syllables, which are decomposed arithmetically
+
+    python gen_unicode_data.py --output ../src/unicode_data_tables.inc
+"""
+import argparse
+import unicodedata
+from pathlib import Path
+
+MAX_CODE_POINT = 0x10FFFF
+HANGUL_FIRST, HANGUL_LAST = 0xAC00, 0xD7A3
+
+
+def is_surrogate(cp):
+    return 0xD800 <= cp <= 0xDFFF
+
+
+def ranges(predicate):
+    result, first = [], None
+    for cp in range(MAX_CODE_POINT + 2):
+        if cp <= MAX_CODE_POINT and not is_surrogate(cp) and predicate(chr(cp)):
+            if first is None:
+                first = cp
+        elif first is not None:
+            result.append((first, cp - 1))
+            first = None
+    return result
+
+
+def normalized(ch):
+    return "".join(c for c in unicodedata.normalize("NFD", ch.lower()) if unicodedata.category(c) != "Mn")
+
+
+def c_string(text):
+    """a C++ string literal of the UTF-8 bytes, hex escapes are closed before a following hex digit"""
+    out, escaped = '"', False
+    for byte in text.encode("utf-8"):
+        ch = chr(byte)
+        if 0x20 <= byte < 0x7F and ch not in '"\\?':
+            if escaped and ch in "0123456789abcdefABCDEF":
+                out += '" "'
+            out += ch
+            escaped = False
+        else:
+            out += f"\\x{byte:02x}"
+            escaped = True
+    return out + '"'
+
+
+def wrap(items, indent="    ", width=120):
+    lines, line = [], indent
+    for item in items:
+        if len(line) + len(item) + 1 > width and line.strip():
+            lines.append(line.rstrip())
+            line = indent
+        line += item + " "
+    if line.strip():
+        lines.append(line.rstrip())
+    return "\n".join(lines)
+
+
+def range_table(name, table):
+    items = [f"{{0x{first:04X}, 0x{last:04X}}}," for first, last in table]
+    return f"constexpr CodePointRange {name}[] = {{\n{wrap(items)}\n}};\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the Unicode tables of the BERT text normalization")
+    parser.add_argument("--output", default="../src/unicode_data_tables.inc")
+    args = parser.parse_args()
+
+    category = unicodedata.category
+    mapping = []
+    for cp in range(MAX_CODE_POINT + 1):
+        if is_surrogate(cp) or HANGUL_FIRST <= cp <= HANGUL_LAST or category(chr(cp)) == "Mn":
+            continue
+        text = normalized(chr(cp))
+        if text != chr(cp):
+            mapping.append((cp, text))
+
+    parts = [
+        f"// Generated by scripts/gen_unicode_data.py from Unicode {unicodedata.unidata_version}, do not edit.\n",
+        range_table("PUNCTUATION", ranges(lambda ch: category(ch).startswith("P"))),
+        range_table("WHITESPACE", ranges(lambda ch: category(ch) in ("Zs", "Zl", "Zp"))),
+        range_table("CONTROL", ranges(lambda ch: category(ch).startswith("C"))),
+        range_table("NONSPACING", ranges(lambda ch: category(ch) == "Mn")),
+        "constexpr NormalizedCodePoint NORMALIZED[] = {\n"
+        + wrap([f"{{0x{cp:04X}, {c_string(text)}}}," for cp, text in mapping])
+        + "\n};\n",
+    ]
+    Path(args.output).write_text("\n".join(parts), encoding="utf-8", newline="\n")
+    print(f"save {len(mapping)} normalized code points in {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,88 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "batch_scheduler.h"
+
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace melo {
+BatchScheduler::BatchScheduler(std::unique_ptr<ov::Core>& core,
+                               const std::filesystem::path& tts_ir_path,
+                               const std::string& tts_device,
+                               bool tts_quantize,
+                               const std::filesystem::path& bert_ir_path,
+                               const std::string& bert_device,
+                               const std::string& language,
+                               bool disable_bert,
+                               const Options& options)
+    : _options(options),
+      _disable_bert(disable_bert),
+      _tts_model(core,
+                 tts_ir_path,
+                 tts_device,
+                 language,
+                 tts_quantize,
+                 // the streams of the compiled model are the items of a batch that run at the same time
+                 AbstractOpenvinoModel::with_streams(
+                     OpenVoiceTTS::set_tts_config(tts_device, tts_quantize), tts_device, options.max_batch)),
+      _bert_batcher(
+          [this](std::vector<BertInput>& inputs, std::vector<std::vector<std::vector<float>>>& berts) {
+              _bert_model.get_bert_features(inputs, berts);
+          },
+          {options.max_batch, options.max_wait, BERT_BUCKET_WIDTH}),
+      _tts_batcher(
+          [this](std::vector<OpenVoiceTTS::Input>& inputs, std::vector<std::vector<float>>& wavs) {
+              wavs = _tts_model.tts_infer_batch(inputs);
+          },
+          {options.max_batch, options.max_wait, TTS_BUCKET_WIDTH}) {
+    assert((core.get() != nullptr) && "core should not be null!");
+    if (!_disable_bert) {
+        // the batches carry their own token ids, the tokenizer stays with the TTS instances
+        _bert_model = Bert(core,
+                           bert_ir_path,
+                           bert_device,
+                           language,
+                           nullptr,
+                           AbstractOpenvinoModel::with_streams(
+                               AbstractOpenvinoModel::set_ov_config(bert_device), bert_device, options.max_batch));
+    }
+    std::cout << "[INFO] BatchScheduler: batches of up to " << options.max_batch << " sentences, waiting up to "
+              << options.max_wait.count() / 1000.0 << " ms for them\n";
+}
+
+std::vector<std::vector<float>> BatchScheduler::bert(const TokenizedText& tokenized,
+                                                     const std::vector<int>& word2ph,
+                                                     const RequestControl& control) {
+    if (_disable_bert)
+        throw std::runtime_error("BatchScheduler: BERT is disabled");
+    if (word2ph.size() != tokenized.ids.size()) {
+        throw std::runtime_error("BatchScheduler::bert: word2ph has " + std::to_string(word2ph.size()) +
+                                 " entries for " + std::to_string(tokenized.ids.size()) + " tokens");
+    }
+    const size_t length = tokenized.ids.size();
+    return _bert_batcher.submit({tokenized.ids, word2ph}, length, control).get();
+}
+
+std::vector<float> BatchScheduler::tts(OpenVoiceTTS::Input input, const RequestControl& control) {
+    const size_t length = input.phones.size();
+    return _tts_batcher.submit(std::move(input), length, control).get();
+}
+
+}  // namespace melo
@@ -0,0 +1,91 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef BATCH_SCHEDULER_H
+#define BATCH_SCHEDULER_H
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bert.h"
+#include "micro_batcher.h"
+#include "openvoice_tts.h"
+#include "request_control.h"
+#include "tokenized_text.h"
+
+namespace melo {
+/**
+ * @brief One compiled BERT and TTS model shared by several TTS instances that synthesize on their own threads, e.g.
+ * the workers of a server. The sentences they submit are grouped by MicroBatcher into batches of similar length and
+ * each batch runs on max_batch streams of the compiled model, so that concurrent requests keep the device busy instead
+ * of taking turns on a model each.
+ */
+class BatchScheduler {
+public:
+    struct Options {
+        size_t max_batch = 4;                        // 1 runs every sentence on its own
+        std::chrono::microseconds max_wait{10000};  // how long a sentence may wait for others
+    };
+    // lengths within a bucket differ by less than these
+    static constexpr size_t BERT_BUCKET_WIDTH = 16;  // tokens
+    static constexpr size_t TTS_BUCKET_WIDTH = 32;   // phones
+
+    BatchScheduler(std::unique_ptr<ov::Core>& core,
+                   const std::filesystem::path& tts_ir_path,
+                   const std::string& tts_device,
+                   bool tts_quantize,
+                   const std::filesystem::path& bert_ir_path,
+                   const std::string& bert_device,
+                   const std::string& language,
+                   bool disable_bert,
+                   const Options& options);
+    BatchScheduler(const BatchScheduler&) = delete;
+    BatchScheduler& operator=(const BatchScheduler&) = delete;
+
+    // Both block the calling thread until the batch holding its sentence is done, and rethrow the error of the batch.
+    // control orders the sentence against the waiting ones and drops it with Cancelled once cancelled
+    std::vector<std::vector<float>> bert(const TokenizedText& tokenized,
+                                         const std::vector<int>& word2ph,
+                                         const RequestControl& control = {});
+    std::vector<float> tts(OpenVoiceTTS::Input input, const RequestControl& control = {});
+
+    inline const Options& options() const {
+        return _options;
+    }
+    using BertBatcher = MicroBatcher<BertInput, std::vector<std::vector<float>>>;
+    using TtsBatcher = MicroBatcher<OpenVoiceTTS::Input, std::vector<float>>;
+    inline BertBatcher::Stats bert_stats() const {
+        return _bert_batcher.stats();
+    }
+    inline TtsBatcher::Stats tts_stats() const {
+        return _tts_batcher.stats();
+    }
+
+private:
+    Options _options;
+    bool _disable_bert;
+    Bert _bert_model;
+    OpenVoiceTTS _tts_model;
+    // after the models, the dispatchers are stopped before the models are destroyed
+    BertBatcher _bert_batcher;
+    TtsBatcher _tts_batcher;
+};
+}  // namespace melo
+#endif  // BATCH_SCHEDULER_H
@@ -17,20 +17,76 @@
  */
 #include "bert.h"
 
+#include <array>
 #include <cassert>
+#include <stdexcept>
+#include <string>
 
 #include "utils.h"
 namespace melo {
 void Bert::get_bert_feature(const std::string& text,
                             const std::vector<int>& word2ph,
                             std::vector<std::vector<float>>& berts) {
-    // clear previous result
-    _input_ids.clear();
-    _attention_mask.clear();
-    _token_type_ids.clear();
-
     // get token ids
     _input_ids = _ov_tokenizer->tokenize(text);
+    infer_input_ids(word2ph, berts);
+}
+
+void Bert::get_bert_feature(const TokenizedText& tokenized,
+                            const std::vector<int>& word2ph,
+                            std::vector<std::vector<float>>& berts) {
+    if (word2ph.size() != tokenized.ids.size()) {
+        throw std::runtime_error("Bert::get_bert_feature: word2ph has " + std::to_string(word2ph.size()) +
+                                 " entries for " + std::to_string(tokenized.ids.size()) + " tokens");
+    }
+    _input_ids = tokenized.ids;
+    infer_input_ids(word2ph, berts);
+}
+
+void Bert::infer_input_ids(const std::vector<int>& word2ph, std::vector<std::vector<float>>& berts) {
+    prepare_inputs();
+    ov_infer();
+
+    get_output(word2ph, berts);
+}
+
+void Bert::start_bert_feature(const TokenizedText& tokenized) {
+    if (_running)
+        throw std::runtime_error("Bert::start_bert_feature: the previous sentence is still running");
+    _input_ids = tokenized.ids;
+    _num_started_tokens = tokenized.ids.size();
+    prepare_inputs();
+    set_input_tensors();
+    _start_time = Time::now();
+    _infer_request->start_async();
+    _running = true;
+}
+
+void Bert::wait_bert_feature(const std::vector<int>& word2ph, std::vector<std::vector<float>>& berts) {
+    if (!_running)
+        throw std::runtime_error("Bert::wait_bert_feature: nothing is running");
+    _running = false;
+    _infer_request->wait();
+    std::cout << "[INFO] bert infer time: " << get_duration_ms_till_now(_start_time) << "ms, overlapped with G2P\n";
+    if (word2ph.size() != _num_started_tokens) {
+        throw std::runtime_error("Bert::wait_bert_feature: word2ph has " + std::to_string(word2ph.size()) +
+                                 " entries for " + std::to_string(_num_started_tokens) + " tokens");
+    }
+    get_output(word2ph, berts);
+}
+
+void Bert::cancel_bert_feature() noexcept {
+    if (!_running)
+        return;
+    _running = false;
+    try {
+        _infer_request->cancel();
+        _infer_request->wait();
+    } catch (...) {
+    }
+}
+
+void Bert::prepare_inputs() {
     size_t n = _input_ids.size();
     _attention_mask = std::vector<int64_t>(n, 1);
     _token_type_ids = std::vector<int64_t>(n, 0);
@@ -47,15 +103,68 @@ void Bert::get_bert_feature(const std::string& text,
     std::cout << std::endl;
     print_input_names();
 #endif
-    ov_infer();
+}
 
-    get_output(word2ph, berts);
+void Bert::get_bert_features(const std::vector<BertInput>& inputs,
+                             std::vector<std::vector<std::vector<float>>>& berts) {
+    // the input tensors wrap these buffers, which must live until the requests are done
+    std::vector<std::array<std::vector<int64_t>, 3>> buffers(inputs.size());
+    auto startTime = Time::now();
+    size_t started = 0;
+    try {
+        for (; started < inputs.size(); ++started) {
+            auto& [input_ids, attention_mask, token_type_ids] = buffers[started];
+            input_ids = inputs[started].ids;
+            attention_mask = std::vector<int64_t>(input_ids.size(), 1);
+            token_type_ids = std::vector<int64_t>(input_ids.size(), 0);
+            if (_static_shape) {
+                input_ids = to_static_1d_shape(input_ids);
+                attention_mask = to_static_1d_shape(attention_mask);
+                token_type_ids = to_static_1d_shape(token_type_ids);
+            }
+            const size_t n = input_ids.size();
+            ov::InferRequest& request = batch_request(started);
+            request.set_input_tensor(2, ov::Tensor(ov::element::i64, {BATCH_SIZE, n}, token_type_ids.data()));
+            request.set_input_tensor(1, ov::Tensor(ov::element::i64, {BATCH_SIZE, n}, attention_mask.data()));
+            request.set_input_tensor(0, ov::Tensor(ov::element::i64, {BATCH_SIZE, n}, input_ids.data()));
+            request.start_async();
+        }
+        wait_batch_requests(started);
+    } catch (...) {
+        try {
+            wait_batch_requests(started);
+        } catch (...) {
+        }
+        throw;
+    }
+    std::cout << "[INFO] bert batch of " << inputs.size() << " infer time: " << get_duration_ms_till_now(startTime)
+              << "ms\n";
+
+    berts.assign(inputs.size(), {});
+    for (size_t i = 0; i < inputs.size(); ++i)
+        to_phone_level(batch_request(i).get_output_tensor(0), inputs[i].word2ph, berts[i]);
 }
 
 void Bert::ov_infer() {
 #ifdef MELO_DEBUG
     std::cout << "Bert::ov_infer:ov_infer begin\n";
 #endif  // DEBUG_PRINT
+    set_input_tensors();
+    auto startTime = Time::now();
+    _infer_request->infer();
+    auto inferTime = get_duration_ms_till_now(startTime);
+    std::cout << "[INFO] bert infer time: " << inferTime << "ms\n";
+#if defined(MODEL_PROFILING_DEBUG)
+    std::cout << "---- [Bert]: Bert model profiling ----" << std::endl;
+    get_profiling_info(_infer_request);
+#endif  // MODEL_PROFILING_DEBUG
+#ifdef MELO_DEBUG
+    std::cout << "bert infer ok\n";
+#endif
+}
+
+// the tensors wrap the member buffers, which are left alone until the request is done
+void Bert::set_input_tensors() {
     size_t n = _input_ids.size();
 
     // set input tensor
@@ -73,22 +182,10 @@ void Bert::ov_infer() {
     _infer_request->set_input_tensor(2, token_type_ids);
     _infer_request->set_input_tensor(1, attention_mask);
     _infer_request->set_input_tensor(0, input_ids);
-    auto startTime = Time::now();
-    _infer_request->infer();
-    auto inferTime = get_duration_ms_till_now(startTime);
-    std::cout << "[INFO] bert infer time: " << inferTime << "ms\n";
-#if defined(MODEL_PROFILING_DEBUG)
-    std::cout << "---- [Bert]: Bert model profiling ----" << std::endl;
-    get_profiling_info(_infer_request);
-#endif  // MODEL_PROFILING_DEBUG
-#ifdef MELO_DEBUG
-    std::cout << "bert infer ok\n";
-#endif
 }
 
 void Bert::get_output(const std::vector<int>& word2ph, std::vector<std::vector<float>>& phone_level_feature) {
     const ov::Tensor& output_tensor = _infer_request->get_output_tensor(0);
-    const float* output_data = _infer_request->get_output_tensor(0).data<const float>();
     // size_t output_size = _input_ids.size();//_infer_request->GetOutputTensorSize(0);
     size_t frame_num = output_tensor.get_shape()[0];
 
@@ -105,6 +202,19 @@ void Bert::get_output(const std::vector<int>& word2ph, std::vector<std::vector<f
     }
     std::cout << std::endl;
 #endif
+    to_phone_level(output_tensor, word2ph, phone_level_feature);
+}
+
+void Bert::to_phone_level(const ov::Tensor& output_tensor,
+                          const std::vector<int>& word2ph,
+                          std::vector<std::vector<float>>& phone_level_feature) {
+    const float* output_data = output_tensor.data<const float>();
+    size_t frame_num = output_tensor.get_shape()[0];
+    // a static shape model pads the tokens, so word2ph may be shorter but never longer
+    if (word2ph.size() > frame_num) {
+        throw std::runtime_error("Bert::to_phone_level: word2ph has " + std::to_string(word2ph.size()) +
+                                 " entries for " + std::to_string(frame_num) + " tokens");
+    }
     std::vector<std::vector<float>> res(frame_num, std::vector<float>(768, 0.0));
     for (int i = 0; i < frame_num; ++i) {
         for (int j = 0; j < 768; ++j) {
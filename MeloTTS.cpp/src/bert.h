@@ -20,18 +20,27 @@
 #define BERT_H
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "openvino_model_base.h"
 #include "openvino_tokenizer.h"
+#include "tokenized_text.h"
 namespace melo {
+// one sentence of a batch: the token ids and one word2ph entry per token
+struct BertInput {
+    std::vector<int64_t> ids;
+    std::vector<int> word2ph;
+};
+
 class Bert : public AbstractOpenvinoModel {
 public:
     Bert(std::unique_ptr<ov::Core>& core_ptr,
          const std::filesystem::path& model_path,
          const std::string& device,
          std::string language,
-         std::shared_ptr<OpenVinoTokenizer> tokenizer)
-        : AbstractOpenvinoModel(core_ptr, model_path, device),
+         std::shared_ptr<OpenVinoTokenizer> tokenizer,
+         const std::optional<ov::AnyMap> config = std::nullopt)
+        : AbstractOpenvinoModel(core_ptr, model_path, device, config),
           _language(language),
           _ov_tokenizer(tokenizer),
           _static_shape(device == "NPU" ? true : false) {}
@@ -40,6 +49,19 @@ public:
     void get_bert_feature(const std::string& text,
                           const std::vector<int>& word2ph,
                           std::vector<std::vector<float>>& berts);
+    // Same as above with the ids G2P already computed, word2ph must hold one entry per token of tokenized
+    void get_bert_feature(const TokenizedText& tokenized,
+                          const std::vector<int>& word2ph,
+                          std::vector<std::vector<float>>& berts);
+    // Same as above in two steps, so that the caller can run G2P meanwhile: start_bert_feature needs the tokenization
+    // only, the word2ph from G2P is needed once the output is expanded. Every start is followed by a wait or a cancel.
+    void start_bert_feature(const TokenizedText& tokenized);
+    void wait_bert_feature(const std::vector<int>& word2ph, std::vector<std::vector<float>>& berts);
+    void cancel_bert_feature() noexcept;
+    // The features of several sentences, each on a batch request of its own: the exported model squeezes the batch
+    // dimension, so the sentences run side by side on the streams of the compiled model instead of one padded tensor
+    void get_bert_features(const std::vector<BertInput>& inputs,
+                           std::vector<std::vector<std::vector<float>>>& berts);
     virtual void ov_infer();
     virtual void get_output(const std::vector<int>& word2ph, std::vector<std::vector<float>>& phone_level_feature);
 
@@ -58,11 +80,25 @@ public:
     [[maybe_unused]] void set_input_tensors(const std::vector<int64_t>& token_ids,
                                             bool static_shape);                  // intended for testing purposes only
     [[maybe_unused]] virtual void get_output(std::vector<std::vector<float>>&);  // intended for testing purposes only
+    // repeat the feature of every token word2ph[i] times, throws std::runtime_error when word2ph has more entries than
+    // the output has tokens
+    static void to_phone_level(const ov::Tensor& output_tensor,
+                               const std::vector<int>& word2ph,
+                               std::vector<std::vector<float>>& phone_level_feature);
+
 private:
+    void infer_input_ids(const std::vector<int>& word2ph, std::vector<std::vector<float>>& berts);
+    // the attention mask and token type ids of _input_ids, padded for the static shape model
+    void prepare_inputs();
+    void set_input_tensors();
+
     bool _static_shape = false;
     std::string _language;
     std::shared_ptr<OpenVinoTokenizer> _ov_tokenizer;
     std::vector<int64_t> _input_ids, _attention_mask, _token_type_ids;
+    bool _running = false;  // started, not waited for yet
+    size_t _num_started_tokens = 0;
+    Time::time_point _start_time;
 };
 }  // namespace melo
 #endif  // BERT_H
@@ -4,10 +4,28 @@
 #include "deepfilter.h"
 #include "openvino_torch_utils.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
+#include "dfn_dsp.h"
+
 namespace melo {
    namespace ov_deepfilternet {
+      namespace {
+         // Exponential smoothing over the frames of xs [frames, bands], starting from and updating state [bands].
+         // Returns the state after every frame.
+         torch::Tensor lerp_scan(const torch::Tensor& xs, torch::Tensor& state, float alpha)
+         {
+            auto x = xs.contiguous();
+            auto out = torch::empty_like(x);
+            auto next_state = state.clone().contiguous();
+            dsp::lerp_scan(x.data_ptr<float>(), next_state.data_ptr<float>(), out.data_ptr<float>(), x.size(0), x.size(1), alpha);
+            state = next_state;
+            return out;
+         }
+      }
+
       DeepFilter::DeepFilter()
       {
          std::cout << "[NF][DFNet] DeepFilter Constructor" << std::endl;
@@ -73,10 +91,12 @@ namespace melo {
 
          _alpha = alpha;
 
-         // Init buffers
-         _reset_reg();
+         // window of the streaming inference, see process()
+         const int64_t num_hops = STREAM_CONTEXT_HOPS + STREAM_BLOCK_HOPS + _lookahead;
+         _dfnet = std::make_shared< DFNetModel >(core, model_folder, device, model_selection, nf_ov_cfg, _erb_indices, _lookahead, _nb_df, num_hops);
 
-         _dfnet = std::make_shared< DFNetModel >(core, model_folder, device, model_selection, nf_ov_cfg, _erb_indices, 2, _nb_df);
+         // Init buffers
+         reset_stream();
       }
 
       void DeepFilter::_reset_reg()
@@ -89,251 +109,190 @@ namespace melo {
 
       std::vector<float> DeepFilter::filter(torch::Tensor noisy_audio, std::optional<float> atten_lim_db, float normalize_atten_lim, float df3_post_filter, ProgressCallbackFunc callback, void* callback_user)
       {
+         noisy_audio = noisy_audio.squeeze(0).contiguous();
+         const float* samples = noisy_audio.data_ptr<float>();
+         const int64_t total_nsamples = noisy_audio.size(0);
+         const int64_t block_samples = STREAM_BLOCK_HOPS * _frame_size;
 
-         //TODO: Make this less confusing. The hardcoded 2 here is lookahead.
-         // Calculate the 'chunk size' which is the amount of samples that we *always* will pass into forward.
-         const int64_t chunk_size = (_dfnet->num_static_hops() - 2) * _frame_size;
-
-         std::cout << "[NF][DFNet] chunk_size = " << chunk_size << std::endl;
-         bool pad = true;
-
-         //take the mean first, for the entire audio segment.
-         //noisy_audio = noisy_audio.mean(0);
-         noisy_audio = noisy_audio.squeeze(0);
-
-         //this might be overkill, but it seems to provide good results... and inference on a 30-second
-         // snippet is super fast, so why not.
-         // 
-         //TODO! Even though we overlap 10 seconds, only crossfade half of that (i.e. throw away entirely half of new segment).
-         // The start of each new segment has a zero-ed out initial state, and could potentially have weird 'starting' artifacts.
-         double crossfade_overlap_seconds = 10;
-
-         //note, 48000 here is sample rate
-         int64_t overlap_samples = (int64_t)((double)48000 * (double)crossfade_overlap_seconds);
-
-         // each segment consists of an offset, and size
-         std::vector< std::pair<int64_t, int64_t> > segments;
-
-         int64_t total_nsamples = noisy_audio.size(0);
+         std::vector<float> output_wav;
+         output_wav.reserve(total_nsamples);
 
+         reset_stream();
+         for (int64_t offset = 0; offset < total_nsamples; offset += block_samples)
          {
-            int64_t current_sample = 0;
-            while (current_sample < total_nsamples)
-            {
-               if (current_sample != 0)
-               {
-                  current_sample -= overlap_samples;
-               }
-
-               std::pair<size_t, size_t> segment = { current_sample,
-                  std::min(total_nsamples - current_sample, chunk_size) };
-
-               segments.push_back(segment);
-
-               current_sample += chunk_size;
-            }
-         }
-
-         std::vector<float> output_wav = std::vector<float>(total_nsamples);
-
-         for (size_t segmenti = 0; segmenti < segments.size(); segmenti++)
-         {
-
-            using namespace torch::indexing;
-
-            auto src_offset = segments[segmenti].first;
-            auto src_size = segments[segmenti].second;
-
-            torch::Tensor chunk_tensor;
-            if (src_size < chunk_size)
-            {
-               chunk_tensor = torch::zeros({ chunk_size });
-               chunk_tensor.index_put_({ Slice(0, src_size) }, noisy_audio.index({ Slice(src_offset, src_offset + src_size) }));
-            }
-            else
-            {
-               chunk_tensor = noisy_audio.index({ Slice(src_offset, src_offset + src_size) });
-            }
-
-            auto wav = forward(chunk_tensor, pad, atten_lim_db, normalize_atten_lim, df3_post_filter);
-
-            if (segmenti == 0)
-            {
-               std::memcpy(output_wav.data(), wav->data(), src_size * sizeof(float));
-            }
-            else
-            {
-               //cross-fade
-               float fade_step = 1.f / (float)(overlap_samples);
-
-               float* pLast = output_wav.data() + src_offset;
-               float* pNew = wav->data();
-
-               int64_t valid_overlap_samples = std::min(overlap_samples, src_size);
-               torch::Tensor crossfade_left = torch::from_blob(pLast, { valid_overlap_samples });
-               torch::Tensor crossfade_right = torch::from_blob(pNew, { valid_overlap_samples });
-
-               auto multiplier = torch::linspace(0.f, 1.f, std::min(valid_overlap_samples, src_size));
-
-               auto faded = crossfade_right * multiplier + crossfade_left * (1.f - multiplier);
-
-               std::memcpy(pLast, faded.data_ptr(), valid_overlap_samples * sizeof(float));
-
-               size_t samples_left = src_size - valid_overlap_samples;
-               if (samples_left)
-               {
-                  std::memcpy(pLast + valid_overlap_samples, pNew + valid_overlap_samples, samples_left * sizeof(float));
-               }
-            }
+            const int64_t n = std::min(block_samples, total_nsamples - offset);
+            process(std::span<const float>(samples + offset, n), output_wav, atten_lim_db, normalize_atten_lim, df3_post_filter);
 
             if (callback)
             {
-               float perc_complete = (float)(segmenti + 1) / segments.size();
+               float perc_complete = (float)(offset + n) / total_nsamples;
                if (!callback(perc_complete, callback_user))
                {
                   //callback returned false, so return empty wav
+                  reset_stream();
                   return {};
                }
             }
          }
+         flush(output_wav, atten_lim_db, normalize_atten_lim, df3_post_filter);
 
          return output_wav;
       }
 
-      static inline torch::Tensor as_complex(torch::Tensor x)
+      void DeepFilter::reset_stream()
       {
-         if (torch::is_complex(x))
-         {
-            return x;
-         }
-
-         if (x.size(-1) != 2)
-         {
-            throw std::runtime_error("Last dimension need to be of length 2 (re + im)");
-         }
-
-         if (x.stride(-1) != 1)
-         {
-            x - x.contiguous();
-         }
+         _reset_reg();
+         _stream_pending.clear();
+         _hist_spec = torch::zeros({ 0, _freq_size }, torch::kComplexFloat);
+         _hist_erb_feat = torch::zeros({ 0, _n_erb_features });
+         _hist_spec_feat = torch::zeros({ 0, _nb_df }, torch::kComplexFloat);
+         _hist_begin = 0;
+         _num_frames = 0;
+         _num_emitted = 0;
+         _num_input_samples = 0;
+         _num_output_samples = 0;
+         // the real-time STFT delays the signal by one window minus one hop
+         _skip_samples = _fft_size - _frame_size;
+      }
 
-         return torch::view_as_complex(x);
+      void DeepFilter::process(std::span<const float> noisy_audio, std::vector<float>& output, std::optional<float> atten_lim_db, float normalize_atten_lim, float df3_post_filter)
+      {
+         _stream_pending.insert(_stream_pending.end(), noisy_audio.begin(), noisy_audio.end());
+         _num_input_samples += noisy_audio.size();
+         _stream_analysis();
+         _stream_run(output, false, atten_lim_db, normalize_atten_lim, df3_post_filter);
       }
 
-      std::shared_ptr<std::vector<float>> DeepFilter::forward(torch::Tensor noisy_audio, bool pad, std::optional<float> atten_lim_db, float normalize_atten_lim, float df3_post_filter)
+      void DeepFilter::flush(std::vector<float>& output, std::optional<float> atten_lim_db, float normalize_atten_lim, float df3_post_filter)
       {
-         _reset_reg();
+         // complete the last hop, then pad to compensate for the delay due to the real-time STFT implementation
+         const int64_t partial = _stream_pending.size() % _frame_size;
+         if (partial)
+            _stream_pending.resize(_stream_pending.size() + _frame_size - partial, 0.f);
+         _stream_pending.resize(_stream_pending.size() + _fft_size, 0.f);
+         _stream_analysis();
+         _stream_run(output, true, atten_lim_db, normalize_atten_lim, df3_post_filter);
+
+         // drop the padding
+         const int64_t extra = _num_output_samples - _num_input_samples;
+         if (extra > 0)
+            output.resize(output.size() - extra);
+         _dfnet->release_infer_memory();
+         reset_stream();
+      }
 
-         auto audio = noisy_audio;
-         auto orig_len = audio.sizes().back();
+      void DeepFilter::_stream_analysis()
+      {
+         const int64_t nhops = _stream_pending.size() / _frame_size;
+         if (nhops == 0)
+            return;
 
-         if (pad)
-         {
-            // Pad audio to compensate for the delay due to the real-time STFT implementation
-            audio = torch::nn::functional::pad(audio, torch::nn::functional::PadFuncOptions({ 0, _fft_size }));
-         }
+         // clone: the analysis memory keeps a view of the last hop
+         auto audio = torch::from_blob(_stream_pending.data(), { nhops * _frame_size }).clone();
+         _stream_pending.erase(_stream_pending.begin(), _stream_pending.begin() + nhops * _frame_size);
 
          auto df_ret = _df_features(audio);
-         auto spec = std::get<0>(df_ret);
-         auto erb_feat = std::get<1>(df_ret);
-         auto spec_feat = std::get<2>(df_ret);
-
-         //_infer_request
-         spec = spec.contiguous();
-         erb_feat = erb_feat.contiguous();
-         spec_feat = spec_feat.contiguous();
-
-         auto enhanced = _dfnet->forward(spec, erb_feat, spec_feat, df3_post_filter);
-
-         if (atten_lim_db && (std::abs(*atten_lim_db) > 0))
-         {
-            float lim = std::pow(10, (-std::abs(*atten_lim_db) / normalize_atten_lim));
-            enhanced = torch::lerp(enhanced, spec, lim);
-         }
+         _hist_spec = torch::cat({ _hist_spec, std::get<0>(df_ret) });
+         _hist_erb_feat = torch::cat({ _hist_erb_feat, std::get<1>(df_ret) });
+         _hist_spec_feat = torch::cat({ _hist_spec_feat, std::get<2>(df_ret) });
+         _num_frames += nhops;
+      }
 
+      void DeepFilter::_stream_run(std::vector<float>& output, bool flushing, std::optional<float> atten_lim_db, float normalize_atten_lim, float df3_post_filter)
+      {
+         using namespace torch::indexing;
+         const int64_t window_hops = _dfnet->num_static_hops();
 
+         // the last _lookahead frames are final only once the following frames are known
+         const int64_t ready = flushing ? _num_frames : _num_frames - _lookahead;
+         while (ready - _num_emitted >= STREAM_BLOCK_HOPS || (flushing && _num_emitted < ready))
          {
-            std::vector< int64_t > view_shape;
-            for (size_t i = 2; i < enhanced.sizes().size(); i++)
-               view_shape.push_back(enhanced.size(i));
-            enhanced = torch::view_as_complex(enhanced.view(view_shape));
-         }
+            const int64_t window_begin = std::max<int64_t>(0, _num_emitted - STREAM_CONTEXT_HOPS);
+            // at most one block per run: the windows, hence the output, do not depend on the block sizes of process()
+            const int64_t emit_end = std::min({ ready, _num_emitted + STREAM_BLOCK_HOPS, window_begin + window_hops - _lookahead });
+            // the networks are causal, the smallest shape that covers the emitted frames and their lookahead suffices
+            const int64_t hops = _dfnet->num_hops_for(emit_end - window_begin + _lookahead);
+            const int64_t available = std::min(_num_frames, window_begin + hops) - window_begin;
+
+            // frames after the last analysed one stay zero, the same as padding the clip
+            auto spec = torch::zeros({ hops, _freq_size }, torch::kComplexFloat);
+            auto erb_feat = torch::zeros({ hops, _n_erb_features });
+            auto spec_feat = torch::zeros({ hops, _nb_df }, torch::kComplexFloat);
+            const int64_t offset = window_begin - _hist_begin;
+            spec.index({ Slice(0, available) }).copy_(_hist_spec.index({ Slice(offset, offset + available) }));
+            erb_feat.index({ Slice(0, available) }).copy_(_hist_erb_feat.index({ Slice(offset, offset + available) }));
+            spec_feat.index({ Slice(0, available) }).copy_(_hist_spec_feat.index({ Slice(offset, offset + available) }));
+
+            auto spec_in = torch::view_as_real(spec).unsqueeze(0).unsqueeze(0).contiguous();
+            auto erb_in = erb_feat.unsqueeze(0).unsqueeze(0).contiguous();
+            auto spec_feat_in = torch::view_as_real(spec_feat).unsqueeze(0).unsqueeze(0).contiguous();
+
+            auto enhanced = _dfnet->forward(spec_in, erb_in, spec_feat_in, df3_post_filter);
+
+            if (atten_lim_db && (std::abs(*atten_lim_db) > 0))
+            {
+               float lim = std::pow(10, (-std::abs(*atten_lim_db) / normalize_atten_lim));
+               enhanced = torch::lerp(enhanced, spec_in, lim);
+            }
 
-         audio = _synthesis_time(enhanced).unsqueeze(0);
+            {
+               std::vector< int64_t > view_shape;
+               for (size_t i = 2; i < enhanced.sizes().size(); i++)
+                  view_shape.push_back(enhanced.size(i));
+               enhanced = torch::view_as_complex(enhanced.view(view_shape));
+            }
 
-         if (pad)
-         {
-            using namespace torch::indexing;
-            auto d = _fft_size - _frame_size;
-            audio = audio.index({ Slice(None), Slice(d, orig_len + d) });
+            auto audio = _synthesis_time(enhanced.index({ Slice(_num_emitted - window_begin, emit_end - window_begin) }));
+            const float* samples = audio.data_ptr<float>();
+            const int64_t skip = std::min<int64_t>(_skip_samples, audio.size(0));
+            output.insert(output.end(), samples + skip, samples + audio.size(0));
+            _skip_samples -= skip;
+            _num_output_samples += audio.size(0) - skip;
+            _num_emitted = emit_end;
+
+            // keep the frames of the next context
+            const int64_t keep_from = std::max<int64_t>(0, _num_emitted - STREAM_CONTEXT_HOPS);
+            if (keep_from > _hist_begin)
+            {
+               _hist_spec = _hist_spec.index({ Slice(keep_from - _hist_begin, None) });
+               _hist_erb_feat = _hist_erb_feat.index({ Slice(keep_from - _hist_begin, None) });
+               _hist_spec_feat = _hist_spec_feat.index({ Slice(keep_from - _hist_begin, None) });
+               _hist_begin = keep_from;
+            }
          }
-
-         std::shared_ptr<std::vector<float>> wav = std::make_shared< std::vector<float> >(audio.size(1));
-         std::memcpy(wav->data(), audio.data_ptr<float>(), audio.size(1) * sizeof(float));
-         return wav;
       }
 
-
+      // spec [frames, freq], erb features [frames, nb_erb] and spec features [frames, nb_df] of audio, which must
+      // be a whole number of hops
       std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> DeepFilter::_df_features(torch::Tensor audio)
       {
          auto spec = _analysis_time(audio);
          auto erb_feat = _erb_norm_time(_erb(spec), _alpha);
 
          using namespace torch::indexing;
-         auto spec_feat = torch::view_as_real(_unit_norm_time(spec.index({ "...", Slice(None, _nb_df) }), _alpha));
-         spec = torch::view_as_real(spec);
+         auto spec_feat = _unit_norm_time(spec.index({ "...", Slice(None, _nb_df) }), _alpha);
 
-         auto spec_ret = spec.unsqueeze(0).unsqueeze(0);
-         auto erb_feat_ret = erb_feat.unsqueeze(0).unsqueeze(0);
-         auto spec_feat_ret = spec_feat.unsqueeze(0).unsqueeze(0);
-
-         return { spec_ret , erb_feat_ret, spec_feat_ret };
+         return { spec, erb_feat, spec_feat };
       }
 
+      // One batched rfft over all frames. Frame i is window * [previous hop | hop i].
       torch::Tensor DeepFilter::_analysis_time(torch::Tensor input_data)
       {
-         auto in_chunks = torch::split(input_data, _frame_size);
-
-         // time chunks iteration
-         std::vector< torch::Tensor > output;
-         for (auto ichunk : in_chunks)
-         {
-            output.push_back(_frame_analysis(ichunk));
-         }
-
-         return torch::stack(output, 0);
-      }
-
-      torch::Tensor DeepFilter::_frame_analysis(torch::Tensor input_frame)
-      {
-         //First part of the window on the previous frame
-         //Second part of the window on the new input frame
-         auto buf = torch::cat({ _reg_analysis_mem, input_frame }) * _window;
-         auto buf_fft = torch::fft::rfft(buf, {}, -1, "backward") * _wnorm;
-
-         // Copy input to analysis_mem for next iteration
-         _reg_analysis_mem = input_frame;
-
-         return buf_fft;
-      }
+         using namespace torch::indexing;
+         auto buf = torch::cat({ _reg_analysis_mem, input_data });
+         auto frames = buf.unfold(0, _window_size, _frame_size) * _window;
+         auto spec = torch::fft::rfft(frames, {}, -1, "backward") * _wnorm;
 
-      torch::Tensor DeepFilter::_erb_norm_time(torch::Tensor input_data, float alpha)
-      {
-         std::vector<torch::Tensor> output;
+         // Copy the last input to analysis_mem for the next block
+         _reg_analysis_mem = input_data.index({ Slice(input_data.size(0) - (_fft_size - _frame_size), None) }).clone();
 
-         for (int64_t i = 0; i < input_data.size(0); ++i) {
-            torch::Tensor in_step = input_data[i];
-            output.push_back(_band_mean_norm_erb(in_step, alpha));
-         }
-
-         return torch::stack(output, 0);
+         return spec;
       }
 
-      torch::Tensor DeepFilter::_band_mean_norm_erb(torch::Tensor xs, float alpha, float denominator)
+      torch::Tensor DeepFilter::_erb_norm_time(torch::Tensor input_data, float alpha, float denominator)
       {
-         _reg_erb_norm_state = torch::lerp(xs, _reg_erb_norm_state, alpha);
-         auto output = (xs - _reg_erb_norm_state) / denominator;
-         return output;
+         auto state = lerp_scan(input_data, _reg_erb_norm_state, alpha);
+         return (input_data - state) / denominator;
       }
 
       torch::Tensor DeepFilter::_erb(const torch::Tensor& input_data, bool db) {
@@ -349,46 +308,22 @@ namespace melo {
 
       torch::Tensor DeepFilter::_unit_norm_time(torch::Tensor input_data, float alpha)
       {
-         std::vector<torch::Tensor> output;
-
-         for (int64_t i = 0; i < input_data.size(0); ++i) {
-            torch::Tensor in_step = input_data[i];
-            output.push_back(_band_unit_norm(in_step, alpha));
-         }
-         return torch::stack(output, 0);
-      }
-
-      torch::Tensor DeepFilter::_band_unit_norm(torch::Tensor xs, float alpha)
-      {
-         _reg_band_unit_norm_state = torch::lerp(xs.abs(), _reg_band_unit_norm_state, alpha);
-         auto output = xs / _reg_band_unit_norm_state.sqrt();
-
-         return output;
+         auto state = lerp_scan(input_data.abs(), _reg_band_unit_norm_state, alpha);
+         return input_data / state.sqrt();
       }
 
+      // One batched irfft, then overlap-add: hop i is the first half of frame i plus the second half of frame i - 1.
       torch::Tensor DeepFilter::_synthesis_time(torch::Tensor input_data)
       {
-         std::vector<torch::Tensor> out_chunks;
-         for (int64_t i = 0; i < input_data.size(0); ++i) {
-            torch::Tensor ichunk = input_data[i];
-            auto output_frame = _frame_synthesis(ichunk);
-            out_chunks.push_back(output_frame);
-         }
-
-         return torch::cat(out_chunks);
-      }
-
-      torch::Tensor DeepFilter::_frame_synthesis(torch::Tensor input_data)
-      {
+         using namespace torch::indexing;
          auto x = torch::fft::irfft(input_data, {}, -1, "forward") * _window;
 
-         auto split_ret = torch::split(x, { _frame_size, x.size(0) - _frame_size });
-         auto x_first = split_ret[0];
-         auto x_second = split_ret[1];
-
-         auto output = x_first + _reg_synthesis_mem;
+         auto x_first = x.index({ Slice(), Slice(None, _frame_size) });
+         auto x_second = x.index({ Slice(), Slice(_frame_size, None) });
+         auto previous = torch::cat({ _reg_synthesis_mem.unsqueeze(0), x_second.index({ Slice(None, -1) }) });
+         auto output = (x_first + previous).reshape({ -1 });
 
-         _reg_synthesis_mem = x_second;
+         _reg_synthesis_mem = x_second[-1].clone();
 
          return output;
       }
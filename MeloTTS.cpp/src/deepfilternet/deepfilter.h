@@ -4,6 +4,8 @@
 #ifdef USE_DEEPFILTERNET
 #include <torch/torch.h>
 #include <optional>
+#include <span>
+#include <vector>
 #include "dfnet_model.h"
 #include "openvino/runtime/intel_gpu/properties.hpp"
 #include "openvino/openvino.hpp"
@@ -32,23 +34,42 @@ namespace melo {
         typedef bool (*ProgressCallbackFunc)(float perc_complete, //<- range 0 to 1
            void* user);
 
+        // Filter a whole clip. Runs the streaming interface below on blocks of STREAM_BLOCK_HOPS hops.
         std::vector<float> filter(torch::Tensor noisy_audio, std::optional<float> atten_lim_db = {},
            float normalize_atten_lim = 20, float df3_post_filter = false,
            ProgressCallbackFunc callback = nullptr, void* callback_user = nullptr);
 
+        // Streaming. The STFT memories and the ERB / unit norm states are carried across calls. Once
+        // STREAM_BLOCK_HOPS hops (plus the model lookahead) are buffered, the networks run on a window of
+        // STREAM_CONTEXT_HOPS already emitted hops followed by the new ones. The exported networks keep their GRU
+        // states internally, so the context hops warm them up instead; their outputs are discarded. The window is cut
+        // to the smallest shape of the networks that covers the emitted hops, e.g. for the tail of a short clip.
+        // Enhanced audio is appended to output, delayed by at most (STREAM_BLOCK_HOPS + lookahead + 1) hops.
+        void reset_stream();
+        void process(std::span<const float> noisy_audio, std::vector<float>& output,
+           std::optional<float> atten_lim_db = {}, float normalize_atten_lim = 20, float df3_post_filter = false);
+        // Emit the remaining audio; the total output has exactly as many samples as the input. Resets the stream.
+        void flush(std::vector<float>& output,
+           std::optional<float> atten_lim_db = {}, float normalize_atten_lim = 20, float df3_post_filter = false);
+
+        static constexpr int64_t STREAM_BLOCK_HOPS = 200;    // 2 s at 48 kHz
+        static constexpr int64_t STREAM_CONTEXT_HOPS = 100;
+
      private:
 
-        std::shared_ptr<std::vector<float>> forward(torch::Tensor noisy_audio, bool pad = true, std::optional<float> atten_lim_db = {}, float normalize_atten_lim = 20, float df3_post_filter=false);
+        // analyse the complete hops of _stream_pending and append the frames and features to the history
+        void _stream_analysis();
+        // run the networks and synthesize frames until fewer than STREAM_BLOCK_HOPS are ready (all when flushing)
+        void _stream_run(std::vector<float>& output, bool flushing,
+           std::optional<float> atten_lim_db, float normalize_atten_lim, float df3_post_filter);
         std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> _df_features(torch::Tensor audio);
+        // The *_time functions process all frames of a block at once and carry their state in the registered
+        // buffers, with the same results as running the recursive per-frame definitions frame by frame.
         torch::Tensor _analysis_time(torch::Tensor input_data);
-        torch::Tensor _frame_analysis(torch::Tensor input_frame);
-        torch::Tensor _erb_norm_time(torch::Tensor input_data, float alpha = 0.9);
-        torch::Tensor _band_mean_norm_erb(torch::Tensor xs, float alpha, float denominator = 40.0);
+        torch::Tensor _erb_norm_time(torch::Tensor input_data, float alpha = 0.9, float denominator = 40.0);
         torch::Tensor _erb(const torch::Tensor& input_data, bool db = true);
         torch::Tensor _unit_norm_time(torch::Tensor input_data, float alpha = 0.9);
-        torch::Tensor _band_unit_norm(torch::Tensor xs, float alpha);
         torch::Tensor _synthesis_time(torch::Tensor input_data);
-        torch::Tensor _frame_synthesis(torch::Tensor input_data);
 
         int64_t fwd_count = 0;
 
@@ -81,6 +102,19 @@ namespace melo {
         void _reset_reg();
 
         std::shared_ptr< DFNetModel > _dfnet;
+        int64_t _lookahead = 2;
+
+        //streaming state
+        std::vector<float> _stream_pending;     // input samples of the incomplete hop
+        torch::Tensor _hist_spec;               // [frames, freq] complex, from frame _hist_begin on
+        torch::Tensor _hist_erb_feat;           // [frames, nb_erb]
+        torch::Tensor _hist_spec_feat;          // [frames, nb_df] complex
+        int64_t _hist_begin = 0;
+        int64_t _num_frames = 0;                // analysed
+        int64_t _num_emitted = 0;               // synthesized
+        int64_t _num_input_samples = 0;
+        int64_t _num_output_samples = 0;
+        int64_t _skip_samples = 0;              // STFT delay still to be dropped from the output
      };
   }
 }
@@ -0,0 +1,309 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: GPL-3.0-only
+#ifdef USE_DEEPFILTERNET_NATIVE
+#include "deepfilter_native.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace melo {
+   namespace ov_deepfilternet {
+      namespace {
+         constexpr double PI = 3.14159265358979323846;
+
+         std::vector<float> linspace(double begin, double end, int64_t count)
+         {
+            std::vector<float> values(count);
+            for (int64_t i = 0; i < count; ++i)
+               values[i] = static_cast<float>(count > 1 ? begin + (end - begin) * i / (count - 1) : begin);
+            return values;
+         }
+
+         const std::vector<int64_t> ERB_WIDTHS = {
+         2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 5, 5, 7, 7, 8,
+         10, 12, 13, 15, 18, 20, 24, 28, 31, 37, 42, 50, 56, 67
+         };
+
+         // drop the first rows of a row-major history
+         template <typename T>
+         void erase_rows(std::vector<T>& rows, int64_t count, int64_t width)
+         {
+            rows.erase(rows.begin(), rows.begin() + count * width);
+         }
+      }
+
+      DeepFilter::DeepFilter()
+      {
+         std::cout << "[NF][DFNet] DeepFilter Constructor" << std::endl;
+      }
+
+      void DeepFilter::Init(
+                            std::unique_ptr<ov::Core>& core,
+                            std::string model_folder,
+                            std::string device,
+                            ModelSelection model_selection,
+                            const ov::AnyMap& nf_ov_cfg,
+                            int64_t sr, int64_t fft_size, int64_t hop_size,
+                            int64_t nb_bands, int64_t, int64_t nb_df, double alpha)
+      {
+         // window of the streaming inference, see process()
+         const int64_t num_hops = STREAM_CONTEXT_HOPS + STREAM_BLOCK_HOPS + _lookahead;
+         Init(std::make_shared< DFNetModel >(core, model_folder, device, model_selection, nf_ov_cfg, ERB_WIDTHS, _lookahead, nb_df, num_hops),
+            sr, fft_size, hop_size, nb_bands, nb_df, alpha);
+      }
+
+      void DeepFilter::Init(std::shared_ptr<DFNetModel> dfnet,
+                            int64_t sr, int64_t fft_size, int64_t hop_size,
+                            int64_t nb_bands, int64_t nb_df, double alpha)
+      {
+         const int64_t num_hops = STREAM_CONTEXT_HOPS + STREAM_BLOCK_HOPS + _lookahead;
+         if (dfnet->num_static_hops() != num_hops)
+            throw std::invalid_argument("DeepFilter: the model must run windows of " + std::to_string(num_hops) + " hops");
+         _dfnet = std::move(dfnet);
+
+         _fft_size = fft_size;
+         _frame_size = hop_size;
+         _freq_size = fft_size / 2 + 1;
+         _wnorm = 1.f / ((_fft_size * _fft_size) / (2 * _frame_size));
+         _fft = dsp::RealFft(_fft_size);
+
+         // Initialize the vorbis window: sin(pi/2*sin^2(pi*n/N))
+         const int64_t window_size_h = fft_size / 2;
+         _window.resize(_fft_size);
+         for (int64_t i = 0; i < _fft_size; ++i)
+         {
+            const float w = static_cast<float>(std::sin(0.5 * PI * (i + 0.5) / window_size_h));
+            _window[i] = static_cast<float>(std::sin(0.5 * PI * (w * w)));
+         }
+
+         _sr = sr;
+         _nb_df = nb_df;
+
+         // Initializing erb features
+         _erb_indices = ERB_WIDTHS;
+         _n_erb_features = nb_bands;
+         _erb_offsets = dsp::erb_offsets(_erb_indices);
+
+         _mean_norm_init = { -60., -90. };
+         _unit_norm_init = { 0.001, 0.0001 };
+
+         _alpha = static_cast<float>(alpha);
+
+         _win_spec.resize(num_hops * _freq_size);
+         _win_erb_feat.resize(num_hops * _n_erb_features);
+         _win_spec_feat.resize(num_hops * _nb_df);
+         _win_enhanced.resize(num_hops * _freq_size);
+         _frame.resize(_fft_size);
+
+         // Init buffers
+         reset_stream();
+      }
+
+      void DeepFilter::_reset_reg()
+      {
+         _reg_analysis_mem.assign(_fft_size - _frame_size, 0.f);
+         _reg_synthesis_mem.assign(_fft_size - _frame_size, 0.f);
+         _reg_band_unit_norm_state = linspace(_unit_norm_init[0], _unit_norm_init[1], _nb_df);
+         _reg_erb_norm_state = linspace(_mean_norm_init[0], _mean_norm_init[1], _n_erb_features);
+      }
+
+      std::vector<float> DeepFilter::filter(std::span<const float> noisy_audio, std::optional<float> atten_lim_db, float normalize_atten_lim, float df3_post_filter, ProgressCallbackFunc callback, void* callback_user)
+      {
+         const int64_t total_nsamples = noisy_audio.size();
+         const int64_t block_samples = STREAM_BLOCK_HOPS * _frame_size;
+
+         std::vector<float> output_wav;
+         output_wav.reserve(total_nsamples);
+
+         reset_stream();
+         for (int64_t offset = 0; offset < total_nsamples; offset += block_samples)
+         {
+            const int64_t n = std::min(block_samples, total_nsamples - offset);
+            process(noisy_audio.subspan(offset, n), output_wav, atten_lim_db, normalize_atten_lim, df3_post_filter);
+
+            if (callback)
+            {
+               float perc_complete = (float)(offset + n) / total_nsamples;
+               if (!callback(perc_complete, callback_user))
+               {
+                  //callback returned false, so return empty wav
+                  reset_stream();
+                  return {};
+               }
+            }
+         }
+         flush(output_wav, atten_lim_db, normalize_atten_lim, df3_post_filter);
+
+         return output_wav;
+      }
+
+      void DeepFilter::reset_stream()
+      {
+         _reset_reg();
+         _stream_pending.clear();
+         _hist_spec.clear();
+         _hist_erb_feat.clear();
+         _hist_spec_feat.clear();
+         _hist_begin = 0;
+         _num_frames = 0;
+         _num_emitted = 0;
+         _num_input_samples = 0;
+         _num_output_samples = 0;
+         // the real-time STFT delays the signal by one window minus one hop
+         _skip_samples = _fft_size - _frame_size;
+      }
+
+      void DeepFilter::process(std::span<const float> noisy_audio, std::vector<float>& output, std::optional<float> atten_lim_db, float normalize_atten_lim, float df3_post_filter)
+      {
+         _stream_pending.insert(_stream_pending.end(), noisy_audio.begin(), noisy_audio.end());
+         _num_input_samples += noisy_audio.size();
+         _stream_analysis();
+         _stream_run(output, false, atten_lim_db, normalize_atten_lim, df3_post_filter);
+      }
+
+      void DeepFilter::flush(std::vector<float>& output, std::optional<float> atten_lim_db, float normalize_atten_lim, float df3_post_filter)
+      {
+         // complete the last hop, then pad to compensate for the delay due to the real-time STFT implementation
+         const int64_t partial = _stream_pending.size() % _frame_size;
+         if (partial)
+            _stream_pending.resize(_stream_pending.size() + _frame_size - partial, 0.f);
+         _stream_pending.resize(_stream_pending.size() + _fft_size, 0.f);
+         _stream_analysis();
+         _stream_run(output, true, atten_lim_db, normalize_atten_lim, df3_post_filter);
+
+         // drop the padding
+         const int64_t extra = _num_output_samples - _num_input_samples;
+         if (extra > 0)
+            output.resize(output.size() - extra);
+         _dfnet->release_infer_memory();
+         reset_stream();
+      }
+
+      // Frame i is window * [previous hop | hop i], transformed and scaled by wnorm. The ERB and unit norm features
+      // of the new frames are appended as well.
+      void DeepFilter::_stream_analysis()
+      {
+         const int64_t nhops = _stream_pending.size() / _frame_size;
+         if (nhops == 0)
+            return;
+
+         const int64_t first = _hist_spec.size() / _freq_size;
+         _hist_spec.resize((first + nhops) * _freq_size);
+         _hist_erb_feat.resize((first + nhops) * _n_erb_features);
+         _hist_spec_feat.resize((first + nhops) * _nb_df);
+         const int64_t mem_size = _fft_size - _frame_size;
+
+         dsp::Complex* spec = _hist_spec.data() + first * _freq_size;
+         for (int64_t i = 0; i < nhops; ++i)
+         {
+            const float* hop = _stream_pending.data() + i * _frame_size;
+            for (int64_t j = 0; j < mem_size; ++j)
+               _frame[j] = _reg_analysis_mem[j] * _window[j];
+            for (int64_t j = 0; j < _frame_size; ++j)
+               _frame[mem_size + j] = hop[j] * _window[mem_size + j];
+
+            dsp::Complex* row = spec + i * _freq_size;
+            _fft.forward(_frame.data(), row);
+            for (int64_t f = 0; f < _freq_size; ++f)
+               row[f] *= _wnorm;
+
+            // the analysis memory keeps the last fft_size - hop_size input samples
+            if (_frame_size >= mem_size)
+            {
+               std::copy(hop + _frame_size - mem_size, hop + _frame_size, _reg_analysis_mem.begin());
+            }
+            else
+            {
+               std::copy(_reg_analysis_mem.begin() + _frame_size, _reg_analysis_mem.end(), _reg_analysis_mem.begin());
+               std::copy(hop, hop + _frame_size, _reg_analysis_mem.end() - _frame_size);
+            }
+         }
+         _stream_pending.erase(_stream_pending.begin(), _stream_pending.begin() + nhops * _frame_size);
+
+         float* erb_feat = _hist_erb_feat.data() + first * _n_erb_features;
+         dsp::erb_db(spec, _erb_offsets, erb_feat, nhops);
+         dsp::erb_norm(erb_feat, _reg_erb_norm_state.data(), nhops, _n_erb_features, _alpha);
+         dsp::unit_norm(spec, _freq_size, _hist_spec_feat.data() + first * _nb_df, _reg_band_unit_norm_state.data(),
+            nhops, _nb_df, _alpha);
+         _num_frames += nhops;
+      }
+
+      void DeepFilter::_stream_run(std::vector<float>& output, bool flushing, std::optional<float> atten_lim_db, float normalize_atten_lim, float df3_post_filter)
+      {
+         const int64_t window_hops = _dfnet->num_static_hops();
+
+         // the last _lookahead frames are final only once the following frames are known
+         const int64_t ready = flushing ? _num_frames : _num_frames - _lookahead;
+         while (ready - _num_emitted >= STREAM_BLOCK_HOPS || (flushing && _num_emitted < ready))
+         {
+            const int64_t window_begin = std::max<int64_t>(0, _num_emitted - STREAM_CONTEXT_HOPS);
+            // at most one block per run: the windows, hence the output, do not depend on the block sizes of process()
+            const int64_t emit_end = std::min({ ready, _num_emitted + STREAM_BLOCK_HOPS, window_begin + window_hops - _lookahead });
+            // the networks are causal, the smallest shape that covers the emitted frames and their lookahead suffices
+            const int64_t hops = _dfnet->num_hops_for(emit_end - window_begin + _lookahead);
+            const int64_t available = std::min(_num_frames, window_begin + hops) - window_begin;
+
+            // frames after the last analysed one stay zero, the same as padding the clip
+            const int64_t offset = window_begin - _hist_begin;
+            auto fill_window = [&](const auto& hist, auto& window, int64_t width) {
+               auto end = std::copy_n(hist.begin() + offset * width, available * width, window.begin());
+               std::fill(end, window.begin() + hops * width, typename std::decay_t<decltype(window)>::value_type());
+            };
+            fill_window(_hist_spec, _win_spec, _freq_size);
+            fill_window(_hist_erb_feat, _win_erb_feat, _n_erb_features);
+            fill_window(_hist_spec_feat, _win_spec_feat, _nb_df);
+
+            _dfnet->forward(_win_spec.data(), _win_erb_feat.data(), _win_spec_feat.data(), _win_enhanced.data(), hops, df3_post_filter);
+
+            const int64_t emit_offset = (_num_emitted - window_begin) * _freq_size;
+            const int64_t emit_count = (emit_end - _num_emitted) * _freq_size;
+            if (atten_lim_db && (std::abs(*atten_lim_db) > 0))
+            {
+               float lim = std::pow(10, (-std::abs(*atten_lim_db) / normalize_atten_lim));
+               dsp::lerp(_win_spec.data() + emit_offset, _win_enhanced.data() + emit_offset, emit_count, lim);
+            }
+
+            _synthesis(_win_enhanced.data() + emit_offset, emit_end - _num_emitted, output);
+            _num_emitted = emit_end;
+
+            // keep the frames of the next context
+            const int64_t keep_from = std::max<int64_t>(0, _num_emitted - STREAM_CONTEXT_HOPS);
+            if (keep_from > _hist_begin)
+            {
+               erase_rows(_hist_spec, keep_from - _hist_begin, _freq_size);
+               erase_rows(_hist_erb_feat, keep_from - _hist_begin, _n_erb_features);
+               erase_rows(_hist_spec_feat, keep_from - _hist_begin, _nb_df);
+               _hist_begin = keep_from;
+            }
+         }
+      }
+
+      // Hop i is the first half of the windowed inverse transform of frame i plus the second half of frame i - 1
+      void DeepFilter::_synthesis(const dsp::Complex* spec, int64_t frames, std::vector<float>& output)
+      {
+         for (int64_t i = 0; i < frames; ++i)
+         {
+            _fft.inverse(spec + i * _freq_size, _frame.data());
+            for (int64_t j = 0; j < _fft_size; ++j)
+               _frame[j] *= _window[j];
+
+            for (int64_t j = 0; j < _frame_size; ++j)
+            {
+               const float sample = _frame[j] + _reg_synthesis_mem[j];
+               if (_skip_samples > 0)
+                  --_skip_samples;
+               else
+               {
+                  output.push_back(sample);
+                  ++_num_output_samples;
+               }
+            }
+            std::copy(_frame.begin() + _frame_size, _frame.end(), _reg_synthesis_mem.begin());
+         }
+      }
+   }
+}
+#endif // USE_DEEPFILTERNET_NATIVE
@@ -0,0 +1,121 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: GPL-3.0-only
+#pragma once
+#ifdef USE_DEEPFILTERNET_NATIVE
+#include <optional>
+#include <span>
+#include <vector>
+#include "dfn_dsp.h"
+#include "dfnet_model_native.h"
+#include "openvino/runtime/intel_gpu/properties.hpp"
+#include "openvino/openvino.hpp"
+
+namespace melo {
+  namespace ov_deepfilternet {
+     // The libtorch-free counterpart of deepfilter.h with the same interface, except that filter() takes a span.
+     // Selected at build time with USE_DEEPFILTERNET_NATIVE.
+     class DeepFilter
+     {
+     public:
+        DeepFilter();
+        void Init(std::unique_ptr<ov::Core>& core,
+                  std::string model_folder,
+                  std::string device,
+                  ModelSelection model_selection = ModelSelection::DEEPFILTERNET3,
+                  const ov::AnyMap& nf_ov_cfg = {},
+                  int64_t sr = 44100,
+                  int64_t fft_size = 960,
+                  int64_t hop_size = 480,
+                  int64_t nb_bands = 32,
+                  int64_t min_nb_freqs = 2,
+                  int64_t nb_df = 96,
+                  double alpha = 0.99);
+        // Init with a model created by the caller, e.g. a stub in the tests; its num_static_hops() must be
+        // STREAM_CONTEXT_HOPS + STREAM_BLOCK_HOPS + 2 (the lookahead)
+        void Init(std::shared_ptr<DFNetModel> dfnet,
+                  int64_t sr = 44100,
+                  int64_t fft_size = 960,
+                  int64_t hop_size = 480,
+                  int64_t nb_bands = 32,
+                  int64_t nb_df = 96,
+                  double alpha = 0.99);
+
+        // Used to subscribe to progress updates. This function can return false to
+        // cancel. In that case, 'filter' will return an empty wav.
+        typedef bool (*ProgressCallbackFunc)(float perc_complete, //<- range 0 to 1
+           void* user);
+
+        // Filter a whole clip. Runs the streaming interface below on blocks of STREAM_BLOCK_HOPS hops.
+        std::vector<float> filter(std::span<const float> noisy_audio, std::optional<float> atten_lim_db = {},
+           float normalize_atten_lim = 20, float df3_post_filter = false,
+           ProgressCallbackFunc callback = nullptr, void* callback_user = nullptr);
+
+        // Streaming, see deepfilter.h
+        void reset_stream();
+        void process(std::span<const float> noisy_audio, std::vector<float>& output,
+           std::optional<float> atten_lim_db = {}, float normalize_atten_lim = 20, float df3_post_filter = false);
+        void flush(std::vector<float>& output,
+           std::optional<float> atten_lim_db = {}, float normalize_atten_lim = 20, float df3_post_filter = false);
+
+        static constexpr int64_t STREAM_BLOCK_HOPS = 200;    // 2 s at 48 kHz
+        static constexpr int64_t STREAM_CONTEXT_HOPS = 100;
+
+     private:
+
+        // analyse the complete hops of _stream_pending and append the frames and features to the history
+        void _stream_analysis();
+        // run the networks and synthesize frames until fewer than STREAM_BLOCK_HOPS are ready (all when flushing)
+        void _stream_run(std::vector<float>& output, bool flushing,
+           std::optional<float> atten_lim_db, float normalize_atten_lim, float df3_post_filter);
+        // overlap-add frames [frames, freq] and append the hops to output
+        void _synthesis(const dsp::Complex* spec, int64_t frames, std::vector<float>& output);
+
+        int64_t _fft_size;
+        int64_t _frame_size;
+        int64_t _freq_size;
+        float _wnorm;
+        int64_t _sr;
+        int64_t _nb_df;
+        int64_t _n_erb_features;
+        float _alpha;
+
+        std::vector< double > _mean_norm_init;
+        std::vector< double > _unit_norm_init;
+
+        std::vector<float> _window;
+        std::vector<int64_t> _erb_indices;
+        std::vector<int64_t> _erb_offsets;
+        dsp::RealFft _fft;
+
+        //registered buffers
+        std::vector<float> _reg_analysis_mem;
+        std::vector<float> _reg_synthesis_mem;
+        std::vector<float> _reg_band_unit_norm_state;
+        std::vector<float> _reg_erb_norm_state;
+        void _reset_reg();
+
+        std::shared_ptr< DFNetModel > _dfnet;
+        int64_t _lookahead = 2;
+
+        //streaming state, the history rows start at frame _hist_begin
+        std::vector<float> _stream_pending;     // input samples of the incomplete hop
+        std::vector<dsp::Complex> _hist_spec;   // [frames, freq]
+        std::vector<float> _hist_erb_feat;      // [frames, nb_erb]
+        std::vector<dsp::Complex> _hist_spec_feat;  // [frames, nb_df]
+        int64_t _hist_begin = 0;
+        int64_t _num_frames = 0;                // analysed
+        int64_t _num_emitted = 0;               // synthesized
+        int64_t _num_input_samples = 0;
+        int64_t _num_output_samples = 0;
+        int64_t _skip_samples = 0;              // STFT delay still to be dropped from the output
+
+        //network window, reused by every run
+        std::vector<dsp::Complex> _win_spec;
+        std::vector<float> _win_erb_feat;
+        std::vector<dsp::Complex> _win_spec_feat;
+        std::vector<dsp::Complex> _win_enhanced;
+        std::vector<float> _frame;
+     };
+  }
+}
+#endif // USE_DEEPFILTERNET_NATIVE
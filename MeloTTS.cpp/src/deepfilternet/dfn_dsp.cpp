@@ -0,0 +1,399 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: GPL-3.0-only
+#include "dfn_dsp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "simd.h"
+
+namespace melo {
+   namespace ov_deepfilternet {
+      namespace dsp {
+         namespace {
+            constexpr double PI = 3.14159265358979323846;
+
+            using ScanKernel = void (*)(const float* x, float* state, float* out, int64_t frames, int64_t bands, float alpha);
+
+            // ATen's vectorized lerp: |alpha| < 0.5: x + alpha * (state - x)      otherwise: state + (alpha - 1) * (state - x)
+            inline bool is_lerp_weight_small(float alpha)
+            {
+               return std::abs(alpha) < 0.5f;
+            }
+
+            inline float lerp_step(float x, float state, float alpha, bool small)
+            {
+               return small ? std::fma(alpha, state - x, x) : std::fma(alpha - 1.f, state - x, state);
+            }
+
+            void lerp_scan_scalar(const float* x, float* state, float* out, int64_t frames, int64_t bands, float alpha)
+            {
+               const bool small = is_lerp_weight_small(alpha);
+               for (int64_t t = 0; t < frames; ++t, x += bands, out += bands)
+               {
+                  for (int64_t b = 0; b < bands; ++b)
+                  {
+                     state[b] = lerp_step(x[b], state[b], alpha, small);
+                     out[b] = state[b];
+                  }
+               }
+            }
+
+#ifdef MELO_SIMD_AVX2
+            MELO_SIMD_TARGET("avx2,fma") void lerp_scan_avx2(const float* x, float* state, float* out, int64_t frames, int64_t bands, float alpha)
+            {
+               const bool small = is_lerp_weight_small(alpha);
+               const __m256 vcoeff = _mm256_set1_ps(small ? alpha : alpha - 1.f);
+               for (int64_t t = 0; t < frames; ++t, x += bands, out += bands)
+               {
+                  int64_t b = 0;
+                  for (; b + 8 <= bands; b += 8)
+                  {
+                     const __m256 s = _mm256_loadu_ps(state + b);
+                     const __m256 v = _mm256_loadu_ps(x + b);
+                     const __m256 r = _mm256_fmadd_ps(vcoeff, _mm256_sub_ps(s, v), small ? v : s);
+                     _mm256_storeu_ps(state + b, r);
+                     _mm256_storeu_ps(out + b, r);
+                  }
+                  for (; b < bands; ++b)
+                  {
+                     state[b] = lerp_step(x[b], state[b], alpha, small);
+                     out[b] = state[b];
+                  }
+               }
+            }
+#endif // MELO_SIMD_AVX2
+
+#ifdef MELO_SIMD_NEON
+            void lerp_scan_neon(const float* x, float* state, float* out, int64_t frames, int64_t bands, float alpha)
+            {
+               const bool small = is_lerp_weight_small(alpha);
+               const float32x4_t vcoeff = vdupq_n_f32(small ? alpha : alpha - 1.f);
+               for (int64_t t = 0; t < frames; ++t, x += bands, out += bands)
+               {
+                  int64_t b = 0;
+                  for (; b + 4 <= bands; b += 4)
+                  {
+                     const float32x4_t s = vld1q_f32(state + b);
+                     const float32x4_t v = vld1q_f32(x + b);
+                     const float32x4_t r = vfmaq_f32(small ? v : s, vcoeff, vsubq_f32(s, v));
+                     vst1q_f32(state + b, r);
+                     vst1q_f32(out + b, r);
+                  }
+                  for (; b < bands; ++b)
+                  {
+                     state[b] = lerp_step(x[b], state[b], alpha, small);
+                     out[b] = state[b];
+                  }
+               }
+            }
+#endif // MELO_SIMD_NEON
+
+            ScanKernel select_scan()
+            {
+               switch (simd::best_isa())
+               {
+#ifdef MELO_SIMD_AVX2
+               case simd::Isa::Avx2:
+               case simd::Isa::Avx512:
+                  return lerp_scan_avx2;
+#endif
+#ifdef MELO_SIMD_NEON
+               case simd::Isa::Neon:
+                  return lerp_scan_neon;
+#endif
+               default:
+                  return lerp_scan_scalar;
+               }
+            }
+
+            // multiply by -i (forward) or +i (inverse)
+            inline Complex rotate(Complex x, int sign)
+            {
+               return sign < 0 ? Complex(x.imag(), -x.real()) : Complex(-x.imag(), x.real());
+            }
+         }
+
+         RealFft::RealFft(int64_t n)
+            : _n(n), _half(n / 2)
+         {
+            if (n < 2 || n % 2)
+               throw std::invalid_argument("RealFft: the length must be even, got " + std::to_string(n));
+
+            // radix 4 stages first, they are the cheapest per point
+            int64_t rest = _half;
+            for (int64_t radix : { 4, 2, 3, 5 })
+            {
+               while (rest % radix == 0)
+               {
+                  _factors.push_back(radix);
+                  rest /= radix;
+               }
+            }
+            for (int64_t radix = 7; rest > 1; radix += 2)
+            {
+               while (rest % radix == 0)
+               {
+                  _factors.push_back(radix);
+                  rest /= radix;
+               }
+            }
+
+            _twiddles.resize(_half);
+            for (int64_t k = 0; k < _half; ++k)
+               _twiddles[k] = std::polar(1.f, static_cast<float>(-2 * PI * k / _half));
+            _post.resize(_half + 1);
+            for (int64_t k = 0; k <= _half; ++k)
+               _post[k] = std::polar(1.f, static_cast<float>(-2 * PI * k / _n));
+            _packed.resize(_half);
+            _spectrum.resize(_half);
+         }
+
+         // Mixed radix decimation in time: the sub-FFTs of every residue class of the input are computed recursively
+         // into consecutive blocks of out, then combined by one butterfly per stage.
+         void RealFft::_fft_stage(Complex* out, const Complex* in, int64_t in_stride, size_t factor, int sign)
+         {
+            const int64_t p = _factors[factor];
+            int64_t m = _half / in_stride / p;    // length of every sub-FFT
+            if (m == 1)
+            {
+               for (int64_t q = 0; q < p; ++q)
+                  out[q] = in[q * in_stride];
+            }
+            else
+            {
+               for (int64_t q = 0; q < p; ++q)
+                  _fft_stage(out + q * m, in + q * in_stride, in_stride * p, factor + 1, sign);
+            }
+
+            auto twiddle = [&](int64_t index) {
+               return sign < 0 ? _twiddles[index] : std::conj(_twiddles[index]);
+            };
+            if (p == 2)
+            {
+               for (int64_t u = 0; u < m; ++u)
+               {
+                  const Complex t = out[u + m] * twiddle(u * in_stride);
+                  out[u + m] = out[u] - t;
+                  out[u] += t;
+               }
+            }
+            else if (p == 4)
+            {
+               for (int64_t u = 0; u < m; ++u)
+               {
+                  const Complex s0 = out[u + m] * twiddle(u * in_stride);
+                  const Complex s1 = out[u + 2 * m] * twiddle(2 * u * in_stride);
+                  const Complex s2 = out[u + 3 * m] * twiddle(3 * u * in_stride);
+                  const Complex s3 = s0 + s2;
+                  const Complex s4 = rotate(s0 - s2, sign);
+                  const Complex s5 = out[u] - s1;
+                  const Complex s6 = out[u] + s1;
+                  out[u] = s6 + s3;
+                  out[u + m] = s5 + s4;
+                  out[u + 2 * m] = s6 - s3;
+                  out[u + 3 * m] = s5 - s4;
+               }
+            }
+            else
+            {
+               // generic: a p-point DFT over the twiddled sub-FFT outputs
+               Complex scratch[16];
+               std::vector<Complex> large;
+               Complex* x = scratch;
+               if (p > 16)
+               {
+                  large.resize(p);
+                  x = large.data();
+               }
+               for (int64_t u = 0; u < m; ++u)
+               {
+                  for (int64_t q = 0; q < p; ++q)
+                     x[q] = out[u + q * m];
+                  for (int64_t q1 = 0; q1 < p; ++q1)
+                  {
+                     const int64_t k = u + q1 * m;
+                     Complex sum = x[0];
+                     int64_t index = 0;
+                     for (int64_t q = 1; q < p; ++q)
+                     {
+                        index += in_stride * k;
+                        index %= _half;
+                        sum += x[q] * twiddle(index);
+                     }
+                     out[k] = sum;
+                  }
+               }
+            }
+         }
+
+         void RealFft::_fft(const Complex* in, Complex* out, int sign)
+         {
+            if (_half == 1)
+            {
+               out[0] = in[0];
+               return;
+            }
+            _fft_stage(out, in, 1, 0, sign);
+         }
+
+         // z[k] = x[2k] + i x[2k + 1] has the spectrum Z = E + i O, E and O being the spectra of the even and odd
+         // samples. X[k] = E[k] + exp(-2 pi i k / n) O[k].
+         void RealFft::forward(const float* in, Complex* out)
+         {
+            for (int64_t k = 0; k < _half; ++k)
+               _packed[k] = Complex(in[2 * k], in[2 * k + 1]);
+            _fft(_packed.data(), _spectrum.data(), -1);
+
+            for (int64_t k = 0; k <= _half; ++k)
+            {
+               const Complex z = _spectrum[k % _half];
+               const Complex zc = std::conj(_spectrum[(_half - k) % _half]);
+               const Complex even = 0.5f * (z + zc);
+               const Complex odd = Complex(0.f, -0.5f) * (z - zc);
+               out[k] = even + _post[k] * odd;
+            }
+         }
+
+         // The inverse of forward(), scaled by n: 2 E[k] = X[k] + conj(X[h - k]), 2 O[k] = (X[k] - conj(X[h - k])) *
+         // exp(2 pi i k / n), and the inverse FFT of E + i O gives the even and odd samples.
+         void RealFft::inverse(const Complex* in, float* out)
+         {
+            auto bin = [&](int64_t k) {
+               return (k == 0 || k == _half) ? Complex(in[k].real(), 0.f) : in[k];
+            };
+            for (int64_t k = 0; k < _half; ++k)
+            {
+               const Complex x = bin(k);
+               const Complex xc = std::conj(bin(_half - k));
+               const Complex even = x + xc;
+               const Complex odd = (x - xc) * std::conj(_post[k]);
+               _spectrum[k] = even + Complex(0.f, 1.f) * odd;
+            }
+            _fft(_spectrum.data(), _packed.data(), 1);
+
+            for (int64_t k = 0; k < _half; ++k)
+            {
+               out[2 * k] = _packed[k].real();
+               out[2 * k + 1] = _packed[k].imag();
+            }
+         }
+
+         void lerp_scan(const float* x, float* state, float* out, int64_t frames, int64_t bands, float alpha)
+         {
+            static const ScanKernel scan = select_scan();
+            scan(x, state, out, frames, bands, alpha);
+         }
+
+         std::vector<int64_t> erb_offsets(const std::vector<int64_t>& erb_widths)
+         {
+            std::vector<int64_t> offsets(1, 0);
+            for (int64_t width : erb_widths)
+               offsets.push_back(offsets.back() + width);
+            return offsets;
+         }
+
+         void erb_db(const Complex* spec, const std::vector<int64_t>& offsets, float* out, int64_t frames)
+         {
+            const int64_t bands = offsets.size() - 1;
+            const int64_t freqs = offsets.back();
+            for (int64_t t = 0; t < frames; ++t, spec += freqs, out += bands)
+            {
+               for (int64_t b = 0; b < bands; ++b)
+               {
+                  const float weight = 1.f / (offsets[b + 1] - offsets[b]);
+                  float power = 0.f;
+                  for (int64_t f = offsets[b]; f < offsets[b + 1]; ++f)
+                     power += weight * std::norm(spec[f]);
+                  out[b] = 10.f * std::log10(power + 1e-10f);
+               }
+            }
+         }
+
+         void erb_norm(float* band_db, float* state, int64_t frames, int64_t bands, float alpha, float denominator)
+         {
+            std::vector<float> smoothed(frames * bands);
+            lerp_scan(band_db, state, smoothed.data(), frames, bands, alpha);
+            for (int64_t i = 0; i < frames * bands; ++i)
+               band_db[i] = (band_db[i] - smoothed[i]) / denominator;
+         }
+
+         void unit_norm(const Complex* spec, int64_t stride, Complex* out, float* state, int64_t frames, int64_t nb_df,
+            float alpha)
+         {
+            std::vector<float> magnitude(frames * nb_df);
+            for (int64_t t = 0; t < frames; ++t)
+            {
+               for (int64_t f = 0; f < nb_df; ++f)
+                  magnitude[t * nb_df + f] = std::abs(spec[t * stride + f]);
+            }
+            lerp_scan(magnitude.data(), state, magnitude.data(), frames, nb_df, alpha);
+            for (int64_t t = 0; t < frames; ++t)
+            {
+               for (int64_t f = 0; f < nb_df; ++f)
+                  out[t * nb_df + f] = spec[t * stride + f] / std::sqrt(magnitude[t * nb_df + f]);
+            }
+         }
+
+         void apply_erb_mask(const Complex* spec, const float* gains, const std::vector<int64_t>& offsets,
+            Complex* enhanced, int64_t frames, int64_t first_bin)
+         {
+            const int64_t bands = offsets.size() - 1;
+            const int64_t freqs = offsets.back();
+            for (int64_t t = 0; t < frames; ++t, spec += freqs, enhanced += freqs, gains += bands)
+            {
+               for (int64_t b = 0; b < bands; ++b)
+               {
+                  for (int64_t f = std::max(first_bin, offsets[b]); f < offsets[b + 1]; ++f)
+                     enhanced[f] = spec[f] * gains[b];
+               }
+            }
+         }
+
+         void deep_filter(const Complex* spec, int64_t stride, const float* coefs, Complex* enhanced, int64_t frames,
+            int64_t nb_df, int64_t order, int64_t lookahead)
+         {
+            const int64_t pad = order - 1 - lookahead;
+            for (int64_t t = 0; t < frames; ++t)
+            {
+               Complex* row = enhanced + t * stride;
+               std::fill(row, row + nb_df, Complex());
+               for (int64_t n = 0; n < order; ++n)
+               {
+                  const int64_t source = t + n - pad;
+                  if (source < 0 || source >= frames)
+                     continue;
+                  const Complex* x = spec + source * stride;
+                  const float* c = coefs + (t * nb_df * order + n) * 2;
+                  for (int64_t f = 0; f < nb_df; ++f, c += order * 2)
+                     row[f] += x[f] * Complex(c[0], c[1]);
+               }
+            }
+         }
+
+         void post_filter(const Complex* spec, Complex* enhanced, int64_t count, float beta)
+         {
+            constexpr float eps = 1e-12f;
+            for (int64_t i = 0; i < count; ++i)
+            {
+               const float mask = std::clamp(std::abs(enhanced[i]) / (std::abs(spec[i]) + eps), eps, 1.f);
+               const float mask_sin = mask * std::max(std::sin(static_cast<float>(PI) * mask / 2), eps);
+               const float ratio = mask / mask_sin;
+               enhanced[i] *= (1 + beta) / (1 + beta * ratio * ratio);
+            }
+         }
+
+         void lerp(const Complex* spec, Complex* enhanced, int64_t count, float weight)
+         {
+            const bool small = is_lerp_weight_small(weight);
+            for (int64_t i = 0; i < count; ++i)
+            {
+               const Complex diff = spec[i] - enhanced[i];
+               enhanced[i] = small ? enhanced[i] + weight * diff : spec[i] - (1.f - weight) * diff;
+            }
+         }
+      }
+   }
+}
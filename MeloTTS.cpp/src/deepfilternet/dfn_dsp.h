@@ -0,0 +1,90 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: GPL-3.0-only
+#pragma once
+#ifndef DFN_DSP_H
+#define DFN_DSP_H
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+// Signal processing of DeepFilterNet on plain buffers, without libtorch. Used by the native build
+// (USE_DEEPFILTERNET_NATIVE) for everything around the three networks; the libtorch build shares lerp_scan.
+// Matrices are row-major, one row per frame.
+namespace melo {
+   namespace ov_deepfilternet {
+      namespace dsp {
+         using Complex = std::complex<float>;
+
+         // Real FFT of an even length n. The real input is packed into a mixed radix complex FFT of n / 2, which is
+         // fast when n / 2 has only small prime factors (960 = 2 * 2^5 * 3 * 5). Both directions are unnormalized,
+         // i.e. torch::fft::rfft with "backward" and torch::fft::irfft with "forward" norm. Not thread safe: the
+         // scratch buffers are members.
+         class RealFft
+         {
+         public:
+            explicit RealFft(int64_t n = 960);
+
+            int64_t size() const
+            {
+               return _n;
+            }
+
+            // n samples -> n / 2 + 1 bins
+            void forward(const float* in, Complex* out);
+            // n / 2 + 1 bins -> n samples; the imaginary parts of the DC and Nyquist bins are ignored
+            void inverse(const Complex* in, float* out);
+
+         private:
+            // complex FFT of _half points, sign -1 forward, +1 inverse
+            void _fft(const Complex* in, Complex* out, int sign);
+            void _fft_stage(Complex* out, const Complex* in, int64_t in_stride, size_t factor, int sign);
+
+            int64_t _n;
+            int64_t _half;
+            std::vector<int64_t> _factors;     // radix of every stage, 4 first
+            std::vector<Complex> _twiddles;    // exp(-2 pi i k / half), k < half
+            std::vector<Complex> _post;        // exp(-2 pi i k / n), k <= half
+            std::vector<Complex> _packed;
+            std::vector<Complex> _spectrum;
+         };
+
+         // Exponential smoothing of x [frames, bands]: state = x[t] + alpha * (state - x[t]) for every frame t, with
+         // the fused formula of ATen's vectorized lerp so that the result matches torch::lerp step by step. The state
+         // after every frame is written to out, which may alias x.
+         void lerp_scan(const float* x, float* state, float* out, int64_t frames, int64_t bands, float alpha);
+
+         // Bin ranges of the ERB bands, from their widths
+         std::vector<int64_t> erb_offsets(const std::vector<int64_t>& erb_widths);
+
+         // 10 * log10(mean power + 1e-10) of every band; spec [frames, offsets.back()], out [frames, bands]
+         void erb_db(const Complex* spec, const std::vector<int64_t>& offsets, float* out, int64_t frames);
+
+         // (x - state) / denominator with the smoothed state of band_db [frames, bands], in place
+         void erb_norm(float* band_db, float* state, int64_t frames, int64_t bands, float alpha, float denominator = 40.f);
+
+         // spec [frames, stride] -> out [frames, nb_df]: the first nb_df bins divided by the square root of their
+         // smoothed magnitude
+         void unit_norm(const Complex* spec, int64_t stride, Complex* out, float* state, int64_t frames, int64_t nb_df,
+            float alpha);
+
+         // enhanced[t, f] = spec[t, f] * gains[t, band(f)] for every bin f >= first_bin; spec and enhanced
+         // [frames, offsets.back()], gains [frames, bands] (the ERB mask of the networks)
+         void apply_erb_mask(const Complex* spec, const float* gains, const std::vector<int64_t>& offsets,
+            Complex* enhanced, int64_t frames, int64_t first_bin = 0);
+
+         // Deep filtering of the first nb_df bins:
+         //   enhanced[t, f] = sum_n spec[t + n - order + 1 + lookahead, f] * coef(t, f, n)
+         // spec frames outside [0, frames) are zero. coefs [frames, nb_df, order, 2] as the df decoder emits them.
+         // spec and enhanced [frames, stride] must not alias.
+         void deep_filter(const Complex* spec, int64_t stride, const float* coefs, Complex* enhanced, int64_t frames,
+            int64_t nb_df, int64_t order, int64_t lookahead);
+
+         // DeepFilterNet3 post filter: attenuates the bins the network already attenuated a little more
+         void post_filter(const Complex* spec, Complex* enhanced, int64_t count, float beta = 0.02f);
+
+         // enhanced = lerp(enhanced, spec, weight)
+         void lerp(const Complex* spec, Complex* enhanced, int64_t count, float weight);
+      }
+   }
+}
+#endif // DFN_DSP_H
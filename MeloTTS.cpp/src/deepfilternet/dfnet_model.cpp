@@ -3,9 +3,6 @@
 #ifdef USE_DEEPFILTERNET
 #include "dfnet_model.h"
 #include "openvino_torch_utils.h"
-#if defined(MODEL_PROFILING_DEBUG)
-#include "utils.h"
-#endif // MODEL_PROFILING_DEBUG
 
 #include <iostream>
 
@@ -98,8 +95,8 @@ namespace melo {
       };
 
       DFNetModel::DFNetModel(std::unique_ptr<ov::Core>& _core, std::string model_folder, std::string device, ModelSelection model_selection,
-         const ov::AnyMap& nf_ov_cfg, torch::Tensor erb_widths, int64_t lookahead, int64_t nb_df)
-         : _nb_df(nb_df), _df(nb_df, 5, 2)
+         const ov::AnyMap& nf_ov_cfg, torch::Tensor erb_widths, int64_t lookahead, int64_t nb_df, int64_t num_hops)
+         : _nb_df(nb_df), _df(nb_df, 5, 2), _num_hops(num_hops)
       {
          auto erb_inv_fb = erb_fb(erb_widths, 48000, true, true);
 
@@ -121,123 +118,12 @@ namespace melo {
 
          _mask = std::make_shared<Mask>(erb_inv_fb);
 
-         if (device.find("CPU") != std::string::npos) {
-             _core->set_property("CPU", { {"CPU_RUNTIME_CACHE_CAPACITY", "0"} });
-             std::cout << "[DFNetModel] Set CPU_RUNTIME_CACHE_CAPACITY 0\n";
-         }
-         
-         _num_hops = 3002;
-
-   #define DFNET_USE_ONNX 0 //set to 1 to use .onnx models, set to 0 to use OpenVINO IR (.xml)
-
-         //enc
-         {
-   #if DFNET_USE_ONNX
-            auto model_fullpath = FullPath(model_folder, "enc.onnx");
-   #else
-            auto model_fullpath = FullPath(model_folder, "enc.xml");
-   #endif
-            std::cout << "model_fullpath = " << model_fullpath << std::endl;
-            auto model = _core->read_model(model_fullpath);
-
-            std::map<ov::Output<ov::Node>, ov::PartialShape> port_to_shape;
-            port_to_shape[model->input("feat_erb")] = { 1, 1, _num_hops, 32 };
-            port_to_shape[model->input("feat_spec")] = { 1, 2, _num_hops, 96 };
-            model->reshape(port_to_shape);
-   #if 0
-            //dump IR
-            ov::serialize(model, "enc.xml", "enc.bin");
-   #endif
-   #ifdef MODEL_DEBUG
-            std::cout << "enc: " << std::endl;
-            logBasicModelInfo(model);
-   #endif
-            _model_request_enc = std::make_unique<ov::CompiledModel>(_core->compile_model(model, device, nf_ov_cfg));
-            _infer_request_enc = std::make_unique<ov::InferRequest>(_model_request_enc->create_infer_request());
-         }
-
-         //erb_dec
-         {
-   #if DFNET_USE_ONNX
-            auto model_fullpath = FullPath(model_folder, "erb_dec.onnx");
-   #else
-            auto model_fullpath = FullPath(model_folder, "erb_dec.xml");
-   #endif
-            auto model = _core->read_model(model_fullpath);
-
-            std::map<ov::Output<ov::Node>, ov::PartialShape> port_to_shape;
-            if (_bDF3)
-            {
-               port_to_shape[model->input("emb")] = { 1, _num_hops, 512 };
-            }
-            else
-            {
-               port_to_shape[model->input("emb")] = { 1, _num_hops, 256 };
-            }
-
-            port_to_shape[model->input("e3")] = { 1, 64, _num_hops, 8 };
-            port_to_shape[model->input("e2")] = { 1, 64, _num_hops, 8 };
-            port_to_shape[model->input("e1")] = { 1, 64, _num_hops, 16 };
-            port_to_shape[model->input("e0")] = { 1, 64, _num_hops, 32 };
-            model->reshape(port_to_shape);
-   #if 0
-            //dump IR
-            ov::serialize(model, "erb_dec.xml", "erb_dec.bin");
-   #endif
-   #ifdef MODEL_DEBUG
-            std::cout << "erb_dec: " << std::endl;
-            logBasicModelInfo(model);
-   #endif
-            _model_request_erb_dec = std::make_unique<ov::CompiledModel>(_core->compile_model(model, device, nf_ov_cfg));
-            _infer_request_erb_dec = std::make_unique<ov::InferRequest>(_model_request_erb_dec->create_infer_request());
-
-            //'link' the output of enc directly to the input of erb_dec
-            _infer_request_erb_dec->set_tensor("emb", _infer_request_enc->get_tensor("emb"));
-            _infer_request_erb_dec->set_tensor("e3", _infer_request_enc->get_tensor("e3"));
-            _infer_request_erb_dec->set_tensor("e2", _infer_request_enc->get_tensor("e2"));
-            _infer_request_erb_dec->set_tensor("e1", _infer_request_enc->get_tensor("e1"));
-            _infer_request_erb_dec->set_tensor("e0", _infer_request_enc->get_tensor("e0"));
-         }
-
-         //df_dec
-         {
-   #if DFNET_USE_ONNX
-            auto model_fullpath = FullPath(model_folder, "df_dec.onnx");
-   #else
-            auto model_fullpath = FullPath(model_folder, "df_dec.xml");
-   #endif
-            auto model = _core->read_model(model_fullpath);
-
-            std::map<ov::Output<ov::Node>, ov::PartialShape> port_to_shape;
-            if (_bDF3)
-            {
-               port_to_shape[model->input("emb")] = { 1, _num_hops, 512 };
-            }
-            else
-            {
-               port_to_shape[model->input("emb")] = { 1, _num_hops, 256 };
-            }
-            port_to_shape[model->input("c0")] = { 1, 64, _num_hops, 96 };
-            model->reshape(port_to_shape);
-   #if 0
-            //dump IR
-            ov::serialize(model, "df_dec.xml", "df_dec.bin");
-   #endif
-   #ifdef MODEL_DEBUG
-            std::cout << "df_dec: " << std::endl;
-            logBasicModelInfo(model);
-   #endif
-            _model_request_df_dec = std::make_unique<ov::CompiledModel>(_core->compile_model(model, device, nf_ov_cfg));
-            _infer_request_df_dec = std::make_unique<ov::InferRequest>(_model_request_df_dec->create_infer_request());
-
-            _infer_request_df_dec->set_tensor("emb", _infer_request_enc->get_tensor("emb"));
-            _infer_request_df_dec->set_tensor("c0", _infer_request_enc->get_tensor("c0"));
-         }
+         _networks = std::make_unique<DFNetNetworks>(_core, model_folder, device, _bDF3, nf_ov_cfg, erb_widths.size(0), _nb_df, _num_hops);
       }
 
       torch::Tensor DFNetModel::forward(torch::Tensor spec, torch::Tensor feat_erb, torch::Tensor feat_spec, bool post_filter)
       {
-        
+         _networks->prepare(spec.size(2));
          if (_bDF3) [[likely]]
          {
             return forward_df3(spec, feat_erb, feat_spec, post_filter);
@@ -272,39 +158,26 @@ namespace melo {
          feat_erb = (*_pad_feat)(feat_erb);
          feat_spec = (*_pad_feat)(feat_spec);
 
-         //run enc
+         //run enc, then start both decoders on its outputs
          {
-            auto ov_erb = wrap_ov_tensor_as_torch(_infer_request_enc->get_tensor("feat_erb"));
-            auto ov_feat_spec = wrap_ov_tensor_as_torch(_infer_request_enc->get_tensor("feat_spec"));
+            auto ov_erb = wrap_ov_tensor_as_torch(_networks->feat_erb());
+            auto ov_feat_spec = wrap_ov_tensor_as_torch(_networks->feat_spec());
 
             ov_erb.copy_(feat_erb);
             ov_feat_spec.copy_(feat_spec);
 
-            _infer_request_enc->infer();
-#if defined(MODEL_PROFILING_DEBUG)
-            std::cout << "---- [NF][DFNet]: Encoder model profiling ----" << std::endl;
-            get_profiling_info(_infer_request_enc);
-#endif // MODEL_PROFILING_DEBUG
-            auto lsnr = wrap_ov_tensor_as_torch(_infer_request_enc->get_tensor("lsnr"));
-
-            //note: remember, the output tensors of _infer_request_enc are set as input tensors for 
-            // both _infer_request_erb_dec and _infer_request_df_dec, which is why you don't see me explictly
-            // grabbing the output of the above infer, and copying them to the input tensors for the other 
-            // infer_requests.
+            _networks->infer();
          }
 
          //expose this?
          bool run_erb = true;
 
          torch::Tensor m, spec_m;
+         auto spec_df = spec.clone();
          if (run_erb)
          {
-            _infer_request_erb_dec->infer();
-#if defined(MODEL_PROFILING_DEBUG)
-            std::cout << "---- [NF][DFNet]: ERB Decoder model profiling ----" << std::endl;
-            get_profiling_info(_infer_request_erb_dec);
-#endif // MODEL_PROFILING_DEBUG
-            m = wrap_ov_tensor_as_torch(_infer_request_erb_dec->get_tensor("m"));
+            //waits for erb_dec only, the mask is applied while df_dec is still running
+            m = wrap_ov_tensor_as_torch(_networks->mask());
 
             //auto pad_spec = torch::nn::functional::pad(spec, torch::nn::functional::PadFuncOptions({ 0, 0, 0, 0, 1, -1, 0, 0 }).value(0.0));
 
@@ -323,12 +196,7 @@ namespace melo {
          torch::Tensor df_coefs;
          if (run_df)
          {
-            _infer_request_df_dec->infer();
-#if defined(MODEL_PROFILING_DEBUG)
-            std::cout << "---- [NF][DFNet]: DF Decoder model profiling ----" << std::endl;
-            get_profiling_info(_infer_request_df_dec);
-#endif // MODEL_PROFILING_DEBUG
-            df_coefs = wrap_ov_tensor_as_torch(_infer_request_df_dec->get_tensor("coefs"));
+            df_coefs = wrap_ov_tensor_as_torch(_networks->coefs());
 
             //DfOutputReshapeMF forward
             {
@@ -352,7 +220,7 @@ namespace melo {
          }
 
          using namespace torch::indexing;
-         auto spec_e = _df.forward(spec.clone(), df_coefs);
+         auto spec_e = _df.forward(spec_df, df_coefs);
          spec_e.index_put_({ "...", Slice(_nb_df, None),  Slice(None) }, spec_m.index({ "...", Slice(_nb_df, None),  Slice(None) }));
 
          if (post_filter)
@@ -364,54 +232,46 @@ namespace melo {
             auto pf = (1 + beta) / (1 + beta * mask.div(mask_sin).pow(2));
             spec_e = spec_e * pf.unsqueeze(-1);
          }
-         //Release infer memory
-         _model_request_df_dec->release_memory();
-         _model_request_enc->release_memory();
-         _model_request_erb_dec->release_memory();
-
          return spec_e;
       }
 
+      void DFNetModel::release_infer_memory()
+      {
+         _networks->release_infer_memory();
+      }
+
       torch::Tensor DFNetModel::forward_df2(torch::Tensor spec, torch::Tensor feat_erb, torch::Tensor feat_spec)
       {
          feat_spec = feat_spec.squeeze(1).permute({ 0, 3, 1, 2 });
          feat_erb = (*_pad_feat)(feat_erb);
          feat_spec = (*_pad_feat)(feat_spec);
 
-         //run enc
+         //run enc, then start both decoders on its outputs
          {
-            auto ov_erb = wrap_ov_tensor_as_torch(_infer_request_enc->get_tensor("feat_erb"));
-            auto ov_feat_spec = wrap_ov_tensor_as_torch(_infer_request_enc->get_tensor("feat_spec"));
+            auto ov_erb = wrap_ov_tensor_as_torch(_networks->feat_erb());
+            auto ov_feat_spec = wrap_ov_tensor_as_torch(_networks->feat_spec());
 
             ov_erb.copy_(feat_erb);
             ov_feat_spec.copy_(feat_spec);
 
-            _infer_request_enc->infer();
-#if defined(MODEL_PROFILING_DEBUG)
-            std::cout << "---- [NF][DFNet]: Encoder model profiling ----" << std::endl;
-            get_profiling_info(_infer_request_enc);
-#endif // MODEL_PROFILING_DEBUG
-
-            //note: remember, the output tensors of _infer_request_enc are set as input tensors for 
-            // both _infer_request_erb_dec and _infer_request_df_dec, which is why you don't see me explictly
-            // grabbing the output of the above infer, and copying them to the input tensors for the other 
-            // infer_requests.
+            _networks->infer();
          }
 
          //expose this?
          bool run_erb = true;
+         if (run_erb)
          {
-            _infer_request_erb_dec->infer();
-#if defined(MODEL_PROFILING_DEBUG)
-            std::cout << "---- [NF][DFNet]: ERB Decoder model profiling ----" << std::endl;
-            get_profiling_info(_infer_request_erb_dec);
-#endif // MODEL_PROFILING_DEBUG
-            auto m = wrap_ov_tensor_as_torch(_infer_request_erb_dec->get_tensor("m"));
+            //waits for erb_dec only, the mask is applied while df_dec is still running
+            auto m = wrap_ov_tensor_as_torch(_networks->mask());
 
             //auto pad_spec = torch::nn::functional::pad(spec, torch::nn::functional::PadFuncOptions({ 0, 0, 0, 0, 1, -1, 0, 0 }).value(0.0));
 
             spec = _mask->forward(spec, m);
          }
+         else
+         {
+            throw std::runtime_error("not implemented run_erb=false");
+         }
 
          //expose this?
          bool run_df = true;
@@ -419,12 +279,7 @@ namespace melo {
          torch::Tensor df_coefs;
          if (run_df)
          {
-            _infer_request_df_dec->infer();
-#if defined(MODEL_PROFILING_DEBUG)
-            std::cout << "---- [NF][DFNet]: DF Decoder model profiling ----" << std::endl;
-            get_profiling_info(_infer_request_df_dec);
-#endif // MODEL_PROFILING_DEBUG
-            df_coefs = wrap_ov_tensor_as_torch(_infer_request_df_dec->get_tensor("coefs"));
+            df_coefs = wrap_ov_tensor_as_torch(_networks->coefs());
 
             //DfOutputReshapeMF forward
             {
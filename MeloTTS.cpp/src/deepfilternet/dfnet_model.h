@@ -5,6 +5,7 @@
 #include <optional>
 #include <openvino/openvino.hpp>
 #include "multiframe.h"
+#include "dfnet_networks.h"
 
 namespace melo {
       namespace ov_deepfilternet {
@@ -26,8 +27,10 @@ namespace melo {
                ModelSelection model_selection,
                const ov::AnyMap& nf_ov_cfg,
                torch::Tensor erb_widths,
-               int64_t lookahead = 2, int64_t nb_df = 96);
+               int64_t lookahead = 2, int64_t nb_df = 96,
+               int64_t num_hops = 3002);
 
+            // runs the networks on spec.size(2) hops, which must be num_hops_for() of the frames needed
             torch::Tensor
                forward(torch::Tensor spec, torch::Tensor feat_erb, torch::Tensor feat_spec, bool post_filter=false);
 
@@ -35,6 +38,14 @@ namespace melo {
             {
                return _num_hops;
             };
+            // hops of the smallest shape that covers frames <= num_static_hops()
+            int64_t num_hops_for(int64_t frames)
+            {
+               return _networks->hops_for(frames);
+            }
+
+            // free the intermediate buffers of the three networks, e.g. at the end of a stream
+            void release_infer_memory();
          private:
 
             torch::Tensor
@@ -43,13 +54,7 @@ namespace melo {
             [[maybe_unused]] torch::Tensor
                forward_df2(torch::Tensor spec, torch::Tensor feat_erb, torch::Tensor feat_spec);
 
-            std::unique_ptr<ov::CompiledModel> _model_request_enc;
-            std::unique_ptr<ov::CompiledModel> _model_request_erb_dec;
-            std::unique_ptr<ov::CompiledModel> _model_request_df_dec;
-
-            std::unique_ptr<ov::InferRequest> _infer_request_enc;
-            std::unique_ptr<ov::InferRequest> _infer_request_erb_dec;
-            std::unique_ptr<ov::InferRequest> _infer_request_df_dec;
+            std::unique_ptr<DFNetNetworks> _networks;
 
             std::shared_ptr< torch::nn::ConstantPad3d > _pad_spec;
             std::shared_ptr< torch::nn::ConstantPad2d > _pad_feat;
@@ -0,0 +1,91 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: GPL-3.0-only
+#ifdef USE_DEEPFILTERNET_NATIVE
+#include "dfnet_model_native.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+namespace melo {
+   namespace ov_deepfilternet {
+      DFNetModel::DFNetModel(std::unique_ptr<ov::Core>& _core, std::string model_folder, std::string device, ModelSelection model_selection,
+         const ov::AnyMap& nf_ov_cfg, const std::vector<int64_t>& erb_widths, int64_t lookahead, int64_t nb_df, int64_t num_hops)
+         : _erb_offsets(dsp::erb_offsets(erb_widths)), _lookahead(lookahead), _nb_df(nb_df), _num_hops(num_hops)
+      {
+         _bDF3 = (model_selection == ModelSelection::DEEPFILTERNET3);
+         model_folder = (std::filesystem::path(model_folder) / (_bDF3 ? "deepfilternet3" : "deepfilternet2")).string();
+         _networks = std::make_unique<DFNetNetworks>(_core, model_folder, device, _bDF3, nf_ov_cfg, erb_widths.size(), _nb_df, _num_hops);
+
+         if (!_bDF3)
+            _masked.resize(_num_hops * _erb_offsets.back());
+      }
+
+      void DFNetModel::_run_networks(const float* feat_erb, const dsp::Complex* feat_spec, int64_t hops)
+      {
+         _networks->prepare(hops);
+         const int64_t nb_erb = _erb_offsets.size() - 1;
+         const int64_t shifted = std::max<int64_t>(0, hops - _lookahead);
+
+         // feat_erb [1, 1, T, nb_erb], feat_spec [1, 2, T, nb_df] (real plane, imaginary plane), both shifted by the
+         // lookahead: frame t of the input is frame t + lookahead of the features, the last frames are zero
+         float* erb_in = _networks->feat_erb().data<float>();
+         std::copy_n(feat_erb + _lookahead * nb_erb, shifted * nb_erb, erb_in);
+         std::fill(erb_in + shifted * nb_erb, erb_in + hops * nb_erb, 0.f);
+
+         float* spec_re = _networks->feat_spec().data<float>();
+         float* spec_im = spec_re + hops * _nb_df;
+         for (int64_t t = 0; t < shifted; ++t)
+         {
+            const dsp::Complex* row = feat_spec + (t + _lookahead) * _nb_df;
+            for (int64_t f = 0; f < _nb_df; ++f)
+            {
+               spec_re[t * _nb_df + f] = row[f].real();
+               spec_im[t * _nb_df + f] = row[f].imag();
+            }
+         }
+         std::fill(spec_re + shifted * _nb_df, spec_re + hops * _nb_df, 0.f);
+         std::fill(spec_im + shifted * _nb_df, spec_im + hops * _nb_df, 0.f);
+
+         _networks->infer();
+      }
+
+      void DFNetModel::forward(const dsp::Complex* spec, const float* feat_erb, const dsp::Complex* feat_spec,
+         dsp::Complex* enhanced, int64_t hops, bool post_filter)
+      {
+         _run_networks(feat_erb, feat_spec, hops);
+
+         // m [1, 1, T, nb_erb]; the mask is applied while df_dec is still running
+         const float* m = _networks->mask().data<float>();
+         const int64_t freq_size = _erb_offsets.back();
+         const dsp::Complex* df_input = spec;
+         if (_bDF3) [[likely]]
+         {
+            // the deep filter runs on the unmasked spectrum, the mask covers the bins above nb_df only
+            dsp::apply_erb_mask(spec, m, _erb_offsets, enhanced, hops, _nb_df);
+         }
+         else [[unlikely]]
+         {
+            dsp::apply_erb_mask(spec, m, _erb_offsets, _masked.data(), hops);
+            std::copy_n(_masked.begin(), hops * freq_size, enhanced);
+            df_input = _masked.data();
+         }
+
+         // coefs [1, T, nb_df, order * 2]
+         auto coefs_tensor = _networks->coefs();
+         if (coefs_tensor.get_shape().back() != static_cast<size_t>(_df_order * 2))
+            throw std::runtime_error("DFNetModel: unexpected shape of the deep filter coefficients");
+         dsp::deep_filter(df_input, freq_size, coefs_tensor.data<float>(), enhanced, hops, _nb_df, _df_order, _lookahead);
+
+         if (_bDF3 && post_filter)
+            dsp::post_filter(spec, enhanced, hops * freq_size);
+      }
+
+      void DFNetModel::release_infer_memory()
+      {
+         _networks->release_infer_memory();
+      }
+   }
+}
+#endif // USE_DEEPFILTERNET_NATIVE
@@ -0,0 +1,79 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: GPL-3.0-only
+#pragma once
+#ifdef USE_DEEPFILTERNET_NATIVE
+#include <memory>
+#include <string>
+#include <vector>
+#include <openvino/openvino.hpp>
+#include "dfn_dsp.h"
+#include "dfnet_networks.h"
+
+namespace melo {
+      namespace ov_deepfilternet {
+         enum class ModelSelection
+         {
+            DEEPFILTERNET2,
+            DEEPFILTERNET3,
+         };
+
+         // The libtorch-free counterpart of dfnet_model.h: the features are written straight into the input tensors
+         // of the encoder, the ERB mask and the deep filter are applied by dsp:: on the output tensors.
+         class DFNetModel
+         {
+         public:
+
+            DFNetModel(
+               std::unique_ptr<ov::Core>& core,
+               std::string model_folder,
+               std::string device,
+               ModelSelection model_selection,
+               const ov::AnyMap& nf_ov_cfg,
+               const std::vector<int64_t>& erb_widths,
+               int64_t lookahead = 2, int64_t nb_df = 96,
+               int64_t num_hops = 3002);
+            virtual ~DFNetModel() = default;
+
+            // spec [hops, freq], feat_erb [hops, nb_erb], feat_spec [hops, nb_df] -> enhanced [hops, freq], where hops
+            // must be num_hops_for() of the frames needed
+            virtual void forward(const dsp::Complex* spec, const float* feat_erb, const dsp::Complex* feat_spec,
+               dsp::Complex* enhanced, int64_t hops, bool post_filter = false);
+
+            int64_t num_static_hops()
+            {
+               return _num_hops;
+            };
+            // hops of the smallest shape that covers frames <= num_static_hops()
+            virtual int64_t num_hops_for(int64_t frames)
+            {
+               return _networks->hops_for(frames);
+            }
+
+            // free the intermediate buffers of the three networks, e.g. at the end of a stream
+            virtual void release_infer_memory();
+
+         protected:
+            // without networks, for a model that overrides the virtual functions, e.g. a stub in the tests
+            DFNetModel(int64_t lookahead, int64_t nb_df, int64_t num_hops)
+               : _lookahead(lookahead), _nb_df(nb_df), _num_hops(num_hops), _bDF3(true) {}
+
+         private:
+
+            // copy the features shifted by the lookahead into the encoder, run the encoder and start the decoders
+            void _run_networks(const float* feat_erb, const dsp::Complex* feat_spec, int64_t hops);
+
+            std::unique_ptr<DFNetNetworks> _networks;
+
+            std::vector<int64_t> _erb_offsets;
+            std::vector<dsp::Complex> _masked;   // DeepFilterNet2 filters the masked spectrum
+
+            int64_t _lookahead;
+            int64_t _nb_df;
+            int64_t _df_order = 5;
+            int64_t _num_hops;
+
+            bool _bDF3;
+         };
+      }
+}
+#endif // USE_DEEPFILTERNET_NATIVE
@@ -0,0 +1,214 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: GPL-3.0-only
+#ifdef USE_DEEPFILTERNET
+#include "dfnet_networks.h"
+#if defined(MODEL_PROFILING_DEBUG)
+#include "utils.h"
+#endif // MODEL_PROFILING_DEBUG
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+namespace melo {
+   namespace ov_deepfilternet {
+      namespace {
+         std::shared_ptr<ov::Model> read(std::unique_ptr<ov::Core>& core, const std::string& model_folder, const char* name)
+         {
+            const auto model_fullpath = (std::filesystem::path(model_folder) / name).string();
+            std::cout << "model_fullpath = " << model_fullpath << std::endl;
+            return core->read_model(model_fullpath);
+         }
+
+         void reshape(const std::shared_ptr<ov::Model>& model, const std::map<std::string, ov::PartialShape>& shapes)
+         {
+            std::map<ov::Output<ov::Node>, ov::PartialShape> port_to_shape;
+            for (const auto& [name, shape] : shapes)
+               port_to_shape[model->input(name)] = shape;
+            model->reshape(port_to_shape);
+         }
+      }
+
+      DFNetNetworks::DFNetNetworks(std::unique_ptr<ov::Core>& core, const std::string& model_folder, const std::string& device,
+         bool df3, const ov::AnyMap& nf_ov_cfg, int64_t nb_erb, int64_t nb_df, int64_t max_hops)
+         : _core(core), _device(device), _nf_ov_cfg(nf_ov_cfg), _nb_erb(nb_erb), _nb_df(nb_df),
+           _emb_size(df3 ? 512 : 256), _max_hops(max_hops)
+      {
+         // the CPU plugin runs dynamic shapes, GPU and NPU get static buckets
+         _dynamic = (device == "CPU");
+         if (device.find("CPU") != std::string::npos && !_dynamic) {
+             // a static shape never changes, the runtime cache would only hold memory
+             _core->set_property("CPU", { {"CPU_RUNTIME_CACHE_CAPACITY", "0"} });
+             std::cout << "[DFNetModel] Set CPU_RUNTIME_CACHE_CAPACITY 0\n";
+         }
+
+         _enc_model = read(_core, model_folder, "enc.xml");
+         _erb_dec_model = read(_core, model_folder, "erb_dec.xml");
+         _df_dec_model = read(_core, model_folder, "df_dec.xml");
+
+         if (_dynamic)
+         {
+            _requests[-1] = _compile(-1);
+            _current = _requests[-1].get();
+         }
+         std::cout << "[NF][DFNet] " << (_dynamic ? "dynamic hops" : "static hop buckets") << ", at most " << _max_hops << std::endl;
+      }
+
+      int64_t DFNetNetworks::hops_for(int64_t frames) const
+      {
+         if (frames > _max_hops)
+            throw std::invalid_argument("DFNetNetworks: " + std::to_string(frames) + " hops exceed " + std::to_string(_max_hops));
+         if (_dynamic)
+            return std::max<int64_t>(frames, 1);
+         return std::min(_max_hops, std::max<int64_t>(1, (frames + HOP_BUCKET - 1) / HOP_BUCKET) * HOP_BUCKET);
+      }
+
+      std::unique_ptr<DFNetNetworks::Requests> DFNetNetworks::_compile(int64_t hops)
+      {
+         reshape(_enc_model, { { "feat_erb", { 1, 1, hops, _nb_erb } }, { "feat_spec", { 1, 2, hops, _nb_df } } });
+         reshape(_erb_dec_model, { { "emb", { 1, hops, _emb_size } },
+                                   { "e3", { 1, 64, hops, 8 } },
+                                   { "e2", { 1, 64, hops, 8 } },
+                                   { "e1", { 1, 64, hops, 16 } },
+                                   { "e0", { 1, 64, hops, 32 } } });
+         reshape(_df_dec_model, { { "emb", { 1, hops, _emb_size } }, { "c0", { 1, 64, hops, _nb_df } } });
+         auto requests = std::make_unique<Requests>();
+         requests->enc = std::make_unique<ov::CompiledModel>(_core->compile_model(_enc_model, _device, _nf_ov_cfg));
+         requests->erb_dec = std::make_unique<ov::CompiledModel>(_core->compile_model(_erb_dec_model, _device, _nf_ov_cfg));
+         requests->df_dec = std::make_unique<ov::CompiledModel>(_core->compile_model(_df_dec_model, _device, _nf_ov_cfg));
+         requests->enc_request = std::make_unique<ov::InferRequest>(requests->enc->create_infer_request());
+         requests->erb_dec_request = std::make_unique<ov::InferRequest>(requests->erb_dec->create_infer_request());
+         requests->df_dec_request = std::make_unique<ov::InferRequest>(requests->df_dec->create_infer_request());
+
+         if (hops > 0)
+         {
+            //'link' the outputs of enc directly to the inputs of the decoders; dynamic outputs are linked after every
+            // inference, see infer()
+            for (const char* name : { "emb", "e3", "e2", "e1", "e0" })
+               requests->erb_dec_request->set_tensor(name, requests->enc_request->get_tensor(name));
+            for (const char* name : { "emb", "c0" })
+               requests->df_dec_request->set_tensor(name, requests->enc_request->get_tensor(name));
+            std::cout << "[NF][DFNet] compiled for " << hops << " hops" << std::endl;
+         }
+         return requests;
+      }
+
+      void DFNetNetworks::prepare(int64_t hops)
+      {
+         if (hops == _current_hops)
+            return;
+         if (hops != hops_for(hops))
+            throw std::invalid_argument("DFNetNetworks: no shape of " + std::to_string(hops) + " hops");
+
+         if (_dynamic)
+         {
+            _feat_erb = ov::Tensor(ov::element::f32, ov::Shape{ 1, 1, static_cast<size_t>(hops), static_cast<size_t>(_nb_erb) });
+            _feat_spec = ov::Tensor(ov::element::f32, ov::Shape{ 1, 2, static_cast<size_t>(hops), static_cast<size_t>(_nb_df) });
+            _current->enc_request->set_tensor("feat_erb", _feat_erb);
+            _current->enc_request->set_tensor("feat_spec", _feat_spec);
+         }
+         else
+         {
+            auto& requests = _requests[hops];
+            if (!requests)
+               requests = _compile(hops);
+            _current = requests.get();
+         }
+         _current_hops = hops;
+      }
+
+      ov::Tensor DFNetNetworks::feat_erb()
+      {
+         return _current->enc_request->get_tensor("feat_erb");
+      }
+
+      ov::Tensor DFNetNetworks::feat_spec()
+      {
+         return _current->enc_request->get_tensor("feat_spec");
+      }
+
+      void DFNetNetworks::infer()
+      {
+         _current->enc_request->infer();
+#if defined(MODEL_PROFILING_DEBUG)
+         std::cout << "---- [NF][DFNet]: Encoder model profiling ----" << std::endl;
+         get_profiling_info(_current->enc_request);
+#endif // MODEL_PROFILING_DEBUG
+         if (_dynamic)
+         {
+            for (const char* name : { "emb", "e3", "e2", "e1", "e0" })
+               _current->erb_dec_request->set_tensor(name, _current->enc_request->get_tensor(name));
+            for (const char* name : { "emb", "c0" })
+               _current->df_dec_request->set_tensor(name, _current->enc_request->get_tensor(name));
+         }
+
+         _current->df_dec_request->start_async();
+         try
+         {
+            _current->erb_dec_request->start_async();
+         }
+         catch (...)
+         {
+            _current->df_dec_request->wait();
+            throw;
+         }
+      }
+
+      void DFNetNetworks::_wait(ov::InferRequest& request, ov::InferRequest& other)
+      {
+         try
+         {
+            request.wait();
+         }
+         catch (...)
+         {
+            // the tensors of the other request must not be touched while it runs
+            try
+            {
+               other.wait();
+            }
+            catch (...)
+            {
+            }
+            throw;
+         }
+      }
+
+      ov::Tensor DFNetNetworks::mask()
+      {
+         _wait(*_current->erb_dec_request, *_current->df_dec_request);
+#if defined(MODEL_PROFILING_DEBUG)
+         std::cout << "---- [NF][DFNet]: ERB Decoder model profiling ----" << std::endl;
+         get_profiling_info(_current->erb_dec_request);
+#endif // MODEL_PROFILING_DEBUG
+         return _current->erb_dec_request->get_tensor("m");
+      }
+
+      ov::Tensor DFNetNetworks::coefs()
+      {
+         _wait(*_current->df_dec_request, *_current->erb_dec_request);
+#if defined(MODEL_PROFILING_DEBUG)
+         std::cout << "---- [NF][DFNet]: DF Decoder model profiling ----" << std::endl;
+         get_profiling_info(_current->df_dec_request);
+#endif // MODEL_PROFILING_DEBUG
+         return _current->df_dec_request->get_tensor("coefs");
+      }
+
+      ov::Tensor DFNetNetworks::lsnr()
+      {
+         return _current->enc_request->get_tensor("lsnr");
+      }
+
+      void DFNetNetworks::release_infer_memory()
+      {
+         for (auto& [hops, requests] : _requests)
+         {
+            requests->df_dec->release_memory();
+            requests->enc->release_memory();
+            requests->erb_dec->release_memory();
+         }
+      }
+   }
+}
+#endif // USE_DEEPFILTERNET
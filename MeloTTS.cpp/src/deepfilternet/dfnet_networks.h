@@ -0,0 +1,88 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: GPL-3.0-only
+#pragma once
+#ifdef USE_DEEPFILTERNET
+#include <map>
+#include <memory>
+#include <string>
+#include <openvino/openvino.hpp>
+
+namespace melo {
+   namespace ov_deepfilternet {
+      // The encoder, ERB decoder and DF decoder of DeepFilterNet, shared by the libtorch and the native DFNetModel.
+      //
+      // The networks are causal in time (the lookahead is a shift of the features), so a window of a few hops gives
+      // the same result for those hops as the same hops zero-padded to the maximum. The number of hops run is
+      // therefore chosen per call:
+      //  - CPU: the time dimension of the models is dynamic, every call runs exactly the hops it needs.
+      //  - other devices need static shapes: one compiled set of models per multiple of HOP_BUCKET hops (capped at
+      //    max_hops), compiled on first use.
+      class DFNetNetworks
+      {
+      public:
+         static constexpr int64_t HOP_BUCKET = 50;   // 0.5 s at 48 kHz
+
+         DFNetNetworks(std::unique_ptr<ov::Core>& core, const std::string& model_folder, const std::string& device,
+            bool df3, const ov::AnyMap& nf_ov_cfg, int64_t nb_erb, int64_t nb_df, int64_t max_hops);
+
+         int64_t max_hops() const
+         {
+            return _max_hops;
+         }
+         bool is_dynamic() const
+         {
+            return _dynamic;
+         }
+         // number of hops run for a window of frames hops, frames <= max_hops
+         int64_t hops_for(int64_t frames) const;
+
+         // make the models of hops_for(hops) == hops current, compiling them if needed
+         void prepare(int64_t hops);
+         // inputs of the current shape: feat_erb [1, 1, hops, nb_erb], feat_spec [1, 2, hops, nb_df]
+         ov::Tensor feat_erb();
+         ov::Tensor feat_spec();
+         // Run enc, then start erb_dec and df_dec on its outputs. Both decoders read only encoder outputs, so they run
+         // concurrently; mask() and coefs() wait for their own decoder, which lets the caller apply the mask while
+         // df_dec is still running. Both must be called before the next infer().
+         void infer();
+         // outputs: m [1, 1, hops, nb_erb], coefs [1, hops, nb_df, order * 2], lsnr
+         ov::Tensor mask();
+         ov::Tensor coefs();
+         ov::Tensor lsnr();
+
+         // free the intermediate buffers of the compiled models, e.g. at the end of a stream
+         void release_infer_memory();
+
+      private:
+         struct Requests
+         {
+            std::unique_ptr<ov::CompiledModel> enc, erb_dec, df_dec;
+            std::unique_ptr<ov::InferRequest> enc_request, erb_dec_request, df_dec_request;
+         };
+
+         // reshape the models to hops (-1: dynamic) and compile them
+         std::unique_ptr<Requests> _compile(int64_t hops);
+         // wait for a decoder started by infer(); on failure the other one is waited for as well before rethrowing
+         void _wait(ov::InferRequest& request, ov::InferRequest& other);
+
+         std::unique_ptr<ov::Core>& _core;
+         std::string _device;
+         ov::AnyMap _nf_ov_cfg;
+         std::shared_ptr<ov::Model> _enc_model;
+         std::shared_ptr<ov::Model> _erb_dec_model;
+         std::shared_ptr<ov::Model> _df_dec_model;
+         int64_t _nb_erb;
+         int64_t _nb_df;
+         int64_t _emb_size;
+         int64_t _max_hops;
+         bool _dynamic;
+
+         std::map<int64_t, std::unique_ptr<Requests>> _requests;   // by hop count, a single entry -1 when dynamic
+         Requests* _current = nullptr;
+         int64_t _current_hops = 0;
+         ov::Tensor _feat_erb;    // dynamic: inputs of the current shape
+         ov::Tensor _feat_spec;
+      };
+   }
+}
+#endif // USE_DEEPFILTERNET
@@ -37,7 +37,7 @@ namespace melo {
   	/* can be DEEPFILTERNET2 or DEEPFILTERNET3 */
     std::cout << " NoiseFilter::init. aModel_path = " << aModel_path << " nf devices = " << aModel_device << std::endl;
     auto dfnet_version = ov_deepfilternet::ModelSelection::DEEPFILTERNET3;
-    mDeepfilter.Init(core, aModel_path, aModel_device, dfnet_version, set_nf_ov_cfg(aModel_device));
+    mDeepfilter.Init(core, aModel_path, aModel_device, dfnet_version, set_nf_ov_cfg(aModel_device), SAMPLE_RATE);
   }
 
   ov::AnyMap NoiseFilter::set_nf_ov_cfg(const std::string& device_name) {
@@ -75,8 +75,24 @@ namespace melo {
 
 
   void NoiseFilter::proc(std::vector<float>& aMamples) {
+#ifdef USE_DEEPFILTERNET_NATIVE
+    aMamples = mDeepfilter.filter(aMamples);
+#else
     torch::Tensor input_wav_tensor = torch::from_blob(aMamples.data(), { 1, (int64_t)aMamples.size() });
     aMamples = mDeepfilter.filter(input_wav_tensor);
+#endif // USE_DEEPFILTERNET_NATIVE
+  }
+
+  void NoiseFilter::reset() {
+    mDeepfilter.reset_stream();
+  }
+
+  void NoiseFilter::proc(std::span<const float> samples, std::vector<float>& output) {
+    mDeepfilter.process(samples, output);
+  }
+
+  void NoiseFilter::flush(std::vector<float>& output) {
+    mDeepfilter.flush(output);
   }
 }
 #endif // USE_DEEPFILTERNET
@@ -1,13 +1,19 @@
 #ifndef NOISE_FILTER_H
 #define NOISE_FILTER_H
 #ifdef USE_DEEPFILTERNET
+#ifdef USE_DEEPFILTERNET_NATIVE
+#include "deepfilter_native.h"
+#else
 #include "deepfilter.h"
+#endif // USE_DEEPFILTERNET_NATIVE
+#include <span>
 #include <string>
 #include <vector>
 
 namespace melo {
   class NoiseFilter {
     public:
+      static constexpr int32_t SAMPLE_RATE = 48000;  // the rate the DeepFilterNet3 model is trained for
       explicit NoiseFilter();
       ~NoiseFilter();
       void init(std::unique_ptr<ov::Core>& core,
@@ -15,6 +21,10 @@ namespace melo {
                 const std::string aModel_device);
       ov::AnyMap set_nf_ov_cfg(const std::string& device_name);
       void proc(std::vector<float>& aMamples);
+      // streaming, see DeepFilter::process: the filtered audio is appended to output
+      void reset();
+      void proc(std::span<const float> samples, std::vector<float>& output);
+      void flush(std::vector<float>& output);
     private:
       ov_deepfilternet::DeepFilter mDeepfilter;
   };
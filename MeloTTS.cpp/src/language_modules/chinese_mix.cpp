@@ -17,11 +17,15 @@
  */
 #include "chinese_mix.h"
 
+#include <algorithm>
 #include <cctype>
 #include <format>
+#include <fstream>
 #include <iterator>
+#include <sstream>
 
 #include "tone_sandhi.h"
+#include "utf8_utils.h"
 namespace melo {
 // namespace chinese_mix {
 auto printVec = [](const auto& vec, const std::string& vecName) {
@@ -57,7 +61,7 @@ const std::unordered_map<std::string, std::string> v_rep_map = {
 const std::unordered_set<std::string> rep_map = {".", "...", "?", ",", "!", "-", "'"};
 
 // Constructor
-ChineseMix::ChineseMix(const std::filesystem::path& data_folder) {
+ChineseMix::ChineseMix(const std::filesystem::path& data_folder, size_t g2p_cache_prewarm_words) {
     // english pronounciation dict
     auto cmudict_path = data_folder / "cmudict_cache.txt";
 
@@ -92,9 +96,12 @@ ChineseMix::ChineseMix(const std::filesystem::path& data_folder) {
         std::cerr << "[ERROR] ChineseMix::file does not exists!\n";
     cmudict = std::make_shared<melo::CMUDict>(cmudict_path.string());
     jieba = std::make_shared<cppjieba::Jieba>(cppjieba_dict);
+    tone_sandhi = std::make_unique<ToneSandhi::SandhiEngine>(jieba);
     pinyin_to_symbol_map = readPinyinFile(pinyin_to_symbol_map_path);
     pinyin = std::make_shared<cppinyin::PinyinEncoder>(cppinyin_resource);
     normalizer = std::make_shared<text_normalization::TextNormalizer>(data_folder);
+    if (g2p_cache_prewarm_words > 0)
+        prewarm_g2p_cache(cppjieba_dict / "jieba.dict.utf8", g2p_cache_prewarm_words);
     std::cout << "[INFO] Init Chinese language Module Succeed!\n";
 }
 
@@ -102,11 +109,33 @@ ChineseMix::ChineseMix(const std::filesystem::path& data_folder) {
 // Corresponds to the python version of chinsese_mix._g2p_v2 function
 std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> ChineseMix::g2p(
     const std::string& segment,
-    std::shared_ptr<OpenVinoTokenizer>& tokenizer) {
+    std::shared_ptr<OpenVinoTokenizer>& tokenizer,
+    TokenizedText& tokenized) {
     std::vector<std::string> phones_list{"_"};
     std::vector<int64_t> tones_list{0};
     std::vector<int> word2ph{1};
 
+    // Tokenize the whole sentence once, the same ids are fed to BERT. BERT splits every Chinese character and
+    // punctuation mark into its own word, so the words of tokenized can be walked along with the jieba result.
+    if (tokenized.empty())
+        tokenized = tokenizer->encode(segment);
+    size_t word_index = 0;
+    bool aligned = true;
+    auto take_subwords = [&](const std::string& word) {
+        if (aligned && word_index < tokenized.num_words()) {
+            auto subwords = tokenized.word_tokens(word_index);
+            std::string joined;
+            for (const auto& subword : subwords)
+                joined.append(subword.starts_with("##") ? std::string_view(subword).substr(2) : subword);
+            if (joined == word) {
+                ++word_index;
+                return std::vector<std::string>(subwords.begin(), subwords.end());
+            }
+        }
+        aligned = false;
+        return tokenizer->word_segment(word);
+    };
+
     // Cut sentence into words
     // We assume that the Jieba segmentation result is either pure Chinese or pure English
     std::vector<std::string> words;
@@ -135,8 +164,7 @@ std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> Chi
                 tmp_chinese_segment.clear();
             }
             // process english word
-            // tokenizer->Tokenize(word, tokenized_en, token_ids);
-            std::vector<std::string> tokenized_en = tokenizer->word_segment(word);
+            std::vector<std::string> tokenized_en = take_subwords(word);
 #ifdef MELO_DEBUG
             for (std::cout << "tokenizer_en:<<"; const auto& x : tokenized_en)
                 std::cout << word << ",";
@@ -150,6 +178,7 @@ std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> Chi
             tones_list.insert(tones_list.end(), tones_en.begin(), tones_en.end());
             word2ph.insert(word2ph.end(), word2ph_en.begin(), word2ph_en.end());
         } else {
+            word_index += utf8::length(word);  // one BERT word per character
             tmp_chinese_segment.emplace_back(std::move(word), std::move(tag));
         }
     }
@@ -169,49 +198,19 @@ std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> Chi
 std::unordered_set<char> spaces = {'\n', ' ', '\r', '\t', '\0'};
 std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> ChineseMix::_chinese_g2p(
     std::vector<std::pair<std::string, std::string>>& segments) {
-    auto new_segments = ToneSandhi::pre_merge_for_modify(segments);  // adjust word segmentation
+    tone_sandhi->pre_merge_for_modify(segments);  // adjust word segmentation, in place
     std::vector<std::string> phones_list;
     std::vector<int64_t> tones_list;
     std::vector<int> word2ph;
 
-    for (const auto& [word, tag] : new_segments) {
+    for (const auto& [word, tag] : segments) {
         // An ugly workaround to prevent pinyin from failing to parse.
         if (spaces.contains(word.front()))
             continue;
-        auto [sub_initials, sub_finals] = _get_initials_finals(word);
-        ToneSandhi::modified_tone(word, tag, jieba, sub_finals);
-        int n = sub_initials.size();
-        assert(n == sub_finals.size());
-        std::string pinyin;
-        int tone = 0;
-        // std::vector<std::string> phone;
-        //  iteration word by word in C++23 std::views::zip(initials, finals)
-        for (int i = 0; i < n; ++i) {
-            pinyin.clear();
-            tone = 0;
-            auto c = sub_initials[i];  // 声母 e.g. "w"
-            auto v = sub_finals[i];    // 韵母+声调 "eng2"
-            if (c == v) {              // punctuation
-                word2ph.emplace_back(1);
-                phones_list.emplace_back(c);
-                tones_list.emplace_back(0);
-            } else {
-                tone = v.back() - '0';  // number for 声调
-                v.pop_back();           // 韵母 without tone(声调)
-                pinyin = c + v;
-                assert(tone > 0 && tone <= 5);
-                // 多音节
-                if (v_rep_map.contains(v)) {
-                    pinyin = c + v_rep_map.at(v);
-                }
-                if (!pinyin_to_symbol_map->contains(pinyin))
-                    std::cerr << std::format("_chinese_g2p: {} not in map,{}\n", pinyin, word);
-                const auto& phone = pinyin_to_symbol_map->at(pinyin);
-                word2ph.emplace_back(phone.size());
-                phones_list.insert(phones_list.end(), phone.begin(), phone.end());
-                tones_list.insert(tones_list.end(), phone.size(), tone);
-            }
-        }
+        auto res = _word_g2p(word, tag);
+        phones_list.insert(phones_list.end(), res->phones.begin(), res->phones.end());
+        tones_list.insert(tones_list.end(), res->tones.begin(), res->tones.end());
+        word2ph.insert(word2ph.end(), res->word2ph.begin(), res->word2ph.end());
     }
 #ifdef MELO_DEBUG
     printVec(phones_list, "phones_list");
@@ -220,6 +219,85 @@ std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> Chi
 #endif
     return {phones_list, tones_list, word2ph};
 }
+std::shared_ptr<const ChineseMix::WordPhones> ChineseMix::_word_g2p(const std::string& word, const std::string& tag) {
+    std::string key;
+    key.reserve(word.size() + 2);
+    key.append(word).push_back('\t');
+    if (!tag.empty())
+        key.push_back(tag.front());
+    if (auto cached = g2p_cache.get(key))
+        return *cached;
+
+    auto res = std::make_shared<WordPhones>();
+    auto [sub_initials, sub_finals] = _get_initials_finals(word);
+    tone_sandhi->modified_tone(word, tag, sub_finals);
+    int n = sub_initials.size();
+    assert(n == sub_finals.size());
+    std::string pinyin;
+    int tone = 0;
+    //  iteration word by word in C++23 std::views::zip(initials, finals)
+    for (int i = 0; i < n; ++i) {
+        pinyin.clear();
+        tone = 0;
+        auto& c = sub_initials[i];  // 声母 e.g. "w"
+        auto& v = sub_finals[i];    // 韵母+声调 "eng2"
+        if (c == v) {               // punctuation
+            res->word2ph.emplace_back(1);
+            res->phones.emplace_back(c);
+            res->tones.emplace_back(0);
+        } else {
+            tone = v.back() - '0';  // number for 声调
+            v.pop_back();           // 韵母 without tone(声调)
+            pinyin = c + v;
+            assert(tone > 0 && tone <= 5);
+            // 多音节
+            if (v_rep_map.contains(v)) {
+                pinyin = c + v_rep_map.at(v);
+            }
+            if (!pinyin_to_symbol_map->contains(pinyin))
+                std::cerr << std::format("_chinese_g2p: {} not in map,{}\n", pinyin, word);
+            const auto& phone = pinyin_to_symbol_map->at(pinyin);
+            res->word2ph.emplace_back(phone.size());
+            res->phones.insert(res->phones.end(), phone.begin(), phone.end());
+            res->tones.insert(res->tones.end(), phone.size(), tone);
+        }
+    }
+    g2p_cache.put(key, res);
+    return res;
+}
+void ChineseMix::prewarm_g2p_cache(const std::filesystem::path& jieba_dict_path, size_t top_n) {
+    std::ifstream file(jieba_dict_path);
+    if (!file.is_open()) {
+        std::cerr << "[ERROR] ChineseMix::prewarm_g2p_cache: cannot open " << jieba_dict_path.string() << "\n";
+        return;
+    }
+    // each line of jieba.dict.utf8 is "word freq tag"
+    struct Entry {
+        std::string word, tag;
+        int64_t freq;
+    };
+    std::vector<Entry> entries;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        Entry entry;
+        if (!(iss >> entry.word >> entry.freq >> entry.tag))
+            continue;
+        bool all_chinese = true;
+        utf8::for_each(entry.word, [&](char32_t code_point, size_t, size_t) {
+            all_chinese = all_chinese && utf8::classify(code_point) == utf8::CharClass::Cjk;
+        });
+        if (all_chinese)
+            entries.emplace_back(std::move(entry));
+    }
+    top_n = std::min(top_n, entries.size());
+    std::partial_sort(entries.begin(), entries.begin() + top_n, entries.end(), [](const auto& a, const auto& b) {
+        return a.freq > b.freq;
+    });
+    for (size_t i = 0; i < top_n; ++i)
+        _word_g2p(entries[i].word, entries[i].tag);
+    std::cout << "[INFO] ChineseMix::prewarm_g2p_cache: " << top_n << " words\n";
+}
 std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> ChineseMix::_chinese_g2p(
     const std::string& word,
     const std::string& tag) {
@@ -422,91 +500,38 @@ std::pair<std::vector<std::string>, std::vector<std::string>> ChineseMix::_get_i
     return {initials, finals};
 }
 
-// Convert uppercase to lowercase
+// Normalize the text, then convert uppercase to lowercase and filter in the same pass that encodes back to UTF-8
 std::string ChineseMix::text_normalize(const std::string& text) {
-    std::string norm_text = text_normalization::wstring_to_string(
-        normalizer->normalize_sentence(text_normalization::string_to_wstring(text)));
-    std::for_each(norm_text.begin(), norm_text.end(), [](auto& ch) {
-        if (ch <= 'Z' && ch >= 'A')
-            ch = ch + 'a' - 'A';
-    });
-    norm_text = filter_text(norm_text);
+    std::string norm_text = filter_text(normalizer->normalize_sentence(utf8::to_wstring(text)));
     std::cout << "[INFO] normed test is:" << norm_text << std::endl;
     return norm_text;
 }
 // @brief This functionality cleans up text by retaining only Chinese characters, English letters,
 //  and valid punctuation symbols (including space), while removing all other characters.
-// UTF-8 is a variable-length encoding that uses 1 to 4 bytes to represent a character.
-// It is similar to a Huffman tree in structure. The specific mapping relationship with Unicode is as follows:
-// (Adapted from Reference 1)
-//
-// Unicode Range (Hexadecimal)       UTF-8 Encoding (Binary)
-// ----------------------------------------------------------
-// 0000 0000 ~ 0000 007F             0xxxxxxx
-// 0000 0080 ~ 0000 07FF             110xxxxx 10xxxxxx
-// 0000 0800 ~ 0000 FFFF             1110xxxx 10xxxxxx 10xxxxxx
-// 0001 0000 ~ 0010 FFFF             11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
-//
-// UTF-8 is fully compatible with the original ASCII encoding.
-// The number of leading 1 bits in the first byte indicates the number of bytes the character occupies.
-// Using the table above, Unicode can be converted to UTF-8 encoding by replacing the 'x' placeholders
-// with the binary bits of the Unicode value, in high-to-low order, padding with 0s where necessary.
-//
-// For example, consider the Chinese character "一":
-// - Its Unicode code point is 0x4E00, which in binary is: 100 1110 0000 0000 (15 bits).
-// - Using the UTF-8 encoding pattern for the range 0000 0800 ~ 0000 FFFF:
-//   1110xxxx 10xxxxxx 10xxxxxx
-// - Fill in the binary bits of the Unicode code point:
-//   - First byte: 1110 + 0100 (first 4 bits of the code point) = 11100100
-//   - Second byte: 10 + 111000 (next 6 bits) = 10111000
-//   - Third byte: 10 + 000000 (remaining 6 bits) = 10000000
-// - Final UTF-8 encoding: 11100100 10111000 10000000 (E4 B8 80 in hexadecimal).
-//
-// Ref
-// https://www.freecodecamp.org/chinese/news/what-is-utf-8-character-encoding/
-// https://sf-zhou.github.io/programming/chinese_encoding.html
-std::string ChineseMix::filter_text(const std::string& input) {
+// English letters are lowercased and the result is encoded as UTF-8 in the same pass.
+// It corresponds to the Python code:
+// replaced_text = re.sub(r"[^\u4e00-\u9fa5_a-zA-Z\s" + "".join(punctuation) + r"]+", "", replaced_text)
+std::string ChineseMix::filter_text(std::wstring_view input) {
     std::string output;
-    size_t i = 0;
-    while (i < input.size()) {
-        unsigned char first_byte = input[i];
-        size_t char_len = 0;
-        unsigned int code_point = 0;
-
-        // determine the length of a character (in UTF-8 encoding)
-        if ((first_byte & 0x80) == 0x00) {  // 1-byte sequence: 0xxxxxxx
-            char_len = 1;
-            code_point = first_byte;
-        } else if ((first_byte & 0xE0) == 0xC0) {  // 2-byte sequence: 110xxxxx 10xxxxxx
-            if (i + 1 >= input.size())
-                break;
-            char_len = 2;
-            code_point = (first_byte & 0x1F) << 6;
-            code_point |= (input[i + 1] & 0x3F);
-        } else if ((first_byte & 0xF0) == 0xE0) {  // 3-byte sequence: 1110xxxx 10xxxxxx 10xxxxxx
-            if (i + 2 >= input.size())
-                break;
-            char_len = 3;
-            code_point = (first_byte & 0x0F) << 12;
-            code_point |= (input[i + 1] & 0x3F) << 6;
-            code_point |= (input[i + 2] & 0x3F);
-        } else if ((first_byte & 0xF8) == 0xF0) {  // 4-byte sequence: 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
-            if (i + 3 >= input.size())
-                break;
-            char_len = 4;
-            code_point = (first_byte & 0x07) << 18;
-            code_point |= (input[i + 1] & 0x3F) << 12;
-            code_point |= (input[i + 2] & 0x3F) << 6;
-            code_point |= (input[i + 3] & 0x3F);
-        }
-
-        // Determine if the character is a Simplified Chinese or English character
-        // or if it is a valid punctuation mark or space
-        if (is_chinese_char(code_point) || is_english_char(code_point) || is_valid_punc(code_point) ||
-            char_len == 1 && first_byte == ' ') {
-            output += input.substr(i, char_len);
+    output.reserve(input.size() * 3);
+    for (wchar_t ch : input) {
+        const char32_t code_point = utf8::to_lower_ascii(static_cast<char32_t>(ch));
+        switch (utf8::classify(code_point)) {
+        case utf8::CharClass::Cjk:
+        case utf8::CharClass::Lower:
+            utf8::append(output, code_point);
+            break;
+        case utf8::CharClass::Punct:
+            if (is_valid_punc(static_cast<char>(code_point)))
+                output += static_cast<char>(code_point);
+            break;
+        case utf8::CharClass::Space:
+            if (code_point == ' ')
+                output += ' ';
+            break;
+        default:
+            break;
         }
-        i += char_len;
     }
     return output;
 }
@@ -19,22 +19,27 @@
 #ifndef CHINESE_MIX_H
 #define CHINESE_MIX_H
 #include <memory>
+#include <string_view>
 
 #include "Jieba.hpp"
 #include "cmudict.h"
 #include "cppinyin.h"
 #include "language_module_base.h"
+#include "lru_cache.h"
 #include "openvino_tokenizer.h"
 #include "text_normalization/text_normalization.h"
+#include "tone_sandhi.h"
 
 namespace melo {
 class ChineseMix : public AbstractLanguageModule {
 public:
-    ChineseMix(const std::filesystem::path& data_folder);
+    // g2p_cache_prewarm_words: the number of most frequent jieba dictionary words converted at startup, 0 disables it
+    ChineseMix(const std::filesystem::path& data_folder, size_t g2p_cache_prewarm_words = 0);
     virtual ~ChineseMix() = default;
     virtual std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> g2p(
         const std::string& segment,
-        std::shared_ptr<OpenVinoTokenizer>& tokenizer) override;
+        std::shared_ptr<OpenVinoTokenizer>& tokenizer,
+        TokenizedText& tokenized) override;
     virtual inline int64_t symbol_to_id(const std::string& symbol) override {
         return symbol_to_id_mp.at(symbol);
     }
@@ -51,6 +56,18 @@ private:
         const std::string& tag);
     std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> _chinese_g2p(
         std::vector<std::pair<std::string, std::string>>& segment);
+
+    // phones/tones/word2ph of a single Chinese word after tone sandhi
+    struct WordPhones {
+        std::vector<std::string> phones;
+        std::vector<int64_t> tones;
+        std::vector<int> word2ph;
+    };
+    // Memoized per-word G2P. The result only depends on the word itself and the first letter of its POS tag (the
+    // only part of the tag read by tone sandhi), so both form the cache key.
+    std::shared_ptr<const WordPhones> _word_g2p(const std::string& word, const std::string& tag);
+    // Fill the G2P cache with the top_n most frequent pure Chinese words of the jieba dictionary
+    void prewarm_g2p_cache(const std::filesystem::path& jieba_dict_path, size_t top_n);
     std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> g2p_en(
         const std::string& word,
         std::vector<std::string>& tokenized);
@@ -82,24 +99,13 @@ private:
         }
         return true;
     }
-    /**
-     * The following functions correspond to the Python code:
-     * replaced_text = re.sub(r"[^\u4e00-\u9fa5_a-zA-Z\s" + "".join(punctuation) + r"]+", "", replaced_text)
-     */
-    inline bool is_english_char(unsigned int code_point) {
-        return (code_point >= 0x41 && code_point <= 0x5A) || (code_point >= 0x61 && code_point <= 0x7A);
-    }
-    inline bool is_chinese_char(unsigned int code_point) {
-        // Unicode in \u4e00 - \u9fa5）
-        return (code_point >= 0x4E00 && code_point <= 0x9FA5);
-    }
-
-    std::string filter_text(const std::string& text);
+    std::string filter_text(std::wstring_view text);
 
     const std::unordered_set<char> simple_initials = {'b', 'p', 'm', 'f', 'd', 't', 'n', 'l', 'g', 'k',
                                                       'h', 'j', 'q', 'x', 'r', 'z', 'c', 's', 'y', 'w'};
     const std::unordered_set<std::string> compound_initials = {"zh", "ch", "sh"};
     static constexpr int64_t language_tone_start_map_for_en = 7;  // language_tone_start_map['EN'] in python version
+    static constexpr size_t G2P_CACHE_CAPACITY = 1 << 15;
 
     const std::unordered_set<char> punctuations =
         {',', '.', '!', '?', ';', '-', '\''};  // After filtering, only these punctuation marks are accepted.
@@ -109,9 +115,11 @@ private:
     }
     std::shared_ptr<CMUDict> cmudict;
     std::shared_ptr<cppjieba::Jieba> jieba;
+    std::unique_ptr<ToneSandhi::SandhiEngine> tone_sandhi;
     std::shared_ptr<cppinyin::PinyinEncoder> pinyin;
     std::shared_ptr<std::unordered_map<std::string, std::vector<std::string>>> pinyin_to_symbol_map;
     std::shared_ptr<text_normalization::TextNormalizer> normalizer;  // speical test normalizer for chinese
+    ShardedLruCache<std::string, std::shared_ptr<const WordPhones>> g2p_cache{G2P_CACHE_CAPACITY};
 
     const std::unordered_map<std::string, int64_t> symbol_to_id_mp = {
         {"_", 0},   {"AA", 1},  {"E", 2},    {"EE", 3},    {"En", 4},   {"N", 5},     {"OO", 6},   {"V", 7},
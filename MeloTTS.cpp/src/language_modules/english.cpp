@@ -51,20 +51,22 @@ English::English(std::unique_ptr<ov::Core>& core_ptr, const std::filesystem::pat
 
 std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> English::g2p(
     const std::string& sentence,
-    std::shared_ptr<OpenVinoTokenizer>& tokenizer) {
+    std::shared_ptr<OpenVinoTokenizer>& tokenizer,
+    TokenizedText& tokenized) {
     std::vector<std::string> phones_list{"_"};
     std::vector<int64_t> tones_list{0};
     std::vector<int> word2ph{1};
 
-    std::vector<std::string> tokenized = tokenizer->word_segment(sentence);
+    if (tokenized.empty())
+        tokenized = tokenizer->encode(sentence);
 #ifdef MELO_DEBUG
-    for (std::cout << "Enligsh::English tokenizer_en"; const auto& x : tokenized)
+    for (std::cout << "Enligsh::English tokenizer_en"; const auto& x : tokenized.subwords())
         std::cout << x << ",";
     std::cout << std::endl;
 #endif
     std::vector<std::vector<std::string>> ph_groups;
     // remove ## in suffix
-    for (auto& token : tokenized) {
+    for (const auto& token : tokenized.subwords()) {
         if (token.front() == '#') {
             if (!ph_groups.size()) {
                 std::cerr << "[ERROR] English::g2p: Suffix should has Prefix\n";
@@ -96,7 +98,11 @@ std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> Eng
             phones_list.insert(phones_list.end(), phones.begin(), phones.end());
             tones_list.insert(tones_list.end(), tones.begin(), tones.end());
         } else {
-            auto syllables_ = bart_g2p->forward(w);
+            std::vector<std::string> syllables_;
+            {
+                std::lock_guard<std::mutex> lock(_bart_mutex);
+                syllables_ = bart_g2p->forward(w);
+            }
             if (syllables_.empty())
                 continue;
             auto [phones, tones] = refine_syllables(syllables_);
@@ -143,14 +149,9 @@ std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> Eng
 }
 
 std::string English::text_normalize(const std::string& text) {
-    std::string norm_text = text;
-    std::for_each(norm_text.begin(), norm_text.end(), [](auto& ch) {
-        if (ch <= 'Z' && ch >= 'A')
-            ch = ch + 'a' - 'A';
-    });
-    norm_text = text_normalization::expand_time_english(norm_text);
-    norm_text = text_normalization::expand_abbreviations(norm_text);
-    norm_text = text_normalization::normalize_numbers(norm_text);
+    // lowercase, time, abbreviations and numbers in one pass
+    std::string norm_text;
+    text_normalization::normalize_english(text, norm_text);
     return norm_text;
 }
 
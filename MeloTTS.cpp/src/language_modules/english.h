@@ -17,6 +17,8 @@
  */
 #ifndef ENGLISH_H
 #define ENGLISH_H
+#include <mutex>
+
 #include "cmudict.h"
 #include "language_module_base.h"
 #include "mini-bart-g2p/mini-bart-g2p.h"
@@ -28,7 +30,8 @@ public:
     // Grapheme to Phoneme conversion
     virtual std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> g2p(
         const std::string& segment,
-        std::shared_ptr<OpenVinoTokenizer>& tokenizer) override;
+        std::shared_ptr<OpenVinoTokenizer>& tokenizer,
+        TokenizedText& tokenized) override;
     virtual std::string text_normalize(const std::string& text) override;
     virtual inline int64_t symbol_to_id(const std::string& symbol) override {
         return symbol_to_id_mp.at(symbol);
@@ -40,6 +43,7 @@ public:
 private:
     std::shared_ptr<CMUDict> cmudict;
     std::shared_ptr<MiniBartG2P> bart_g2p;
+    std::mutex _bart_mutex;  // g2p runs on several threads, bart_g2p has one infer request for the words not in cmudict
     const std::unordered_map<std::string, int> symbol_to_id_mp = {
         {"_", 0},     {"\"", 1},    {"(", 2},     {")", 3},    {"*", 4},    {"/", 5},    {":", 6},     {"AA", 7},
         {"E", 8},     {"EE", 9},    {"En", 10},   {"N", 11},   {"OO", 12},  {"Q", 13},   {"V", 14},    {"[", 15},
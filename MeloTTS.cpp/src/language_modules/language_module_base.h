@@ -28,9 +28,12 @@ class AbstractLanguageModule {
 public:
     virtual ~AbstractLanguageModule() = default;
     // Grapheme to Phoneme conversion
+    // tokenized receives the BERT tokenization of segment, word2ph holds one entry per token of it. A tokenization of
+    // segment passed in is used as is, e.g. when BERT already runs on it.
     virtual std::tuple<std::vector<std::string>, std::vector<int64_t>, std::vector<int>> g2p(
         const std::string& segment,
-        std::shared_ptr<OpenVinoTokenizer>& tokenizer) = 0;
+        std::shared_ptr<OpenVinoTokenizer>& tokenizer,
+        TokenizedText& tokenized) = 0;
     virtual std::string text_normalize(const std::string& text) = 0;
     virtual inline int64_t symbol_to_id(const std::string& symbol) = 0;
     virtual inline std::string get_language_name() = 0;
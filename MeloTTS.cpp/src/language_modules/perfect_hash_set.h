@@ -0,0 +1,149 @@
+/**
+ * Copyright      2024    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef PERFECT_HASH_SET_H
+#define PERFECT_HASH_SET_H
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace melo {
+/**
+ * @brief An immutable set of strings with a perfect hash built at compile time (hash and displace).
+ * Every key is hashed once to pick a bucket; the bucket stores either the slot of its single key or the seed that
+ * scatters its keys into free slots without collision. A lookup is therefore two hashes and one string compare, no
+ * probing and no allocation.
+ *
+ * e.g.
+ *  static constexpr auto words = make_perfect_hash_set({"男子", "女子"});
+ *  words.contains("男子");
+ */
+template <size_t N>
+class PerfectHashSet {
+public:
+    static constexpr size_t TABLE_SIZE = std::bit_ceil(N == 0 ? size_t(1) : N);
+
+    consteval explicit PerfectHashSet(const std::array<std::string_view, N>& keys) {
+        constexpr uint64_t MASK = TABLE_SIZE - 1;
+        // group the keys by bucket (counting sort)
+        std::array<size_t, TABLE_SIZE + 1> bucket_begin{};
+        std::array<size_t, N> bucket_of{};
+        for (size_t i = 0; i < N; ++i) {
+            bucket_of[i] = hash(keys[i], BUCKET_SEED) & MASK;
+            ++bucket_begin[bucket_of[i] + 1];
+        }
+        size_t max_bucket_size = 0;
+        for (size_t b = 0; b < TABLE_SIZE; ++b) {
+            max_bucket_size = std::max(max_bucket_size, bucket_begin[b + 1]);
+            bucket_begin[b + 1] += bucket_begin[b];
+        }
+        std::array<size_t, N> order{};
+        std::array<size_t, TABLE_SIZE> fill{};
+        for (size_t i = 0; i < N; ++i)
+            order[bucket_begin[bucket_of[i]] + fill[bucket_of[i]]++] = i;
+
+        std::array<bool, TABLE_SIZE> used{};
+        size_t next_free = 0;
+        // the largest buckets are placed first while the table is still empty
+        for (size_t size = max_bucket_size; size > 0; --size) {
+            for (size_t b = 0; b < TABLE_SIZE; ++b) {
+                if (bucket_begin[b + 1] - bucket_begin[b] != size)
+                    continue;
+                const size_t* members = order.data() + bucket_begin[b];
+                if (size == 1) {
+                    while (used[next_free])
+                        ++next_free;
+                    used[next_free] = true;
+                    _slots[next_free] = keys[members[0]];
+                    _occupied[next_free] = true;
+                    _displacement[b] = -static_cast<int32_t>(next_free) - 1;
+                    continue;
+                }
+                for (size_t i = 0; i < size; ++i) {
+                    for (size_t j = i + 1; j < size; ++j) {
+                        if (keys[members[i]] == keys[members[j]])
+                            throw std::invalid_argument("PerfectHashSet: duplicate key");
+                    }
+                }
+                int32_t seed = 1;
+                std::array<size_t, TABLE_SIZE> candidate{};
+                for (;; ++seed) {
+                    bool ok = true;
+                    for (size_t i = 0; i < size && ok; ++i) {
+                        candidate[i] = hash(keys[members[i]], static_cast<uint64_t>(seed)) & MASK;
+                        ok = !used[candidate[i]];
+                        for (size_t j = 0; j < i && ok; ++j)
+                            ok = candidate[j] != candidate[i];
+                    }
+                    if (ok)
+                        break;
+                }
+                for (size_t i = 0; i < size; ++i) {
+                    used[candidate[i]] = true;
+                    _slots[candidate[i]] = keys[members[i]];
+                    _occupied[candidate[i]] = true;
+                }
+                _displacement[b] = seed;
+            }
+        }
+    }
+
+    constexpr bool contains(std::string_view key) const {
+        constexpr uint64_t MASK = TABLE_SIZE - 1;
+        const int32_t d = _displacement[hash(key, BUCKET_SEED) & MASK];
+        const size_t slot = d < 0 ? static_cast<size_t>(-d - 1) : hash(key, static_cast<uint64_t>(d)) & MASK;
+        return _occupied[slot] && _slots[slot] == key;
+    }
+    static constexpr size_t size() {
+        return N;
+    }
+
+private:
+    static constexpr uint64_t BUCKET_SEED = 0;
+    // FNV-1a with a seed, followed by the splitmix64 finalizer so that different seeds give independent hashes
+    static constexpr uint64_t hash(std::string_view key, uint64_t seed) {
+        uint64_t h = 0xcbf29ce484222325ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+        for (char ch : key) {
+            h ^= static_cast<uint8_t>(ch);
+            h *= 0x100000001b3ULL;
+        }
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h;
+    }
+
+    std::array<std::string_view, TABLE_SIZE> _slots{};
+    std::array<bool, TABLE_SIZE> _occupied{};
+    std::array<int32_t, TABLE_SIZE> _displacement{};
+};
+
+template <size_t N>
+consteval PerfectHashSet<N> make_perfect_hash_set(const std::string_view (&keys)[N]) {
+    std::array<std::string_view, N> arr{};
+    for (size_t i = 0; i < N; ++i)
+        arr[i] = keys[i];
+    return PerfectHashSet<N>(arr);
+}
+}  // namespace melo
+#endif  // PERFECT_HASH_SET_H
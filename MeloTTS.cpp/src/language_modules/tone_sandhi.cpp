@@ -19,31 +19,99 @@
 
 #include <algorithm>
 
-#include "utils.h"
+#include "perfect_hash_set.h"
+#include "utf8_utils.h"
 
 namespace melo {
 namespace ToneSandhi {
-const std::unordered_set<char> punctuations = {
-    ',',
-    '.',
-    '!',
-    '?',
-    ';',
-    '-',
-    '\''};  // After filtering, only these punctuation marks are accepted. same as in chinese_ix
+namespace {
+// After filtering, only these punctuation marks are accepted. same as in chinese_mix
+inline bool is_punctuation(char ch) {
+    return std::string_view(",.!?;-'").find(ch) != std::string_view::npos;
+}
+// the last/first two characters of a word as one view, the characters are views into the same word
+inline std::string_view join_adjacent(std::string_view first, std::string_view second) {
+    return std::string_view(first.data(), first.size() + second.size());
+}
+
+constexpr auto numeric =
+    make_perfect_hash_set({"零", "一", "二", "三", "四", "五", "六", "七", "八", "九", "十", "百", "千", "万", "亿", "兆"});
+constexpr auto must_not_neural_tone_words = make_perfect_hash_set(
+    {"男子", "女子", "分子", "原子", "量子", "莲子", "石子", "瓜子", "电子", "人人", "虎虎"});
+constexpr auto must_neural_tone_words = make_perfect_hash_set({
+    "麻烦", "麻利", "鸳鸯", "高粱", "骨头", "骆驼", "马虎", "首饰", "馒头", "馄饨", "风筝", "难为", "队伍", "阔气",
+    "闺女", "门道", "锄头", "铺盖", "铃铛", "铁匠", "钥匙", "里脊", "里头", "部分", "那么", "道士", "造化", "迷糊",
+    "连累", "这么", "这个", "运气", "过去", "软和", "转悠", "踏实", "跳蚤", "跟头", "趔趄", "财主", "豆腐", "讲究",
+    "记性", "记号", "认识", "规矩", "见识", "裁缝", "补丁", "衣裳", "衣服", "衙门", "街坊", "行李", "行当", "蛤蟆",
+    "蘑菇", "薄荷", "葫芦", "葡萄", "萝卜", "荸荠", "苗条", "苗头", "苍蝇", "芝麻", "舒服", "舒坦", "舌头", "自在",
+    "膏药", "脾气", "脑袋", "脊梁", "能耐", "胳膊", "胭脂", "胡萝", "胡琴", "胡同", "聪明", "耽误", "耽搁", "耷拉",
+    "耳朵", "老爷", "老实", "老婆", "老头", "老太", "翻腾", "罗嗦", "罐头", "编辑", "结实", "红火", "累赘", "糨糊",
+    "糊涂", "精神", "粮食", "簸箕", "篱笆", "算计", "算盘", "答应", "笤帚", "笑语", "笑话", "窟窿", "窝囊", "窗户",
+    "稳当", "稀罕", "称呼", "秧歌", "秀气", "秀才", "福气", "祖宗", "砚台", "码头", "石榴", "石头", "石匠", "知识",
+    "眼睛", "眯缝", "眨巴", "眉毛", "相声", "盘算", "白净", "痢疾", "痛快", "疟疾", "疙瘩", "疏忽", "畜生", "生意",
+    "甘蔗", "琵琶", "琢磨", "琉璃", "玻璃", "玫瑰", "玄乎", "狐狸", "状元", "特务", "牲口", "牙碜", "牌楼", "爽快",
+    "爱人", "热闹", "烧饼", "烟筒", "烂糊", "点心", "炊帚", "灯笼", "火候", "漂亮", "滑溜", "溜达", "温和", "清楚",
+    "消息", "浪头", "活泼", "比方", "正经", "欺负", "模糊", "槟榔", "棺材", "棒槌", "棉花", "核桃", "栅栏", "柴火",
+    "架势", "枕头", "枇杷", "机灵", "本事", "木头", "木匠", "朋友", "月饼", "月亮", "暖和", "明白", "时候", "新鲜",
+    "故事", "收拾", "收成", "提防", "挖苦", "挑剔", "指甲", "指头", "拾掇", "拳头", "拨弄", "招牌", "招呼", "抬举",
+    "护士", "折腾", "扫帚", "打量", "打算", "打点", "打扮", "打听", "打发", "扎实", "扁担", "戒指", "懒得", "意识",
+    "意思", "情形", "悟性", "怪物", "思量", "怎么", "念头", "念叨", "快活", "忙活", "志气", "心思", "得罪", "张罗",
+    "弟兄", "开通", "应酬", "庄稼", "干事", "帮手", "帐篷", "希罕", "师父", "师傅", "巴结", "巴掌", "差事", "工夫",
+    "岁数", "屁股", "尾巴", "少爷", "小气", "小伙", "将就", "对头", "对付", "寡妇", "家伙", "客气", "实在", "官司",
+    "学问", "学生", "字号", "嫁妆", "媳妇", "媒人", "婆家", "娘家", "委屈", "姑娘", "姐夫", "妯娌", "妥当", "妖精",
+    "奴才", "女婿", "头发", "太阳", "大爷", "大方", "大意", "大夫", "多少", "多么", "外甥", "壮实", "地道", "地方",
+    "在乎", "困难", "嘴巴", "嘱咐", "嘟囔", "嘀咕", "喜欢", "喇嘛", "喇叭", "商量", "唾沫", "哑巴", "哈欠", "哆嗦",
+    "咳嗽", "和尚", "告诉", "告示", "含糊", "吓唬", "后头", "名字", "名堂", "合同", "吆喝", "叫唤", "口袋", "厚道",
+    "厉害", "千斤", "包袱", "包涵", "匀称", "勤快", "动静", "动弹", "功夫", "力气", "前头", "刺猬", "刺激", "别扭",
+    "利落", "利索", "利害", "分析", "出息", "凑合", "凉快", "冷战", "冤枉", "冒失", "养活", "关系", "先生", "兄弟",
+    "便宜", "使唤", "佩服", "作坊", "体面", "位置", "似的", "伙计", "休息", "什么", "人家", "亲戚", "亲家", "交情",
+    "云彩", "事情", "买卖", "主意", "丫头", "丧气", "两口", "东西", "东家", "世故", "不由", "不在", "下水", "下巴",
+    "上头", "上司", "丈夫", "丈人", "一辈", "那个", "菩萨", "父亲", "母亲", "咕噜", "邋遢", "费用", "冤家", "甜头",
+    "介绍", "荒唐", "大人", "泥鳅", "幸福", "熟悉", "计划", "扑腾", "蜡烛", "姥爷", "照顾", "喉咙", "吉他", "弄堂",
+    "蚂蚱", "凤凰", "拖沓", "寒碜", "糟蹋", "倒腾", "报复", "逻辑", "盘缠", "喽啰", "牢骚", "咖喱", "扫把", "惦记",
+});
+constexpr auto neural_char_set = make_perfect_hash_set({"吧", "呢", "啊", "呐", "噻", "嘛", "吖", "嗨", "哦", "哒",
+                                                        "额", "滴", "哩", "哟", "喽", "啰", "耶", "喔", "诶", "的",
+                                                        "地", "得"});
+constexpr auto st1 = make_perfect_hash_set({"上", "下", "进", "出", "回", "过", "起", "开"});
+constexpr auto st2 = make_perfect_hash_set({"几", "有", "两", "半", "多", "各", "整", "每", "做", "是"});
+}  // namespace
+
+bool is_numeric(std::string_view chinese_character) {
+    return numeric.contains(chinese_character);
+}
+
+SandhiEngine::SandhiEngine(std::shared_ptr<cppjieba::Jieba> jieba) : _jieba(std::move(jieba)) {}
 
-std::vector<std::pair<std::string, std::string>> pre_merge_for_modify(
-    std::vector<std::pair<std::string, std::string>>& seg) {
-    auto seg1 = _merge_yi(seg);
-    return _merge_chinese_patterns(seg1);
+void SandhiEngine::pre_merge_for_modify(std::vector<Segment>& seg) const {
+    seg.resize(_merge_yi(seg));
+    seg.resize(_merge_chinese_patterns(seg));
 }
+
+size_t SandhiEngine::split_word(const std::string& word) const {
+    if (auto cached = _split_cache.get(word))
+        return *cached;
+    std::vector<cppjieba::Word> words;
+    _jieba->CutForSearch(word, words);
+    size_t slices = 0;
+    if (!words.empty()) {
+        const cppjieba::Word& wordForSearch = words[0];
+        if (wordForSearch.unicode_offset == 0) {
+            if (wordForSearch.unicode_length != word.size())
+                slices = wordForSearch.unicode_length;
+        } else {
+            slices = wordForSearch.unicode_offset;
+        }
+    }
+    _split_cache.put(word, static_cast<uint32_t>(slices));
+    return slices;
+}
+
 /**
  * @brief This function combines the logic of three Python functions:
  * _merge_bu, _merge_er, and _merge_reduplication.
  */
-std::vector<std::pair<std::string, std::string>> _merge_chinese_patterns(
-    std::vector<std::pair<std::string, std::string>>& seg) {
-    std::vector<std::pair<std::string, std::string>> new_seg;
+size_t _merge_chinese_patterns(std::span<Segment> seg) {
 #ifdef MELO_DEBUG
     std::cout << "origin seg\n";
     for (const auto& [word, _] : seg) {
@@ -51,27 +119,30 @@ std::vector<std::pair<std::string, std::string>> _merge_chinese_patterns(
     }
     std::cout << std::endl;
 #endif
-
-    for (auto& [word, pos] : seg) {
+    size_t n = 0;  // seg[0, n) is the merged result
+    for (size_t i = 0; i < seg.size(); ++i) {
+        auto& [word, pos] = seg[i];
         //_merge_reduplication and _merge_bu
         // Here, two consecutive punctuation marks are prevented from being combined within the same word segmentation.
-        if (new_seg.size() &&
-            (word == new_seg.back().first && !punctuations.contains(word.front()) || new_seg.back().first == "不"))
-            new_seg.back().first += word;
-        else if (new_seg.size() && word == "儿")  //_merge_er
-            new_seg.back().first += "儿";
-        else
-            new_seg.emplace_back(std::move(word), std::move(pos));
+        if (n && (word == seg[n - 1].first && !is_punctuation(word.front()) || seg[n - 1].first == "不")) {
+            seg[n - 1].first += word;
+        } else if (n && word == "儿") {  //_merge_er
+            seg[n - 1].first += "儿";
+        } else {
+            if (n != i)
+                seg[n] = {std::move(word), std::move(pos)};
+            ++n;
+        }
     }
-    if (new_seg.size() && new_seg.back().first == "不")
-        new_seg.back().second = "d";
+    if (n && seg[n - 1].first == "不")
+        seg[n - 1].second = "d";
 #ifdef MELO_DEBUG
     std::cout << "_merge_chinese_patterns:";
-    for (const auto& [word, _] : new_seg)
+    for (const auto& [word, _] : seg.first(n))
         std::cout << word << '|';
     std::cout << std::endl;
 #endif
-    return new_seg;
+    return n;
 }
 // merge "不" and the word behind it
 // if don't merge, "不" sometimes appears alone according to jieba, which may occur sandhi error
@@ -95,32 +166,41 @@ std::vector<std::pair<std::string, std::string>> _merge_chinese_patterns(
   e.g.
 input seg : [('听', 'v'), ('一', 'm'), ('听', 'v')]
 output seg : [['听一听', 'v']]*/
-std::vector<std::pair<std::string, std::string>> _merge_yi(std::vector<std::pair<std::string, std::string>>& seg) {
-    std::vector<std::pair<std::string, std::string>> new_seg;
-    int n = seg.size();
+size_t _merge_yi(std::span<Segment> seg) {
+    const size_t total = seg.size();
+    size_t n = 0;  // seg[0, n) is the merged result
+    // whether seg[i] is the "一" between two identical verbs, decided before seg[i - 1] may be moved
+    auto is_reduplicated_yi = [&](size_t i) {
+        return i >= 1 && i + 1 < total && seg[i].first == "一" && seg[i - 1].first == seg[i + 1].first &&
+               seg[i - 1].second == "v";
+    };
+    bool reduplicated_yi = false;
     // function 1 and function2
-    bool if_continue = false;  // skip second "听", of "听一听"
-    for (int i = 0; i < n; ++i) {
-        if (if_continue) {
-            if_continue = false;
+    for (size_t i = 0; i < total; ++i) {
+        const bool next_reduplicated_yi = i + 1 < total && is_reduplicated_yi(i + 1);
+        auto& [word, pos] = seg[i];
+        if (reduplicated_yi) {
+            seg[n - 1].first += "一";
+            seg[n - 1].first += seg[i + 1].first;
+            ++i;  // skip second "听", of "听一听"
+            reduplicated_yi = i + 1 < total && is_reduplicated_yi(i + 1);
             continue;
+        } else if (n && seg[n - 1].first == "一") {
+            seg[n - 1].first += word;
+        } else {
+            if (n != i)
+                seg[n] = {std::move(word), std::move(pos)};
+            ++n;
         }
-        auto& [word, pos] = seg[i];
-        if (i >= 1 && word == "一" && i + 1 < n && seg[i - 1].first == seg[i + 1].first && seg[i - 1].second == "v") {
-            new_seg.back().first += "一" + seg[i + 1].first;
-            if_continue = true;
-        } else if (new_seg.size() && new_seg.back().first == "一") {
-            new_seg.back().first += word;
-        } else
-            new_seg.emplace_back(word, pos);
+        reduplicated_yi = next_reduplicated_yi;
     }
 #ifdef MELO_DEBUG
     std::cout << "_merge_yi:";
-    for (const auto& [word, _] : new_seg)
+    for (const auto& [word, _] : seg.first(n))
         std::cout << word << ' ';
     std::cout << std::endl;
 #endif
-    return new_seg;
+    return n;
 }
 
 // std::vector<std::pair<std::string, std::string>> _merge_er(std::vector<std::pair<std::string, std::string>>& seg) {
@@ -154,18 +234,20 @@ std::vector<std::pair<std::string, std::string>> _merge_yi(std::vector<std::pair
  * @param tag The part of speech associated with the input word, which influences the tone modification.
  * @param sub_finals: 韵母
  */
-void modified_tone(const std::string& word,
-                   const std::string& tag,
-                   const std::shared_ptr<cppjieba::Jieba>& jieba,
-                   std::vector<std::string>& sub_finals) {
+void SandhiEngine::modified_tone(const std::string& word,
+                                 const std::string& tag,
+                                 std::vector<std::string>& sub_finals) const {
     // 此处需要 汉语分字 假设这里进入的是utf-8纯汉字无标点
-    std::vector<std::string> chinese_characters = split_utf8_chinese(word);
+    const std::vector<std::string_view> chinese_characters = utf8::split_chars(word);
+    if (chinese_characters.empty())
+        return;
+    const size_t slices = chinese_characters.size() >= 2 ? split_word(word) : 0;
     _bu_sandhi(chinese_characters, sub_finals);
     _yi_sandhi(chinese_characters, sub_finals);
-    _neural_sandhi(word, chinese_characters, tag, jieba, sub_finals);
-    _three_sandhi(word, chinese_characters, jieba, sub_finals);
+    _neural_sandhi(word, chinese_characters, tag, slices, sub_finals);
+    _three_sandhi(chinese_characters, slices, sub_finals);
 }
-void _bu_sandhi(const std::vector<std::string>& chinese_characters, std::vector<std::string>& sub_finals) {
+void _bu_sandhi(std::span<const std::string_view> chinese_characters, std::vector<std::string>& sub_finals) {
     if (chinese_characters.size() == 3 && chinese_characters[1] == "不") {
         sub_finals[1].back() = '5';
         return;
@@ -177,7 +259,7 @@ void _bu_sandhi(const std::vector<std::string>& chinese_characters, std::vector<
         }
     }
 }
-void _yi_sandhi(const std::vector<std::string>& chinese_characters, std::vector<std::string>& sub_finals) {
+void _yi_sandhi(std::span<const std::string_view> chinese_characters, std::vector<std::string>& sub_finals) {
     if (is_numeric(chinese_characters)) {
         return;
     }
@@ -186,7 +268,7 @@ void _yi_sandhi(const std::vector<std::string>& chinese_characters, std::vector<
         sub_finals[1].back() = '5';
         return;
     }
-    if (chinese_characters[0] == "第" && chinese_characters[1] == "一")  // word.startswith("第一"):
+    if (chinese_characters.size() >= 2 && chinese_characters[0] == "第" && chinese_characters[1] == "一")  // word.startswith("第一"):
         return;
 
     for (size_t i = 0; i < chinese_characters.size(); i++) {
@@ -200,32 +282,24 @@ void _yi_sandhi(const std::vector<std::string>& chinese_characters, std::vector<
         }
     }
 }
-void _neural_sandhi(const std::string& word,
-                    const std::vector<std::string>& chinese_characters,
+void _neural_sandhi(std::string_view word,
+                    std::span<const std::string_view> chinese_characters,
                     const std::string& pos,
-                    const std::shared_ptr<cppjieba::Jieba>& jieba,
+                    size_t slices,
                     std::vector<std::string>& sub_finals) {
     int n = chinese_characters.size();
     if (n < 2 || must_not_neural_tone_words.contains(word))
         return;
 
-    std::string temp = chinese_characters[n - 2] + chinese_characters.back();
-
-    if (must_neural_tone_words.contains(temp)) {
+    if (must_neural_tone_words.contains(join_adjacent(chinese_characters[n - 2], chinese_characters.back()))) {
         sub_finals.back().back() = '5';
     }
     for (size_t i = 1; i < n; i++) {
-        auto& c = chinese_characters[i];
         if (chinese_characters[i] == chinese_characters[i - 1] && (pos[0] == 'n' || pos[0] == 'v' || pos[0] == 'a')) {
             sub_finals[i].back() = '5';
         }
     }
-    const static std::unordered_set<std::string> nenuralCharSet = {"吧", "呢", "啊", "呐", "噻", "嘛", "吖", "嗨",
-                                                                   "呐", "哦", "哒", "额", "滴", "哩", "哟", "喽",
-                                                                   "啰", "耶", "喔", "诶", "的", "地", "得"};
-    static const std::unordered_set<std::string> st1 = {"上", "下", "进", "出", "回", "过", "起", "开"};
-    static const std::unordered_set<std::string> st2 = {"几", "有", "两", "半", "多", "各", "整", "每", "做", "是"};
-    if (nenuralCharSet.contains(chinese_characters.back())) {
+    if (neural_char_set.contains(chinese_characters.back())) {
         sub_finals.back().back() = '5';
     } else if ((chinese_characters.back() == "们" || chinese_characters.back() == "字") &&
                (pos[0] == 'n' || pos[0] == 'r')) {
@@ -244,10 +318,8 @@ void _neural_sandhi(const std::string& word,
         (is_numeric(*(it - 1)) || st2.contains(*(it - 1)))) {
         sub_finals[it - chinese_characters.begin()].back() = '5';
     }
-    auto slices = _split_word(word, jieba);
     if (slices == 2) {
-        auto temp = chinese_characters.front() + chinese_characters[1];
-        if (must_neural_tone_words.contains(temp)) {
+        if (must_neural_tone_words.contains(join_adjacent(chinese_characters[0], chinese_characters[1]))) {
             sub_finals[slices - 1].back() = '5';
         }
     }
@@ -257,16 +329,14 @@ auto _all_tone_three = [](const std::vector<std::string>& finals) {
         return f.back() == '3';
     });
 };
-void _three_sandhi(const std::string& word,
-                   const std::vector<std::string>& chinese_characters,
-                   const std::shared_ptr<cppjieba::Jieba>& jieba,
+void _three_sandhi(std::span<const std::string_view> chinese_characters,
+                   size_t slices,
                    std::vector<std::string>& sub_finals) {
     if (chinese_characters.size() == 2 && sub_finals[0].back() == '3' && sub_finals[1].back() == '3') {
         sub_finals[0].back() = '2';
         return;
     }
     if (chinese_characters.size() == 3) {
-        size_t slices = _split_word(word, jieba);
         if (_all_tone_three(sub_finals)) {
             if (slices == 2) {
                 sub_finals[0].back() = sub_finals[1].back() = '2';
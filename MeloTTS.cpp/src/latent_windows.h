@@ -0,0 +1,56 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef LATENT_WINDOWS_H
+#define LATENT_WINDOWS_H
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace melo {
+/**
+ * @brief A window of the latent frames of a sentence that the vocoder decodes on its own, so that the audio can be
+ * handed on a chunk at a time. The decoder is convolutional: with enough context on either side, the audio of the kept
+ * frames matches the audio of decoding the whole sentence at once, and the audio of the context is dropped.
+ */
+struct LatentWindow {
+    size_t first = 0;   // first frame fed to the decoder
+    size_t width = 0;   // frames fed to the decoder
+    size_t offset = 0;  // frames of context before the kept ones
+    size_t kept = 0;    // frames whose audio is kept
+    bool last = false;
+};
+
+// chunk_frames kept frames per window, the last one may have fewer; 0 decodes the sentence in one window
+inline std::vector<LatentWindow> latent_windows(size_t frames, size_t chunk_frames, size_t context_frames) {
+    std::vector<LatentWindow> windows;
+    if (chunk_frames == 0)
+        chunk_frames = std::max<size_t>(frames, 1);
+    for (size_t begin = 0; begin < frames; begin += chunk_frames) {
+        const size_t end = std::min(frames, begin + chunk_frames);
+        const size_t left = std::min(begin, context_frames), right = std::min(frames - end, context_frames);
+        windows.push_back({.first = begin - left,
+                           .width = left + (end - begin) + right,
+                           .offset = left,
+                           .kept = end - begin,
+                           .last = end == frames});
+    }
+    return windows;
+}
+}  // namespace melo
+#endif  // LATENT_WINDOWS_H
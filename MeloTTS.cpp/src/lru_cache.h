@@ -0,0 +1,116 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace melo {
+/**
+ * @brief A bounded, thread-safe LRU cache.
+ * Keys are spread over independently locked shards so that concurrent lookups rarely contend; each shard evicts its
+ * least recently used entry once it holds capacity / num_shards entries.
+ * Values are returned by copy, so store something cheap to copy such as std::shared_ptr<const T>.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedLruCache {
+public:
+    explicit ShardedLruCache(size_t capacity, size_t num_shards = 16)
+        : _shards(std::max<size_t>(num_shards, 1)),
+          _shard_capacity(std::max<size_t>(capacity / std::max<size_t>(num_shards, 1), 1)) {}
+    ShardedLruCache(const ShardedLruCache&) = delete;
+    ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+    std::optional<Value> get(const Key& key) {
+        Shard& shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto iter = shard.index.find(key);
+        if (iter == shard.index.end()) {
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        // move to the front (most recently used)
+        shard.entries.splice(shard.entries.begin(), shard.entries, iter->second);
+        _hits.fetch_add(1, std::memory_order_relaxed);
+        return iter->second->second;
+    }
+
+    void put(const Key& key, Value value) {
+        Shard& shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto iter = shard.index.find(key);
+        if (iter != shard.index.end()) {
+            iter->second->second = std::move(value);
+            shard.entries.splice(shard.entries.begin(), shard.entries, iter->second);
+            return;
+        }
+        if (shard.entries.size() >= _shard_capacity) {
+            shard.index.erase(shard.entries.back().first);
+            shard.entries.pop_back();
+        }
+        shard.entries.emplace_front(key, std::move(value));
+        shard.index.emplace(key, shard.entries.begin());
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (auto& shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            n += shard.entries.size();
+        }
+        return n;
+    }
+    void clear() {
+        for (auto& shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.index.clear();
+            shard.entries.clear();
+        }
+    }
+    size_t hits() const {
+        return _hits.load(std::memory_order_relaxed);
+    }
+    size_t misses() const {
+        return _misses.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<std::pair<Key, Value>> entries;  // front is the most recently used
+        std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator, Hash> index;
+    };
+    Shard& shard_of(const Key& key) {
+        return _shards[Hash{}(key) % _shards.size()];
+    }
+
+    std::vector<Shard> _shards;
+    size_t _shard_capacity;
+    std::atomic<size_t> _hits{0};
+    std::atomic<size_t> _misses{0};
+};
+}  // namespace melo
+#endif  // LRU_CACHE_H
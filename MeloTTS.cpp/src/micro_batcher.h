@@ -0,0 +1,230 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef MICRO_BATCHER_H
+#define MICRO_BATCHER_H
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <future>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "request_control.h"
+
+namespace melo {
+/**
+ * @brief Groups the items that concurrent callers submit into batches, e.g. the sentences of several requests for one
+ * model. Items are bucketed by length / bucket_width so that a batch holds similar lengths. A bucket runs as soon as
+ * it holds max_batch items, otherwise once an item has waited max_wait or reached its deadline: max_wait is the
+ * latency an item may pay for the throughput of a larger batch. Of the buckets that may run, the one with the most
+ * urgent item (see RequestControl) runs first, and a bucket gives its most urgent items to the batch, so interactive
+ * sentences pass the bulk ones queued before them. Items cancelled while they wait are dropped with Cancelled.
+ * The batches run one at a time on a dispatcher thread and every result goes back to its caller through the future
+ * submit() returned.
+ */
+template <typename Item, typename Result>
+class MicroBatcher {
+public:
+    struct Options {
+        size_t max_batch = 4;
+        std::chrono::microseconds max_wait{10000};
+        size_t bucket_width = 32;
+    };
+    struct Stats {
+        uint64_t num_items = 0;
+        uint64_t num_batches = 0;
+        uint64_t num_cancelled = 0;  // dropped before they ran
+    };
+    // must fill results with one entry per item, in the same order; an exception is passed to every item
+    using RunBatch = std::function<void(std::vector<Item>& items, std::vector<Result>& results)>;
+
+    MicroBatcher(RunBatch run_batch, const Options& options)
+        : _run_batch(std::move(run_batch)),
+          _options(clamped(options)),
+          _dispatcher([this] { dispatch(); }) {}
+    // the items submitted already are run without waiting for more
+    ~MicroBatcher() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _changed.notify_all();
+        _dispatcher.join();
+    }
+    MicroBatcher(const MicroBatcher&) = delete;
+    MicroBatcher& operator=(const MicroBatcher&) = delete;
+
+    std::future<Result> submit(Item item, size_t length, const RequestControl& control = {}) {
+        Pending pending{std::move(item), {}, Clock::now(), control};
+        std::future<Result> result = pending.promise.get_future();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::deque<Pending>& bucket = _buckets[length / _options.bucket_width];
+            // most urgent first, in arrival order among equals
+            auto position = std::find_if(bucket.begin(), bucket.end(), [&](const Pending& queued) {
+                return pending.control.before(queued.control);
+            });
+            bucket.insert(position, std::move(pending));
+            ++_num_pending;
+        }
+        _changed.notify_all();
+        return result;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _stats;
+    }
+    const Options& options() const {
+        return _options;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Pending {
+        Item item;
+        std::promise<Result> promise;
+        Clock::time_point arrival;
+        RequestControl control;
+
+        // when the item stops waiting for others to fill its batch
+        Clock::time_point due(std::chrono::microseconds max_wait) const {
+            return std::min(arrival + max_wait, control.deadline);
+        }
+    };
+
+    static Options clamped(Options options) {
+        options.max_batch = std::max<size_t>(options.max_batch, 1);
+        options.bucket_width = std::max<size_t>(options.bucket_width, 1);
+        return options;
+    }
+
+    void dispatch() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _changed.wait(lock, [this] { return _stopping || _num_pending > 0; });
+            drop_cancelled();
+            if (_num_pending == 0) {
+                if (_stopping)
+                    return;
+                continue;
+            }
+            // of the buckets that are full or due, the one with the most urgent item
+            const Clock::time_point now = Clock::now();
+            auto next = _buckets.end();
+            Clock::time_point wake = Clock::time_point::max();
+            for (auto iter = _buckets.begin(); iter != _buckets.end(); ++iter) {
+                Clock::time_point due = Clock::time_point::max();
+                for (const Pending& pending : iter->second)
+                    due = std::min(due, pending.due(_options.max_wait));
+                if (iter->second.size() < _options.max_batch && !_stopping && now < due) {
+                    wake = std::min(wake, due);
+                    continue;
+                }
+                const Pending& first = iter->second.front();
+                if (next == _buckets.end() || first.control.before(next->second.front().control) ||
+                    (!next->second.front().control.before(first.control) &&
+                     first.arrival < next->second.front().arrival)) {
+                    next = iter;
+                }
+            }
+            if (next == _buckets.end()) {
+                _changed.wait_until(lock, wake);
+                continue;
+            }
+
+            std::deque<Pending>& bucket = next->second;
+            const size_t n = std::min(bucket.size(), _options.max_batch);
+            std::vector<Pending> batch;
+            batch.reserve(n);
+            for (size_t i = 0; i < n; ++i) {
+                batch.push_back(std::move(bucket.front()));
+                bucket.pop_front();
+            }
+            if (bucket.empty())
+                _buckets.erase(next);
+            _num_pending -= n;
+            _stats.num_items += n;
+            ++_stats.num_batches;
+            lock.unlock();
+            run(batch);
+            lock.lock();
+        }
+    }
+
+    // fail the items whose request was cancelled while they waited
+    void drop_cancelled() {
+        for (auto iter = _buckets.begin(); iter != _buckets.end();) {
+            std::deque<Pending>& bucket = iter->second;
+            for (auto pending = bucket.begin(); pending != bucket.end();) {
+                if (pending->control.is_cancelled()) {
+                    pending->promise.set_exception(std::make_exception_ptr(Cancelled("batching")));
+                    pending = bucket.erase(pending);
+                    --_num_pending;
+                    ++_stats.num_cancelled;
+                } else {
+                    ++pending;
+                }
+            }
+            iter = bucket.empty() ? _buckets.erase(iter) : std::next(iter);
+        }
+    }
+
+    void run(std::vector<Pending>& batch) {
+        std::vector<Item> items;
+        items.reserve(batch.size());
+        for (auto& pending : batch)
+            items.push_back(std::move(pending.item));
+        std::vector<Result> results;
+        try {
+            _run_batch(items, results);
+            if (results.size() != batch.size())
+                throw std::runtime_error("MicroBatcher: the batch returned " + std::to_string(results.size()) +
+                                         " results for " + std::to_string(batch.size()) + " items");
+        } catch (...) {
+            for (auto& pending : batch)
+                pending.promise.set_exception(std::current_exception());
+            return;
+        }
+        for (size_t i = 0; i < batch.size(); ++i)
+            batch[i].promise.set_value(std::move(results[i]));
+    }
+
+    RunBatch _run_batch;
+    Options _options;
+    mutable std::mutex _mutex;
+    std::condition_variable _changed;
+    std::map<size_t, std::deque<Pending>> _buckets;  // by length / bucket_width, never empty
+    size_t _num_pending = 0;
+    bool _stopping = false;
+    Stats _stats;
+    std::thread _dispatcher;  // last, it uses the members above
+};
+}  // namespace melo
+#endif  // MICRO_BATCHER_H
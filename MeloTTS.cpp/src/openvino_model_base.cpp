@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <exception>
 #ifdef MELO_DEBUG
 // dump exectuation graph
 #include "openvino/core/graph_util.hpp"
@@ -53,6 +54,26 @@ AbstractOpenvinoModel::AbstractOpenvinoModel(std::unique_ptr<ov::Core>& core_ptr
 #endif  // MELO_DEBUG
 }
 
+ov::InferRequest& AbstractOpenvinoModel::batch_request(size_t i) {
+    while (_batch_requests.size() <= i)
+        _batch_requests.push_back(std::make_unique<ov::InferRequest>(_compiled_model->create_infer_request()));
+    return *_batch_requests[i];
+}
+
+void AbstractOpenvinoModel::wait_batch_requests(size_t n) {
+    std::exception_ptr error;
+    for (size_t i = 0; i < n; ++i) {
+        try {
+            _batch_requests[i]->wait();
+        } catch (...) {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
 void AbstractOpenvinoModel::print_input_names() const {
     const std::vector<ov::Output<const ov::Node>>& inputs = _compiled_model->inputs();
     for (size_t i = 0; i < inputs.size(); i++) {
@@ -19,6 +19,7 @@
 #ifndef OPENVINO_MODEL_BASE_H_
 #define OPENVINO_MODEL_BASE_H_
 
+#include <algorithm>
 #include <any>
 #include <filesystem>
 #include <map>
@@ -82,10 +83,25 @@ public:
         }
         return device_config;
     }
+    // config for running num_streams inferences at the same time, e.g. several sentences on the batch requests
+    static inline ov::AnyMap with_streams(ov::AnyMap config, const std::string& device_name, size_t num_streams) {
+        if (device_name.find("CPU") != std::string::npos || device_name.find("GPU") != std::string::npos) {
+            config[ov::hint::performance_mode.name()] = ov::hint::PerformanceMode::THROUGHPUT;
+            config[ov::num_streams.name()] = ov::streams::Num(static_cast<int32_t>(std::max<size_t>(num_streams, 1)));
+        }
+        return config;
+    }
     void print_input_names() const;
 
 protected:
+    // the i-th infer request for the items of a batch, created on first use; they run concurrently on as many
+    // streams as the model was compiled with
+    ov::InferRequest& batch_request(size_t i);
+    // wait for batch requests 0 .. n - 1, the first error is rethrown once all of them are done
+    void wait_batch_requests(size_t n);
+
     std::unique_ptr<ov::InferRequest> _infer_request;
+    std::vector<std::unique_ptr<ov::InferRequest>> _batch_requests;
     std::unique_ptr<ov::CompiledModel> _compiled_model;
     std::string _device;
 };
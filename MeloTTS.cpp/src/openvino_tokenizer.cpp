@@ -17,12 +17,28 @@
  */
 #include "openvino_tokenizer.h"
 
+#include <iostream>
+
 namespace melo {
+OpenVinoTokenizer::OpenVinoTokenizer(const std::filesystem::path& tokenizer_model_folder,
+                                     const std::filesystem::path& vocab_path)
+    : _tokenizer(tokenizer_model_folder) {
+    const auto vocab = vocab_path.empty() ? tokenizer_model_folder / "vocab.txt" : vocab_path;
+    if (std::filesystem::exists(vocab)) {
+        _wordpiece = WordPieceTokenizer(vocab);
+        std::cout << "[INFO] OpenVinoTokenizer: native word segmentation with " << vocab.string() << std::endl;
+    } else {
+        std::cout << "[INFO] OpenVinoTokenizer: " << vocab.string()
+                  << " does not exist, word segmentation runs on the OpenVINO tokenizer\n";
+    }
+}
 std::vector<int64_t> OpenVinoTokenizer::tokenize(const std::string& prompt) {
     return get_output_vec<int64_t>(_tokenizer.encode(prompt).input_ids);
 }
 // https://github.com/huggingface/transformers/blob/main/docs/source/en/tokenizer_summary.md#subword-tokenization
 std::vector<std::string> OpenVinoTokenizer::word_segment(const std::string& prompt) {
+    if (!_wordpiece.empty())
+        return _wordpiece.word_segment(prompt);
     ov::genai::TokenizedInputs encode_res = _tokenizer.encode(prompt);
     std::vector<std::string> decode_res = _tokenizer.decode(encode_res.input_ids);
     std::vector<std::string> res;
@@ -33,4 +49,22 @@ std::vector<std::string> OpenVinoTokenizer::word_segment(const std::string& prom
     }
     return res;
 }
-}  // namespace melo
\ No newline at end of file
+TokenizedText OpenVinoTokenizer::encode(const std::string& text) {
+    TokenizedText res;
+    if (!_wordpiece.empty()) {
+        _wordpiece.encode(text, res);
+        return res;
+    }
+    // one encode + decode round trip gives both the ids and the subwords
+    ov::genai::TokenizedInputs encode_res = _tokenizer.encode(text);
+    res.ids = get_output_vec<int64_t>(encode_res.input_ids);
+    res.tokens = _tokenizer.decode(encode_res.input_ids);
+    if (res.tokens.size() != res.ids.size()) {
+        std::cerr << "[ERROR] OpenVinoTokenizer::encode: " << res.tokens.size() << " subwords for " << res.ids.size()
+                  << " ids\n";
+        res.tokens.resize(res.ids.size());
+    }
+    res.mark_words();
+    return res;
+}
+}  // namespace melo
@@ -24,6 +24,9 @@
 #include <openvino/genai/tokenizer.hpp>
 #include <string>
 #include <vector>
+
+#include "tokenized_text.h"
+#include "wordpiece_tokenizer.h"
 namespace melo {
 /**
  * @class OpenVinoTokenizer
@@ -33,12 +36,20 @@ namespace melo {
  */
 class OpenVinoTokenizer {
 public:
-    OpenVinoTokenizer(const std::filesystem::path& tokenizer_model_folder) : _tokenizer(tokenizer_model_folder) {}
+    // vocab_path: WordPiece vocabulary (vocab.txt) of the same model. When it exists, word_segment runs natively
+    // instead of an encode + decode round trip through the OpenVINO tokenizer graphs. By default vocab.txt is looked
+    // up in tokenizer_model_folder.
+    OpenVinoTokenizer(const std::filesystem::path& tokenizer_model_folder, const std::filesystem::path& vocab_path = {});
     OpenVinoTokenizer() = default;
     ~OpenVinoTokenizer() = default;
 
     std::vector<int64_t> tokenize(const std::string& prompt);
     std::vector<std::string> word_segment(const std::string& text);
+    // Tokenize a sentence once for both G2P (subwords) and BERT (ids)
+    TokenizedText encode(const std::string& text);
+    inline bool has_native_word_segment() const {
+        return !_wordpiece.empty();
+    }
 
     template <typename T>
     static std::vector<T> get_output_vec(const ov::Tensor& output_tensor) {
@@ -54,6 +65,7 @@ public:
 
 private:
     ov::genai::Tokenizer _tokenizer;
+    WordPieceTokenizer _wordpiece;
 };
 }  // namespace melo
 #endif  // OPENVINO_TOKENIZER_H
\ No newline at end of file
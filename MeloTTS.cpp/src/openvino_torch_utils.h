@@ -5,13 +5,14 @@
 #include <torch/torch.h>
 
 #include <chrono>
-#include <codecvt>
 #include <fstream>
 #include <iostream>
 #include <locale>
 #include <openvino/openvino.hpp>
 #include <optional>
 
+#include "utf8_utils.h"
+
 static void dump_tensor(torch::Tensor z, std::string fname) {
     z = z.contiguous();
     std::ofstream wf(fname, std::ios::binary);
@@ -43,7 +44,7 @@ static inline std::string FullPath(std::string base_dir, std::string filename) {
 }
 
 static inline std::wstring ToWString(const std::string& str) {
-    return std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(str);
+    return melo::utf8::to_wstring(str);
 }
 
 static ov::Tensor wrap_torch_tensor_as_ov(torch::Tensor tensor_torch) {
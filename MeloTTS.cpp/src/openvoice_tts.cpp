@@ -17,21 +17,67 @@
  */
 #include "openvoice_tts.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <fstream>
 #include <iterator>
+#include <stdexcept>
+#include <string>
 
 #include "info_data.h"
+#include "latent_windows.h"
 #include "utils.h"
 
 namespace melo {
+OpenVoiceTTS::OpenVoiceTTS(std::unique_ptr<ov::Core>& core_ptr,
+                           const std::filesystem::path& model_path,
+                           const std::string& device,
+                           const std::string& language,
+                           const bool quantize,
+                           size_t chunk_frames,
+                           size_t context_frames)
+    : AbstractOpenvinoModel(core_ptr,
+                            split_model_path(model_path, "encoder"),
+                            device,
+                            OpenVoiceTTS::set_tts_config(device, quantize)),
+      _flow(std::make_unique<SubModel>(core_ptr,
+                                       split_model_path(model_path, "flow"),
+                                       device,
+                                       OpenVoiceTTS::set_tts_config(device, quantize))),
+      _decoder(std::make_unique<SubModel>(core_ptr,
+                                          split_model_path(model_path, "decoder"),
+                                          device,
+                                          OpenVoiceTTS::set_tts_config(device, quantize))),
+      _chunk_frames(chunk_frames),
+      _context_frames(context_frames),
+      _language(language) {}
+
+// e.g. tts_en_int8.xml -> tts_en_int8_decoder.xml
+std::filesystem::path OpenVoiceTTS::split_model_path(const std::filesystem::path& model_path, const std::string& part) {
+    return model_path.parent_path() / (model_path.stem().string() + "_" + part + model_path.extension().string());
+}
+
+bool OpenVoiceTTS::has_split_models(const std::filesystem::path& model_path) {
+    return std::filesystem::exists(split_model_path(model_path, "encoder")) &&
+           std::filesystem::exists(split_model_path(model_path, "flow")) &&
+           std::filesystem::exists(split_model_path(model_path, "decoder"));
+}
+
+void OpenVoiceTTS::release_infer_memory() {
+    AbstractOpenvinoModel::release_infer_memory();
+    if (_flow)
+        _flow->release_infer_memory();
+    if (_decoder)
+        _decoder->release_infer_memory();
+}
+
 /* The function 'tts_infer' serves as the entry point for TTS inference.
    1. The parameters 'phones', 'tones', and 'lang_ids' are not declared with 'const' because they are involved in the
    construction of ov::Tensor objects.
    2.  Additionally, the numeric parameters 'speaker_id', 'spd_ratio', 'noise_scale', and 'noise_scale_w' are explicitly
-   copied to ensure the correct data type and byte length are passed to the ov::Tensor constructor. This explicit
-   copying is to match the expected data types for the ov::Tensor construction.*/
+   copied into InputBuffers to ensure the correct data type and byte length are passed to the ov::Tensor constructor.
+   This explicit copying is to match the expected data types for the ov::Tensor construction.*/
 std::vector<float> OpenVoiceTTS::tts_infer(std::vector<int64_t>& phones_,
                                            std::vector<int64_t>& tones_,
                                            std::vector<int64_t>& lang_ids_,
@@ -42,27 +88,204 @@ std::vector<float> OpenVoiceTTS::tts_infer(std::vector<int64_t>& phones_,
                                            const float& sdp_ratio_,
                                            const float& noise_scale_,
                                            const float& noise_scale_w_) {
+    assert((_infer_request.get() != nullptr) && "openvoice_tts::_infer_request should not be null!");
+    InputBuffers buffers;
+    set_input_tensors(*_infer_request,
+                      phones_,
+                      tones_,
+                      lang_ids_,
+                      phone_level_feature,
+                      speed_,
+                      speaker_id_,
+                      disable_bert,
+                      sdp_ratio_,
+                      noise_scale_,
+                      noise_scale_w_,
+                      buffers);
+
+    ov_infer();
+
+    return get_ouput();
+}
+
+std::vector<std::vector<float>> OpenVoiceTTS::tts_infer_batch(std::vector<Input>& inputs) {
+    auto startTime = Time::now();
+    std::vector<std::vector<float>> wavs(inputs.size());
+    try {
+        for (size_t i = 0; i < inputs.size(); ++i)
+            start_infer(i, std::move(inputs[i]));
+        for (size_t i = 0; i < inputs.size(); ++i)
+            wavs[i] = wait_infer(i);
+    } catch (...) {
+        wait_all();
+        throw;
+    }
+    std::cout << "[INFO] tts batch of " << inputs.size() << " infer time: " << get_duration_ms_till_now(startTime)
+              << "ms\n";
+    return wavs;
+}
+
+void OpenVoiceTTS::start_infer(size_t slot, Input input) {
+    if (_slot_inputs.size() <= slot) {
+        _slot_inputs.resize(slot + 1);
+        _slot_buffers.resize(slot + 1);
+        _slot_busy.resize(slot + 1, false);
+    }
+    if (_slot_busy[slot])
+        throw std::runtime_error("OpenVoiceTTS::start_infer: slot " + std::to_string(slot) + " is still running");
+    Input& kept = _slot_inputs[slot] = std::move(input);
+    ov::InferRequest& request = batch_request(slot);
+    set_input_tensors(request,
+                      kept.phones,
+                      kept.tones,
+                      kept.lang_ids,
+                      kept.phone_level_feature,
+                      kept.speed,
+                      kept.speaker_id,
+                      kept.disable_bert,
+                      kept.sdp_ratio,
+                      kept.noise_scale,
+                      kept.noise_scale_w,
+                      _slot_buffers[slot]);
+    request.start_async();
+    _slot_busy[slot] = true;
+}
+
+std::vector<float> OpenVoiceTTS::wait_infer(size_t slot) {
+    if (slot >= _slot_busy.size() || !_slot_busy[slot])
+        throw std::runtime_error("OpenVoiceTTS::wait_infer: nothing runs on slot " + std::to_string(slot));
+    ov::InferRequest& request = batch_request(slot);
+    _slot_busy[slot] = false;
+    request.wait();
+    return copy_output(request);
+}
+
+void OpenVoiceTTS::wait_all() noexcept {
+    for (size_t slot = 0; slot < _slot_busy.size(); ++slot) {
+        if (!_slot_busy[slot])
+            continue;
+        _slot_busy[slot] = false;
+        try {
+            batch_request(slot).wait();
+        } catch (...) {
+        }
+    }
+}
+
+// The encoder samples the prior of every frame, the flow turns it into the latent z of the sentence at once, then the
+// decoder runs over the windows of z. The outputs of the encoder and the flow stay on their requests until the end.
+void OpenVoiceTTS::tts_infer_chunks(Input& input,
+                                    const std::function<void(std::vector<float>& chunk, bool last)>& on_chunk) {
+    if (!is_split())
+        throw std::runtime_error("OpenVoiceTTS::tts_infer_chunks: the model is not split");
+    auto startTime = Time::now();
+    InputBuffers buffers;
+    set_input_tensors(*_infer_request,
+                      input.phones,
+                      input.tones,
+                      input.lang_ids,
+                      input.phone_level_feature,
+                      input.speed,
+                      input.speaker_id,
+                      input.disable_bert,
+                      input.sdp_ratio,
+                      input.noise_scale,
+                      input.noise_scale_w,
+                      buffers);
+    _infer_request->infer();
+    // z_p [1, channels, frames], the speaker embedding g [1, gin_channels, 1]
+    const ov::Tensor& z_p = _infer_request->get_output_tensor(0);
+    const ov::Tensor& g = _infer_request->get_output_tensor(1);
+    ov::InferRequest& flow = _flow->request();
+    flow.set_input_tensor(0, z_p);
+    flow.set_input_tensor(1, g);
+    flow.infer();
+    const ov::Tensor& z = flow.get_output_tensor(0);
+    const size_t channels = z.get_shape()[1], frames = z.get_shape()[2];
+    std::cout << "[INFO] tts encoder and flow time: " << get_duration_ms_till_now(startTime) << "ms, " << frames
+              << " frames\n";
+
+    ov::InferRequest& decoder = _decoder->request();
+    decoder.set_input_tensor(1, g);
+    const float* latent = z.data<const float>();
+    std::vector<float> window, chunk;
+    const std::vector<LatentWindow> windows = latent_windows(frames, _chunk_frames, _context_frames);
+    if (windows.empty())
+        on_chunk(chunk, true);
+    for (const LatentWindow& w : windows) {
+        // z is channel major, the window is copied channel by channel
+        window.resize(channels * w.width);
+        for (size_t c = 0; c < channels; ++c)
+            std::copy_n(latent + c * frames + w.first, w.width, window.begin() + c * w.width);
+        decoder.set_input_tensor(0, ov::Tensor(ov::element::f32, {BATCH_SIZE, channels, w.width}, window.data()));
+        decoder.infer();
+        const ov::Tensor& audio = decoder.get_output_tensor(0);
+        const float* samples = audio.data<const float>();
+        const size_t hop = audio.get_byte_size() / sizeof(float) / w.width;
+        chunk.assign(samples + w.offset * hop, samples + (w.offset + w.kept) * hop);
+        if (&w == &windows.front())
+            std::cout << "[INFO] tts first chunk time: " << get_duration_ms_till_now(startTime) << "ms\n";
+        on_chunk(chunk, w.last);
+    }
+    std::cout << "[INFO] tts infer time: " << get_duration_ms_till_now(startTime) << "ms, decoded in chunks\n";
+}
+
+std::vector<float> OpenVoiceTTS::copy_output(ov::InferRequest& request) {
+    const ov::Tensor& output = request.get_output_tensor(0);
+    const float* data = output.data<const float>();
+    return std::vector<float>(data, data + output.get_byte_size() / sizeof(float));
+}
+
+// The buffers of a slot are reused by the next sentence on it, so ja_bert is overwritten as a whole
+void OpenVoiceTTS::to_ja_bert(const std::vector<std::vector<float>>& phone_level_feature,
+                              size_t num_phones,
+                              bool disable_bert,
+                              std::vector<float>& ja_bert) {
+    const size_t row = num_phones, col = JA_BERT_DIM;
+    ja_bert.assign(row * col, 0.0f);
+    if (disable_bert)
+        return;
+    if (phone_level_feature.size() != row) {
+        throw std::runtime_error("OpenVoiceTTS::to_ja_bert: " + std::to_string(phone_level_feature.size()) +
+                                 " BERT features for " + std::to_string(row) + " phones");
+    }
+    for (const auto& feature : phone_level_feature) {
+        if (feature.size() != col)
+            throw std::runtime_error("OpenVoiceTTS::to_ja_bert: a BERT feature of " + std::to_string(feature.size()) +
+                                     " values instead of " + std::to_string(col));
+    }
+#ifdef MELO_DEBUG
+    std::cout << "[" << row << "," << col << "]" << std::endl;
+#endif
+    for (size_t k = 0; k < col; ++k) {
+        for (size_t j = 0; j < row; ++j) {
+            ja_bert[k * row + j] = phone_level_feature[j][k];
+        }
+    }
+}
+
+void OpenVoiceTTS::set_input_tensors(ov::InferRequest& request,
+                                     std::vector<int64_t>& phones_,
+                                     std::vector<int64_t>& tones_,
+                                     std::vector<int64_t>& lang_ids_,
+                                     const std::vector<std::vector<float>>& phone_level_feature,
+                                     float speed_,
+                                     int speaker_id_,
+                                     bool disable_bert,
+                                     float sdp_ratio_,
+                                     float noise_scale_,
+                                     float noise_scale_w_,
+                                     InputBuffers& buffers) {
     size_t n = phones_.size();
     // calculate ja_bert bert
-    size_t row = n, col = 768;
+    size_t row = n;
     assert(row == tones_.size() && row == lang_ids_.size() &&
            "phones_.size()==tones_.size()==phone_level_feature.size()");
 
-    std::vector<float> ja_bert_data, bert_data(1024 * row, 0.0f);
-    if (!disable_bert) {
-        assert(phone_level_feature.front().size() == col && "phone_level_feature.front().size()==768");
-        assert(phone_level_feature.size() == row && "phone_level_feature.size() should be equal to phones.size");
-        ja_bert_data.reserve(row * col);
-#ifdef MELO_DEBUG
-        std::cout << "[" << row << "," << col << "]" << std::endl;
-#endif
-        for (int k = 0; k < col; ++k) {
-            for (int j = 0; j < row; ++j) {
-                ja_bert_data.emplace_back(phone_level_feature[j][k]);
-            }
-        }
-    } else
-        ja_bert_data.resize(row * col, 0.0f);
+    std::vector<float>& ja_bert_data = buffers.ja_bert;
+    std::vector<float>& bert_data = buffers.bert;
+    bert_data.assign(1024 * row, 0.0f);
+    to_ja_bert(phone_level_feature, row, disable_bert, ja_bert_data);
     // tts infer
     /*  0 phones
         1 phones_length
@@ -78,39 +301,34 @@ std::vector<float> OpenVoiceTTS::tts_infer(std::vector<int64_t>& phones_,
     // set input tensor
 
     ov::Tensor phones(ov::element::i64, {BATCH_SIZE, n}, phones_.data());
-    int64_t len = static_cast<int64_t>(n);
-    ov::Tensor phones_length(ov::element::i64, {BATCH_SIZE}, &len);
-    _speakers = static_cast<int64_t>(speaker_id_);
-    ov::Tensor speakers(ov::element::i64, {BATCH_SIZE}, &_speakers);
+    buffers.length = static_cast<int64_t>(n);
+    ov::Tensor phones_length(ov::element::i64, {BATCH_SIZE}, &buffers.length);
+    buffers.speakers = static_cast<int64_t>(speaker_id_);
+    ov::Tensor speakers(ov::element::i64, {BATCH_SIZE}, &buffers.speakers);
     ov::Tensor tones(ov::element::i64, {BATCH_SIZE, n}, tones_.data());
     ov::Tensor lang_ids(ov::element::i64, {BATCH_SIZE, n}, lang_ids_.data());
     ov::Tensor bert(ov::element::f32, {BATCH_SIZE, 1024, row}, bert_data.data());
     ov::Tensor ja_bert(ov::element::f32, {BATCH_SIZE, 768, row}, ja_bert_data.data());
-    _noise_scale = noise_scale_;
-    ov::Tensor noise_scale(ov::element::f32, {BATCH_SIZE}, &_noise_scale);
-    _length_scale = 1 / speed_;
-    ov::Tensor length_scale(ov::element::f32, {BATCH_SIZE}, &_length_scale);
-    _noise_scale_w = noise_scale_w_;
-    ov::Tensor noise_scale_w(ov::element::f32, {BATCH_SIZE}, &_noise_scale_w);
-    _sdp_ration = sdp_ratio_;
-    ov::Tensor sdp_ratio(ov::element::f32, {BATCH_SIZE}, &_sdp_ration);
+    buffers.noise_scale = noise_scale_;
+    ov::Tensor noise_scale(ov::element::f32, {BATCH_SIZE}, &buffers.noise_scale);
+    buffers.length_scale = 1 / speed_;
+    ov::Tensor length_scale(ov::element::f32, {BATCH_SIZE}, &buffers.length_scale);
+    buffers.noise_scale_w = noise_scale_w_;
+    ov::Tensor noise_scale_w(ov::element::f32, {BATCH_SIZE}, &buffers.noise_scale_w);
+    buffers.sdp_ratio = sdp_ratio_;
+    ov::Tensor sdp_ratio(ov::element::f32, {BATCH_SIZE}, &buffers.sdp_ratio);
     // std::cout << "tts set_input_tensor\n";
-    assert((_infer_request.get() != nullptr) && "openvoice_tts::_infer_request should not be null!");
-    _infer_request->set_input_tensor(0, phones);
-    _infer_request->set_input_tensor(1, phones_length);
-    _infer_request->set_input_tensor(2, speakers);
-    _infer_request->set_input_tensor(3, tones);
-    _infer_request->set_input_tensor(4, lang_ids);
-    _infer_request->set_input_tensor(5, bert);
-    _infer_request->set_input_tensor(6, ja_bert);
-    _infer_request->set_input_tensor(7, noise_scale);
-    _infer_request->set_input_tensor(8, length_scale);
-    _infer_request->set_input_tensor(9, noise_scale_w);
-    _infer_request->set_input_tensor(10, sdp_ratio);
-
-    ov_infer();
-
-    return get_ouput();
+    request.set_input_tensor(0, phones);
+    request.set_input_tensor(1, phones_length);
+    request.set_input_tensor(2, speakers);
+    request.set_input_tensor(3, tones);
+    request.set_input_tensor(4, lang_ids);
+    request.set_input_tensor(5, bert);
+    request.set_input_tensor(6, ja_bert);
+    request.set_input_tensor(7, noise_scale);
+    request.set_input_tensor(8, length_scale);
+    request.set_input_tensor(9, noise_scale_w);
+    request.set_input_tensor(10, sdp_ratio);
 }
 void OpenVoiceTTS::ov_infer() {
     auto startTime = Time::now();
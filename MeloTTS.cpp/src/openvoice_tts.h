@@ -18,6 +18,8 @@
 #pragma once
 #ifndef OPENVOICE_TTS_H
 #define OPENVOICE_TTS_H
+#include <functional>
+
 #include "openvino_model_base.h"
 namespace melo {
 class OpenVoiceTTS : public AbstractOpenvinoModel {
@@ -33,6 +35,16 @@ public:
                                 device,
                                 config.value_or(OpenVoiceTTS::set_tts_config(device, quantize))),
           _language(language) {}
+    // The split export of model_path instead (see scripts/export_split_tts.py), which tts_infer_chunks decodes
+    // chunk_frames latent frames at a time: <stem>_encoder.xml takes the inputs of the whole model and runs the text
+    // encoder and the duration predictor, <stem>_flow.xml and <stem>_decoder.xml the rest.
+    OpenVoiceTTS(std::unique_ptr<ov::Core>& core_ptr,
+                 const std::filesystem::path& model_path,
+                 const std::string& device,
+                 const std::string& language,
+                 const bool quantize,
+                 size_t chunk_frames,
+                 size_t context_frames = DECODER_CONTEXT_FRAMES);
 
     OpenVoiceTTS() = default;
     std::vector<float> tts_infer(std::vector<int64_t>& phones,
@@ -45,6 +57,36 @@ public:
                                  const float& sdp_ratio = 0.2f,
                                  const float& noise_scale = 0.6f,
                                  const float& noise_scale_w = 0.8f);
+    // the arguments of tts_infer for one sentence of a batch
+    struct Input {
+        std::vector<int64_t> phones, tones, lang_ids;
+        std::vector<std::vector<float>> phone_level_feature;
+        float speed = 1.0f;
+        int speaker_id = 1;
+        bool disable_bert = false;
+        float sdp_ratio = 0.2f;
+        float noise_scale = 0.6f;
+        float noise_scale_w = 0.8f;
+    };
+    // The audio of several sentences, each on a batch request of its own: the exported model returns no length per
+    // item, so the sentences run side by side on the streams of the compiled model instead of one padded tensor
+    std::vector<std::vector<float>> tts_infer_batch(std::vector<Input>& inputs);
+    // One sentence on batch request slot, started without waiting, so that the next sentences can run on the other
+    // streams meanwhile. wait_infer(slot) returns its audio; the input is kept until then.
+    void start_infer(size_t slot, Input input);
+    std::vector<float> wait_infer(size_t slot);
+    // wait for every started slot and drop the errors, e.g. before the inputs go away after a failure
+    void wait_all() noexcept;
+    // The audio of one sentence in chunks, each handed to on_chunk as soon as it is decoded; last is set for the last
+    // chunk of the sentence. Only for a split model.
+    void tts_infer_chunks(Input& input, const std::function<void(std::vector<float>& chunk, bool last)>& on_chunk);
+    inline bool is_split() const {
+        return _decoder != nullptr;
+    }
+    static std::filesystem::path split_model_path(const std::filesystem::path& model_path, const std::string& part);
+    static bool has_split_models(const std::filesystem::path& model_path);
+    // of the sub-models too
+    void release_infer_memory();
     virtual void ov_infer();
     virtual std::vector<float> get_ouput();
 
@@ -52,6 +94,15 @@ public:
         return _language;
     }
     static constexpr size_t BATCH_SIZE = 1;
+    static constexpr size_t JA_BERT_DIM = 768;
+    // the [phones][768] features as the [768][phones] ja_bert input, all zeros with disable_bert; ja_bert is replaced
+    static void to_ja_bert(const std::vector<std::vector<float>>& phone_level_feature,
+                           size_t num_phones,
+                           bool disable_bert,
+                           std::vector<float>& ja_bert);
+    static constexpr size_t HOP_LENGTH = 512;  // audio samples per latent frame, hop_length of the model config
+    // frames decoded on either side of a chunk, about the receptive field of the decoder
+    static constexpr size_t DECODER_CONTEXT_FRAMES = 8;
     // This function must be static because it is used in the constructor
     inline static ov::AnyMap set_tts_config(const std::string& device_name, bool quantize = false) {
 #ifdef MELO_DEBUG
@@ -86,13 +137,46 @@ public:
     }
 
 private:
-    std::string _language = "ZH";
+    // the data the input tensors of one sentence wrap, it must live until the inference is done
+    struct InputBuffers {
+        std::vector<float> bert, ja_bert;
+        int64_t length = 0;
+        int64_t speakers = 1;  // default speak id for zh
+        float noise_scale = 0.6f;
+        float length_scale = 1.00f;
+        float noise_scale_w = 0.80f;
+        float sdp_ratio = 0.2f;
+    };
+    void set_input_tensors(ov::InferRequest& request,
+                           std::vector<int64_t>& phones,
+                           std::vector<int64_t>& tones,
+                           std::vector<int64_t>& lang_ids,
+                           const std::vector<std::vector<float>>& phone_level_feature,
+                           float speed,
+                           int speaker_id,
+                           bool disable_bert,
+                           float sdp_ratio,
+                           float noise_scale,
+                           float noise_scale_w,
+                           InputBuffers& buffers);
+
+    static std::vector<float> copy_output(ov::InferRequest& request);
 
-    int64_t _speakers = 1;  // default speak id for zh
-    float _noise_scale = 0.6f;
-    float _length_scale = 1.00f;
-    float _noise_scale_w = 0.80f;
-    float _sdp_ration = 0.2f;
+    // the flow or the decoder of a split model
+    class SubModel : public AbstractOpenvinoModel {
+    public:
+        using AbstractOpenvinoModel::AbstractOpenvinoModel;
+        inline ov::InferRequest& request() {
+            return *_infer_request;
+        }
+    };
+    std::unique_ptr<SubModel> _flow, _decoder;
+    size_t _chunk_frames = 0, _context_frames = 0;
+
+    std::vector<Input> _slot_inputs;
+    std::vector<InputBuffers> _slot_buffers;
+    std::vector<bool> _slot_busy;
+    std::string _language = "ZH";
 };
 }  // namespace melo
 #endif  // OVOPENVOICETTS_H
\ No newline at end of file
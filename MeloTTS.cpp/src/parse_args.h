@@ -5,6 +5,7 @@
 #pragma once
 #ifndef PARSE_ARGS_H
 #define PARSE_ARGS_H
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
 #include <unordered_set>
@@ -12,9 +13,11 @@
 #include <fcntl.h>
 #include <io.h>
 #include <windows.h>
-
-#include <codecvt>
 #endif
+
+#include "pcm_convert.h"
+#include "resampler.h"
+#include "utf8_utils.h"
 struct Args {
     std::filesystem::path model_dir = "ov_models";
     std::string tts_device = "CPU";
@@ -22,8 +25,17 @@ struct Args {
     std::string nf_device = "CPU";
     std::string input_file = "inputs.txt";
     std::string output_filename = "audio";
+    std::string output_format = "wav";  // wav or pcm
+    int32_t output_rate = 0;            // 0: the rate of the model, 44100
+    static constexpr int32_t model_rate = 44100;  // melo::TTS::sampling_rate_, resampled to output_rate
+    static constexpr int32_t min_output_rate = 1000, max_output_rate = 192000;
+    melo::pcm::ConvertOptions convert_options;  // float -> int16 of the output audio
     float speed = 1.0;
     bool quantize = true; // quantize for tts
+    size_t tts_streams = 1;  // sentences synthesized at the same time
+    size_t front_end_threads = 0;  // 0: the front end runs on the synthesizing thread
+    size_t tts_chunk_ms = 0;       // 0: whole sentences
+    size_t g2p_prewarm_words = 0;  // 0: the G2P cache of ZH fills as the texts come
     bool disable_bert = false;
     bool disable_nf = false;
     std::string language = "EN";
@@ -54,10 +66,31 @@ inline void usage(const std::string& prog) {
               << "  --input_file            Specifies the input text file to be processed.\n"
               << "  --output_filename       Specifies the output audio filename to be generated in the format "
                  "{output_filename}_{language_style}.wav. For example, if the language is Chinese and the output_filen "
-                 "is \"audio\", the file will be saved as audio_ZH-MIX-EN.wav\n"
+                 "is \"audio\", the file will be saved as audio_ZH-MIX-EN.wav. \"-\" streams the audio of the first "
+                 "language style to stdout, the logs are written to stderr instead.\n"
+              << "  --output_format         Specifies the output format, wav or headerless 16-bit mono pcm (default: "
+                 "wav).\n"
+              << "  --output_rate           Specifies the sample rate of the output audio, e.g. 8000, 16000 or 48000 "
+                 "(default: 44100, the rate of the model).\n"
+              << "  --output_gain           Specifies the gain applied to the output audio before the 16-bit "
+                 "conversion (default: 1.0).\n"
+              << "  --normalize_peak        Specifies the peak the output audio is limited to, e.g. 0.95: the gain "
+                 "drops once a louder sample comes and is never raised again, 0 for none (default: 0).\n"
+              << "  --dither                Indicates whether to add TPDF dither before the 16-bit conversion "
+                 "(default: false).\n"
               << "  --speed                 Specifies the speed of output audio (default: 1.0).\n"
               << "  --quantize              Indicates whether to use an int8 quantized tts model (default: true, use int8 "
                  "model by default).\n"
+              << "  --tts_streams           Specifies how many sentences of a text the TTS model synthesizes at the "
+                 "same time on a throughput-compiled model, e.g. the number of CPU sockets or GPU streams (default: "
+                 "1).\n"
+              << "  --front_end_threads     Specifies the threads that normalize the text and run G2P a few sentences "
+                 "ahead of the models, 0 for none (default: 0).\n"
+              << "  --tts_chunk_ms          Specifies the length of the audio chunks a sentence is decoded in with the "
+                 "split TTS model from scripts/export_split_tts.py, e.g. 100, 0 for whole sentences, not with "
+                 "--tts_streams above 1 (default: 0).\n"
+              << "  --g2p_prewarm_words     Specifies how many of the most frequent Chinese words are converted to "
+                 "phones at startup, e.g. 2000, 0 for none (default: 0).\n"
               << "  --disable_bert          Indicates whether to disable the BERT model inference (default: false).\n"
 #    ifdef USE_DEEPFILTERNET
               << "  --disable_nf            Indicates whether to disable the DeepfilterNet model inference (default: "
@@ -93,6 +126,26 @@ inline Args parse_args(const std::vector<std::string>& argv) {
             args.input_file = argv[++i];
         } else if (arg == "--output_filename") {
             args.output_filename = argv[++i];
+        } else if (arg == "--output_format") {
+            args.output_format = argv[++i];
+            if (args.output_format != "wav" && args.output_format != "pcm") {
+                usage(argv[0]);
+                throw std::runtime_error("Unknown output format: " + args.output_format);
+            }
+        } else if (arg == "--output_rate") {
+            args.output_rate = std::stoi(argv[++i]);
+            if (args.output_rate != 0 &&
+                (args.output_rate < Args::min_output_rate || args.output_rate > Args::max_output_rate ||
+                 !melo::Resampler::supports(Args::model_rate, args.output_rate))) {
+                usage(argv[0]);
+                throw std::runtime_error("Unsupported output rate: " + std::to_string(args.output_rate));
+            }
+        } else if (arg == "--output_gain") {
+            args.convert_options.gain = std::stof(argv[++i]);
+        } else if (arg == "--normalize_peak") {
+            args.convert_options.normalize_peak = std::clamp(std::stof(argv[++i]), 0.0f, 1.0f);
+        } else if (arg == "--dither") {
+            args.convert_options.dither = to_bool(argv[++i]);
         } else if (arg == "--speed") {
             args.speed = std::stof(argv[++i]);
         } else if (arg == "--disable_bert") {
@@ -101,6 +154,14 @@ inline Args parse_args(const std::vector<std::string>& argv) {
             args.disable_nf = to_bool(argv[++i]);
         } else if (arg == "--quantize") {
             args.quantize = to_bool(argv[++i]);
+        } else if (arg == "--tts_streams") {
+            args.tts_streams = std::max(std::stoi(argv[++i]), 1);
+        } else if (arg == "--front_end_threads") {
+            args.front_end_threads = std::max(std::stoi(argv[++i]), 0);
+        } else if (arg == "--tts_chunk_ms") {
+            args.tts_chunk_ms = std::max(std::stoi(argv[++i]), 0);
+        } else if (arg == "--g2p_prewarm_words") {
+            args.g2p_prewarm_words = std::max(std::stoi(argv[++i]), 0);
         } else if (arg == "--language") {
             args.language = argv[++i];
         } else {
@@ -108,6 +169,11 @@ inline Args parse_args(const std::vector<std::string>& argv) {
             throw std::runtime_error("Unknown argument: " + arg);
         }
     }
+    // the split model decodes one sentence at a time
+    if (args.tts_chunk_ms > 0 && args.tts_streams > 1) {
+        usage(argv[0]);
+        throw std::runtime_error("--tts_chunk_ms and --tts_streams above 1 cannot be combined");
+    }
     args.generate_init_file_paths();
     return args;
 }
@@ -119,9 +185,8 @@ inline Args parse_args(int argc, char** argv) {
 #    ifdef _WIN32
     LPWSTR* wargs = CommandLineToArgvW(GetCommandLineW(), &argc);
 
-    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
     for (int i = 0; i < argc; i++) {
-        argv_vec.emplace_back(converter.to_bytes(wargs[i]));
+        argv_vec.emplace_back(melo::utf8::to_string(wargs[i]));
     }
 
     LocalFree(wargs);
@@ -0,0 +1,188 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "pcm_convert.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simd.h"
+
+namespace melo::pcm {
+namespace {
+constexpr float INT16_MAX_F = 32767.0f;
+constexpr float INT16_MIN_F = -32768.0f;
+
+using ConvertKernel = void (*)(const float* in, int16_t* out, size_t n, float scale, const float* noise);
+
+// Rounds to nearest even like the SIMD conversions. NaN becomes 32767, the same as min/max in the x86 kernels.
+void convert_scalar(const float* in, int16_t* out, size_t n, float scale, const float* noise) {
+    for (size_t i = 0; i < n; ++i) {
+        float x = in[i] * scale + (noise ? noise[i] : 0.0f);
+        if (!(x < INT16_MAX_F))
+            x = INT16_MAX_F;
+        if (x < INT16_MIN_F)
+            x = INT16_MIN_F;
+        out[i] = static_cast<int16_t>(std::lrintf(x));
+    }
+}
+
+#ifdef MELO_SIMD_SSE2
+MELO_SIMD_TARGET("sse2") inline __m128i to_int32_sse2(const float* in, const float* noise, __m128 scale) {
+    __m128 x = _mm_mul_ps(_mm_loadu_ps(in), scale);
+    if (noise)
+        x = _mm_add_ps(x, _mm_loadu_ps(noise));
+    x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(INT16_MAX_F)), _mm_set1_ps(INT16_MIN_F));
+    return _mm_cvtps_epi32(x);
+}
+MELO_SIMD_TARGET("sse2") void convert_sse2(const float* in, int16_t* out, size_t n, float scale, const float* noise) {
+    const __m128 vscale = _mm_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i lo = to_int32_sse2(in + i, noise ? noise + i : nullptr, vscale);
+        const __m128i hi = to_int32_sse2(in + i + 4, noise ? noise + i + 4 : nullptr, vscale);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(lo, hi));
+    }
+    convert_scalar(in + i, out + i, n - i, scale, noise ? noise + i : nullptr);
+}
+#endif  // MELO_SIMD_SSE2
+
+#ifdef MELO_SIMD_AVX2
+MELO_SIMD_TARGET("avx2") inline __m256i to_int32_avx2(const float* in, const float* noise, __m256 scale) {
+    __m256 x = _mm256_mul_ps(_mm256_loadu_ps(in), scale);
+    if (noise)
+        x = _mm256_add_ps(x, _mm256_loadu_ps(noise));
+    x = _mm256_max_ps(_mm256_min_ps(x, _mm256_set1_ps(INT16_MAX_F)), _mm256_set1_ps(INT16_MIN_F));
+    return _mm256_cvtps_epi32(x);
+}
+MELO_SIMD_TARGET("avx2") void convert_avx2(const float* in, int16_t* out, size_t n, float scale, const float* noise) {
+    const __m256 vscale = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256i lo = to_int32_avx2(in + i, noise ? noise + i : nullptr, vscale);
+        const __m256i hi = to_int32_avx2(in + i + 8, noise ? noise + i + 8 : nullptr, vscale);
+        // packs works per 128-bit lane: lo0-3 hi0-3 lo4-7 hi4-7, restore the order of the 64-bit quarters
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+    convert_scalar(in + i, out + i, n - i, scale, noise ? noise + i : nullptr);
+}
+#endif  // MELO_SIMD_AVX2
+
+#ifdef MELO_SIMD_AVX512
+MELO_SIMD_AVX512_BEGIN
+MELO_SIMD_TARGET("avx512f") void convert_avx512(const float* in, int16_t* out, size_t n, float scale, const float* noise) {
+    const __m512 vscale = _mm512_set1_ps(scale);
+    const __m512 vmax = _mm512_set1_ps(INT16_MAX_F);
+    const __m512 vmin = _mm512_set1_ps(INT16_MIN_F);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 x = _mm512_mul_ps(_mm512_loadu_ps(in + i), vscale);
+        if (noise)
+            x = _mm512_add_ps(x, _mm512_loadu_ps(noise + i));
+        x = _mm512_max_ps(_mm512_min_ps(x, vmax), vmin);
+        const __m256i packed = _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(x));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+    convert_scalar(in + i, out + i, n - i, scale, noise ? noise + i : nullptr);
+}
+MELO_SIMD_AVX512_END
+#endif  // MELO_SIMD_AVX512
+
+#ifdef MELO_SIMD_NEON
+void convert_neon(const float* in, int16_t* out, size_t n, float scale, const float* noise) {
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t lo = vmulq_f32(vld1q_f32(in + i), vscale);
+        float32x4_t hi = vmulq_f32(vld1q_f32(in + i + 4), vscale);
+        if (noise) {
+            lo = vaddq_f32(lo, vld1q_f32(noise + i));
+            hi = vaddq_f32(hi, vld1q_f32(noise + i + 4));
+        }
+        // vcvtnq rounds to nearest even and saturates to int32, vqmovn saturates to int16
+        const int16x8_t packed = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(lo)), vqmovn_s32(vcvtnq_s32_f32(hi)));
+        vst1q_s16(out + i, packed);
+    }
+    convert_scalar(in + i, out + i, n - i, scale, noise ? noise + i : nullptr);
+}
+#endif  // MELO_SIMD_NEON
+
+struct Kernel {
+    const char* name;
+    ConvertKernel convert;
+};
+
+Kernel select_kernel() {
+    switch (simd::best_isa()) {
+#ifdef MELO_SIMD_AVX512
+        case simd::Isa::Avx512:
+            return {"avx512", convert_avx512};
+#endif
+#ifdef MELO_SIMD_AVX2
+        case simd::Isa::Avx2:
+            return {"avx2", convert_avx2};
+#endif
+#ifdef MELO_SIMD_SSE2
+        case simd::Isa::Sse2:
+            return {"sse2", convert_sse2};
+#endif
+#ifdef MELO_SIMD_NEON
+        case simd::Isa::Neon:
+            return {"neon", convert_neon};
+#endif
+        default:
+            return {"scalar", convert_scalar};
+    }
+}
+
+const Kernel& kernel() {
+    static const Kernel selected = select_kernel();
+    return selected;
+}
+}  // namespace
+
+void Dither::fill(std::span<float> noise) {
+    // the sum of two uniform values has a triangular distribution
+    for (float& value : noise)
+        value = uniform() - uniform();
+}
+
+void float_to_int16(std::span<const float> in, std::span<int16_t> out, float scale, const float* noise) {
+    kernel().convert(in.data(), out.data(), std::min(in.size(), out.size()), scale, noise);
+}
+
+float peak(std::span<const float> in) {
+    float max_abs = 0.0f;
+    for (float x : in)
+        max_abs = std::max(max_abs, std::fabs(x));
+    return max_abs;
+}
+
+float scale_for(std::span<const float> in, const ConvertOptions& options) {
+    if (options.normalize_peak > 0.0f) {
+        const float max_abs = peak(in);
+        if (max_abs > 0.0f)
+            return options.normalize_peak / max_abs * INT16_SCALE;
+    }
+    return options.gain * INT16_SCALE;
+}
+
+const char* kernel_name() {
+    return kernel().name;
+}
+}  // namespace melo::pcm
@@ -0,0 +1,69 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef PCM_CONVERT_H
+#define PCM_CONVERT_H
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace melo::pcm {
+/**
+ * @brief float -> int16 conversion of the synthesized audio.
+ *
+ * Samples are scaled by gain * 32767, rounded to nearest and saturated to [-32768, 32767], so that peaks clip
+ * instead of wrapping around. The kernel is picked once according to simd::best_isa().
+ */
+struct ConvertOptions {
+    float gain = 1.0f;
+    // > 0: scale_for scales so that the peak of the converted samples becomes this value (e.g. 0.95), overriding gain;
+    // WaveWriter limits the running peak of its output to it instead
+    float normalize_peak = 0.0f;
+    // add triangular (TPDF) dither of +-1 LSB before rounding
+    bool dither = false;
+};
+
+// Dither noise source, xorshift32. One per output stream.
+class Dither {
+public:
+    explicit Dither(uint32_t seed = 0x9E3779B9u) : _state(seed ? seed : 1u) {}
+    // fill noise with TPDF values in (-1, 1), in LSB
+    void fill(std::span<float> noise);
+
+private:
+    inline float uniform() {
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return static_cast<float>(_state >> 8) * (1.0f / 16777216.0f);  // [0, 1)
+    }
+    uint32_t _state;
+};
+
+// out[i] = saturate(round(in[i] * scale + (noise ? noise[i] : 0))), out.size() must be >= in.size()
+void float_to_int16(std::span<const float> in, std::span<int16_t> out, float scale, const float* noise = nullptr);
+// max |in[i]|
+float peak(std::span<const float> in);
+// scale for float_to_int16 according to options, samples are only read for normalize_peak
+float scale_for(std::span<const float> in, const ConvertOptions& options);
+// name of the kernel in use: "avx512", "avx2", "sse2", "neon" or "scalar"
+const char* kernel_name();
+
+constexpr float INT16_SCALE = 32767.0f;
+}  // namespace melo::pcm
+#endif  // PCM_CONVERT_H
@@ -0,0 +1,136 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef PIPELINE_STAGE_H
+#define PIPELINE_STAGE_H
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace melo {
+/**
+ * @brief A pipeline stage that consumes items in order on its own thread.
+ * push() hands an item over and returns at once unless `capacity` items are already waiting, which bounds the memory
+ * held when the producer is faster than the consumer. finish() waits until every item is consumed.
+ * An exception thrown by the consumer stops the stage; it is rethrown once, by the next push() or by finish(), and the
+ * remaining items are dropped.
+ */
+template <typename T>
+class PipelineStage {
+public:
+    explicit PipelineStage(std::function<void(T&)> consume, size_t capacity = 2)
+        : _consume(std::move(consume)),
+          _capacity(std::max<size_t>(capacity, 1)),
+          _worker([this] { run(); }) {}
+    PipelineStage(const PipelineStage&) = delete;
+    PipelineStage& operator=(const PipelineStage&) = delete;
+
+    // an unfinished stage drops its remaining items
+    ~PipelineStage() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+            _queue.clear();
+        }
+        _changed.notify_all();
+        if (_worker.joinable())
+            _worker.join();
+    }
+
+    void push(T item) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait(lock, [this] { return _queue.size() < _capacity || _error || _stopped; });
+        rethrow(lock);
+        if (_stopped)
+            return;
+        _queue.emplace_back(std::move(item));
+        lock.unlock();
+        _changed.notify_all();
+    }
+
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _changed.notify_all();
+        if (_worker.joinable())
+            _worker.join();
+        std::unique_lock<std::mutex> lock(_mutex);
+        rethrow(lock);
+    }
+
+    // the consumer has thrown, whether or not the exception has been rethrown yet
+    bool failed() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _failed;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _changed.wait(lock, [this] { return !_queue.empty() || _closed; });
+            if (_queue.empty())
+                break;
+            T item = std::move(_queue.front());
+            _queue.pop_front();
+            lock.unlock();
+            _changed.notify_all();
+            try {
+                _consume(item);
+            } catch (...) {
+                lock.lock();
+                _error = std::current_exception();
+                _failed = true;
+                _queue.clear();
+                break;
+            }
+            lock.lock();
+        }
+        _stopped = true;
+        lock.unlock();
+        _changed.notify_all();
+    }
+
+    void rethrow(std::unique_lock<std::mutex>& lock) {
+        if (!_error)
+            return;
+        auto error = std::exchange(_error, nullptr);
+        lock.unlock();
+        std::rethrow_exception(error);
+    }
+
+    std::function<void(T&)> _consume;
+    size_t _capacity;
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    std::deque<T> _queue;
+    std::exception_ptr _error;
+    bool _failed = false;
+    bool _closed = false;   // no more items
+    bool _stopped = false;  // the worker has returned
+    std::thread _worker;    // last, started once the members above are constructed
+};
+}  // namespace melo
+#endif  // PIPELINE_STAGE_H
@@ -0,0 +1,113 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef REQUEST_CONTROL_H
+#define REQUEST_CONTROL_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace melo {
+// Thrown by a synthesis whose CancellationToken was cancelled, at the next stage it reaches
+class Cancelled : public std::runtime_error {
+public:
+    explicit Cancelled(const std::string& stage) : std::runtime_error("cancelled before " + stage) {}
+};
+
+// Set from any thread, e.g. when the client of a request has gone, and checked between the stages of the synthesis.
+// A wait that the stages cannot check, e.g. for a free worker, is woken by a callback.
+class CancellationToken {
+public:
+    inline void cancel() noexcept {
+        std::map<uint64_t, std::function<void()>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_cancelled.exchange(true, std::memory_order_relaxed))
+                return;
+            callbacks.swap(_callbacks);
+        }
+        for (auto& [id, callback] : callbacks)
+            callback();
+    }
+    // callback runs once, on the thread that cancels; not at all when the token is cancelled already, so check
+    // is_cancelled() after adding it. The id is for remove_callback.
+    inline uint64_t add_callback(std::function<void()> callback) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!is_cancelled())
+            _callbacks.emplace(_next_callback, std::move(callback));
+        return _next_callback++;
+    }
+    inline void remove_callback(uint64_t id) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _callbacks.erase(id);
+    }
+    inline bool is_cancelled() const noexcept {
+        return _cancelled.load(std::memory_order_relaxed);
+    }
+    inline void throw_if_cancelled(const char* stage) const {
+        if (is_cancelled())
+            throw Cancelled(stage);
+    }
+
+private:
+    std::atomic<bool> _cancelled{false};
+    mutable std::mutex _mutex;
+    mutable std::map<uint64_t, std::function<void()>> _callbacks;
+    mutable uint64_t _next_callback = 0;
+};
+
+// smaller is served first
+enum class Priority : int {
+    Interactive = 0,  // someone waits for the first audio
+    Bulk = 1,         // e.g. rendering an audiobook, only the throughput counts
+};
+
+/**
+ * @brief How a synthesis is scheduled against the others that share the models: by priority, then by the earliest
+ * deadline, then in arrival order. The deadline orders the work, it does not abort it.
+ */
+struct RequestControl {
+    using Clock = std::chrono::steady_clock;
+
+    Priority priority = Priority::Interactive;
+    Clock::time_point deadline = Clock::time_point::max();
+    std::shared_ptr<const CancellationToken> token;  // none: cannot be cancelled
+
+    inline bool is_cancelled() const {
+        return token && token->is_cancelled();
+    }
+    // call before every stage
+    inline void check(const char* stage) const {
+        if (token)
+            token->throw_if_cancelled(stage);
+    }
+    // compares the urgency of two requests, before() comes first
+    inline bool before(const RequestControl& other) const {
+        return std::tie(priority, deadline) < std::tie(other.priority, other.deadline);
+    }
+};
+}  // namespace melo
+#endif  // REQUEST_CONTROL_H
@@ -0,0 +1,240 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include "simd.h"
+
+namespace melo {
+namespace {
+constexpr uint32_t MAX_PHASES = 4096;
+
+// zeroth order modified Bessel function of the first kind
+double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+// The dot products below have n % 16 == 0, see Resampler::num_taps()
+using DotKernel = float (*)(const float* a, const float* b, size_t n);
+
+float dot_scalar(const float* a, const float* b, size_t n) {
+    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (size_t i = 0; i < n; i += 4) {
+        for (size_t j = 0; j < 4; ++j)
+            sum[j] += a[i + j] * b[i + j];
+    }
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+#ifdef MELO_SIMD_SSE2
+MELO_SIMD_TARGET("sse2") float dot_sse2(const float* a, const float* b, size_t n) {
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    for (size_t i = 0; i < n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    const __m128 acc = _mm_add_ps(acc0, acc1);
+    const __m128 pair = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    return _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 1)));
+}
+#endif  // MELO_SIMD_SSE2
+
+#ifdef MELO_SIMD_AVX2
+MELO_SIMD_TARGET("avx2,fma") float dot_avx2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    for (size_t i = 0; i < n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    const __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1)));
+}
+#endif  // MELO_SIMD_AVX2
+
+#ifdef MELO_SIMD_AVX512
+MELO_SIMD_AVX512_BEGIN
+MELO_SIMD_TARGET("avx512f") float dot_avx512(const float* a, const float* b, size_t n) {
+    __m512 acc = _mm512_setzero_ps();
+    for (size_t i = 0; i < n; i += 16)
+        acc = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc);
+    return _mm512_reduce_add_ps(acc);
+}
+MELO_SIMD_AVX512_END
+#endif  // MELO_SIMD_AVX512
+
+#ifdef MELO_SIMD_NEON
+float dot_neon(const float* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+    for (size_t i = 0; i < n; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1));
+}
+#endif  // MELO_SIMD_NEON
+
+DotKernel select_dot() {
+    switch (simd::best_isa()) {
+#ifdef MELO_SIMD_AVX512
+        case simd::Isa::Avx512:
+            return dot_avx512;
+#endif
+#ifdef MELO_SIMD_AVX2
+        case simd::Isa::Avx2:
+            return dot_avx2;
+#endif
+#ifdef MELO_SIMD_SSE2
+        case simd::Isa::Sse2:
+            return dot_sse2;
+#endif
+#ifdef MELO_SIMD_NEON
+        case simd::Isa::Neon:
+            return dot_neon;
+#endif
+        default:
+            return dot_scalar;
+    }
+}
+
+const DotKernel dot = select_dot();
+}  // namespace
+
+bool Resampler::supports(int32_t in_rate, int32_t out_rate) {
+    if (in_rate <= 0 || out_rate <= 0)
+        return false;
+    return static_cast<uint32_t>(out_rate / std::gcd(in_rate, out_rate)) <= MAX_PHASES;
+}
+
+Resampler::Resampler(int32_t in_rate, int32_t out_rate) : _in_rate(in_rate), _out_rate(out_rate) {
+    if (in_rate <= 0 || out_rate <= 0)
+        throw std::invalid_argument("Resampler: invalid sample rate");
+    if (!supports(in_rate, out_rate))
+        throw std::invalid_argument("Resampler: unsupported ratio " + std::to_string(in_rate) + " -> " +
+                                    std::to_string(out_rate));
+    const int32_t divisor = std::gcd(in_rate, out_rate);
+    _up = static_cast<uint32_t>(out_rate / divisor);
+    _down = static_cast<uint32_t>(in_rate / divisor);
+    build_filters();
+    reset();
+}
+
+void Resampler::build_filters() {
+    // cutoff relative to the input Nyquist frequency
+    const double cutoff = ROLLOFF * std::min(1.0, static_cast<double>(_up) / _down);
+    _half = static_cast<size_t>(std::ceil(ZERO_CROSSINGS / cutoff));
+    _half = (_half + 7) / 8 * 8;
+    _num_taps = 2 * _half;
+    if (is_passthrough())
+        return;
+
+    const double i0_beta = bessel_i0(KAISER_BETA);
+    _filters.resize(static_cast<size_t>(_up) * _num_taps);
+    for (uint32_t phase = 0; phase < _up; ++phase) {
+        float* filter = _filters.data() + phase * _num_taps;
+        const double frac = static_cast<double>(phase) / _up;
+        double sum = 0.0;
+        std::vector<double> taps(_num_taps);
+        for (size_t i = 0; i < _num_taps; ++i) {
+            // distance from the output position to input sample i of the window, in input samples
+            const double x = static_cast<double>(i) - static_cast<double>(_half - 1) - frac;
+            const double r = x / _half;
+            const double window = r * r < 1.0 ? bessel_i0(KAISER_BETA * std::sqrt(1.0 - r * r)) / i0_beta : 0.0;
+            const double t = std::numbers::pi * cutoff * x;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(t) / t;
+            taps[i] = cutoff * sinc * window;
+            sum += taps[i];
+        }
+        // unity gain at DC for every phase
+        for (size_t i = 0; i < _num_taps; ++i)
+            filter[i] = static_cast<float>(taps[i] / sum);
+    }
+}
+
+void Resampler::reset() {
+    _history.assign(_half - 1, 0.0f);
+    _position = static_cast<uint64_t>(_half - 1) * _up;
+    _num_input = 0;
+    _num_output = 0;
+}
+
+void Resampler::run(std::vector<float>& output, size_t max_output) {
+    size_t produced = 0;
+    while (produced < max_output) {
+        const uint64_t index = _position / _up;
+        if (index + _half >= _history.size())
+            break;
+        const float* filter = _filters.data() + (_position % _up) * _num_taps;
+        output.push_back(dot(_history.data() + index - (_half - 1), filter, _num_taps));
+        _position += _down;
+        ++produced;
+    }
+    _num_output += produced;
+    // drop the samples no later output needs
+    const uint64_t drop = std::min<uint64_t>(_position / _up - (_half - 1), _history.size());
+    _history.erase(_history.begin(), _history.begin() + drop);
+    _position -= drop * _up;
+}
+
+void Resampler::process(std::span<const float> input, std::vector<float>& output) {
+    if (is_passthrough()) {
+        output.insert(output.end(), input.begin(), input.end());
+        return;
+    }
+    _history.insert(_history.end(), input.begin(), input.end());
+    _num_input += input.size();
+    run(output, SIZE_MAX);
+}
+
+void Resampler::flush(std::vector<float>& output) {
+    if (!is_passthrough()) {
+        const uint64_t total = (_num_input * _up + _down / 2) / _down;
+        _history.insert(_history.end(), _half, 0.0f);
+        if (total > _num_output)
+            run(output, total - _num_output);
+    }
+    reset();
+}
+
+std::vector<float> Resampler::resample(std::span<const float> input, int32_t in_rate, int32_t out_rate) {
+    std::vector<float> output;
+    if (in_rate == out_rate) {
+        output.assign(input.begin(), input.end());
+        return output;
+    }
+    Resampler resampler(in_rate, out_rate);
+    output.reserve(static_cast<size_t>(static_cast<double>(input.size()) * out_rate / in_rate) + 1);
+    resampler.process(input, output);
+    resampler.flush(output);
+    return output;
+}
+}  // namespace melo
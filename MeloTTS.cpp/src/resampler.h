@@ -0,0 +1,85 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace melo {
+/**
+ * @brief Streaming polyphase windowed-sinc resampler between two fixed rates, e.g. 44100 -> 8000/16000/48000.
+ *
+ * The ratio is reduced to up/down = out_rate/in_rate. Every one of the `up` phases has its own Kaiser windowed sinc
+ * filter of num_taps() coefficients, with the cutoff at 0.95 of the lower Nyquist frequency (about -90 dB stop band).
+ * An output sample is one dot product between the input history and the filter of its phase (SIMD).
+ * process() may be called with blocks of any size; the output does not depend on how the input is split.
+ * flush() emits the tail, the total output is then round(input * out_rate / in_rate) samples, aligned with the input.
+ */
+class Resampler {
+public:
+    static constexpr int ZERO_CROSSINGS = 16;  // per side, at the cutoff frequency
+    static constexpr double ROLLOFF = 0.95;
+    static constexpr double KAISER_BETA = 8.6;
+
+    // throws std::invalid_argument unless supports(in_rate, out_rate)
+    Resampler(int32_t in_rate, int32_t out_rate);
+    // both rates positive and at most MAX_PHASES output samples per period of the reduced ratio
+    static bool supports(int32_t in_rate, int32_t out_rate);
+
+    // append the resampled input to output
+    void process(std::span<const float> input, std::vector<float>& output);
+    // append the remaining output and reset
+    void flush(std::vector<float>& output);
+    void reset();
+
+    inline bool is_passthrough() const {
+        return _up == _down;
+    }
+    inline int32_t in_rate() const {
+        return _in_rate;
+    }
+    inline int32_t out_rate() const {
+        return _out_rate;
+    }
+    inline size_t num_taps() const {
+        return _num_taps;
+    }
+    // resample a whole signal at once
+    static std::vector<float> resample(std::span<const float> input, int32_t in_rate, int32_t out_rate);
+
+private:
+    void build_filters();
+    void run(std::vector<float>& output, size_t max_output);
+
+    int32_t _in_rate, _out_rate;
+    uint32_t _up, _down;  // out_rate / in_rate reduced
+    size_t _num_taps;             // multiple of 16
+    size_t _half;                 // _num_taps / 2
+    std::vector<float> _filters;  // _up * _num_taps, phase major
+
+    // input samples still needed, initially _half - 1 zeros that stand for the samples before the first one
+    std::vector<float> _history;
+    uint64_t _position;  // next output position in _history, in units of 1/_up samples
+    uint64_t _num_input = 0;
+    uint64_t _num_output = 0;
+};
+}  // namespace melo
+#endif  // RESAMPLER_H
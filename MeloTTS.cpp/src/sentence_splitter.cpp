@@ -0,0 +1,217 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sentence_splitter.h"
+
+#include <array>
+#include <utility>
+
+#include "utf8_utils.h"
+
+namespace melo {
+namespace {
+// replacement of every ASCII punctuation mark, 0 for the characters that are kept as they are
+constexpr std::array<char, 128> make_ascii_punct_table() {
+    std::array<char, 128> table{};
+    for (char ch : {',', '.', '!', '?', ';', '-'})
+        table[ch] = ch;
+    for (char ch : {':', '"', '\'', '/', '(', ')', '[', ']', '<', '>', '\t', '\r'})
+        table[ch] = ' ';
+    table['\n'] = '.';
+    table['$'] = '.';
+    table['~'] = '-';
+    return table;
+}
+constexpr std::array<char, 128> ASCII_PUNCT = make_ascii_punct_table();
+
+struct MultibytePunct {
+    std::string_view key;
+    char replacement;
+};
+constexpr MultibytePunct MULTIBYTE_PUNCT[] = {
+    {"，", ','}, {"。", '.'}, {"！", '!'}, {"？", '?'}, {"、", ','}, {"；", ','}, {"：", ','}, {"·", ','},
+    {"“", ' '},  {"”", ' '},  {"‘", ' '},  {"’", ' '},  {"（", ' '}, {"）", ' '}, {"【", ' '}, {"】", ' '},
+    {"《", ' '}, {"》", ' '}, {"「", ' '}, {"」", ' '}, {"……", ' '}, {"¥ ", ' '}, {"—", '-'}, {"～", '-'},
+    {"…", '.'},  // after "……"
+};
+// first bytes of the keys above; Chinese characters (E4 - E9) never start a multibyte mark
+constexpr std::array<bool, 256> make_multibyte_lead_table() {
+    std::array<bool, 256> table{};
+    for (const auto& punct : MULTIBYTE_PUNCT)
+        table[static_cast<unsigned char>(punct.key.front())] = true;
+    return table;
+}
+constexpr std::array<bool, 256> MULTIBYTE_LEAD = make_multibyte_lead_table();
+
+inline bool is_splitter(char replacement) {
+    return replacement == ',' || replacement == '.' || replacement == '!' || replacement == '?' || replacement == ';';
+}
+inline bool is_digit(char ch) {
+    return ch >= '0' && ch <= '9';
+}
+inline bool is_space(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+struct Punct {
+    bool is_punct = false;
+    char replacement = 0;  // 0: dropped
+    size_t length = 1;     // bytes
+    bool ends_sentence = false;
+};
+// Classify the character at text[pos]
+inline Punct classify_punct(std::string_view text, size_t pos) {
+    const unsigned char ch = static_cast<unsigned char>(text[pos]);
+    if (ch < 0x80) {
+        if (ASCII_PUNCT[ch] == 0)
+            return {};
+        // an ellipsis "..." (any run of dots) is one full stop as in punc.dic
+        if (ch == '.' && pos + 1 < text.size() && text[pos + 1] == '.') {
+            const size_t end = text.find_first_not_of('.', pos);
+            const size_t length = (end == std::string_view::npos ? text.size() : end) - pos;
+            return {true, '.', length, true};
+        }
+        if (ch == ',' || ch == '.') {
+            // Keep the decimal point for the text normalization, drop the thousands separator. e.g. 3.14 1,000
+            if (pos > 0 && pos + 1 < text.size() && is_digit(text[pos - 1]) && is_digit(text[pos + 1]))
+                return {true, ch == '.' ? '.' : '\0', 1, false};
+            // Special workaround for .com
+            if (ch == '.' && text.substr(pos + 1, 3) == "com")
+                return {true, '.', 1, false};
+        }
+        return {true, ASCII_PUNCT[ch], 1, is_splitter(ASCII_PUNCT[ch])};
+    }
+    if (MULTIBYTE_LEAD[ch]) {
+        const std::string_view rest = text.substr(pos);
+        for (const auto& punct : MULTIBYTE_PUNCT) {
+            if (rest.starts_with(punct.key))
+                return {true, punct.replacement, punct.key.size(), is_splitter(punct.replacement)};
+        }
+    }
+    return {};
+}
+
+// call on_sentence(begin, end) for every sentence of text, in byte offsets
+template <typename Func>
+void for_each_sentence(std::string_view text, Func&& on_sentence) {
+    size_t begin = 0;
+    for (size_t pos = 0; pos < text.size();) {
+        const Punct punct = classify_punct(text, pos);
+        pos += punct.length;
+        if (punct.ends_sentence) {
+            on_sentence(begin, pos);
+            begin = pos;
+        }
+    }
+    if (begin < text.size())
+        on_sentence(begin, text.size());
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && is_space(text.front()))
+        text.remove_prefix(1);
+    while (!text.empty() && is_space(text.back()))
+        text.remove_suffix(1);
+    return text;
+}
+}  // namespace
+
+std::vector<std::string_view> SentenceSplitter::split(std::string_view text) {
+    std::vector<std::string_view> sentences;
+    for_each_sentence(text, [&](size_t begin, size_t end) {
+        sentences.emplace_back(text.substr(begin, end - begin));
+    });
+    return sentences;
+}
+
+std::vector<std::string_view> SentenceSplitter::chunk(std::string_view text, const ChunkPolicy& policy) {
+    std::vector<std::pair<size_t, size_t>> ranges;  // [begin, end) of every chunk
+    size_t chunk_begin = 0, phonemes = 0;
+    for_each_sentence(text, [&](size_t begin, size_t end) {
+        phonemes += estimate_phonemes(text.substr(begin, end - begin));
+        const size_t target = ranges.empty() ? policy.first_chunk_phonemes : policy.chunk_phonemes;
+        if (phonemes >= target) {
+            ranges.emplace_back(chunk_begin, end);
+            chunk_begin = end;
+            phonemes = 0;
+        }
+    });
+    if (chunk_begin < text.size()) {
+        if (!ranges.empty() && phonemes < policy.min_tail_phonemes)
+            ranges.back().second = text.size();  // merge a short tail into the previous chunk
+        else if (phonemes > 0)
+            ranges.emplace_back(chunk_begin, text.size());
+    }
+
+    std::vector<std::string_view> chunks;
+    chunks.reserve(ranges.size());
+    for (const auto& [begin, end] : ranges) {
+        std::string_view piece = trim(text.substr(begin, end - begin));
+        if (!piece.empty())
+            chunks.emplace_back(piece);
+    }
+    return chunks;
+}
+
+std::string SentenceSplitter::clean(std::string_view chunk) {
+    std::string res;
+    res.reserve(chunk.size());
+    for (size_t pos = 0; pos < chunk.size();) {
+        const Punct punct = classify_punct(chunk, pos);
+        if (!punct.is_punct) {
+            res += chunk[pos++];
+            continue;
+        }
+        pos += punct.length;
+        if (punct.replacement != 0)
+            res += punct.replacement;
+        // sentences merged into one chunk stay separated by a space
+        if (punct.ends_sentence && pos < chunk.size())
+            res += ' ';
+    }
+    return res;
+}
+
+size_t SentenceSplitter::estimate_phonemes(std::string_view text) {
+    size_t phonemes = 0, letters = 0;
+    auto end_word = [&]() {
+        phonemes += (letters * 3 + 3) / 4;
+        letters = 0;
+    };
+    utf8::for_each(text, [&](char32_t code_point, size_t, size_t) {
+        const utf8::CharClass char_class = utf8::classify(code_point);
+        if (char_class == utf8::CharClass::Upper || char_class == utf8::CharClass::Lower) {
+            ++letters;
+            return;
+        }
+        end_word();
+        switch (char_class) {
+            case utf8::CharClass::Cjk:
+            case utf8::CharClass::Digit:
+                phonemes += 2;
+                break;
+            case utf8::CharClass::Space:
+                break;
+            default:
+                phonemes += 1;
+                break;
+        }
+    });
+    end_word();
+    return phonemes;
+}
+}  // namespace melo
@@ -0,0 +1,60 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef SENTENCE_SPLITTER_H
+#define SENTENCE_SPLITTER_H
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace melo {
+/**
+ * @brief How sentences are grouped into the chunks synthesized one at a time, measured in estimated phonemes.
+ * The first chunk is kept small so that the first audio is ready early, later chunks are larger for throughput.
+ */
+struct ChunkPolicy {
+    size_t first_chunk_phonemes = 20;
+    size_t chunk_phonemes = 60;
+    size_t min_tail_phonemes = 5;  // a shorter last chunk is merged into the previous one
+};
+
+/**
+ * @brief Splits text into sentences at , . ! ? ; and their Chinese counterparts without copying it.
+ *
+ * Punctuation is classified with a 128-entry ASCII table and a short table of multibyte marks, which is the same
+ * mapping tests/test_darts.cpp builds into punc.dic:
+ *  1. ，。！？、；：· and \n end a sentence (as , . ! ? , , , , .); decimal points, thousands separators and ".com"
+ *     do not.
+ *  2. Quotes, brackets and the remaining marks become spaces, which keeps English words apart.
+ *  3. — ～ ~ become '-'.
+ * split() and chunk() return views into text, clean() applies the mapping when a chunk is materialized.
+ */
+class SentenceSplitter {
+public:
+    // sentences of text, each one including its trailing splitter
+    static std::vector<std::string_view> split(std::string_view text);
+    // consecutive sentences grouped according to policy, leading and trailing whitespace trimmed
+    static std::vector<std::string_view> chunk(std::string_view text, const ChunkPolicy& policy = {});
+    // punctuation mapped as described above, e.g. "你好，世界（hello）。" -> "你好, 世界 hello ."
+    static std::string clean(std::string_view chunk);
+    // rough number of phonemes: 2 per Chinese character or digit, 3 per 4 letters of a word, 1 per punctuation mark
+    static size_t estimate_phonemes(std::string_view text);
+};
+}  // namespace melo
+#endif  // SENTENCE_SPLITTER_H
@@ -0,0 +1,81 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sentence_writer.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace melo {
+SentenceWriter::SentenceWriter(WaveWriter& writer,
+                               int32_t model_rate,
+                               int32_t stage_rate,
+                               size_t silence_samples,
+                               Filter filter)
+    : _writer(writer),
+      _model_rate(model_rate),
+      _stage_rate(stage_rate),
+      _filter(std::move(filter)),
+      _to_stage(model_rate, stage_rate),
+      _to_output(stage_rate, writer.sample_rate()),
+      _silence(silence_samples, 0.0f) {}
+
+void SentenceWriter::write(std::span<const float> audio, bool sentence_end) {
+    _staged.clear();
+    _to_stage.process(audio, _staged);
+    _num_model_samples += audio.size();
+    if (sentence_end)
+        _sentence_ends.push_back((_num_model_samples * _stage_rate + _model_rate / 2) / _model_rate);
+    write_staged(false);
+}
+
+void SentenceWriter::finish() {
+    _staged.clear();
+    _to_stage.flush(_staged);
+    write_staged(true);
+}
+
+void SentenceWriter::write_staged(bool last) {
+    if (_filter) {
+        _filtered.clear();
+        _filter(_staged, _filtered, last);
+        _staged.swap(_filtered);
+    }
+    _spliced.clear();
+    size_t done = 0;
+    while (!_sentence_ends.empty() &&
+           (last || _sentence_ends.front() <= _num_staged + static_cast<int64_t>(_staged.size()))) {
+        const size_t end = std::clamp<int64_t>(_sentence_ends.front() - _num_staged, done, _staged.size());
+        _spliced.insert(_spliced.end(), _staged.begin() + done, _staged.begin() + end);
+        _spliced.insert(_spliced.end(), _silence.begin(), _silence.end());
+        _sentence_ends.pop_front();
+        done = end;
+    }
+    _spliced.insert(_spliced.end(), _staged.begin() + done, _staged.end());
+    _num_staged += _staged.size();
+
+    if (_to_output.is_passthrough() && !last) {
+        _writer.write(_spliced);
+        return;
+    }
+    _resampled.clear();
+    _to_output.process(_spliced, _resampled);
+    if (last)
+        _to_output.flush(_resampled);
+    _writer.write(_resampled);
+}
+}  // namespace melo
@@ -0,0 +1,75 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef SENTENCE_WRITER_H
+#define SENTENCE_WRITER_H
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "resampler.h"
+#include "wave_writer.h"
+
+namespace melo {
+/**
+ * @brief Streams the sentences of a synthesis into a WaveWriter with the silence between them:
+ * model rate -> stage rate -> filter (e.g. the noise filter) -> silence after every sentence -> writer rate.
+ *
+ * The silence is digital zero, so it bypasses the resampler and the filter: the sentences are streamed back to back,
+ * which carries the filter state across them, and the silence is spliced into the output at the position where the
+ * sentence ends. Both the resampler and the filter keep the output aligned with the input, so that position is the
+ * input length scaled to the stage rate.
+ */
+class SentenceWriter {
+public:
+    // append the filtered input to output, aligned with the input over the whole stream; last: flush the filter too
+    using Filter = std::function<void(std::span<const float> input, std::vector<float>& output, bool last)>;
+
+    // without a filter stage_rate should be the rate of writer, the audio is then resampled once
+    SentenceWriter(WaveWriter& writer,
+                   int32_t model_rate,
+                   int32_t stage_rate,
+                   size_t silence_samples,
+                   Filter filter = {});
+
+    // audio at model_rate, a sentence or a part of one; silence_samples of silence follow it if sentence_end
+    void write(std::span<const float> audio, bool sentence_end);
+    // write the tail of the resamplers and the filter
+    void finish();
+
+private:
+    // filter staged, splice the silence in and write the result
+    void write_staged(bool last);
+
+    WaveWriter& _writer;
+    int32_t _model_rate;
+    int32_t _stage_rate;
+    Filter _filter;
+    Resampler _to_stage;
+    Resampler _to_output;
+    std::vector<float> _silence;
+    std::vector<float> _staged, _filtered, _spliced, _resampled;
+    std::deque<int64_t> _sentence_ends;  // in stage samples without the silence
+    int64_t _num_model_samples = 0;
+    int64_t _num_staged = 0;
+};
+}  // namespace melo
+#endif  // SENTENCE_WRITER_H
@@ -0,0 +1,199 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "server/http.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+
+namespace melo {
+namespace http {
+namespace {
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+        text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r'))
+        text.remove_suffix(1);
+    return text;
+}
+
+std::string to_lower(std::string_view text) {
+    std::string lower(text);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    return lower;
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+}  // namespace
+
+std::optional<std::string> Request::header(const std::string& lower_name) const {
+    auto iter = headers.find(lower_name);
+    if (iter == headers.end())
+        return std::nullopt;
+    return iter->second;
+}
+
+std::optional<std::string> Request::param(const std::string& name) const {
+    auto iter = query.find(name);
+    if (iter == query.end())
+        return std::nullopt;
+    return iter->second;
+}
+
+std::string url_decode(std::string_view text, bool plus_is_space) {
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (c == '%' && i + 2 < text.size() && hex_value(text[i + 1]) >= 0 && hex_value(text[i + 2]) >= 0) {
+            decoded.push_back(static_cast<char>(hex_value(text[i + 1]) * 16 + hex_value(text[i + 2])));
+            i += 2;
+        } else if (c == '+' && plus_is_space) {
+            decoded.push_back(' ');
+        } else {
+            decoded.push_back(c);
+        }
+    }
+    return decoded;
+}
+
+std::map<std::string, std::string> parse_query(std::string_view query) {
+    std::map<std::string, std::string> params;
+    while (!query.empty()) {
+        const size_t end = std::min(query.find('&'), query.size());
+        const std::string_view pair = query.substr(0, end);
+        query.remove_prefix(std::min(end + 1, query.size()));
+        if (pair.empty())
+            continue;
+        const size_t equal = pair.find('=');
+        if (equal == std::string_view::npos)
+            params[url_decode(pair, true)] = "";
+        else
+            params[url_decode(pair.substr(0, equal), true)] = url_decode(pair.substr(equal + 1), true);
+    }
+    return params;
+}
+
+Request parse_head(std::string_view head) {
+    Request request;
+    const size_t line_end = std::min(head.find("\r\n"), head.size());
+    const std::string_view line = head.substr(0, line_end);
+    // METHOD SP request-target SP HTTP-version
+    const size_t first = line.find(' ');
+    const size_t last = line.rfind(' ');
+    if (first == std::string_view::npos || first == last)
+        throw Error(400, "malformed request line");
+    request.method = std::string(line.substr(0, first));
+    const std::string_view target = line.substr(first + 1, last - first - 1);
+    const std::string_view version = line.substr(last + 1);
+    if (request.method.empty() || target.empty() || target.front() != '/' || version.substr(0, 5) != "HTTP/")
+        throw Error(400, "malformed request line");
+    const size_t question = target.find('?');
+    request.path = url_decode(target.substr(0, question), false);
+    if (question != std::string_view::npos)
+        request.query = parse_query(target.substr(question + 1));
+
+    head.remove_prefix(std::min(line_end + 2, head.size()));
+    while (!head.empty()) {
+        const size_t end = std::min(head.find("\r\n"), head.size());
+        const std::string_view field = head.substr(0, end);
+        head.remove_prefix(std::min(end + 2, head.size()));
+        if (field.empty())
+            continue;
+        const size_t colon = field.find(':');
+        if (colon == std::string_view::npos || colon == 0)
+            throw Error(400, "malformed header field");
+        request.headers[to_lower(field.substr(0, colon))] = std::string(trim(field.substr(colon + 1)));
+    }
+    return request;
+}
+
+size_t content_length(const Request& request, size_t max_body) {
+    if (auto coding = request.header("transfer-encoding"); coding && to_lower(*coding) != "identity")
+        throw Error(501, "chunked request bodies are not supported, send a Content-Length");
+    auto value = request.header("content-length");
+    if (!value)
+        return 0;
+    size_t length = 0;
+    const char* end = value->data() + value->size();
+    auto [ptr, ec] = std::from_chars(value->data(), end, length);
+    if (ec != std::errc() || ptr != end)
+        throw Error(400, "invalid Content-Length");
+    if (length > max_body)
+        throw Error(413, "the body exceeds " + std::to_string(max_body) + " bytes");
+    return length;
+}
+
+const char* reason(int status) {
+    switch (status) {
+    case 100:
+        return "Continue";
+    case 200:
+        return "OK";
+    case 400:
+        return "Bad Request";
+    case 404:
+        return "Not Found";
+    case 405:
+        return "Method Not Allowed";
+    case 408:
+        return "Request Timeout";
+    case 413:
+        return "Content Too Large";
+    case 431:
+        return "Request Header Fields Too Large";
+    case 500:
+        return "Internal Server Error";
+    case 501:
+        return "Not Implemented";
+    case 503:
+        return "Service Unavailable";
+    default:
+        return "Unknown";
+    }
+}
+
+std::string response_head(int status, const Headers& headers) {
+    std::string head = "HTTP/1.1 " + std::to_string(status) + " " + reason(status) + "\r\n";
+    for (const auto& [name, value] : headers)
+        head += name + ": " + value + "\r\n";
+    head += "\r\n";
+    return head;
+}
+
+std::string chunk(std::string_view data) {
+    char size[20];
+    const int n = std::snprintf(size, sizeof(size), "%zx\r\n", data.size());
+    std::string encoded;
+    encoded.reserve(n + data.size() + 2);
+    encoded.append(size, n);
+    encoded.append(data);
+    encoded.append("\r\n");
+    return encoded;
+}
+}  // namespace http
+}  // namespace melo
@@ -0,0 +1,77 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef HTTP_H
+#define HTTP_H
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace melo {
+namespace http {
+/**
+ * @brief The subset of HTTP/1.1 that melo_server speaks: one request per connection, a Content-Length body, and a
+ * response with either a Content-Length body or chunked transfer coding.
+ */
+class Error : public std::runtime_error {
+public:
+    Error(int status, const std::string& message) : std::runtime_error(message), _status(status) {}
+    inline int status() const {
+        return _status;
+    }
+
+private:
+    int _status;
+};
+
+struct Request {
+    std::string method;
+    std::string path;                           // percent-decoded, without the query
+    std::map<std::string, std::string> query;   // percent-decoded
+    std::map<std::string, std::string> headers; // names in lower case
+    std::string body;
+
+    std::optional<std::string> header(const std::string& lower_name) const;
+    std::optional<std::string> param(const std::string& name) const;
+};
+
+using Headers = std::vector<std::pair<std::string, std::string>>;
+
+// Parse the request line and the header fields, head ends before the empty line. Throws Error(400) on malformed input.
+Request parse_head(std::string_view head);
+// "a=1&b=x%20y" -> {a: 1, b: x y}; a key without '=' maps to ""
+std::map<std::string, std::string> parse_query(std::string_view query);
+// %XX escapes and '+' for a space (in a query)
+std::string url_decode(std::string_view text, bool plus_is_space);
+// Content-Length of the request, 0 without one. Throws Error(400) when invalid, Error(413) above max_body and
+// Error(501) for a chunked request body.
+size_t content_length(const Request& request, size_t max_body);
+
+const char* reason(int status);
+// status line and header fields up to the empty line
+std::string response_head(int status, const Headers& headers);
+// one chunk of the chunked transfer coding, data must not be empty
+std::string chunk(std::string_view data);
+inline constexpr std::string_view LAST_CHUNK = "0\r\n\r\n";
+}  // namespace http
+}  // namespace melo
+#endif  // HTTP_H
@@ -0,0 +1,150 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef LEASE_POOL_H
+#define LEASE_POOL_H
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "request_control.h"
+
+namespace melo {
+/**
+ * @brief A fixed set of objects that are not thread-safe, e.g. loaded TTS models, lent out one caller at a time.
+ * Callers wait by priority, then by deadline, then in arrival order (see RequestControl). At most max_queue callers
+ * wait; acquire() fails right away above that, so that a server can answer "busy" instead of piling up requests.
+ */
+template <typename T>
+class LeasePool {
+public:
+    // returns the object to the pool on destruction
+    class Lease {
+    public:
+        Lease(LeasePool* pool, T* object) : _pool(pool), _object(object) {}
+        Lease(Lease&& other) noexcept
+            : _pool(std::exchange(other._pool, nullptr)),
+              _object(std::exchange(other._object, nullptr)) {}
+        Lease& operator=(Lease&&) = delete;
+        ~Lease() {
+            if (_pool)
+                _pool->release(_object);
+        }
+        T& operator*() const {
+            return *_object;
+        }
+        T* operator->() const {
+            return _object;
+        }
+
+    private:
+        LeasePool* _pool;
+        T* _object;
+    };
+
+    LeasePool(std::vector<std::unique_ptr<T>> objects, size_t max_queue)
+        : _objects(std::move(objects)),
+          _max_queue(max_queue) {
+        for (auto& object : _objects)
+            _free.push_back(object.get());
+    }
+    LeasePool(const LeasePool&) = delete;
+    LeasePool& operator=(const LeasePool&) = delete;
+
+    // Wait for a free object, std::nullopt when max_queue callers are waiting already. Throws Cancelled once the
+    // token of control is cancelled, which gives up the place in the queue at once.
+    std::optional<Lease> acquire(const RequestControl& control = {}) {
+        // wakes the wait below, the pool outlives its callers
+        struct Subscription {
+            const CancellationToken* token = nullptr;
+            uint64_t id = 0;
+            ~Subscription() {
+                if (token)
+                    token->remove_callback(id);
+            }
+        } subscription;
+        if (control.token) {
+            subscription.token = control.token.get();
+            subscription.id = control.token->add_callback([this] {
+                { std::lock_guard<std::mutex> lock(_mutex); }
+                _changed.notify_all();
+            });
+        }
+        std::unique_lock<std::mutex> lock(_mutex);
+        control.check("a free worker");
+        if (_free.empty() && _waiting.size() >= _max_queue)
+            return std::nullopt;
+        const Ticket ticket{static_cast<int>(control.priority), control.deadline, _next_ticket++};
+        _waiting.insert(ticket);
+        _changed.wait(lock, [&] { return control.is_cancelled() || (!_free.empty() && *_waiting.begin() == ticket); });
+        _waiting.erase(ticket);
+        if (control.is_cancelled()) {
+            lock.unlock();
+            // the next waiter may be first now
+            _changed.notify_all();
+            throw Cancelled("a free worker");
+        }
+        T* object = _free.back();
+        _free.pop_back();
+        lock.unlock();
+        _changed.notify_all();
+        return Lease(this, object);
+    }
+
+    size_t size() const {
+        return _objects.size();
+    }
+    size_t num_busy() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _objects.size() - _free.size();
+    }
+    size_t num_waiting() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _waiting.size();
+    }
+    size_t max_queue() const {
+        return _max_queue;
+    }
+
+private:
+    void release(T* object) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _free.push_back(object);
+        }
+        _changed.notify_all();
+    }
+
+    std::vector<std::unique_ptr<T>> _objects;
+    std::vector<T*> _free;
+    size_t _max_queue;
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    // priority, deadline, arrival: the first of _waiting is served next
+    using Ticket = std::tuple<int, RequestControl::Clock::time_point, uint64_t>;
+    std::set<Ticket> _waiting;
+    uint64_t _next_ticket = 0;
+};
+}  // namespace melo
+#endif  // LEASE_POOL_H
@@ -0,0 +1,284 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef SINGLE_FLIGHT_H
+#define SINGLE_FLIGHT_H
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "request_control.h"
+
+namespace melo {
+/**
+ * @brief The output of one running computation, streamed as chunks to every request that asked for the same.
+ * The chunks are shared by the readers, not copied. Readers that join late start from the first chunk, which is
+ * possible within the first replay_bytes of the output only: past them a chunk is dropped once every reader attached
+ * has read it, so that a long output is not held in memory. A reader that stalls more than max_lag_bytes behind the
+ * producer is cut off (see Listener::fell_behind) rather than holding every later chunk. Once every listener has left
+ * before the end, token() is cancelled.
+ */
+class Broadcast {
+public:
+    using Chunk = std::shared_ptr<const std::string>;
+    static constexpr size_t DEFAULT_REPLAY_BYTES = 1 << 20;   // about 12 s of 44.1 kHz 16-bit audio
+    static constexpr size_t DEFAULT_MAX_LAG_BYTES = 4 << 20;  // about 48 s
+
+    // max_lag_bytes should be at least replay_bytes, a reader that joins replays that much
+    explicit Broadcast(size_t replay_bytes = DEFAULT_REPLAY_BYTES, size_t max_lag_bytes = DEFAULT_MAX_LAG_BYTES)
+        : _replay_bytes(replay_bytes),
+          _max_lag_bytes(std::max(max_lag_bytes, replay_bytes)),
+          _token(std::make_shared<CancellationToken>()) {}
+    Broadcast(const Broadcast&) = delete;
+    Broadcast& operator=(const Broadcast&) = delete;
+
+    // producer
+    void publish(Chunk chunk) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _offsets.push_back(_num_published_bytes);
+            _num_published_bytes += chunk->size();
+            _chunks.push_back(std::move(chunk));
+            trim();
+        }
+        _changed.notify_all();
+    }
+    // ok false: failed or cancelled, status is the answer for the readers that have not started a response yet;
+    // only the first call counts
+    void finish(bool ok, int status = 500) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_finished)
+                return;
+            _finished = true;
+            _ok = ok;
+            _status = status;
+        }
+        _changed.notify_all();
+    }
+    // for the computation to check
+    std::shared_ptr<const CancellationToken> token() const {
+        return _token;
+    }
+
+    // A request that reads the broadcast, see read(), or with reads false one that only keeps the computation alive,
+    // e.g. the one that runs it. leave() may be called from another thread, e.g. when the client disconnects; it wakes
+    // the read() of this listener.
+    class Listener {
+    public:
+        explicit Listener(std::shared_ptr<Broadcast> broadcast, bool reads = true) : _broadcast(std::move(broadcast)) {
+            _broadcast->attach(this, reads);
+        }
+        ~Listener() {
+            leave();
+        }
+        Listener(const Listener&) = delete;
+        Listener& operator=(const Listener&) = delete;
+
+        void leave() {
+            if (!_left.exchange(true))
+                _broadcast->detach(this);
+        }
+        bool has_left() const {
+            return _left.load();
+        }
+        // the reader lagged more than max_lag_bytes behind and read() returns false from then on, its output is
+        // incomplete
+        bool fell_behind() const {
+            return _fell_behind.load();
+        }
+
+    private:
+        friend class Broadcast;
+        std::shared_ptr<Broadcast> _broadcast;
+        std::atomic<bool> _left{false};
+        mutable std::atomic<bool> _fell_behind{false};
+    };
+
+    // wait for chunk index; false at the end of the broadcast, once listener has left or once it fell behind. The
+    // chunks before index count as read by listener.
+    bool read(size_t index, Chunk& chunk, const Listener& listener) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        advance(listener, index);
+        // a reader that waits here has caught up and is not cut off meanwhile
+        _changed.wait(lock, [&] { return index < end() || _finished || listener.has_left(); });
+        if (index >= end() || index < _first || listener.has_left() || listener.fell_behind())
+            return false;
+        chunk = _chunks[index - _first];
+        advance(listener, index + 1);
+        return true;
+    }
+    // valid once read() returned false at the end
+    bool ok() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _ok;
+    }
+    int status() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _status;
+    }
+    // the chunks held for the readers
+    size_t num_retained() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _chunks.size();
+    }
+
+    // For a request that joins: false once the first chunk may be gone already. Otherwise the chunks are kept from
+    // the first one until the reading Listener of the request is attached.
+    bool reserve_reader() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!replayable())
+            return false;
+        ++_num_reserved;
+        return true;
+    }
+
+private:
+    void attach(const Listener* listener, bool reads) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_num_listeners;
+        if (!reads)
+            return;
+        if (_num_reserved > 0)
+            --_num_reserved;
+        _readers[listener] = _first;
+    }
+    void detach(const Listener* listener) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _readers.erase(listener);
+            if (--_num_listeners == 0 && !_finished)
+                _token->cancel();
+            trim();
+        }
+        _changed.notify_all();
+    }
+    // under _mutex
+    inline size_t end() const {
+        return _first + _chunks.size();
+    }
+    inline bool replayable() const {
+        return _first == 0 && _num_published_bytes <= _replay_bytes;
+    }
+    void advance(const Listener& listener, size_t index) {
+        auto iter = _readers.find(&listener);
+        if (iter != _readers.end() && index > iter->second) {
+            iter->second = index;
+            trim();
+        }
+    }
+    // drop the chunks every reader is past, once a new reader can no longer start from the first one; the readers
+    // too far behind are cut off first
+    void trim() {
+        if (replayable() || _num_reserved > 0)
+            return;
+        size_t keep_from = end();
+        for (auto iter = _readers.begin(); iter != _readers.end();) {
+            const size_t next = iter->second;
+            if (next < end() && _num_published_bytes - _offsets[next - _first] > _max_lag_bytes) {
+                iter->first->_fell_behind = true;
+                iter = _readers.erase(iter);
+                continue;
+            }
+            keep_from = std::min(keep_from, next);
+            ++iter;
+        }
+        for (; _first < keep_from; ++_first) {
+            _chunks.pop_front();
+            _offsets.pop_front();
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    std::deque<Chunk> _chunks;     // from chunk _first on
+    std::deque<size_t> _offsets;   // of _chunks in the output
+    size_t _first = 0;
+    size_t _num_published_bytes = 0;
+    const size_t _replay_bytes;
+    const size_t _max_lag_bytes;
+    std::map<const Listener*, size_t> _readers;  // the next chunk every reading listener waits for
+    size_t _num_reserved = 0;                    // requests that joined, their reading listener is not attached yet
+    bool _finished = false;
+    bool _ok = false;
+    int _status = 500;
+    size_t _num_listeners = 0;
+    std::shared_ptr<CancellationToken> _token;
+};
+
+/**
+ * @brief The table of the computations in flight: requests for the same key join the running one instead of
+ * starting their own, as long as it can replay its output from the start (see Broadcast). A computation leaves the
+ * table when it lands, so this does not cache finished results.
+ */
+template <typename Key>
+class SingleFlight {
+public:
+    explicit SingleFlight(size_t replay_bytes = Broadcast::DEFAULT_REPLAY_BYTES,
+                          size_t max_lag_bytes = Broadcast::DEFAULT_MAX_LAG_BYTES)
+        : _replay_bytes(replay_bytes),
+          _max_lag_bytes(max_lag_bytes) {}
+
+    // The running broadcast of key, which the caller then reads with a Listener. Or a new one that the caller leads
+    // (leader is set) and must land(), also when the running one is too far along to be replayed: that one keeps
+    // serving its own readers.
+    std::shared_ptr<Broadcast> join(const Key& key, bool& leader) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto [iter, inserted] = _flights.try_emplace(key);
+        leader = inserted || !iter->second->reserve_reader();
+        if (leader)
+            iter->second = std::make_shared<Broadcast>(_replay_bytes, _max_lag_bytes);
+        else
+            ++_num_coalesced;
+        return iter->second;
+    }
+    // the leader is done producing: the requests for key from now on start a new computation
+    void land(const Key& key, const std::shared_ptr<Broadcast>& flight) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto iter = _flights.find(key);
+        if (iter != _flights.end() && iter->second == flight)
+            _flights.erase(iter);
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _flights.size();
+    }
+    // the requests that joined a running computation
+    uint64_t num_coalesced() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _num_coalesced;
+    }
+
+private:
+    const size_t _replay_bytes;
+    const size_t _max_lag_bytes;
+    std::mutex _mutex;
+    std::map<Key, std::shared_ptr<Broadcast>> _flights;
+    uint64_t _num_coalesced = 0;
+};
+}  // namespace melo
+#endif  // SINGLE_FLIGHT_H
@@ -0,0 +1,302 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "server/socket_server.h"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace melo {
+namespace {
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;  // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+void set_timeout(int fd, int option, int seconds) {
+    timeval timeout{};
+    timeout.tv_sec = seconds;
+    setsockopt(fd, SOL_SOCKET, option, &timeout, sizeof(timeout));
+}
+
+std::runtime_error socket_error(const std::string& what) {
+    return std::runtime_error("SocketServer: " + what + ": " + std::strerror(errno));
+}
+}  // namespace
+
+Connection::Connection(int fd, size_t max_head, size_t max_body) : _fd(fd), _max_head(max_head), _max_body(max_body) {
+    set_timeout(_fd, SO_RCVTIMEO, RECEIVE_TIMEOUT_S);
+    set_timeout(_fd, SO_SNDTIMEO, SEND_TIMEOUT_S);
+#ifdef SO_NOSIGPIPE
+    const int on = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+Connection::~Connection() {
+    ::close(_fd);
+}
+
+void Connection::receive() {
+    char block[4096];
+    while (true) {
+        const ssize_t n = ::recv(_fd, block, sizeof(block), 0);
+        if (n > 0) {
+            _buffer.append(block, n);
+            return;
+        }
+        if (n == 0)
+            throw http::Error(400, "the connection was closed before the request was complete");
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            throw http::Error(408, "timed out reading the request");
+        throw http::Error(400, std::string("receive failed: ") + std::strerror(errno));
+    }
+}
+
+http::Request Connection::read_request() {
+    size_t head_end;
+    while ((head_end = _buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (_buffer.size() > _max_head)
+            throw http::Error(431, "the request head exceeds " + std::to_string(_max_head) + " bytes");
+        receive();
+    }
+    if (head_end > _max_head)
+        throw http::Error(431, "the request head exceeds " + std::to_string(_max_head) + " bytes");
+    http::Request request = http::parse_head(std::string_view(_buffer).substr(0, head_end));
+    const size_t length = http::content_length(request, _max_body);
+    _buffer.erase(0, head_end + 4);
+
+    if (_buffer.size() < length) {
+        // e.g. curl waits for this before it sends a large body
+        auto expect = request.header("expect");
+        if (expect && (*expect == "100-continue" || *expect == "100-Continue"))
+            send("HTTP/1.1 100 Continue\r\n\r\n");
+    }
+    while (_buffer.size() < length)
+        receive();
+    request.body = _buffer.substr(0, length);
+    _buffer.erase(0, length);
+    return request;
+}
+
+bool Connection::send(std::string_view data) {
+    while (!_broken && !data.empty()) {
+        const ssize_t n = ::send(_fd, data.data(), data.size(), SEND_FLAGS);
+        if (n > 0) {
+            data.remove_prefix(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            _broken = true;
+        }
+    }
+    return !_broken;
+}
+
+bool Connection::respond(int status, const std::string& content_type, std::string_view body, http::Headers headers) {
+    headers.emplace_back("Content-Type", content_type);
+    headers.emplace_back("Content-Length", std::to_string(body.size()));
+    headers.emplace_back("Connection", "close");
+    return send(http::response_head(status, headers)) && send(body);
+}
+
+bool Connection::begin_chunked(int status, http::Headers headers) {
+    headers.emplace_back("Transfer-Encoding", "chunked");
+    headers.emplace_back("Connection", "close");
+    return send(http::response_head(status, headers));
+}
+
+bool Connection::send_chunk(std::string_view data) {
+    if (data.empty())
+        return !_broken;  // an empty chunk would end the response
+    return send(http::chunk(data));
+}
+
+bool Connection::end_chunked() {
+    return send(http::LAST_CHUNK);
+}
+
+bool Connection::peer_closed(int timeout_ms) {
+#ifdef POLLRDHUP
+    pollfd fd{_fd, POLLIN | POLLRDHUP, 0};
+#else
+    pollfd fd{_fd, POLLIN, 0};
+#endif
+    const int ready = ::poll(&fd, 1, timeout_ms);
+    if (ready <= 0)
+        return false;
+    if (fd.revents & (POLLHUP | POLLERR | POLLNVAL))
+        return true;
+#ifdef POLLRDHUP
+    if (fd.revents & POLLRDHUP)
+        return true;
+#endif
+    char byte;
+    const ssize_t n = ::recv(_fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0)
+        return true;
+    if (n > 0)  // bytes past the request, only a close counts: do not spin on them
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+    return false;
+}
+
+SocketServer::SocketServer(Handler handler, size_t max_connections)
+    : _handler(std::move(handler)),
+      _max_connections(std::max<size_t>(max_connections, 1)) {
+    if (::pipe(_wake) != 0)
+        throw socket_error("pipe");
+    ::fcntl(_wake[1], F_SETFL, O_NONBLOCK);
+}
+
+SocketServer::~SocketServer() {
+    for (int fd : _listeners)
+        ::close(fd);
+    for (const auto& path : _unix_paths)
+        ::unlink(path.c_str());
+    ::close(_wake[0]);
+    ::close(_wake[1]);
+}
+
+void SocketServer::listen_unix(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("SocketServer: invalid Unix socket path " + path);
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    // a socket file left behind by a previous run would make bind fail
+    struct stat info;
+    if (::stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+        ::unlink(path.c_str());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw socket_error("socket");
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        const auto error = socket_error("cannot listen on " + path);
+        ::close(fd);
+        throw error;
+    }
+    _listeners.push_back(fd);
+    _unix_paths.push_back(path);
+    std::cout << "[INFO] SocketServer: listening on unix:" << path << std::endl;
+}
+
+void SocketServer::listen_tcp(const std::string& host, uint16_t port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    addrinfo* addresses = nullptr;
+    const std::string service = std::to_string(port);
+    if (const int error = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses); error != 0)
+        throw std::runtime_error("SocketServer: cannot resolve " + host + ": " + ::gai_strerror(error));
+
+    int fd = -1;
+    for (addrinfo* address = addresses; address && fd < 0; address = address->ai_next) {
+        fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd < 0)
+            continue;
+        const int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (::bind(fd, address->ai_addr, address->ai_addrlen) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ::freeaddrinfo(addresses);
+    if (fd < 0)
+        throw socket_error("cannot listen on " + host + ":" + service);
+    _listeners.push_back(fd);
+    std::cout << "[INFO] SocketServer: listening on http://" << host << ":" << port << std::endl;
+}
+
+void SocketServer::run() {
+    std::vector<pollfd> fds;
+    for (int fd : _listeners)
+        fds.push_back({fd, POLLIN, 0});
+    fds.push_back({_wake[0], POLLIN, 0});
+
+    bool stopping = false;
+    while (!stopping) {
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "[ERROR] SocketServer: poll failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        stopping = fds.back().revents != 0;
+        for (size_t i = 0; i + 1 < fds.size() && !stopping; ++i) {
+            if (!(fds[i].revents & POLLIN))
+                continue;
+            const int fd = ::accept(fds[i].fd, nullptr, nullptr);
+            if (fd < 0)
+                continue;
+            bool accepted = false;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_num_connections < _max_connections) {
+                    ++_num_connections;
+                    accepted = true;
+                }
+            }
+            if (accepted) {
+                std::thread([this, fd] { serve(fd); }).detach();
+            } else {
+                Connection connection(fd, MAX_HEAD, MAX_BODY);
+                connection.respond(503, "text/plain", "too many connections\n", {{"Retry-After", "1"}});
+            }
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this] { return _num_connections == 0; });
+}
+
+void SocketServer::stop() {
+    const char byte = 0;
+    [[maybe_unused]] const ssize_t n = ::write(_wake[1], &byte, 1);
+}
+
+void SocketServer::serve(int fd) {
+    try {
+        Connection connection(fd, MAX_HEAD, MAX_BODY);
+        _handler(connection);
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] SocketServer: " << e.what() << std::endl;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (--_num_connections == 0)
+        _idle.notify_all();
+}
+}  // namespace melo
@@ -0,0 +1,111 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef SOCKET_SERVER_H
+#define SOCKET_SERVER_H
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "server/http.h"
+
+namespace melo {
+/**
+ * @brief One HTTP exchange on an accepted socket, closed on destruction.
+ * The send functions return false once the peer is gone (or stops reading for SEND_TIMEOUT_S), after which nothing
+ * more is sent.
+ */
+class Connection {
+public:
+    static constexpr int RECEIVE_TIMEOUT_S = 30;
+    static constexpr int SEND_TIMEOUT_S = 60;
+
+    Connection(int fd, size_t max_head, size_t max_body);
+    ~Connection();
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    // read the head and the Content-Length body, answering "Expect: 100-continue"; throws http::Error
+    http::Request read_request();
+
+    bool send(std::string_view data);
+    bool respond(int status, const std::string& content_type, std::string_view body, http::Headers headers = {});
+    // a chunked response: the head, any number of non-empty chunks, then the last chunk
+    bool begin_chunked(int status, http::Headers headers);
+    bool send_chunk(std::string_view data);
+    bool end_chunked();
+    inline bool is_broken() const {
+        return _broken;
+    }
+    // Wait up to timeout_ms for the peer to close its end, true once it has. Callable while another thread sends, to
+    // notice a client that gave up while its response is being produced.
+    bool peer_closed(int timeout_ms);
+
+private:
+    // append what the socket has to _buffer, throws http::Error(408) on a timeout and (400) when the peer closed
+    void receive();
+
+    int _fd;
+    size_t _max_head, _max_body;
+    bool _broken = false;
+    std::string _buffer;
+};
+
+/**
+ * @brief Accepts connections on Unix domain and TCP sockets and hands every one to the handler on its own thread.
+ * At most max_connections are handled at a time, the ones above are answered with 503 right away.
+ * POSIX only.
+ */
+class SocketServer {
+public:
+    using Handler = std::function<void(Connection&)>;
+    static constexpr size_t MAX_HEAD = 16 * 1024;
+    static constexpr size_t MAX_BODY = 1024 * 1024;
+
+    SocketServer(Handler handler, size_t max_connections);
+    ~SocketServer();
+    SocketServer(const SocketServer&) = delete;
+    SocketServer& operator=(const SocketServer&) = delete;
+
+    // a stale socket file at path is replaced; throws std::runtime_error when the address cannot be bound
+    void listen_unix(const std::string& path);
+    void listen_tcp(const std::string& host, uint16_t port);
+    // accept until stop(), then wait for the open connections to finish
+    void run();
+    // async-signal-safe, callable from any thread
+    void stop();
+
+private:
+    void serve(int fd);
+
+    Handler _handler;
+    size_t _max_connections;
+    std::vector<int> _listeners;
+    std::vector<std::string> _unix_paths;  // removed on destruction
+    int _wake[2] = {-1, -1};               // stop() writes to _wake[1]
+
+    std::mutex _mutex;
+    std::condition_variable _idle;
+    size_t _num_connections = 0;
+};
+}  // namespace melo
+#endif  // SOCKET_SERVER_H
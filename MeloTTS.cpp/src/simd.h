@@ -0,0 +1,108 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef SIMD_H
+#define SIMD_H
+/**
+ * Instruction sets available to the SIMD kernels (pcm_convert, resampler).
+ *
+ * x86 with GCC/Clang: every kernel is compiled with MELO_SIMD_TARGET("...") and best_isa() checks the CPU at
+ * runtime. MSVC: only the instruction sets the build targets (/arch:AVX2, /arch:AVX512). AArch64: NEON.
+ */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#    include <immintrin.h>
+#    if defined(__GNUC__) || defined(__clang__)
+#        define MELO_SIMD_TARGET(isa) __attribute__((target(isa)))
+#        define MELO_SIMD_RUNTIME_DISPATCH
+#        define MELO_SIMD_SSE2
+#        define MELO_SIMD_AVX2
+#        define MELO_SIMD_AVX512
+#    else
+#        define MELO_SIMD_TARGET(isa)
+#        if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#            define MELO_SIMD_SSE2
+#        endif
+#        if defined(__AVX2__)
+#            define MELO_SIMD_AVX2
+#        endif
+#        if defined(__AVX512F__)
+#            define MELO_SIMD_AVX512
+#        endif
+#    endif
+// GCC's AVX-512 headers use self-initialized _mm512_undefined_* placeholders, which trip -Wuninitialized
+#    if defined(__GNUC__) && !defined(__clang__)
+#        define MELO_SIMD_AVX512_BEGIN                                                     \
+            _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wuninitialized\"") \
+                _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#        define MELO_SIMD_AVX512_END _Pragma("GCC diagnostic pop")
+#    else
+#        define MELO_SIMD_AVX512_BEGIN
+#        define MELO_SIMD_AVX512_END
+#    endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#    include <arm_neon.h>
+#    define MELO_SIMD_NEON
+#endif
+
+namespace melo::simd {
+enum class Isa { Scalar, Sse2, Avx2, Avx512, Neon };
+
+// AVX2 implies FMA here, every AVX2 CPU we target has both
+inline Isa detect_isa() {
+#if defined(MELO_SIMD_RUNTIME_DISPATCH)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return Isa::Avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return Isa::Avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return Isa::Sse2;
+#elif defined(MELO_SIMD_AVX512)
+    return Isa::Avx512;
+#elif defined(MELO_SIMD_AVX2)
+    return Isa::Avx2;
+#elif defined(MELO_SIMD_SSE2)
+    return Isa::Sse2;
+#elif defined(MELO_SIMD_NEON)
+    return Isa::Neon;
+#endif
+    return Isa::Scalar;
+}
+
+// detected once per process
+inline Isa best_isa() {
+    static const Isa isa = detect_isa();
+    return isa;
+}
+
+inline const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::Sse2:
+            return "sse2";
+        case Isa::Avx2:
+            return "avx2";
+        case Isa::Avx512:
+            return "avx512";
+        case Isa::Neon:
+            return "neon";
+        default:
+            return "scalar";
+    }
+}
+}  // namespace melo::simd
+#endif  // SIMD_H
@@ -21,10 +21,13 @@
 #include <fstream>
 #include <iostream>
 #include <locale>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
 
+#include "utf8_utils.h"
+
 #ifdef _WIN32
 #define NOGDI
 #define NOCRYPT
@@ -49,6 +52,7 @@ std::wstring readFile(const std::string& filename) {
     return buffer.str();
 }
 // 保存映射到二进制文件
+// 文件格式: size_t 条目数, 之后每个条目为两个 UTF-16 码元 (key, value), 与 wchar_t 的平台宽度无关
 void save_map_to_binary_file(const std::unordered_map<wchar_t, wchar_t>& map, const std::string& filename) {
     std::ofstream file(filename, std::ios::binary);
     if (!file.is_open()) {
@@ -60,8 +64,10 @@ void save_map_to_binary_file(const std::unordered_map<wchar_t, wchar_t>& map, co
     file.write(reinterpret_cast<const char*>(&size), sizeof(size));
 
     for (const auto& pair : map) {
-        file.write(reinterpret_cast<const char*>(&pair.first), sizeof(pair.first));
-        file.write(reinterpret_cast<const char*>(&pair.second), sizeof(pair.second));
+        char16_t key = static_cast<char16_t>(pair.first);
+        char16_t value = static_cast<char16_t>(pair.second);
+        file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
     }
     file.close();
 }
@@ -74,15 +80,20 @@ std::unordered_map<wchar_t, wchar_t> load_map_from_binary_file(const std::string
         return map;
     }
 
-    size_t size;
+    size_t size = 0;
     file.read(reinterpret_cast<char*>(&size), sizeof(size));
+    map.reserve(size);
 
-    wchar_t key, value;
-    for (size_t i = 0; i < size; ++i) {
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
-        file.read(reinterpret_cast<char*>(&value), sizeof(value));
-        map[key] = value;
+    // the records are UTF-16 code units, wchar_t is 4 bytes on Linux so it can not be read directly
+    char16_t key, value;
+    for (size_t i = 0; i < size && file.read(reinterpret_cast<char*>(&key), sizeof(key)) &&
+                       file.read(reinterpret_cast<char*>(&value), sizeof(value));
+         ++i) {
+        map[static_cast<wchar_t>(key)] = static_cast<wchar_t>(value);
     }
+    if (map.size() != size)
+        std::cerr << "[ERROR] load_map_from_binary_file:: " << filename << " is truncated, loaded " << map.size()
+                  << " of " << size << " entries\n";
     file.close();
     return map;
 }
@@ -110,20 +121,18 @@ std::unordered_map<wchar_t, wchar_t> load_map_from_binary_file(const std::string
 //    //save_map_to_binary_file(t2s_dict, L"t2s_map.bin");
 //}
 std::string wstring_to_string(const std::wstring& wstr) {
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-    return converter.to_bytes(wstr);
+    return melo::utf8::to_string(wstr);
 }
 std::wstring string_to_wstring(const std::string& str) {
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-    return converter.from_bytes(str);
+    return melo::utf8::to_wstring(str);
 }
 // 将繁体转换为简体
 std::wstring traditional_to_simplified(const std::wstring& text) {
     std::wstring result;
 
     for (wchar_t ch : text) {
-        if (t2s_dict.find(ch) != t2s_dict.end()) {
-            result += t2s_dict[ch];
+        if (auto iter = t2s_dict.find(ch); iter != t2s_dict.end()) {
+            result += iter->second;
         } else {
             result += ch;  // 保持原字符
         }
@@ -136,8 +145,8 @@ std::wstring simplified_to_traditional(const std::wstring& text) {
     std::wstring result;
 
     for (wchar_t ch : text) {
-        if (s2t_dict.find(ch) != s2t_dict.end()) {
-            result += s2t_dict[ch];
+        if (auto iter = s2t_dict.find(ch); iter != s2t_dict.end()) {
+            result += iter->second;
         } else {
             result += ch;  // 保持原字符
         }
@@ -146,11 +155,14 @@ std::wstring simplified_to_traditional(const std::wstring& text) {
     return result;
 }
 void initialize_char_maps(const std::filesystem::path& char_map_folder) {
-    std::filesystem::path s2t_path = char_map_folder / "s2t_map.bin";
-    std::filesystem::path t2s_map = char_map_folder / "t2s_map.bin";
-    // 从二进制文件加载映射
-    s2t_dict = load_map_from_binary_file(s2t_path.string());
-    t2s_dict = load_map_from_binary_file(t2s_map.string());
+    static std::once_flag loaded;
+    std::call_once(loaded, [&] {
+        std::filesystem::path s2t_path = char_map_folder / "s2t_map.bin";
+        std::filesystem::path t2s_map = char_map_folder / "t2s_map.bin";
+        // 从二进制文件加载映射
+        s2t_dict = load_map_from_binary_file(s2t_path.string());
+        t2s_dict = load_map_from_binary_file(t2s_map.string());
+    });
 }
 }  // namespace text_normalization
 
@@ -24,6 +24,7 @@ namespace text_normalization {
 extern std::unordered_map<wchar_t, wchar_t> s2t_dict;
 extern std::unordered_map<wchar_t, wchar_t> t2s_dict;
 
+// Loads the maps above once per process, later calls keep them: they are read without a lock
 void initialize_char_maps(const std::filesystem::path& char_map_folder);
 // 从文件中读取字符串
 std::wstring readFile(const std::string& filename);
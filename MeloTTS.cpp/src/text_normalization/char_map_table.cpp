@@ -0,0 +1,70 @@
+/**
+ * Copyright      2025    Alex G Chen (alex.g.chen@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "char_map_table.h"
+
+#include <iostream>
+
+namespace text_normalization {
+CharMapTable::CharMapTable() : _pages(1) {}
+
+void CharMapTable::set(char32_t code_point, std::wstring_view replacement) {
+    if (code_point > 0xFFFF) {
+        std::cerr << "[ERROR] CharMapTable::set: code point out of BMP: " << static_cast<uint32_t>(code_point) << "\n";
+        return;
+    }
+    size_t page = code_point >> PAGE_BITS;
+    if (_page_index[page] == 0) {
+        _page_index[page] = static_cast<uint16_t>(_pages.size());
+        _pages.emplace_back();
+    }
+    Entry& entry = _pages[_page_index[page]][code_point & (PAGE_SIZE - 1)];
+    // mapping a character to itself is the same as no mapping
+    if (replacement.size() == 1 && static_cast<char32_t>(replacement.front()) == code_point)
+        replacement = {};
+    if (entry.length == 0 && !replacement.empty())
+        ++_size;
+    else if (entry.length != 0 && replacement.empty())
+        --_size;
+    // an overwritten entry reuses its slot when the replacement fits
+    if (replacement.size() > entry.capacity) {
+        entry.offset = static_cast<uint32_t>(_pool.size());
+        entry.capacity = static_cast<uint32_t>(replacement.size());
+        _pool.append(replacement);
+    } else {
+        _pool.replace(entry.offset, replacement.size(), replacement);
+    }
+    entry.length = static_cast<uint32_t>(replacement.size());
+}
+
+void CharMapTable::translate(std::wstring_view input, std::wstring& output) const {
+    output.reserve(output.size() + input.size());
+    for (wchar_t ch : input) {
+        std::wstring_view replacement = find(static_cast<char32_t>(ch));
+        if (replacement.empty())
+            output += ch;
+        else
+            output.append(replacement);
+    }
+}
+
+std::wstring CharMapTable::translate(std::wstring_view input) const {
+    std::wstring output;
+    translate(input, output);
+    return output;
+}
+}  // namespace text_normalization
@@ -0,0 +1,74 @@
+/**
+ * Copyright      2025    Alex G Chen (alex.g.chen@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef CHAR_MAP_TABLE_H
+#define CHAR_MAP_TABLE_H
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace text_normalization {
+// 码点转换表: a flat two-level array over the BMP that maps a code point to a replacement string.
+// The high byte of the code point selects a page and the low byte selects the entry inside the page.
+// Pages without any mapping share the identity page, so a lookup is always two array reads and
+// code points outside the BMP are passed through unchanged.
+class CharMapTable {
+public:
+    CharMapTable();
+
+    void set(char32_t code_point, std::wstring_view replacement);
+    // returns an empty view if the code point maps to itself
+    inline std::wstring_view find(char32_t code_point) const {
+        if (code_point > 0xFFFF)
+            return {};
+        const Entry& entry = _pages[_page_index[code_point >> PAGE_BITS]][code_point & (PAGE_SIZE - 1)];
+        return std::wstring_view(_pool.data() + entry.offset, entry.length);
+    }
+    inline bool contains(char32_t code_point) const {
+        return !find(code_point).empty();
+    }
+    // Translate every character of input in one linear pass and append the result to output.
+    void translate(std::wstring_view input, std::wstring& output) const;
+    std::wstring translate(std::wstring_view input) const;
+    inline size_t size() const {
+        return _size;
+    }
+    // characters held for the replacements, overwritten mappings included
+    inline size_t pool_size() const {
+        return _pool.size();
+    }
+
+private:
+    struct Entry {
+        uint32_t offset = 0;
+        uint32_t length = 0;    // 0 means identity
+        uint32_t capacity = 0;  // characters of _pool owned by the entry from offset, kept when it is overwritten
+    };
+    static constexpr size_t PAGE_BITS = 8;
+    static constexpr size_t PAGE_SIZE = 1 << PAGE_BITS;
+    static constexpr size_t NUM_PAGES = 0x10000 >> PAGE_BITS;
+
+    std::vector<std::array<Entry, PAGE_SIZE>> _pages;  // _pages[0] is the shared identity page
+    std::array<uint16_t, NUM_PAGES> _page_index{};
+    std::wstring _pool;  // replacement strings stored back to back
+    size_t _size = 0;
+};
+}  // namespace text_normalization
+#endif
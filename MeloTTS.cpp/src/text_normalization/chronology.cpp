@@ -39,7 +39,7 @@ std::wregex RE_DATE2(LR"((\d{4})([- /.])(0[1-9]|1[012])\2(0[1-9]|[12][0-9]|3[01]
 std::wstring _time_num2str(const std::wstring& num_string) {
     std::wstring result = num2str(num_string.substr(num_string.find_first_not_of(L'0')));
     if (num_string[0] == L'0') {
-        result = DIGITS[L'0'] + result;
+        result = reading_of(DIGITS, L'0') + result;
     }
     return result;
 }
@@ -31,6 +31,7 @@ extern std::unordered_map<wchar_t, wchar_t> H2F_PUNCTUATIONS;
 extern std::unordered_map<wchar_t, wchar_t> F2H_SPACE;
 extern std::unordered_map<wchar_t, wchar_t> H2F_SPACE;
 
+// Fills the maps above once per process: they are read without a lock
 void initialize_constant_maps();
 std::wstring fullwidth_to_halfwidth(const std::wstring& input);
 std::wstring halfwidth_to_fullwidth(const std::wstring& input);
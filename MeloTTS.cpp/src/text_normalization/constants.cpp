@@ -18,6 +18,7 @@
 #include <cctype>
 #include <cwchar>  // 用于宽字符处理
 #include <iostream>
+#include <mutex>
 #include <regex>
 #include <string>
 #include <unordered_map>
@@ -42,46 +43,49 @@ std::unordered_map<wchar_t, wchar_t> F2H_SPACE;
 std::unordered_map<wchar_t, wchar_t> H2F_SPACE;
 // 初始化字符映射
 void initialize_constant_maps() {
-    // ASCII 字母 全角 -> 半角
-    for (wchar_t ch = L'a'; ch <= L'z'; ++ch) {
-        F2H_ASCII_LETTERS[ch + 65248] = ch;
-        H2F_ASCII_LETTERS[ch] = ch + 65248;
-    }
-    for (wchar_t ch = L'A'; ch <= L'Z'; ++ch) {
-        F2H_ASCII_LETTERS[ch + 65248] = ch;
-        H2F_ASCII_LETTERS[ch] = ch + 65248;
-    }
+    static std::once_flag initialized;
+    std::call_once(initialized, [] {
+        // ASCII 字母 全角 -> 半角
+        for (wchar_t ch = L'a'; ch <= L'z'; ++ch) {
+            F2H_ASCII_LETTERS[ch + 65248] = ch;
+            H2F_ASCII_LETTERS[ch] = ch + 65248;
+        }
+        for (wchar_t ch = L'A'; ch <= L'Z'; ++ch) {
+            F2H_ASCII_LETTERS[ch + 65248] = ch;
+            H2F_ASCII_LETTERS[ch] = ch + 65248;
+        }
 
-    // 数字字符 全角 -> 半角
-    for (wchar_t ch = L'0'; ch <= L'9'; ++ch) {
-        F2H_DIGITS[ch + 65248] = ch;
-        H2F_DIGITS[ch] = ch + 65248;
-    }
+        // 数字字符 全角 -> 半角
+        for (wchar_t ch = L'0'; ch <= L'9'; ++ch) {
+            F2H_DIGITS[ch + 65248] = ch;
+            H2F_DIGITS[ch] = ch + 65248;
+        }
 
-    // 标点符号 全角 -> 半角
-    std::wstring punctuations = L"!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
-    for (wchar_t ch : punctuations) {
-        F2H_PUNCTUATIONS[ch + 65248] = ch;
-        H2F_PUNCTUATIONS[ch] = ch + 65248;
-    }
+        // 标点符号 全角 -> 半角
+        std::wstring punctuations = L"!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+        for (wchar_t ch : punctuations) {
+            F2H_PUNCTUATIONS[ch + 65248] = ch;
+            H2F_PUNCTUATIONS[ch] = ch + 65248;
+        }
 
-    // 空格 全角 -> 半角
-    F2H_SPACE[L'\u3000'] = L' ';
-    H2F_SPACE[L' '] = L'\u3000';
+        // 空格 全角 -> 半角
+        F2H_SPACE[L'\u3000'] = L' ';
+        H2F_SPACE[L' '] = L'\u3000';
+    });
 }
 
 // 将全角字符转换为半角
 std::wstring fullwidth_to_halfwidth(const std::wstring& input) {
     std::wstring result;
     for (wchar_t ch : input) {
-        if (F2H_ASCII_LETTERS.count(ch)) {
-            result += F2H_ASCII_LETTERS[ch];
-        } else if (F2H_DIGITS.count(ch)) {
-            result += F2H_DIGITS[ch];
-        } else if (F2H_PUNCTUATIONS.count(ch)) {
-            result += F2H_PUNCTUATIONS[ch];
-        } else if (F2H_SPACE.count(ch)) {
-            result += F2H_SPACE[ch];
+        if (auto iter = F2H_ASCII_LETTERS.find(ch); iter != F2H_ASCII_LETTERS.end()) {
+            result += iter->second;
+        } else if (auto iter = F2H_DIGITS.find(ch); iter != F2H_DIGITS.end()) {
+            result += iter->second;
+        } else if (auto iter = F2H_PUNCTUATIONS.find(ch); iter != F2H_PUNCTUATIONS.end()) {
+            result += iter->second;
+        } else if (auto iter = F2H_SPACE.find(ch); iter != F2H_SPACE.end()) {
+            result += iter->second;
         } else {
             result += ch;  // 如果没有匹配，保持原字符
         }
@@ -93,14 +97,14 @@ std::wstring fullwidth_to_halfwidth(const std::wstring& input) {
 std::wstring halfwidth_to_fullwidth(const std::wstring& input) {
     std::wstring result;
     for (wchar_t ch : input) {
-        if (H2F_ASCII_LETTERS.count(ch)) {
-            result += H2F_ASCII_LETTERS[ch];
-        } else if (H2F_DIGITS.count(ch)) {
-            result += H2F_DIGITS[ch];
-        } else if (H2F_PUNCTUATIONS.count(ch)) {
-            result += H2F_PUNCTUATIONS[ch];
-        } else if (H2F_SPACE.count(ch)) {
-            result += H2F_SPACE[ch];
+        if (auto iter = H2F_ASCII_LETTERS.find(ch); iter != H2F_ASCII_LETTERS.end()) {
+            result += iter->second;
+        } else if (auto iter = H2F_DIGITS.find(ch); iter != H2F_DIGITS.end()) {
+            result += iter->second;
+        } else if (auto iter = H2F_PUNCTUATIONS.find(ch); iter != H2F_PUNCTUATIONS.end()) {
+            result += iter->second;
+        } else if (auto iter = H2F_SPACE.find(ch); iter != H2F_SPACE.end()) {
+            result += iter->second;
         } else {
             result += ch;  // 如果没有匹配，保持原字符
         }
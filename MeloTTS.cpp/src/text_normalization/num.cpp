@@ -36,7 +36,7 @@
 
 namespace text_normalization {
 // 数字和单位的映射
-std::unordered_map<wchar_t, std::wstring> DIGITS = {{L'0', L"零"},
+const std::unordered_map<wchar_t, std::wstring> DIGITS = {{L'0', L"零"},
                                                     {L'1', L"一"},
                                                     {L'2', L"二"},
                                                     {L'3', L"三"},
@@ -47,9 +47,9 @@ std::unordered_map<wchar_t, std::wstring> DIGITS = {{L'0', L"零"},
                                                     {L'8', L"八"},
                                                     {L'9', L"九"}};
 
-std::map<int, std::wstring> UNITS = {{1, L"十"}, {2, L"百"}, {3, L"千"}, {4, L"万"}, {8, L"亿"}};
+const std::map<int, std::wstring> UNITS = {{1, L"十"}, {2, L"百"}, {3, L"千"}, {4, L"万"}, {8, L"亿"}};
 
-std::unordered_map<wchar_t, std::wstring> asmd_map = {
+const std::unordered_map<wchar_t, std::wstring> asmd_map = {
     {L'+', L"加"},
     {L'-', L"减"},
     {L'×', L"乘"},
@@ -123,14 +123,14 @@ std::wstring replace_default_num(const std::wsmatch& match) {
     std::wstring number = match.str(0);
     std::wstring result;
     for (wchar_t digit : number) {
-        result += DIGITS[digit];
+        result += reading_of(DIGITS, digit);
     }
     return match.prefix().str() + result + match.suffix().str();
 }
 
 // 四则运算替换
 std::wstring replace_asmd(const std::wsmatch& match) {
-    std::wstring result = match.str(1) + asmd_map[match.str(8)[0]] + match.str(9);
+    std::wstring result = match.str(1) + reading_of(asmd_map, match.str(8)[0]) + match.str(9);
     return match.prefix().str() + result + match.suffix().str();
 }
 // 加、减、乘、除、大于、小于、等于
@@ -215,9 +215,9 @@ std::vector<std::wstring> _get_value(const std::wstring& value_string, bool use_
         return {};
     } else if (stripped.size() == 1) {
         if (use_zero && stripped.size() < value_string.size()) {
-            return {DIGITS[L'0'], DIGITS[stripped[0]]};
+            return {reading_of(DIGITS, L'0'), reading_of(DIGITS, stripped[0])};
         } else {
-            return {DIGITS[stripped[0]]};
+            return {reading_of(DIGITS, stripped[0])};
         }
     } else {
         int largest_unit = 0;
@@ -230,7 +230,7 @@ std::vector<std::wstring> _get_value(const std::wstring& value_string, bool use_
         std::wstring first_part = value_string.substr(0, value_string.size() - largest_unit);
         std::wstring second_part = value_string.substr(value_string.size() - largest_unit);
         std::vector<std::wstring> result = _get_value(first_part);
-        result.push_back(UNITS[largest_unit]);
+        result.push_back(UNITS.at(largest_unit));
         std::vector<std::wstring> second_result = _get_value(second_part);
 
         // 判断第二部分是否全为 '0'，如果是，则不再递归处理
@@ -251,11 +251,12 @@ std::wstring verbalize_cardinal(const std::wstring& value_string) {
     std::wstring stripped = value_string;
     stripped.erase(0, std::min(stripped.find_first_not_of(L'0'), stripped.size() - 1));
     if (stripped.empty()) {
-        return DIGITS[L'0'];
+        return reading_of(DIGITS, L'0');
     }
 
     std::vector<std::wstring> result_symbols = _get_value(value_string);
-    if (result_symbols.size() >= 2 && result_symbols[0] == DIGITS[L'1'] && result_symbols[1] == UNITS[1]) {
+    if (result_symbols.size() >= 2 && result_symbols[0] == reading_of(DIGITS, L'1') &&
+        result_symbols[1] == UNITS.at(1)) {
         result_symbols.erase(result_symbols.begin());
     }
     std::wstring result;
@@ -268,7 +269,7 @@ std::wstring verbalize_cardinal(const std::wstring& value_string) {
 std::wstring verbalize_digit(const std::wstring& value_string, bool alt_one) {
     std::wstring result;
     for (wchar_t digit : value_string) {
-        result += DIGITS[digit];
+        result += reading_of(DIGITS, digit);
     }
     // 替换 "一" 为 "幺"
     if (alt_one) {
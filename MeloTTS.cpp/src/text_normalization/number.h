@@ -28,9 +28,16 @@
 #include <vector>
 
 namespace text_normalization {
-extern std::unordered_map<wchar_t, std::wstring> DIGITS;
-extern std::map<int, std::wstring> UNITS;
-extern std::unordered_map<wchar_t, std::wstring> asmd_map;
+// read-only, shared by the threads that normalize text
+extern const std::unordered_map<wchar_t, std::wstring> DIGITS;
+extern const std::map<int, std::wstring> UNITS;
+extern const std::unordered_map<wchar_t, std::wstring> asmd_map;
+// the reading of ch in readings, empty when it has none
+inline const std::wstring& reading_of(const std::unordered_map<wchar_t, std::wstring>& readings, wchar_t ch) {
+    static const std::wstring none;
+    auto iter = readings.find(ch);
+    return iter != readings.end() ? iter->second : none;
+}
 extern std::wregex re_frac;
 extern std::wregex re_percentage;
 extern std::wregex re_negative_num;
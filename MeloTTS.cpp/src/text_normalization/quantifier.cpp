@@ -23,7 +23,7 @@
 #include "number.h"
 
 namespace text_normalization {
-std::unordered_map<std::wstring, std::wstring> measure_dict = {
+const std::unordered_map<std::wstring, std::wstring> measure_dict = {
     {L"cm2", L"平方厘米"},
     {L"cm²", L"平方厘米"},
     {L"cm3", L"立方厘米"},
@@ -24,7 +24,7 @@
 #include <unordered_map>
 namespace text_normalization {
 // extern unordered_map<string, string> measure_dict;
-extern std::unordered_map<std::wstring, std::wstring> measure_dict;
+extern const std::unordered_map<std::wstring, std::wstring> measure_dict;
 // extern regex re_temperature;
 extern std::wregex re_temperature;
 
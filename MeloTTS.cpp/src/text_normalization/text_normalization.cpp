@@ -21,9 +21,12 @@
 #include <iostream>
 #include <regex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "char_convert.h"
+#include "char_map_table.h"
 #include "chronology.h"
 #include "constant.h"
 #include "number.h"
@@ -45,11 +48,12 @@ TextNormalizer::TextNormalizer(const std::filesystem::path& char_map_folder)
     : SENTENCE_SPLITOR(L"([：、；。？！;?!][”’]?)") {
     initialize_constant_maps();
     initialize_char_maps(char_map_folder);
+    build_char_map_table();
     std::cout << "[INFO] TextNormalizer is constructed!\n";
 }
 
 // 分割函数
-std::vector<std::wstring> TextNormalizer::split(const std::wstring& text, const std::wstring& lang) {
+std::vector<std::wstring> TextNormalizer::split(const std::wstring& text, const std::wstring& lang) const {
     std::wstring modified_text = text;
     if (lang == L"zh") {
         // modified_text.erase(std::remove(modified_text.begin(), modified_text.end(), L' '), modified_text.end());
@@ -71,64 +75,93 @@ std::vector<std::wstring> TextNormalizer::split(const std::wstring& text, const
     return sentences;
 }
 
+namespace {
+// 单字符符号的读法, 与位置无关, 因此可以并入查表
+const std::pair<wchar_t, const wchar_t*> SYMBOL_VERBALIZATIONS[] = {
+    {L'①', L"一"},        {L'②', L"二"},       {L'③', L"三"},         {L'④', L"四"},       {L'⑤', L"五"},
+    {L'⑥', L"六"},        {L'⑦', L"七"},       {L'⑧', L"八"},         {L'⑨', L"九"},       {L'⑩', L"十"},
+    {L'α', L"阿尔法"},    {L'β', L"贝塔"},     {L'γ', L"伽玛"},       {L'Γ', L"伽玛"},     {L'δ', L"德尔塔"},
+    {L'Δ', L"德尔塔"},    {L'ε', L"艾普西龙"}, {L'ζ', L"捷塔"},       {L'η', L"依塔"},     {L'θ', L"西塔"},
+    {L'Θ', L"西塔"},      {L'ι', L"艾欧塔"},   {L'κ', L"喀帕"},       {L'λ', L"拉姆达"},   {L'Λ', L"拉姆达"},
+    {L'μ', L"缪"},        {L'ν', L"拗"},       {L'ξ', L"克西"},       {L'Ξ', L"克西"},     {L'ο', L"欧米克伦"},
+    {L'π', L"派"},        {L'Π', L"派"},       {L'ρ', L"肉"},         {L'ς', L"西格玛"},   {L'σ', L"西格玛"},
+    {L'Σ', L"西格玛"},    {L'τ', L"套"},       {L'υ', L"宇普西龙"},   {L'φ', L"服艾"},     {L'Φ', L"服艾"},
+    {L'χ', L"器"},        {L'ψ', L"普赛"},     {L'Ψ', L"普赛"},       {L'ω', L"欧米伽"},   {L'Ω', L"欧米伽"},
+    {L'@', L" at "},      {L'嗯', L"恩"},      {L'呣', L"母"},
+};
+
+void replace_all(std::wstring& text, std::wstring_view from, std::wstring_view to) {
+    size_t pos = text.find(from);
+    if (pos == std::wstring::npos)
+        return;
+    std::wstring result;
+    result.reserve(text.size());
+    size_t last = 0;
+    for (; pos != std::wstring::npos; pos = text.find(from, last)) {
+        result.append(text, last, pos - last);
+        result.append(to);
+        last = pos + from.size();
+    }
+    result.append(text, last, std::wstring::npos);
+    text.swap(result);
+}
+}  // namespace
+
+// 将 繁体转简体, 全角转半角 和 单字符符号读法 合成一张码点转换表
+// 每个码点依次经过 t2s -> f2h -> 符号读法, 结果与原来分三遍处理一致
+void TextNormalizer::build_char_map_table() {
+    std::unordered_map<wchar_t, std::wstring> verbalizations;
+    for (const auto& [ch, reading] : SYMBOL_VERBALIZATIONS)
+        verbalizations.emplace(ch, reading);
+
+    auto fullwidth_to_halfwidth_char = [](wchar_t ch) {
+        for (const auto* table : {&F2H_ASCII_LETTERS, &F2H_DIGITS, &F2H_PUNCTUATIONS, &F2H_SPACE}) {
+            auto iter = table->find(ch);
+            if (iter != table->end())
+                return iter->second;
+        }
+        return ch;
+    };
+
+    for (char32_t cp = 0; cp <= 0xFFFF; ++cp) {
+        if (cp >= 0xD800 && cp <= 0xDFFF)  // surrogates
+            continue;
+        wchar_t ch = static_cast<wchar_t>(cp);
+        auto t2s_iter = t2s_dict.find(ch);
+        if (t2s_iter != t2s_dict.end())
+            ch = t2s_iter->second;
+        ch = fullwidth_to_halfwidth_char(ch);
+        auto verbalization_iter = verbalizations.find(ch);
+        if (verbalization_iter != verbalizations.end())
+            _char_map_table.set(cp, verbalization_iter->second);
+        else if (static_cast<char32_t>(ch) != cp)
+            _char_map_table.set(cp, std::wstring_view(&ch, 1));
+    }
+    std::cout << "[INFO] TextNormalizer::build_char_map_table: " << _char_map_table.size() << " code points mapped\n";
+}
+
+std::wstring TextNormalizer::map_chars(const std::wstring& sentence) const {
+    return _char_map_table.translate(sentence);
+}
+
 // 后处理替换函数
-std::wstring TextNormalizer::post_replace(const std::wstring& sentence) {
+// 单字符替换已经在 map_chars 中完成, 这里只保留依赖上下文或顺序的规则:
+// '/' 在分数和日期规则之后才能读作 "每", 网址需要匹配多个字符
+std::wstring TextNormalizer::post_replace(const std::wstring& sentence) const {
     std::wstring modified_sentence = sentence;
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"/"), L"每");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"①"), L"一");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"②"), L"二");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"③"), L"三");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"④"), L"四");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"⑤"), L"五");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"⑥"), L"六");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"⑦"), L"七");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"⑧"), L"八");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"⑨"), L"九");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"⑩"), L"十");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"α"), L"阿尔法");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"β"), L"贝塔");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"γ|Γ"), L"伽玛");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"δ|Δ"), L"德尔塔");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"ε"), L"艾普西龙");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"ζ"), L"捷塔");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"η"), L"依塔");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"θ|Θ"), L"西塔");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"ι"), L"艾欧塔");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"κ"), L"喀帕");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"λ|Λ"), L"拉姆达");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"μ"), L"缪");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"ν"), L"拗");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"ξ|Ξ"), L"克西");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"ο"), L"欧米克伦");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"π|Π"), L"派");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"ρ"), L"肉");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"ς|σ|Σ"), L"西格玛");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"τ"), L"套");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"υ"), L"宇普西龙");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"φ|Φ"), L"服艾");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"χ"), L"器");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"ψ|Ψ"), L"普赛");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"ω|Ω"), L"欧米伽");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"@"), L" at ");
-    // Regular expression to match "www."
-    // Explanation of "www\\.":
-    // - In regular expressions, "." matches any character. To match a literal ".", we use "\."
-    // - In C++ strings, "\" needs to be escaped as "\\". So "\." becomes "\\." in C++ code.
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"www\\."), L" www dot ");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"\\.com"), L" dot come ");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"嗯"), L"恩");
-    modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"呣"), L"母");
+    replace_all(modified_sentence, L"/", L"每");
+    replace_all(modified_sentence, L"www.", L" www dot ");
+    replace_all(modified_sentence, L".com", L" dot come ");
     // modified_sentence = std::regex_replace(modified_sentence, std::wregex(L"([-——《》【】<=>{}()（）#&@“”^_|\\\\])"),
     // L"");
     return modified_sentence;
 }
 
-std::wstring TextNormalizer::normalize_sentence(const std::wstring& sentence) {
+std::wstring TextNormalizer::normalize_sentence(const std::wstring& sentence) const {
     std::wstring modified_sentence = sentence;
     std::wsmatch match;
-    modified_sentence = traditional_to_simplified(modified_sentence);  // char_convert 繁体转简体
-
-    modified_sentence = fullwidth_to_halfwidth(modified_sentence);  // constants 全角转半角
+    // 繁体转简体, 全角转半角, 单字符符号读法
+    modified_sentence = map_chars(modified_sentence);
 
     // number related NSW verbalization
 
@@ -217,7 +250,7 @@ std::wstring TextNormalizer::normalize_sentence(const std::wstring& sentence) {
     return modified_sentence;
 }
 
-std::vector<std::wstring> TextNormalizer::normalize(const std::wstring& text) {
+std::vector<std::wstring> TextNormalizer::normalize(const std::wstring& text) const {
     std::vector<std::wstring> sentences = split(text);
     for (auto& sentence : sentences) {
         sentence = normalize_sentence(sentence);
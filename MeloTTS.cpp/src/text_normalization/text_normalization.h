@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "char_convert.h"
+#include "char_map_table.h"
 #include "chronology.h"
 #include "constant.h"
 #include "number.h"
@@ -34,13 +35,19 @@ namespace text_normalization {
 class TextNormalizer {
 public:
     explicit TextNormalizer(const std::filesystem::path& char_map_folder);
-    std::vector<std::wstring> split(const std::wstring& text, const std::wstring& lang = L"zh");
-    std::wstring post_replace(const std::wstring& sentence);
-    std::wstring normalize_sentence(const std::wstring& sentence);
-    std::vector<std::wstring> normalize(const std::wstring& text);
+    // the methods below only read the tables built by the constructor and may run on several threads at once
+    std::vector<std::wstring> split(const std::wstring& text, const std::wstring& lang = L"zh") const;
+    std::wstring post_replace(const std::wstring& sentence) const;
+    std::wstring normalize_sentence(const std::wstring& sentence) const;
+    std::vector<std::wstring> normalize(const std::wstring& text) const;
+    // 繁体转简体 + 全角转半角 + 单字符符号读法, 一次查表完成
+    std::wstring map_chars(const std::wstring& sentence) const;
 
 private:
+    void build_char_map_table();
+
     std::wregex SENTENCE_SPLITOR;
+    CharMapTable _char_map_table;
 };
 }  // namespace text_normalization
 
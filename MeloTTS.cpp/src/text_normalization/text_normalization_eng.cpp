@@ -17,221 +17,361 @@
  */
 #include "text_normalization_eng.h"
 
-#include <cmath>
-#include <iostream>
-#include <regex>
-#include <unordered_map>
+#include <cstdint>
+#include <limits>
+#include <utility>
 
 namespace text_normalization {
+namespace {
+constexpr std::string_view BELOW_TWENTY[] = {
+    "zero",    "one",     "two",       "three",    "four",     "five",    "six",
+    "seven",   "eight",   "nine",      "ten",      "eleven",   "twelve",  "thirteen",
+    "fourteen", "fifteen", "sixteen",  "seventeen", "eighteen", "nineteen"};
+constexpr std::string_view TENS[] = {"", "", "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety"};
+// 2^64 - 1 = 18,446,744,073,709,551,615 needs 7 groups of three digits
+constexpr std::string_view SCALES[] =
+    {"", "thousand", "million", "billion", "trillion", "quadrillion", "quintillion"};
+// irregular ordinals, the others append "th" or turn the trailing "y" into "ieth"
+constexpr std::pair<std::string_view, std::string_view> IRREGULAR_ORDINALS[] = {
+    {"one", "first"},
+    {"two", "second"},
+    {"three", "third"},
+    {"five", "fifth"},
+    {"eight", "eighth"},
+    {"nine", "ninth"},
+    {"twelve", "twelfth"}};
+// List of (abbreviation, replacement) pairs for abbreviations in English, matched case-insensitively when followed by
+// a "." at the start of a word
+constexpr std::pair<std::string_view, std::string_view> ABBREVIATIONS_EN[] = {
+    {"mrs", "misess"},     {"mr", "mister"},    {"dr", "doctor"},     {"st", "saint"},       {"co", "company"},
+    {"jr", "junior"},      {"maj", "major"},    {"gen", "general"},   {"drs", "doctors"},    {"rev", "reverend"},
+    {"lt", "lieutenant"},  {"hon", "honorable"}, {"sgt", "sergeant"}, {"capt", "captain"},   {"esq", "esquire"},
+    {"ltd", "limited"},    {"col", "colonel"},  {"ft", "fort"}};
 
-// normalize_numbers
-const std::regex decimal_number_re(R"(([0-9]+\.[0-9]+))");
-const std::regex number_re(R"(-?[0-9]+)");
-const std::regex ordinal_re(R"([0-9]+(st|nd|rd|th))");
-const std::regex comma_number_re(R"(\b\d{1,3}(,\d{3})+\b)");
-
-const std::vector<std::string> belowTwenty = {
-    "",    "one",    "two",    "three",    "four",     "five",    "six",     "seven",     "eight",    "nine",
-    "ten", "eleven", "twelve", "thirteen", "fourteen", "fifteen", "sixteen", "seventeen", "eighteen", "nineteen"};
-const std::vector<std::string> tens =
-    {"", "", "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety"};
-const std::vector<std::string> thousands = {"", "thousand", "million"};
-static std::string int_to_words_helper(int num) {
-    if (num == 0)
-        return "";
-    if (num < 20)
-        return belowTwenty[num] + " ";
-    if (num < 100)
-        return tens[num / 10] + (num % 10 ? " " + belowTwenty[num % 10] : "");
-    return belowTwenty[num / 100] + " hundred" + (num % 100 ? " " + int_to_words_helper(num % 100) : "");
+inline bool is_digit(char ch) {
+    return ch >= '0' && ch <= '9';
 }
-static std::string int_to_words(int num) {
-    if (num == 0)
-        return "zero";
-    std::string result;
-    int i = 0;
-    while (num > 0) {
-        if (num % 1000) {
-            result = int_to_words_helper(num % 1000) + (thousands[i].empty() ? "" : " " + thousands[i]) +
-                     (result.empty() ? "" : " " + result);
-        }
-        num /= 1000;
-        i++;
-    }
-    return result;
+inline bool is_alpha(char ch) {
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
 }
-
-static std::string decimal_to_words(double decimalPart) {
-    if (decimalPart == 0)
-        return "";
-    std::ostringstream oss;
-    oss << std::fixed << decimalPart;
-    std::string decimalStr = oss.str().substr(2);
-    std::string result = "point";
-    for (char c : decimalStr) {
-        result += " " + belowTwenty[c - '0'];
-    }
-    return result;
+// \w in std::regex for char
+inline bool is_word_char(char ch) {
+    return is_digit(ch) || is_alpha(ch) || ch == '_';
 }
-// we assume that if the string size exceeds 10, the number is likely too large and may cause errors with stod or stoi
-inline bool is_number_too_large(const std::string& num_str) {
-    return (num_str.size() > 10);
+inline bool is_space(char ch) {
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
 }
-
-// We assume there are no negative numbers - the situation is too complex otherwise.
-static std::string number_to_words(double num) {
-    double x = std::floor(num);
-    int intPart = static_cast<int>(x);
-    double decimalPart = num - intPart;
-    std::string words = int_to_words(intPart);
-    std::string decimalWords = decimal_to_words(decimalPart);
-    return words + (decimalWords.empty() ? "" : " " + decimalWords);
+inline char to_lower(char ch) {
+    return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch + 'a' - 'A') : ch;
 }
 
-static std::string number_to_words(const std::string& s) {
-    if (is_number_too_large(s)) {
-        std::string res = "";
-        for (const auto& ch : s) {
-            if (ch == '.')
-                res += "point ";
-            else if (ch <= '9' && ch >= '0')
-                res += (ch == '0') ? "zero " : belowTwenty[ch - '0'] + " ";
-        }
-        return res;
+// Appends space separated words to the output and remembers where the last word starts, so that it can be turned into
+// an ordinal in place.
+class WordWriter {
+public:
+    explicit WordWriter(std::string& output) : _output(output), _first(output.size()), _last_word(output.size()) {}
+    void word(std::string_view w) {
+        if (_output.size() > _first)
+            _output += ' ';
+        _last_word = _output.size();
+        _output.append(w);
     }
-    return number_to_words(std::stod(s));
-}
-// TODO: Fix secenario where 211st, 202nd, etc. are not converted correctly
-static std::string convert_ordinal(int num) {
-    static const std::unordered_map<int, std::string> ordinal_map = {
-        {1, "first"},      {2, "second"},       {3, "third"},       {4, "fourth"},      {5, "fifth"},
-        {6, "sixth"},      {7, "seventh"},      {8, "eighth"},      {9, "ninth"},       {10, "tenth"},
-        {11, "eleventh"},  {12, "twelfth"},     {13, "thirteenth"}, {14, "fourteenth"}, {15, "fifteenth"},
-        {16, "sixteenth"}, {17, "seventeenth"}, {18, "eighteenth"}, {19, "nineteenth"}, {20, "twentieth"},
-        {30, "thirtieth"}, {40, "fortieth"},    {50, "fiftieth"},   {60, "sixtieth"},   {70, "seventieth"},
-        {80, "eightieth"}, {90, "ninetieth"}};
-
-    if (ordinal_map.contains(num)) {
-        return ordinal_map.at(num);
-    } else {
-        // Handle cases like 21, 22, 23, etc.
-        int tens = num / 10 * 10;  // Get the tens place
-        int ones = num % 10;       // Get the ones place
-
-        // Handle cases like 21st, 22nd, 23rd, 31st, 32nd, 33rd, etc.
-        if (ordinal_map.contains(tens) && ordinal_map.contains(ones)) {
-            return ordinal_map.at(tens) + " " + ordinal_map.at(ones);
-        } else if (ordinal_map.contains(ones)) {
-            return number_to_words(tens) + " " + ordinal_map.at(ones);
+    void digit(char ch) {
+        word(BELOW_TWENTY[ch - '0']);
+    }
+    // e.g. twenty one -> twenty first, one hundred -> one hundredth, twenty -> twentieth
+    void last_word_to_ordinal() {
+        std::string_view last(_output.data() + _last_word, _output.size() - _last_word);
+        for (const auto& [cardinal, ordinal] : IRREGULAR_ORDINALS) {
+            if (last == cardinal) {
+                _output.resize(_last_word);
+                _output.append(ordinal);
+                return;
+            }
+        }
+        if (!last.empty() && last.back() == 'y') {
+            _output.pop_back();
+            _output.append("ieth");
+        } else {
+            _output.append("th");
         }
-        // For other cases, default to using number_to_words
-        return number_to_words(num) + (ones == 1 ? "st" : ones == 2 ? "nd" : ones == 3 ? "rd" : "th");
     }
-}
 
-// TODO: Add __expand_currency
-std::string normalize_numbers(const std::string& text) {
-    std::string result = text;
-    std::smatch match;
-    // First, convert the commas to facilitate further conversion of decimals and other subsequent numbers.
-    while (std::regex_search(result, match, comma_number_re)) {
-        std::string no_commas = match.str(0);
-        no_commas.erase(std::remove(no_commas.begin(), no_commas.end(), ','), no_commas.end());
-        result.replace(match.position(0), match.length(0), no_commas);
+private:
+    std::string& _output;
+    size_t _first;
+    size_t _last_word;
+};
+
+// 0 <= num < 1000
+void below_thousand_to_words(WordWriter& writer, unsigned num) {
+    if (num >= 100) {
+        writer.word(BELOW_TWENTY[num / 100]);
+        writer.word("hundred");
+        num %= 100;
     }
-    while (std::regex_search(result, match, ordinal_re)) {
-        int num = std::stoi(match.str(0));
-        result.replace(match.position(0), match.length(0), convert_ordinal(num));
+    if (num >= 20) {
+        writer.word(TENS[num / 10]);
+        num %= 10;
     }
-    while (std::regex_search(result, match, decimal_number_re)) {
-        result.replace(match.position(0), match.length(0), number_to_words(match.str(0)));
+    if (num > 0)
+        writer.word(BELOW_TWENTY[num]);
+}
+
+void int_to_words(WordWriter& writer, uint64_t num) {
+    if (num == 0) {
+        writer.word(BELOW_TWENTY[0]);
+        return;
     }
-    while (std::regex_search(result, match, number_re)) {
-        result.replace(match.position(0), match.length(0), number_to_words(match.str(0)));
+    unsigned groups[std::size(SCALES)] = {};
+    int n = 0;
+    for (; num > 0; num /= 1000)
+        groups[n++] = static_cast<unsigned>(num % 1000);
+    for (int i = n - 1; i >= 0; --i) {
+        if (groups[i] == 0)
+            continue;
+        below_thousand_to_words(writer, groups[i]);
+        if (i > 0)
+            writer.word(SCALES[i]);
     }
-
-    return result;
 }
 
-// expand_abbrevations
-// List of (regular expression, replacement) pairs for abbreviations in English
-const std::vector<std::pair<std::regex, std::string>> abbreviations_en = {
-    {std::regex("\\bMrs\\.", std::regex_constants::icase), "misess"},
-    {std::regex("\\bMr\\.", std::regex_constants::icase), "mister"},
-    {std::regex("\\bDr\\.", std::regex_constants::icase), "doctor"},
-    {std::regex("\\bSt\\.", std::regex_constants::icase), "saint"},
-    {std::regex("\\bCo\\.", std::regex_constants::icase), "company"},
-    {std::regex("\\bJr\\.", std::regex_constants::icase), "junior"},
-    {std::regex("\\bMaj\\.", std::regex_constants::icase), "major"},
-    {std::regex("\\bGen\\.", std::regex_constants::icase), "general"},
-    {std::regex("\\bDrs\\.", std::regex_constants::icase), "doctors"},
-    {std::regex("\\bRev\\.", std::regex_constants::icase), "reverend"},
-    {std::regex("\\bLt\\.", std::regex_constants::icase), "lieutenant"},
-    {std::regex("\\bHon\\.", std::regex_constants::icase), "honorable"},
-    {std::regex("\\bSgt\\.", std::regex_constants::icase), "sergeant"},
-    {std::regex("\\bCapt\\.", std::regex_constants::icase), "captain"},
-    {std::regex("\\bEsq\\.", std::regex_constants::icase), "esquire"},
-    {std::regex("\\bLtd\\.", std::regex_constants::icase), "limited"},
-    {std::regex("\\bCol\\.", std::regex_constants::icase), "colonel"},
-    {std::regex("\\bFt\\.", std::regex_constants::icase), "fort"}};
-std::string expand_abbreviations(const std::string& text) {
-    std::string result = text;
-    for (const auto& [regex, replacement] : abbreviations_en) {
-        result = std::regex_replace(result, regex, replacement);
+class EnglishScanner {
+public:
+    EnglishScanner(std::string_view text, std::string& output, unsigned rules)
+        : _text(text),
+          _output(output),
+          _rules(rules) {}
+
+    void run() {
+        while (_pos < _text.size()) {
+            const char ch = _text[_pos];
+            if (is_digit(ch) || (ch == '-' && is_negative_sign())) {
+                if ((_rules & EN_NORM_TIME) && try_time())
+                    continue;
+                if ((_rules & EN_NORM_NUMBER) && try_number())
+                    continue;
+                copy_digits();
+            } else if (is_alpha(ch) || ch == '_') {
+                if ((_rules & EN_NORM_ABBREVIATION) && at_word_start() && try_abbreviation())
+                    continue;
+                copy_letters();
+            } else {
+                _output += ch;
+                ++_pos;
+            }
+        }
     }
-    return result;
-}
 
-// expand_time_english
-const std::regex time_re(R"(((0?[0-9])|(1[0-1])|(1[2-9])|(2[0-3])):([0-5][0-9])\s*(a\.m\.|am|pm|p\.m\.|a\.m|p\.m)?)",
-                         std::regex_constants::icase);
+private:
+    char peek(size_t pos) const {
+        return pos < _text.size() ? _text[pos] : '\0';
+    }
+    bool at_word_start() const {
+        return _pos == 0 || !is_word_char(_text[_pos - 1]);
+    }
+    // "-" followed by a digit and not part of a word or range like 2020-2021
+    bool is_negative_sign() const {
+        return is_digit(peek(_pos + 1)) && at_word_start() && (_rules & EN_NORM_NUMBER);
+    }
+    void copy_letters() {
+        const bool lower = _rules & EN_NORM_LOWERCASE;
+        for (; _pos < _text.size() && (is_alpha(_text[_pos]) || _text[_pos] == '_'); ++_pos)
+            _output += lower ? to_lower(_text[_pos]) : _text[_pos];
+    }
+    void copy_digits() {
+        do {
+            _output += _text[_pos++];
+        } while (_pos < _text.size() && is_digit(_text[_pos]));
+    }
 
-static std::string _expand_time_english(const std::smatch& match) {
-    int hour = std::stoi(match.str(1));
-    bool past_noon = hour >= 12;
-    std::string result;
+    // hour(0-23):minute(00-59) \s* (a.m.|am|pm|p.m.|a.m|p.m)?
+    bool try_time() {
+        size_t p = _pos;
+        if (!is_digit(peek(p)) || (p > 0 && is_digit(_text[p - 1])))
+            return false;
+        unsigned hour = _text[p++] - '0';
+        if (is_digit(peek(p)))
+            hour = hour * 10 + (_text[p++] - '0');
+        if (hour > 23 || peek(p) != ':')
+            return false;
+        ++p;
+        if (peek(p) < '0' || peek(p) > '5' || !is_digit(peek(p + 1)) || is_digit(peek(p + 2)))
+            return false;
+        unsigned minute = (_text[p] - '0') * 10 + (_text[p + 1] - '0');
+        p += 2;
+        while (is_space(peek(p)))
+            ++p;
+        // am / pm with optional dots, not the beginning of a longer word
+        size_t am_pm_begin = p, am_pm_end = p;
+        const char a_or_p = to_lower(peek(p));
+        if (a_or_p == 'a' || a_or_p == 'p') {
+            size_t q = p + 1;
+            const bool dotted = peek(q) == '.';
+            if (dotted)
+                ++q;
+            if (to_lower(peek(q)) == 'm') {
+                ++q;
+                if (dotted && peek(q) == '.')
+                    ++q;
+                if (!is_alpha(peek(q)))
+                    am_pm_end = q;
+            }
+        }
 
-    if (hour > 12) {
-        hour -= 12;
-    } else if (hour == 0) {
-        hour = 12;
-        past_noon = true;
+        bool past_noon = hour >= 12;
+        if (hour > 12) {
+            hour -= 12;
+        } else if (hour == 0) {
+            hour = 12;
+            past_noon = true;
+        }
+        WordWriter writer(_output);
+        int_to_words(writer, hour);
+        if (minute > 0) {
+            if (minute < 10)
+                writer.word("oh");
+            int_to_words(writer, minute);
+        }
+        if (am_pm_end == am_pm_begin) {
+            _output.append(past_noon ? " p m " : " a m ");
+        } else {
+            for (size_t i = am_pm_begin; i < am_pm_end; ++i) {
+                if (_text[i] != '.') {
+                    _output += ' ';
+                    _output += (_rules & EN_NORM_LOWERCASE) ? to_lower(_text[i]) : _text[i];
+                }
+            }
+            _output += ' ';
+        }
+        _pos = am_pm_end;
+        return true;
     }
-    result += number_to_words(hour);
 
-    int minute = std::stoi(match.str(6));
-    if (minute > 0) {
-        if (minute < 10) {
-            result += " oh";
+    bool try_abbreviation() {
+        for (const auto& [abbreviation, replacement] : ABBREVIATIONS_EN) {
+            const size_t n = abbreviation.size();
+            if (peek(_pos + n) != '.')
+                continue;
+            bool match = true;
+            for (size_t i = 0; i < n && match; ++i)
+                match = to_lower(_text[_pos + i]) == abbreviation[i];
+            if (match) {
+                _output.append(replacement);
+                _pos += n + 1;
+                return true;
+            }
         }
-        result += " " + number_to_words(minute);
+        return false;
     }
 
-    std::string am_pm = match.str(7);
-    if (am_pm.empty()) {
-        result += past_noon ? " p m " : " a m ";
-    } else {
-        for (char c : am_pm) {
-            if (c != '.') {
-                result += " ";
-                result += c;
+    // [-]digits[,ddd]*[.digits | st|nd|rd|th]
+    bool try_number() {
+        size_t p = _pos;
+        const bool negative = _text[p] == '-';
+        if (negative)
+            ++p;
+        const size_t int_begin = p;
+        while (is_digit(peek(p)))
+            ++p;
+        size_t int_end = p;
+        // comma groups like 1,234,567 need a word boundary on both sides, same as \b\d{1,3}(,\d{3})+\b
+        if (int_end - int_begin <= 3 && (int_begin == 0 || !is_word_char(_text[int_begin - 1]))) {
+            size_t q = int_end;
+            while (peek(q) == ',' && is_digit(peek(q + 1)) && is_digit(peek(q + 2)) && is_digit(peek(q + 3))) {
+                q += 4;
+                if (!is_word_char(peek(q)))
+                    int_end = q;
+                else
+                    break;
+            }
+        }
+
+        // accumulate the integer part, digit strings beyond 64 bits are read digit by digit
+        uint64_t value = 0;
+        bool overflow = false;
+        for (size_t i = int_begin; i < int_end; ++i) {
+            if (_text[i] == ',')
+                continue;
+            const uint64_t d = _text[i] - '0';
+            if (value > (std::numeric_limits<uint64_t>::max() - d) / 10) {
+                overflow = true;
+                break;
+            }
+            value = value * 10 + d;
+        }
+
+        size_t frac_begin = int_end, frac_end = int_end;
+        if (peek(int_end) == '.' && is_digit(peek(int_end + 1))) {
+            frac_begin = int_end + 1;
+            frac_end = frac_begin;
+            while (is_digit(peek(frac_end)))
+                ++frac_end;
+        }
+        bool ordinal = false;
+        if (frac_begin == frac_end && !overflow) {
+            const char c0 = to_lower(peek(int_end)), c1 = to_lower(peek(int_end + 1));
+            ordinal = (c0 == 's' && c1 == 't') || (c0 == 'n' && c1 == 'd') || (c0 == 'r' && c1 == 'd') ||
+                      (c0 == 't' && c1 == 'h');
+        }
+
+        WordWriter writer(_output);
+        if (negative)
+            writer.word("minus");
+        if (overflow) {
+            for (size_t i = int_begin; i < int_end; ++i) {
+                if (_text[i] != ',')
+                    writer.digit(_text[i]);
             }
+        } else {
+            int_to_words(writer, value);
         }
-        result += " ";
+        if (ordinal) {
+            writer.last_word_to_ordinal();
+            _pos = int_end + 2;
+            return true;
+        }
+        if (frac_end > frac_begin) {
+            writer.word("point");
+            for (size_t i = frac_begin; i < frac_end; ++i)
+                writer.digit(_text[i]);
+            _pos = frac_end;
+            return true;
+        }
+        _pos = int_end;
+        return true;
     }
+
+    std::string_view _text;
+    std::string& _output;
+    unsigned _rules;
+    size_t _pos = 0;
+};
+}  // namespace
+
+void normalize_english(std::string_view text, std::string& output, unsigned rules) {
+    // verbalized numbers are longer than their digits, reserve once for the common case
+    output.reserve(output.size() + text.size() * 2);
+    EnglishScanner(text, output, rules).run();
+}
+
+// TODO: Add __expand_currency
+std::string normalize_numbers(const std::string& text) {
+    std::string result;
+    normalize_english(text, result, EN_NORM_NUMBER);
+    return result;
+}
+
+std::string expand_abbreviations(const std::string& text) {
+    std::string result;
+    normalize_english(text, result, EN_NORM_ABBREVIATION);
     return result;
 }
 
 std::string expand_time_english(const std::string& text) {
-    std::string result = text;
-    std::smatch match;
-    while (std::regex_search(result, match, time_re)) {
-        // std::cout << "match\n";
-        // for (std::size_t i = 0; i < match.size(); ++i)
-        //     std::cout << i << ": " << match[i] << '\n';
-        result.replace(match.position(0), match.length(0), _expand_time_english(match));
-    }
+    std::string result;
+    normalize_english(text, result, EN_NORM_TIME);
     return result;
 }
 
-}  // namespace text_normalization
\ No newline at end of file
+}  // namespace text_normalization
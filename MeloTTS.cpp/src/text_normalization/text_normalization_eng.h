@@ -17,12 +17,25 @@
  */
 #ifndef NUM_TO_ENG_H
 #define NUM_TO_ENG_H
-#include <sstream>
 #include <string>
-#include <vector>
+#include <string_view>
 
 namespace text_normalization {
 
+// Rules applied by normalize_english, they can be combined with |
+enum EnglishNormalizeRule : unsigned {
+    EN_NORM_TIME = 1u << 0,          // 03:15 p.m. -> three fifteen p m
+    EN_NORM_ABBREVIATION = 1u << 1,  // mrs. -> misess
+    EN_NORM_NUMBER = 1u << 2,        // 1,234.5 -> one thousand two hundred thirty four point five, 11th -> eleventh
+    EN_NORM_LOWERCASE = 1u << 3,     // A-Z -> a-z
+    EN_NORM_ALL = EN_NORM_TIME | EN_NORM_ABBREVIATION | EN_NORM_NUMBER | EN_NORM_LOWERCASE,
+};
+
+// @brief Normalize English text in a single pass without regex and append the result to output.
+// Numbers are verbalized with 64-bit integer arithmetic (up to quintillions); longer digit strings are read digit by
+// digit. Reserve output in advance to keep the pass allocation free.
+void normalize_english(std::string_view text, std::string& output, unsigned rules = EN_NORM_ALL);
+
 // @brief convert number to words (e.g. 11 -> eleven, 11st -> eleventh)
 std::string normalize_numbers(const std::string& text);
 
@@ -33,4 +46,4 @@ std::string expand_abbreviations(const std::string& text);
 std::string expand_time_english(const std::string& text);
 
 }  // namespace text_normalization
-#endif
\ No newline at end of file
+#endif
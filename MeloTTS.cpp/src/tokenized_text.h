@@ -0,0 +1,76 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef TOKENIZED_TEXT_H
+#define TOKENIZED_TEXT_H
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace melo {
+/**
+ * @brief BERT tokenization of one sentence, computed once and shared by G2P and BERT.
+ *
+ * e.g. "编译器compiler"
+ *  ids         [101, 6784, 7984, 2693, 85065, 33719, 102]
+ *  tokens      [[CLS], 编, 译, 器, comp, ##iler, [SEP]]
+ *  word_begin  [1, 2, 3, 4, 6]  -> words 编 | 译 | 器 | comp ##iler
+ *
+ * G2P emits one word2ph entry per token, so word2ph.size() == ids.size() is the alignment BERT relies on to expand
+ * token features to phone level.
+ */
+struct TokenizedText {
+    std::vector<int64_t> ids;          // BERT input ids, [CLS] ... [SEP]
+    std::vector<std::string> tokens;   // subword string of every id, [CLS] and [SEP] included
+    std::vector<uint32_t> word_begin;  // index of the first token of every word, followed by the index of [SEP]
+
+    inline size_t num_words() const {
+        return word_begin.empty() ? 0 : word_begin.size() - 1;
+    }
+    // subwords of the i-th word, e.g. [comp, ##iler]
+    inline std::span<const std::string> word_tokens(size_t i) const {
+        return std::span<const std::string>(tokens).subspan(word_begin[i], word_begin[i + 1] - word_begin[i]);
+    }
+    // subwords without [CLS] and [SEP]
+    inline std::span<const std::string> subwords() const {
+        return tokens.size() < 2 ? std::span<const std::string>{}
+                                 : std::span<const std::string>(tokens).subspan(1, tokens.size() - 2);
+    }
+    inline bool empty() const {
+        return ids.empty();
+    }
+    inline void clear() {
+        ids.clear();
+        tokens.clear();
+        word_begin.clear();
+    }
+    // Derive word_begin from tokens: every token that is not a "##" continuation starts a word.
+    inline void mark_words() {
+        word_begin.clear();
+        if (tokens.size() < 2)
+            return;
+        for (uint32_t i = 1; i + 1 < tokens.size(); ++i) {
+            if (!tokens[i].starts_with("##"))
+                word_begin.push_back(i);
+        }
+        word_begin.push_back(static_cast<uint32_t>(tokens.size() - 1));
+    }
+};
+}  // namespace melo
+#endif  // TOKENIZED_TEXT_H
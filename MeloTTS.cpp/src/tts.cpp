@@ -19,12 +19,19 @@
 
 #include <cassert>
 #include <chrono>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <future>
 
 #include "info_data.h"
 #include "language_modules/chinese_mix.h"
 #include "language_modules/english.h"
+#include "pipeline_stage.h"
+#include "sentence_writer.h"
 namespace melo {
 TTS::TTS(std::unique_ptr<ov::Core>& core,
          const std::filesystem::path& model_dir,
@@ -36,70 +43,96 @@ TTS::TTS(std::unique_ptr<ov::Core>& core,
 #ifdef USE_DEEPFILTERNET
          const std::filesystem::path& nf_ir_path,
          const std::string& nf_device,
-         bool disable_nf
+         bool disable_nf,
 #endif  // USE_DEEPFILTERNET
-         )
+         std::shared_ptr<BatchScheduler> scheduler,
+         size_t tts_streams,
+         size_t tts_chunk_ms,
+         size_t g2p_prewarm_words)
     : _language(language),
       _disable_bert(disable_bert),
-      _disable_nf(disable_nf)
+#ifdef USE_DEEPFILTERNET
+      _disable_nf(disable_nf),
+#else
+      _disable_nf(true),
+#endif  // USE_DEEPFILTERNET
+      _scheduler(std::move(scheduler)),
+      _tts_streams(std::max<size_t>(tts_streams, 1))
       {
     assert((core.get() != nullptr) && "core should not be null!");
     assert((std::filesystem::exists(model_dir)) && "ir files or vocab_bert does not exit!");
-    std::filesystem::path tts_ir_path, bert_ir_path, tokenizer_dir_path;
+    const auto [tts_ir_path, bert_ir_path] = model_ir_paths(model_dir, language, tts_quantize, bert_device);
+    std::filesystem::path tokenizer_dir_path, vocab_path;
     if (language == "ZH") {
-        if (bert_device == "NPU") {
-            // NPU device runs the static shape model in Meteor Lake and Lunar Lake.
-            bert_ir_path = model_dir / "bert_ZH_static_int8.xml";
-        } else
-            bert_ir_path = model_dir / "bert_ZH_int8.xml";
-        if (tts_quantize) {
-            tts_ir_path = model_dir / "tts_zn_mix_en_int8.xml";
-        } else {
-            // fp16 model
-            tts_ir_path = model_dir / "tts_zn_mix_en.xml";
-        }
         tokenizer_dir_path = model_dir / "bert-base-multilingual-uncased";
+        // WordPiece vocabulary of bert-base-multilingual-uncased for the native word segmentation
+        vocab_path = model_dir / "vocab.txt";
     } else if (language == "EN") {
-        if (bert_device == "NPU") {
-            // NPU device runs the static shape model in Meteor Lake and Lunar Lake.
-            bert_ir_path = model_dir / "bert_EN_static_int8.xml";
-        } else
-            bert_ir_path = model_dir / "bert_EN_int8.xml";
-        if (tts_quantize) {
-            tts_ir_path = model_dir / "tts_en_int8.xml";
-        } else {
-            // fp16 model
-            tts_ir_path = model_dir / "tts_en.xml";
-        }
+        // vocab.txt in the folder, exported by scripts/export_vocab.py
         tokenizer_dir_path = model_dir / "bert-base-uncased";
     }
-    assert((std::filesystem::exists(tts_ir_path) && std::filesystem::exists(bert_ir_path)) &&
+    const bool split_tts = tts_chunk_ms > 0 && OpenVoiceTTS::has_split_models(tts_ir_path);
+    assert(((std::filesystem::exists(tts_ir_path) || split_tts) && std::filesystem::exists(bert_ir_path)) &&
            "ir files or vocab_bert does not exit!");
     assert((std::filesystem::exists(tokenizer_dir_path)) && "tokenizer model folder does not exit!");
 
     // init tts model
-    tts_model = OpenVoiceTTS(core, tts_ir_path, tts_device, language, tts_quantize);
+    if (tts_chunk_ms > 0 && (_scheduler || !split_tts)) {
+        std::cerr << "[ERROR] TTS::TTS : "
+                  << (_scheduler ? "the batch scheduler synthesizes whole sentences"
+                                 : "no split model next to " + tts_ir_path.string())
+                  << ", the audio is not decoded in chunks\n";
+    }
+    if (_scheduler) {
+        _tts_streams = 1;
+    } else if (split_tts) {
+        // a chunk covers whole latent frames
+        const size_t samples = tts_chunk_ms * sampling_rate_ / 1000;
+        const size_t hop = OpenVoiceTTS::HOP_LENGTH;
+        const size_t chunk_frames = std::max<size_t>((samples + hop / 2) / hop, 1);
+        // one sentence at a time, the chunks of a sentence are decoded one after the other
+        if (_tts_streams > 1)
+            std::cerr << "[ERROR] TTS::TTS : the split tts_model decodes one sentence at a time, tts_streams "
+                      << _tts_streams << " is ignored\n";
+        _tts_streams = 1;
+        tts_model = OpenVoiceTTS(core, tts_ir_path, tts_device, language, tts_quantize, chunk_frames);
+        std::cout << "TTS::TTS : init split tts_model, the audio is decoded in chunks of " << chunk_frames
+                  << " frames\n";
+    } else if (_tts_streams > 1) {
+        tts_model = OpenVoiceTTS(core,
+                                 tts_ir_path,
+                                 tts_device,
+                                 language,
+                                 tts_quantize,
+                                 AbstractOpenvinoModel::with_streams(
+                                     OpenVoiceTTS::set_tts_config(tts_device, tts_quantize), tts_device, _tts_streams));
+        std::cout << "TTS::TTS : init tts_model with " << _tts_streams << " sentences in flight\n";
+    } else
+        tts_model = OpenVoiceTTS(core, tts_ir_path, tts_device, language, tts_quantize);
 
     // init tokenizer
-    ov_tokenizer = std::make_shared<OpenVinoTokenizer>(tokenizer_dir_path);
+    ov_tokenizer = std::make_shared<OpenVinoTokenizer>(tokenizer_dir_path, vocab_path);
 
     // init language module
     if (language == "ZH") {
         // We temporarily assume that the initialization data files used by the language module are all located in the
         // tts_ir_path folder.
-        _language_module = std::make_shared<ChineseMix>(model_dir);
+        _language_module = std::make_shared<ChineseMix>(model_dir, g2p_prewarm_words);
     } else if (language == "EN") {
         _language_module = std::make_shared<English>(core, model_dir);
     } else
         std::cerr << "[ERROR] Unsupported Language\n";
 
     // init bert
-    if (!_disable_bert) {
+    if (_disable_bert) {
+        std::cout << "TTS::TTS : disable bert_model\n";
+    } else if (_scheduler) {
+        std::cout << "TTS::TTS : bert_model and tts_model run by the batch scheduler\n";
+    } else {
         assert(std::filesystem::exists(bert_ir_path) && "bert_ir_path does not exist!\n");
         bert_model = Bert(core, bert_ir_path, bert_device, language, ov_tokenizer);
         std::cout << "TTS::TTS : init bert_model\n";
-    } else
-        std::cout << "TTS::TTS : disable bert_model\n";
+    }
 #ifdef USE_DEEPFILTERNET
     // Init noise filter model
     if (!_disable_nf) {
@@ -109,12 +142,61 @@ TTS::TTS(std::unique_ptr<ov::Core>& core,
     } else
         std::cout << "TTS::TTS : disable nf_model\n";
 #endif  // USE_DEEPFILTERNET
+}
+
+std::pair<std::filesystem::path, std::filesystem::path> TTS::model_ir_paths(const std::filesystem::path& model_dir,
+                                                                            const std::string& language,
+                                                                            const bool tts_quantize,
+                                                                            const std::string& bert_device) {
+    std::filesystem::path tts_ir_path, bert_ir_path;
+    if (language == "ZH") {
+        if (bert_device == "NPU") {
+            // NPU device runs the static shape model in Meteor Lake and Lunar Lake.
+            bert_ir_path = model_dir / "bert_ZH_static_int8.xml";
+        } else
+            bert_ir_path = model_dir / "bert_ZH_int8.xml";
+        if (tts_quantize) {
+            tts_ir_path = model_dir / "tts_zn_mix_en_int8.xml";
+        } else {
+            // fp16 model
+            tts_ir_path = model_dir / "tts_zn_mix_en.xml";
+        }
+    } else if (language == "EN") {
+        if (bert_device == "NPU") {
+            // NPU device runs the static shape model in Meteor Lake and Lunar Lake.
+            bert_ir_path = model_dir / "bert_EN_static_int8.xml";
+        } else
+            bert_ir_path = model_dir / "bert_EN_int8.xml";
+        if (tts_quantize) {
+            tts_ir_path = model_dir / "tts_en_int8.xml";
+        } else {
+            // fp16 model
+            tts_ir_path = model_dir / "tts_en.xml";
+        }
+    }
+    return {tts_ir_path, bert_ir_path};
+}
 
-    // init punctuation dict
-    std::filesystem::path punctuation_dict_path = model_dir / "punc.dic";
-    assert(std::filesystem::exists(punctuation_dict_path) && "punctuation dictionary does not exit!");
-    _da.open(punctuation_dict_path.string().c_str());
-    std::cout << "TTS::TTS : open puncuation dict.\n";
+std::shared_ptr<BatchScheduler> TTS::make_batch_scheduler(std::unique_ptr<ov::Core>& core,
+                                                          const std::filesystem::path& model_dir,
+                                                          const std::string& language,
+                                                          const std::string& tts_device,
+                                                          const bool tts_quantize,
+                                                          const std::string& bert_device,
+                                                          bool disable_bert,
+                                                          const BatchScheduler::Options& options) {
+    const auto [tts_ir_path, bert_ir_path] = model_ir_paths(model_dir, language, tts_quantize, bert_device);
+    assert((std::filesystem::exists(tts_ir_path) && (disable_bert || std::filesystem::exists(bert_ir_path))) &&
+           "ir files do not exist!");
+    return std::make_shared<BatchScheduler>(core,
+                                            tts_ir_path,
+                                            tts_device,
+                                            tts_quantize,
+                                            bert_ir_path,
+                                            bert_device,
+                                            language,
+                                            disable_bert,
+                                            options);
 }
 TTS::TTS(std::unique_ptr<ov::Core>& core,
          const std::filesystem::path& tts_ir_path,
@@ -128,7 +210,7 @@ TTS::TTS(std::unique_ptr<ov::Core>& core,
 #endif  // USE_DEEPFILTERNET
          const std::filesystem::path& tokenizer_runtime_path,
          const std::filesystem::path& tokenizer_model_folder,
-         const std::filesystem::path& punctuation_dict_path,
+         [[maybe_unused]] const std::filesystem::path& punctuation_dict_path,
          const std::string language,
          bool disable_bert,
          bool disable_nf)
@@ -169,10 +251,6 @@ TTS::TTS(std::unique_ptr<ov::Core>& core,
     } else
         std::cout << "TTS::TTS : disable nf_model\n";
 #endif  // USE_DEEPFILTERNET
-        // init punctuation dict
-    assert(std::filesystem::exists(punctuation_dict_path) && "punctuation dictionary does not exit!");
-    _da.open(punctuation_dict_path.string().c_str());
-    std::cout << "TTS::TTS : open puncuation dict.\n";
 }
 
 void TTS::tts_to_file(const std::string& text,
@@ -182,61 +260,10 @@ void TTS::tts_to_file(const std::string& text,
                       const float& sdp_ratio,
                       const float& noise_scale,
                       const float& noise_scale_w) {
-    std::vector<float> audio;
-    try {
-        std::string norm_text = text;
-        // We place English text normalization before sentence splitting.
-        // For English, we need to address cases involving abbreviations like "Mr." and scientific notation.
-        // If normalization is applied after sentence splitting, it may prematurely process periods and commas, which
-        // could lead to issues.
-        if (this->_language == "EN") {
-            norm_text = _language_module->text_normalize(text);
-        }
-        std::vector<std::string> sentences = split_sentences_into_pieces(norm_text, false);
-        for (auto& sentence : sentences) {
-            if (this->_language == "ZH") {
-                sentence = _language_module->text_normalize(sentence);
-            }
-            // structured binding
-            auto startTime = Time::now();
-            auto [phone_level_feature, phones_ids, tones, lang_ids] = get_text_for_tts_infer(sentence);
-
-            auto preProcess = get_duration_ms_till_now(startTime);
-
-            std::vector<float> wav_data = tts_model.tts_infer(phones_ids,
-                                                              tones,
-                                                              lang_ids,
-                                                              phone_level_feature,
-                                                              speed,
-                                                              speaker_id,
-                                                              this->_disable_bert);
-
-            audio_concat(audio, wav_data, speed, sampling_rate_);
-            std::cout << "[INFO] preProcess Time: " << preProcess << "ms\n";
-        }
-#ifdef USE_DEEPFILTERNET
-        if (!_disable_nf) {
-            std::cout << "TTS::TTS : Process audio by noise filter.\n";
-            auto nf_time_1 = std::chrono::high_resolution_clock::now();
-            nf.proc(audio);
-            auto nf_time_2 = std::chrono::high_resolution_clock::now();
-            std::chrono::duration<double> nf_time_duration = nf_time_2 - nf_time_1;
-            std::cout << "TTS::TTS : [NF][DFNet] process time:" << nf_time_duration.count() << " seconds" << std::endl;
-        }
-#endif  // USE_DEEPFILTERNET
-        write_wave(output_filename, audio, sampling_rate_);
-        // release memory buffer
-        tts_model.release_infer_memory();
-        if (!_disable_bert)
-            bert_model.release_infer_memory();
-    } catch (const std::runtime_error& e) {
-        std::cerr << "std::runtime_error: " << e.what() << std::endl;
-
-    } catch (const std::exception& e) {
-        std::cerr << "std::exception: " << e.what() << std::endl;
-    } catch (...) {
-        std::cerr << "Unknown exception caught" << std::endl;
-    }
+    WaveWriter writer(output_filename, sampling_rate_);
+    tts_to_file(text, writer, speaker_id, speed, sdp_ratio, noise_scale, noise_scale_w);
+    writer.close();
+    std::cout << "write wav to " << output_filename << std::endl;
 }
 
 void TTS::tts_to_file(const std::string& text,
@@ -246,42 +273,273 @@ void TTS::tts_to_file(const std::string& text,
                       const float& sdp_ratio,
                       const float& noise_scale,
                       const float& noise_scale_w) {
-    try {
-        std::string norm_text = text;
-        // We place English text normalization before sentence splitting.
-        // For English, we need to address cases involving abbreviations like "Mr." and scientific notation.
-        // If normalization is applied after sentence splitting, it may prematurely process periods and commas, which
-        // could lead to issues.
-        if (this->_language == "EN") {
-            norm_text = _language_module->text_normalize(text);
+    synthesize(
+        {text},
+        [&](std::vector<float>& wav_data, bool sentence_end) {
+            if (sentence_end)
+                audio_concat(output_audio, wav_data, speed, sampling_rate_);
+            else
+                output_audio.insert(output_audio.end(), wav_data.begin(), wav_data.end());
+        },
+        speaker_id,
+        speed,
+        sdp_ratio,
+        noise_scale,
+        noise_scale_w);
+}
+
+void TTS::tts_to_file(const std::string& text,
+                      WaveWriter& writer,
+                      const int& speaker_id,
+                      const float& speed,
+                      const float& sdp_ratio,
+                      const float& noise_scale,
+                      const float& noise_scale_w) {
+    tts_to_file(std::vector<std::string>{text}, writer, speaker_id, speed, sdp_ratio, noise_scale, noise_scale_w);
+}
+
+void TTS::tts_to_file(const std::vector<std::string>& texts,
+                      const std::string& output_filename,
+                      const int& speaker_id,
+                      const float& speed,
+                      const float& sdp_ratio,
+                      const float& noise_scale,
+                      const float& noise_scale_w) {
+    WaveWriter writer(output_filename, sampling_rate_);
+    tts_to_file(texts, writer, speaker_id, speed, sdp_ratio, noise_scale, noise_scale_w);
+    writer.close();
+    std::cout << "write wav to " << output_filename << std::endl;
+}
+
+void TTS::tts_to_file(const std::vector<std::string>& texts,
+                      WaveWriter& writer,
+                      const int& speaker_id,
+                      const float& speed,
+                      const float& sdp_ratio,
+                      const float& noise_scale,
+                      const float& noise_scale_w,
+                      const RequestControl& control) {
+    // Every sentence is handed to a pipeline stage that writes it while the next one is synthesized:
+    // model rate -> (48 kHz -> noise filter) -> writer rate, see SentenceWriter
+    int32_t stage_rate = writer.sample_rate();
+    SentenceWriter::Filter filter;
+#ifdef USE_DEEPFILTERNET
+    const bool use_nf = !_disable_nf;
+    std::chrono::duration<double> nf_time_duration{0};
+    if (use_nf) {
+        nf.reset();
+        stage_rate = NoiseFilter::SAMPLE_RATE;
+        filter = [&](std::span<const float> input, std::vector<float>& output, bool last) {
+            auto nf_time_1 = std::chrono::high_resolution_clock::now();
+            nf.proc(input, output);
+            if (last)
+                nf.flush(output);
+            nf_time_duration += std::chrono::high_resolution_clock::now() - nf_time_1;
+        };
+    }
+#endif  // USE_DEEPFILTERNET
+    SentenceWriter sentences(
+        writer, sampling_rate_, stage_rate, silence_interval(speed, stage_rate), std::move(filter));
+
+    // a sentence or, with a split model, a chunk of one
+    struct Audio {
+        std::vector<float> wav_data;
+        bool sentence_end = true;
+    };
+    PipelineStage<Audio> stage([&](Audio& audio) {
+        control.check("noise filter");
+        sentences.write(audio.wav_data, audio.sentence_end);
+    });
+    synthesize(
+        texts,
+        [&](std::vector<float>& wav_data, bool sentence_end) {
+            stage.push({std::move(wav_data), sentence_end});
+        },
+        speaker_id,
+        speed,
+        sdp_ratio,
+        noise_scale,
+        noise_scale_w,
+        control);
+    stage.finish();
+    if (!stage.failed())
+        sentences.finish();
+#ifdef USE_DEEPFILTERNET
+    if (use_nf)
+        std::cout << "TTS::TTS : [NF][DFNet] process time:" << nf_time_duration.count()
+                  << " seconds, overlapped with the synthesis" << std::endl;
+#endif  // USE_DEEPFILTERNET
+}
+
+void TTS::synthesize(const std::vector<std::string>& texts,
+                     const std::function<void(std::vector<float>& wav_data, bool sentence_end)>& on_audio,
+                     const int& speaker_id,
+                     const float& speed,
+                     const float& sdp_ratio,
+                     const float& noise_scale,
+                     const float& noise_scale_w,
+                     const RequestControl& control) {
+    // The front end runs on _front_end_pool, up to `ahead` sentences before the one the models are on; the models run
+    // here and take the sentences in order. Without a pool the futures are deferred, i.e. run here when taken.
+    const std::shared_ptr<WorkStealingPool> pool = _front_end_pool;
+    const size_t ahead = pool ? FRONT_END_AHEAD_PER_THREAD * pool->size() : 1;
+    // deferred jobs run on this thread, which owns bert_model, so BERT overlaps with their G2P
+    const bool overlap = !pool;
+    auto run_front_end = [&pool](auto job) {
+        return pool ? pool->submit(std::move(job)) : std::async(std::launch::deferred, std::move(job));
+    };
+    // set once this call is left, the front end jobs queued then return at once
+    auto abandoned = std::make_shared<std::atomic<bool>>(false);
+    std::vector<std::future<std::vector<std::string>>> split_texts;
+    std::deque<std::future<SentenceFrontEnd>> pending;
+    // the jobs refer to texts and this, so they are waited for on every way out
+    struct PendingGuard {
+        std::atomic<bool>& abandoned;
+        std::vector<std::future<std::vector<std::string>>>& split_texts;
+        std::deque<std::future<SentenceFrontEnd>>& pending;
+        ~PendingGuard() {
+            abandoned = true;
+            auto wait = [](auto& future) {
+                if (future.valid() && future.wait_for(std::chrono::seconds(0)) != std::future_status::deferred)
+                    future.wait();
+            };
+            std::for_each(split_texts.begin(), split_texts.end(), wait);
+            std::for_each(pending.begin(), pending.end(), wait);
         }
-        std::vector<std::string> sentences = split_sentences_into_pieces(norm_text, false);
-        for (auto& sentence : sentences) {
-            if (!sentence.size())
-                continue;
-            if (this->_language == "ZH") {
-                sentence = _language_module->text_normalize(sentence);
+    } pending_guard{*abandoned, split_texts, pending};
+
+    try {
+        // the texts are split up to `ahead` texts before the sentences queued
+        size_t next_text = 0, next_sentence = 0;
+        auto fill_split_texts = [&] {
+            while (split_texts.size() < texts.size() && split_texts.size() < next_text + ahead) {
+                const std::string& text = texts[split_texts.size()];
+                split_texts.push_back(run_front_end([this, &text, &control, abandoned] {
+                    if (abandoned->load() || text.empty())
+                        return std::vector<std::string>{};
+                    try {
+                        return split_text(text, control);
+                    } catch (const Cancelled&) {
+                        throw;
+                    } catch (const std::exception& e) {
+                        // only this text is skipped
+                        std::cerr << "std::exception: " << e.what() << std::endl;
+                    }
+                    return std::vector<std::string>{};
+                }));
+            }
+        };
+        std::vector<std::string> sentences;
+        auto fill_pending = [&] {
+            while (pending.size() < ahead) {
+                while (next_sentence == sentences.size()) {
+                    if (next_text == texts.size())
+                        return;
+                    fill_split_texts();
+                    sentences = split_texts[next_text++].get();
+                    next_sentence = 0;
+                }
+                pending.push_back(run_front_end(
+                    [this, sentence = std::move(sentences[next_sentence++]), &control, abandoned, overlap]() mutable {
+                        if (abandoned->load())
+                            return SentenceFrontEnd{};
+                        control.check("normalization");
+                        if (this->_language == "ZH") {
+                            sentence = _language_module->text_normalize(sentence);
+                        }
+                        return front_end(sentence, control, overlap);
+                    }));
             }
+        };
+
+        // With several streams, sentence k runs on slot k % _tts_streams: before a slot is reused the oldest sentence
+        // is waited for and handed on, so on_audio gets them in order. A failure waits for the ones still running.
+        std::deque<size_t> running;
+        size_t num_started = 0;
+        struct RunningGuard {
+            OpenVoiceTTS& model;
+            ~RunningGuard() {
+                model.wait_all();
+            }
+        } running_guard{tts_model};
+        auto finish_oldest = [&] {
+            std::vector<float> wav_data = tts_model.wait_infer(running.front());
+            running.pop_front();
+            on_audio(wav_data, true);
+        };
+        for (fill_pending(); !pending.empty(); fill_pending()) {
             auto startTime = Time::now();
-            // structured binding
-            auto [phone_level_feature, phones_ids, tones, lang_ids] = get_text_for_tts_infer(sentence);
+            SentenceFrontEnd sentence = pending.front().get();
+            pending.pop_front();
+            if (sentence.phones_ids.empty())
+                continue;
+            auto phone_level_feature = sentence.phone_level_feature ? std::move(*sentence.phone_level_feature)
+                                                                    : bert_feature(sentence, control);
+            auto& [phones_ids, tones, lang_ids, word2ph, tokenized, overlapped_feature] = sentence;
             auto preProcess = get_duration_ms_till_now(startTime);
+            std::cout << "[INFO] preProcess Time: " << preProcess << "ms, including the time for BERT inference.\n";
 
-            std::vector<float> wav_data = tts_model.tts_infer(phones_ids,
-                                                              tones,
-                                                              lang_ids,
-                                                              phone_level_feature,
-                                                              speed,
-                                                              speaker_id,
-                                                              this->_disable_bert);
+            control.check("TTS");
+            std::vector<float> wav_data;
+            if (_scheduler) {
+                wav_data = _scheduler->tts({.phones = std::move(phones_ids),
+                                            .tones = std::move(tones),
+                                            .lang_ids = std::move(lang_ids),
+                                            .phone_level_feature = std::move(phone_level_feature),
+                                            .speed = speed,
+                                            .speaker_id = speaker_id,
+                                            .disable_bert = this->_disable_bert},
+                                           control);
+            } else if (_tts_streams > 1) {
+                if (running.size() == _tts_streams)
+                    finish_oldest();
+                const size_t slot = num_started++ % _tts_streams;
+                tts_model.start_infer(slot,
+                                      {.phones = std::move(phones_ids),
+                                       .tones = std::move(tones),
+                                       .lang_ids = std::move(lang_ids),
+                                       .phone_level_feature = std::move(phone_level_feature),
+                                       .speed = speed,
+                                       .speaker_id = speaker_id,
+                                       .disable_bert = this->_disable_bert});
+                running.push_back(slot);
+                continue;
+            } else if (tts_model.is_split()) {
+                OpenVoiceTTS::Input input{.phones = std::move(phones_ids),
+                                          .tones = std::move(tones),
+                                          .lang_ids = std::move(lang_ids),
+                                          .phone_level_feature = std::move(phone_level_feature),
+                                          .speed = speed,
+                                          .speaker_id = speaker_id,
+                                          .disable_bert = this->_disable_bert};
+                tts_model.tts_infer_chunks(input, [&](std::vector<float>& chunk, bool last) {
+                    on_audio(chunk, last);
+                    if (!last)
+                        control.check("TTS");
+                });
+                continue;
+            } else {
+                wav_data = tts_model.tts_infer(phones_ids,
+                                               tones,
+                                               lang_ids,
+                                               phone_level_feature,
+                                               speed,
+                                               speaker_id,
+                                               this->_disable_bert);
+            }
 
-            audio_concat(output_audio, wav_data, speed, sampling_rate_);
-            std::cout << "[INFO] preProcess Time: " << preProcess << "ms, including the time for BERT inference.\n";
+            on_audio(wav_data, true);
+        }
+        while (!running.empty())
+            finish_oldest();
+        // release memory buffer, the shared models of the scheduler keep theirs for the other instances
+        if (!_scheduler) {
+            tts_model.release_infer_memory();
+            if (!_disable_bert)
+                bert_model.release_infer_memory();
         }
-        // release memory buffer
-        tts_model.release_infer_memory();
-        if (!_disable_bert)
-            bert_model.release_infer_memory();
+    } catch (const Cancelled&) {
+        throw;
     } catch (const std::runtime_error& e) {
         std::cerr << "std::runtime_error: " << e.what() << std::endl;
 
@@ -292,45 +550,66 @@ void TTS::tts_to_file(const std::string& text,
     }
 }
 
-void TTS::tts_to_file(const std::vector<std::string>& texts,
-                      const std::string& output_filename,
-                      const int& speaker_id,
-                      const float& speed,
-                      const float& sdp_ratio,
-                      const float& noise_scale,
-                      const float& noise_scale_w) {
-    std::vector<float> audio;
-    for (const auto& text : texts) {
-        if (text.empty())
-            continue;
-        tts_to_file(text, audio, speaker_id, speed, sdp_ratio, noise_scale, noise_scale_w);
+std::vector<std::string> TTS::split_text(const std::string& text, const RequestControl& control) {
+    control.check("normalization");
+    std::string norm_text = text;
+    // We place English text normalization before sentence splitting.
+    // For English, we need to address cases involving abbreviations like "Mr." and scientific notation.
+    // If normalization is applied after sentence splitting, it may prematurely process periods and commas, which
+    // could lead to issues.
+    if (this->_language == "EN") {
+        norm_text = _language_module->text_normalize(text);
     }
-#ifdef USE_DEEPFILTERNET
-    if (!_disable_nf) {
-        std::cout << "TTS::TTS : Process audio by noise filter.\n";
-        auto nf_time_1 = std::chrono::high_resolution_clock::now();
-        nf.proc(audio);
-        auto nf_time_2 = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> nf_time_duration = nf_time_2 - nf_time_1;
-        std::cout << "TTS::TTS : [NF][DFNet] process time:" << nf_time_duration.count() << " seconds" << std::endl;
-    }
-#endif  // USE_DEEPFILTERNET
-    write_wave(output_filename, audio, sampling_rate_);
+    return split_sentences_into_pieces(norm_text, false);
 }
+
 std::tuple<std::vector<std::vector<float>>, std::vector<int64_t>, std::vector<int64_t>, std::vector<int64_t>>
-TTS::get_text_for_tts_infer(const std::string& text) {
+TTS::get_text_for_tts_infer(const std::string& text, const RequestControl& control) {
+    SentenceFrontEnd sentence = front_end(text, control, true);
+    if (sentence.phones_ids.empty())
+        return {};
+    try {
+        auto phone_level_feature = sentence.phone_level_feature ? std::move(*sentence.phone_level_feature)
+                                                                : bert_feature(sentence, control);
+        return {phone_level_feature, sentence.phones_ids, sentence.tones, sentence.lang_ids};
+    } catch (const Cancelled&) {
+        throw;
+    } catch (const std::exception& e) {
+        std::cerr << "std::exception: " << e.what() << std::endl;
+    }
+    return {};
+}
+
+TTS::SentenceFrontEnd TTS::front_end(const std::string& text, const RequestControl& control, bool overlap_bert) {
+    // a BERT request left running by an error is cancelled before its input buffers are reused
+    struct BertGuard {
+        Bert* model = nullptr;
+        ~BertGuard() {
+            if (model)
+                model->cancel_bert_feature();
+        }
+    } bert_guard;
     try {
         // std::string norm_text = _language_module->text_normalize(text);
-        auto [phones_list, tones_list, word2ph_list] = _language_module->g2p(text, ov_tokenizer);
-        auto [phones_ids, tones, lang_ids, word2ph] =
+        control.check("G2P");
+        SentenceFrontEnd sentence;
+        // BERT needs the tokenization only, G2P reuses it and provides word2ph for the expansion to phone level
+        if (overlap_bert && !_disable_bert && !_scheduler) {
+            sentence.tokenized = ov_tokenizer->encode(text);
+            control.check("BERT");
+            bert_model.start_bert_feature(sentence.tokenized);
+            bert_guard.model = &bert_model;
+        }
+        auto [phones_list, tones_list, word2ph_list] = _language_module->g2p(text, ov_tokenizer, sentence.tokenized);
+        std::tie(sentence.phones_ids, sentence.tones, sentence.lang_ids, sentence.word2ph) =
             cleaned_text_to_sequence(_language_module, phones_list, tones_list, word2ph_list);
-
-        std::vector<std::vector<float>> phone_level_feature;
-        if (!_disable_bert) {
-            bert_model.get_bert_feature(text, word2ph, phone_level_feature);
-        } else
-            std::cout << " TTS::get_text_for_tts_infer:disable bert infer\n";
-        return {phone_level_feature, phones_ids, tones, lang_ids};
+        if (bert_guard.model) {
+            bert_guard.model = nullptr;
+            bert_model.wait_bert_feature(sentence.word2ph, sentence.phone_level_feature.emplace());
+        }
+        return sentence;
+    } catch (const Cancelled&) {
+        throw;
     } catch (const std::runtime_error& e) {
         std::cerr << "std::runtime_error: " << e.what() << std::endl;
 
@@ -341,97 +620,30 @@ TTS::get_text_for_tts_infer(const std::string& text) {
     }
     return {};
 }
-std::unordered_set<int> sentence_splitter = {
-    ',',
-    '.',
-    '!',
-    '?',
-    ';',
-};
-/*
- * @brief Splits a given text into pieces based on Chinese and English punctuation marks.
- * punctuation marks inlucde {
-    "，", "。", "！", "？", "、", "；", "：", "“", "”", "‘", "’", "（", "）", "【", "】", "《", "》", "——", "……", "·",
-    ",", ".", "!", "?", ";", ":", "\"", "\"", "'", "'", "(", ")", "[", "]", "<", ">", "-", "...", ".", "\n", "\t", "\r",
-    };
-   std::unordered_set<std::string> sentence_splitter = {
-       "，", "。", "！", "？","；",
-       ",", ".", "!", "?", ";",
-    };
-    std::unordered_set<std::string> spaces = {
-        "\n", "\t", "\r",
-    };
- * 1. sentence_splitter is split flag; space is space flag; all other punctuaiton marks are filtered
- * 2. In order to keep English word segmentation, whitespace is not included in punctuation marks.
- * 3. If you want to update the puncuation, please use darts.h file (see tests/test_darts.cpp as an example)
-*/
-std::vector<std::string> TTS::split_sentences_zh(const std::string& text, size_t min_len) {
-    std::vector<std::string> sentences;
-    int n = text.length();
-    int MAX_HIT = 1;
-    std::string tmp;
-    for (int i = 0; i < n;) {
-        const char* query = text.data() + i;
-        std::vector<Darts::DoubleArray::result_pair_type> results(MAX_HIT);
-        size_t num_matches = _da.commonPrefixSearch(query, results.data(), MAX_HIT);
-        if (!num_matches) {
-            tmp += text[i++];
-        } else if ((text[i] == ',' || text[i] == '.') && i > 0 && i < n &&
-                   std::isdigit(static_cast<int>(text[i - 1])) && std::isdigit(static_cast<int>(text[i + 1]))) {
-            if (text[i] == '.')
-                tmp += ".";  // Keep the decimal point here for subsequent text normalization processing.
-            i += results.front().length;
-        } else if (text[i] == '.' && i + 3 < n && text.substr(i + 1, 3) == "com") {
-            tmp += ".";  // Special workaround for .com
-            i += results.front().length;
-        } else if (sentence_splitter.contains(results.front().value)) {  // text splitter
-            tmp += static_cast<char>(results.front().value);
-            sentences.emplace_back(std::move(tmp));
-            tmp.clear();
-            i += results.front().length;
-        } else if (results.front().value == 3 ||
-                   results.front().value == 0) {  // space it is meaningful to english words
-            tmp += " ";
-            i += results.front().length;
-        } else {
-            tmp += static_cast<char>(results.front().value);
-            i += results.front().length;
-        }
-    }
-    if (tmp.size())
-        sentences.emplace_back(std::move(tmp));
 
-    std::vector<std::string> new_sentences;
-    size_t count_len = 0;
-    std::string new_sent;
-    int m = sentences.size();
-    for (int i = 0; i < m; ++i) {
-        new_sent += sentences[i] + " ";
-        count_len += str_len(sentences[i]);
-        if (count_len > min_len || i == m - 1) {
-            if (new_sent.back() == ' ')
-                new_sent.pop_back();
-            // new_sent it self is only one piece and it is space, then skip
-            if (!std::all_of(new_sent.begin(), new_sent.end(), [&](char& ch) {
-                    return ch == ' ';
-                }))
-                new_sentences.emplace_back(std::move(new_sent));
-            new_sent.clear();
-            count_len = 0;
-        }
+std::vector<std::vector<float>> TTS::bert_feature(const SentenceFrontEnd& sentence, const RequestControl& control) {
+    std::vector<std::vector<float>> phone_level_feature;
+    if (_disable_bert) {
+        std::cout << " TTS::get_text_for_tts_infer:disable bert infer\n";
+        return phone_level_feature;
     }
-    // merge_short_sentences_zh
-    // here we fix use the default min_len, so only need to check if the len(new_sentences[-1])<= 2 ;consistent with the
-    // Python code
-    if (new_sentences.size() >= 2 && str_len(new_sentences.back()) <= 2) {
-        new_sentences[new_sentences.size() - 2] += new_sentences.back();
-        new_sentences.pop_back();
-    }
-    return new_sentences;
+    control.check("BERT");
+    if (_scheduler)
+        phone_level_feature = _scheduler->bert(sentence.tokenized, sentence.word2ph, control);
+    else
+        bert_model.get_bert_feature(sentence.tokenized, sentence.word2ph, phone_level_feature);
+    return phone_level_feature;
 }
-
+// Split text into sentences and group them into chunks by estimated phonemes according to _chunk_policy.
+// The chunks are views into text until they are materialized here with the punctuation mapped.
 std::vector<std::string> TTS::split_sentences_into_pieces(const std::string& text, bool quiet) {
-    auto pieces = split_sentences_zh(text);
+    std::vector<std::string> pieces;
+    for (std::string_view chunk : SentenceSplitter::chunk(text, _chunk_policy)) {
+        std::string piece = SentenceSplitter::clean(chunk);
+        // skip the chunks left with spaces only, e.g. a pair of brackets
+        if (piece.find_first_not_of(' ') != std::string::npos)
+            pieces.emplace_back(std::move(piece));
+    }
     if (!quiet) {
         std::cout << " > Text split to sentences." << std::endl;
         for (const auto& piece : pieces) {
@@ -455,57 +667,16 @@ void TTS::audio_concat(std::vector<float>& output,
                        const float& speed,
                        const int32_t& sampling_rate) {
     output.insert(output.end(), segment.begin(), segment.end());
-    int interval =
-        static_cast<int>(std::lroundf(0.05f * sampling_rate / speed));  // Insert 0.05 seconds of silent audio
-    output.insert(output.end(), interval, 0.0);
+    output.insert(output.end(), silence_interval(speed, sampling_rate), 0.0);
+}
+// Insert 0.05 seconds of silent audio between sentences
+size_t TTS::silence_interval(const float& speed, const int32_t& sampling_rate) {
+    return static_cast<size_t>(std::lroundf(0.05f * sampling_rate / speed));
 }
 void TTS::write_wave(const std::string& output_filename, const std::vector<float>& wave, const int32_t& sampling_rate) {
-    try {
-        size_t n = wave.size();
-        melo::WaveHeader header;
-        header.chunk_id = 0x46464952;      // FFIR
-        header.format = 0x45564157;        // EVAW
-        header.subchunk1_id = 0x20746d66;  // "fmt "
-        header.subchunk1_size = 16;        // 16 for PCM
-        header.audio_format = 1;           // PCM =1
-
-        int32_t num_channels = 1;
-        int32_t bits_per_sample = 16;  // int16_t
-        header.num_channels = num_channels;
-        header.sample_rate = sampling_rate;
-        header.byte_rate = sampling_rate * num_channels * bits_per_sample / 8;
-        header.block_align = num_channels * bits_per_sample / 8;
-        header.bits_per_sample = bits_per_sample;
-        header.subchunk2_id = 0x61746164;  // atad
-        header.subchunk2_size = n * num_channels * bits_per_sample / 8;
-
-        header.chunk_size = 36 + header.subchunk2_size;
-
-        std::vector<int16_t> samples_int16(n);
-        for (int32_t i = 0; i != n; ++i) {
-            samples_int16[i] = wave[i] * 32676;
-        }
-
-        std::ofstream os(output_filename, std::ios::binary);
-        if (!os) {
-            std::cout << "Failed to create " + output_filename << "\n";
-        }
-
-        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
-        os.write(reinterpret_cast<const char*>(samples_int16.data()), samples_int16.size() * sizeof(int16_t));
-
-        if (!os) {
-            std::cout << "Write " + output_filename + " failed.";
-        }
-        std::cout << "write wav to " << output_filename << std::endl;
-        return;
-    } catch (const std::runtime_error& e) {
-        std::cerr << "std::runtime_error: " << e.what() << std::endl;
-
-    } catch (const std::exception& e) {
-        std::cerr << "std::exception: " << e.what() << std::endl;
-    } catch (...) {
-        std::cerr << "Unknown exception caught" << std::endl;
-    }
+    WaveWriter writer(output_filename, sampling_rate);
+    writer.write(wave);
+    writer.close();
+    std::cout << "write wav to " << output_filename << std::endl;
 }
 }  // namespace melo
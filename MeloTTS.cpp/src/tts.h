@@ -19,20 +19,35 @@
 #ifndef TTS_H
 #define TTS_H
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
 
 #include "Jieba.hpp"
+#include "batch_scheduler.h"
 #include "bert.h"
-#include "darts.h"
 #include "language_modules/cmudict.h"
 #include "language_modules/language_module_base.h"
 #include "openvino_tokenizer.h"
 #include "openvoice_tts.h"
+#include "request_control.h"
+#include "sentence_splitter.h"
+#include "wave_writer.h"
+#include "work_stealing_pool.h"
 #ifdef USE_DEEPFILTERNET
 #   include "deepfilternet/noisefilter.h"
 #endif  // USE_DEEPFILTERNET
 namespace melo {
 class TTS {
 public:
+    // With a scheduler (see make_batch_scheduler) the BERT and TTS models are not compiled here: the sentences are
+    // batched with the ones of the other instances that share it
+    // Otherwise tts_streams > 1 compiles the TTS model for throughput with that many streams: the next sentences of a
+    // text are synthesized while the earlier ones still run, and are handed on in their order
+    // tts_chunk_ms > 0 loads the split export of the TTS model instead (see OpenVoiceTTS::has_split_models), which
+    // hands the audio of a sentence on in chunks of about that length as soon as each one is decoded, one sentence at a
+    // time whatever tts_streams is
+    // g2p_prewarm_words > 0 converts that many of the most frequent Chinese words at startup (see ChineseMix)
     explicit TTS(std::unique_ptr<ov::Core>& core,
         const std::filesystem::path& model_dir,
         const std::string& language,
@@ -43,9 +58,12 @@ public:
 #ifdef USE_DEEPFILTERNET
         const std::filesystem::path& nf_ir_path = {},
         const std::string& nf_device = "CPU",
-        bool disable_nf = false
+        bool disable_nf = false,
 #endif  // USE_DEEPFILTERNET
-    );
+        std::shared_ptr<BatchScheduler> scheduler = nullptr,
+        size_t tts_streams = 1,
+        size_t tts_chunk_ms = 0,
+        size_t g2p_prewarm_words = 0);
 
     [[deprecated("Use another constructor instead")]]
     explicit TTS(std::unique_ptr<ov::Core>& core,
@@ -60,7 +78,7 @@ public:
 #endif  // USE_DEEPFILTERNET
                  const std::filesystem::path& tokenizer_runtime_path,
                  const std::filesystem::path& tokenizer_model_folder,
-                 const std::filesystem::path& punctuation_dict_path,
+                 const std::filesystem::path& punctuation_dict_path,  // unused, punctuation is built in
                  const std::string language,
                  bool disable_bert = false,
                  bool disable_nf = false);
@@ -90,8 +108,37 @@ public:
                      const float& sdp_ratio = 0.2f,
                      const float& noise_scale = 0.6f,
                      const float& noise_scale_w = 0.8f);
+    // Stream into writer. Every sentence is denoised and written on a worker thread while the next one is
+    // synthesized, so the memory used does not grow with the length of the text. The audio is resampled to
+    // writer.sample_rate(); the silence between sentences is inserted after the noise filter.
+    void tts_to_file(const std::string& text,
+                     WaveWriter& writer,
+                     const int& speaker_id,
+                     const float& speed = 1.0f,
+                     const float& sdp_ratio = 0.2f,
+                     const float& noise_scale = 0.6f,
+                     const float& noise_scale_w = 0.8f);
+    // control is checked before every stage of every sentence: once its token is cancelled this throws Cancelled,
+    // leaving writer with the sentences written so far. Its priority and deadline order the sentences on a shared
+    // BatchScheduler.
+    void tts_to_file(const std::vector<std::string>& texts,
+                     WaveWriter& writer,
+                     const int& speaker_id,
+                     const float& speed = 1.0f,
+                     const float& sdp_ratio = 0.2f,
+                     const float& noise_scale = 0.6f,
+                     const float& noise_scale_w = 0.8f,
+                     const RequestControl& control = {});
     std::vector<std::string> split_sentences_into_pieces(const std::string& text, bool quiet = false);
-    std::vector<std::string> split_sentences_zh(const std::string& text, size_t max_len = 10);
+    inline void set_chunk_policy(const ChunkPolicy& policy) {
+        _chunk_policy = policy;
+    }
+    // The front end (normalization, splitting, G2P) of the texts then runs on pool, a few sentences ahead of the
+    // models, which take the results in order. The pool may be shared by several instances. Without one it runs on
+    // the calling thread, one sentence at a time.
+    inline void set_front_end_pool(std::shared_ptr<WorkStealingPool> pool) {
+        _front_end_pool = std::move(pool);
+    }
     static void audio_concat(std::vector<float>& output,
                              std::vector<float>& segment,
                              const float& speed,
@@ -99,14 +146,57 @@ public:
     static void write_wave(const std::string& output_filename,
                            const std::vector<float>& wave,
                            const int32_t& sampling_rate);
+    static size_t silence_interval(const float& speed, const int32_t& sampling_rate);
+    // Compile the BERT and TTS models of model_dir once for the TTS instances that are given the result
+    static std::shared_ptr<BatchScheduler> make_batch_scheduler(std::unique_ptr<ov::Core>& core,
+                                                                const std::filesystem::path& model_dir,
+                                                                const std::string& language,
+                                                                const std::string& tts_device,
+                                                                const bool tts_quantize,
+                                                                const std::string& bert_device,
+                                                                bool disable_bert,
+                                                                const BatchScheduler::Options& options);
     static constexpr int32_t sampling_rate_ = 44100;
     static const std::map<std::string, std::map<int, std::string>> speaker_ids;
 
 protected:
     std::tuple<std::vector<std::vector<float>>, std::vector<int64_t>, std::vector<int64_t>, std::vector<int64_t>>
-    get_text_for_tts_infer(const std::string& text);
+    get_text_for_tts_infer(const std::string& text, const RequestControl& control = {});
+    // the part of get_text_for_tts_infer before BERT, which may run on several threads at once
+    struct SentenceFrontEnd {
+        std::vector<int64_t> phones_ids, tones, lang_ids;
+        std::vector<int> word2ph;
+        TokenizedText tokenized;
+        std::optional<std::vector<std::vector<float>>> phone_level_feature;  // set when BERT ran along with G2P
+    };
+    // With overlap_bert, BERT of this instance starts on the tokenization before G2P and is joined after it, so the
+    // two run at the same time. Only for the thread that owns bert_model, it is ignored with a scheduler.
+    SentenceFrontEnd front_end(const std::string& text, const RequestControl& control = {}, bool overlap_bert = false);
+    std::vector<std::vector<float>> bert_feature(const SentenceFrontEnd& sentence, const RequestControl& control = {});
+    // Normalize, split and synthesize texts, on_audio receives the audio of every sentence in order, in several chunks
+    // with a split TTS model; sentence_end is set for the last one of a sentence. Errors are reported and swallowed,
+    // except Cancelled; a sentence whose front end fails is skipped.
+    void synthesize(const std::vector<std::string>& texts,
+                    const std::function<void(std::vector<float>& wav_data, bool sentence_end)>& on_audio,
+                    const int& speaker_id,
+                    const float& speed,
+                    const float& sdp_ratio,
+                    const float& noise_scale,
+                    const float& noise_scale_w,
+                    const RequestControl& control = {});
 
 private:
+    // the IR files of the TTS and BERT models for language
+    // the front end of one text up to the sentences
+    std::vector<std::string> split_text(const std::string& text, const RequestControl& control);
+    static constexpr size_t FRONT_END_AHEAD_PER_THREAD = 4;  // sentences in flight on the front end pool
+
+    static std::pair<std::filesystem::path, std::filesystem::path> model_ir_paths(
+        const std::filesystem::path& model_dir,
+        const std::string& language,
+        const bool tts_quantize,
+        const std::string& bert_device);
+
     std::shared_ptr<OpenVinoTokenizer> ov_tokenizer;
     Bert bert_model;
     OpenVoiceTTS tts_model;
@@ -114,10 +204,13 @@ private:
     NoiseFilter nf;
 #endif  // USE_DEEPFILTERNET
     std::string _language;
-    Darts::DoubleArray _da;  // punctuation dict use to split sentence
+    ChunkPolicy _chunk_policy;  // sentence grouping, a small first chunk for a short time to first audio
     bool _disable_bert;
     bool _disable_nf;
     std::shared_ptr<AbstractLanguageModule> _language_module;
+    std::shared_ptr<BatchScheduler> _scheduler;  // runs bert_model and tts_model instead when set
+    size_t _tts_streams = 1;                     // the sentences in flight on tts_model
+    std::shared_ptr<WorkStealingPool> _front_end_pool;
 };
 }  // namespace melo
 
@@ -0,0 +1,97 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "unicode_data.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "utf8_utils.h"
+
+namespace melo::unicode {
+namespace {
+struct CodePointRange {
+    char32_t first, last;
+};
+struct NormalizedCodePoint {
+    char32_t code_point;
+    const char* utf8;
+};
+
+#include "unicode_data_tables.inc"
+
+template <size_t N>
+bool in_ranges(const CodePointRange (&ranges)[N], char32_t code_point) {
+    const auto iter = std::upper_bound(
+        std::begin(ranges), std::end(ranges), code_point, [](char32_t cp, const auto& r) { return cp < r.first; });
+    return iter != std::begin(ranges) && code_point <= std::prev(iter)->last;
+}
+
+constexpr char32_t HANGUL_FIRST = 0xAC00, HANGUL_LAST = 0xD7A3;
+constexpr char32_t JAMO_L = 0x1100, JAMO_V = 0x1161, JAMO_T = 0x11A7;
+constexpr char32_t JAMO_V_COUNT = 21, JAMO_T_COUNT = 28;
+}  // namespace
+
+bool is_punctuation(char32_t code_point) {
+    if (code_point < 0x80)
+        return utf8::classify(code_point) == utf8::CharClass::Punct;
+    return in_ranges(PUNCTUATION, code_point);
+}
+
+bool is_whitespace(char32_t code_point) {
+    if (code_point < 0x80)
+        return code_point == ' ' || code_point == '\t' || code_point == '\n' || code_point == '\r';
+    return in_ranges(WHITESPACE, code_point);
+}
+
+bool is_control(char32_t code_point) {
+    if (code_point < 0x80)
+        return (code_point < 0x20 && code_point != '\t' && code_point != '\n' && code_point != '\r') ||
+               code_point == 0x7F;
+    return in_ranges(CONTROL, code_point);
+}
+
+bool is_chinese_char(char32_t code_point) {
+    return (code_point >= 0x4E00 && code_point <= 0x9FFF) || (code_point >= 0x3400 && code_point <= 0x4DBF) ||
+           (code_point >= 0x20000 && code_point <= 0x2A6DF) || (code_point >= 0x2A700 && code_point <= 0x2B73F) ||
+           (code_point >= 0x2B740 && code_point <= 0x2B81F) || (code_point >= 0x2B820 && code_point <= 0x2CEAF) ||
+           (code_point >= 0xF900 && code_point <= 0xFAFF) || (code_point >= 0x2F800 && code_point <= 0x2FA1F);
+}
+
+void append_normalized(std::string& output, char32_t code_point) {
+    if (code_point < 0x80) {
+        output += static_cast<char>(utf8::to_lower_ascii(code_point));
+        return;
+    }
+    if (code_point >= HANGUL_FIRST && code_point <= HANGUL_LAST) {
+        const char32_t index = code_point - HANGUL_FIRST;
+        utf8::append(output, JAMO_L + index / (JAMO_V_COUNT * JAMO_T_COUNT));
+        utf8::append(output, JAMO_V + index % (JAMO_V_COUNT * JAMO_T_COUNT) / JAMO_T_COUNT);
+        if (index % JAMO_T_COUNT != 0)
+            utf8::append(output, JAMO_T + index % JAMO_T_COUNT);
+        return;
+    }
+    const auto iter = std::lower_bound(std::begin(NORMALIZED),
+                                       std::end(NORMALIZED),
+                                       code_point,
+                                       [](const auto& n, char32_t cp) { return n.code_point < cp; });
+    if (iter != std::end(NORMALIZED) && iter->code_point == code_point)
+        output += iter->utf8;
+    else if (!in_ranges(NONSPACING, code_point))
+        utf8::append(output, code_point);
+}
+}  // namespace melo::unicode
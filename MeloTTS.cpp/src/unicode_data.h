@@ -0,0 +1,38 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef UNICODE_DATA_H
+#define UNICODE_DATA_H
+#include <string>
+
+// The character properties BERT's BasicTokenizer takes from Python's unicodedata, for the native WordPiece
+// tokenizer. The tables are generated by scripts/gen_unicode_data.py; ASCII is answered without them.
+namespace melo::unicode {
+// _is_punctuation: the ASCII symbols (e.g. '$', '^') and the categories P*
+bool is_punctuation(char32_t code_point);
+// _is_whitespace: '\t', '\n', '\r' and the category Zs, plus Zl and Zp that whitespace_tokenize splits on
+bool is_whitespace(char32_t code_point);
+// _is_control: the categories C* (unassigned code points included) but '\t', '\n' and '\r'
+bool is_control(char32_t code_point);
+// _is_chinese_char: the CJK Unified Ideographs blocks, not the Japanese and Korean scripts
+bool is_chinese_char(char32_t code_point);
+// Append code_point lowercased, NFD decomposed and without nonspacing marks (_run_strip_accents) as UTF-8,
+// e.g. 'É' -> "e", U+0301 -> "", Hangul syllables -> their jamo
+void append_normalized(std::string& output, char32_t code_point);
+}  // namespace melo::unicode
+#endif  // UNICODE_DATA_H
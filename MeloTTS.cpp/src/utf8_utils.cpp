@@ -0,0 +1,153 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "utf8_utils.h"
+
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define MELO_UTF8_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#    include <arm_neon.h>
+#    define MELO_UTF8_NEON
+#endif
+
+namespace melo::utf8 {
+namespace {
+constexpr uint64_t HIGH_BITS = 0x8080808080808080ULL;
+
+inline uint64_t load_u64(const char* p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+// number of bytes in word which are not 10xxxxxx
+inline size_t count_non_continuation(uint64_t word) {
+    // a byte is a continuation byte iff bit7 = 1 and bit6 = 0
+    const uint64_t continuation = word & ~(word << 1) & HIGH_BITS;
+    return 8 - std::popcount(continuation);
+}
+}  // namespace
+
+size_t ascii_prefix_length(std::string_view text) {
+    const char* data = text.data();
+    const size_t size = text.size();
+    size_t i = 0;
+#if defined(MELO_UTF8_SSE2)
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const int mask = _mm_movemask_epi8(chunk);  // high bit of every byte
+        if (mask != 0)
+            return i + std::countr_zero(static_cast<unsigned>(mask));
+    }
+#elif defined(MELO_UTF8_NEON)
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+        if (vmaxvq_u8(chunk) >= 0x80)
+            break;
+    }
+#endif
+    for (; i + 8 <= size; i += 8) {
+        const uint64_t high = load_u64(data + i) & HIGH_BITS;
+        if (high != 0)
+            return i + (std::countr_zero(high) >> 3);  // little endian
+    }
+    for (; i < size; ++i) {
+        if (static_cast<unsigned char>(data[i]) >= 0x80)
+            return i;
+    }
+    return size;
+}
+
+size_t length(std::string_view text) {
+    const char* data = text.data();
+    const size_t size = text.size();
+    size_t i = 0, count = 0;
+#if defined(MELO_UTF8_SSE2)
+    // continuation bytes are 0x80 - 0xBF, i.e. -128 ~ -65 as signed char
+    const __m128i threshold = _mm_set1_epi8(static_cast<char>(0xBF));
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const int mask = _mm_movemask_epi8(_mm_cmpgt_epi8(chunk, threshold));
+        count += std::popcount(static_cast<unsigned>(mask));
+    }
+#elif defined(MELO_UTF8_NEON)
+    const int8x16_t threshold = vdupq_n_s8(static_cast<int8_t>(0xBF));
+    for (; i + 16 <= size; i += 16) {
+        const int8x16_t chunk = vld1q_s8(reinterpret_cast<const int8_t*>(data + i));
+        const uint8x16_t is_lead = vshrq_n_u8(vcgtq_s8(chunk, threshold), 7);  // 1 or 0 per byte
+        count += vaddvq_u8(is_lead);
+    }
+#endif
+    for (; i + 8 <= size; i += 8)
+        count += count_non_continuation(load_u64(data + i));
+    for (; i < size; ++i) {
+        if ((static_cast<unsigned char>(data[i]) & 0xC0) != 0x80)
+            ++count;
+    }
+    return count;
+}
+
+std::vector<std::string_view> split_chars(std::string_view text) {
+    std::vector<std::string_view> res;
+    res.reserve(text.size());
+    for_each(text, [&](char32_t, size_t offset, size_t char_len) {
+        res.emplace_back(text.substr(offset, char_len));
+    });
+    return res;
+}
+
+std::wstring to_wstring(std::string_view text) {
+    std::wstring res;
+    res.reserve(text.size());
+    for_each(text, [&](char32_t code_point, size_t, size_t) {
+        if constexpr (sizeof(wchar_t) == 2) {
+            if (code_point >= 0x10000) {
+                code_point -= 0x10000;
+                res += static_cast<wchar_t>(0xD800 + (code_point >> 10));
+                res += static_cast<wchar_t>(0xDC00 + (code_point & 0x3FF));
+                return;
+            }
+        }
+        res += static_cast<wchar_t>(code_point);
+    });
+    return res;
+}
+
+std::string to_string(std::wstring_view text) {
+    std::string res;
+    res.reserve(text.size() * 3);
+    for (size_t i = 0; i < text.size(); ++i) {
+        char32_t code_point = static_cast<char32_t>(text[i]);
+        if constexpr (sizeof(wchar_t) == 2) {
+            if (code_point >= 0xD800 && code_point <= 0xDBFF && i + 1 < text.size()) {
+                const char32_t low = static_cast<char32_t>(text[i + 1]);
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                    ++i;
+                }
+            }
+        }
+        if (code_point > 0x10FFFF)
+            code_point = REPLACEMENT_CHARACTER;
+        append(res, code_point);
+    }
+    return res;
+}
+}  // namespace melo::utf8
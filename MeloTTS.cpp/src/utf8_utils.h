@@ -0,0 +1,181 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef UTF8_UTILS_H
+#define UTF8_UTILS_H
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// This module is the only UTF-8 decoder of the program. Text is kept as UTF-8 std::string_view wherever possible;
+// runs of ASCII are skipped 16 bytes at a time with SSE2/NEON (8 bytes at a time with plain 64-bit words otherwise).
+//
+// Unicode Range (Hexadecimal)       UTF-8 Encoding (Binary)
+// ----------------------------------------------------------
+// 0000 0000 ~ 0000 007F             0xxxxxxx
+// 0000 0080 ~ 0000 07FF             110xxxxx 10xxxxxx
+// 0000 0800 ~ 0000 FFFF             1110xxxx 10xxxxxx 10xxxxxx
+// 0001 0000 ~ 0010 FFFF             11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+//
+// The number of leading 1 bits in the first byte is the number of bytes the character occupies.
+// e.g. "一" is U+4E00 = 100 1110 0000 0000, encoded as 1110'0100 10'111000 10'000000 (E4 B8 80).
+// Ref https://sf-zhou.github.io/programming/chinese_encoding.html
+namespace melo::utf8 {
+inline constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+enum class CharClass : uint8_t {
+    Other = 0,
+    Space,      // ' ', \t, \n, \r, \v, \f and U+3000
+    Digit,      // 0-9
+    Upper,      // A-Z
+    Lower,      // a-z
+    Punct,      // ASCII punctuation
+    Cjk,        // U+4E00 - U+9FA5, the range accepted by the Chinese front end
+    CjkPunct,   // CJK symbols and punctuation U+3001 - U+303F, full-width forms U+FF00 - U+FFEF
+};
+
+namespace detail {
+constexpr std::array<CharClass, 128> make_ascii_class_table() {
+    std::array<CharClass, 128> table{};
+    for (int ch = 0; ch < 128; ++ch) {
+        if (ch == ' ' || (ch >= '\t' && ch <= '\r'))
+            table[ch] = CharClass::Space;
+        else if (ch >= '0' && ch <= '9')
+            table[ch] = CharClass::Digit;
+        else if (ch >= 'A' && ch <= 'Z')
+            table[ch] = CharClass::Upper;
+        else if (ch >= 'a' && ch <= 'z')
+            table[ch] = CharClass::Lower;
+        else if (ch > ' ' && ch < 127)
+            table[ch] = CharClass::Punct;
+    }
+    return table;
+}
+inline constexpr std::array<CharClass, 128> ASCII_CLASS = make_ascii_class_table();
+}  // namespace detail
+
+inline CharClass classify(char32_t code_point) {
+    if (code_point < 0x80)
+        return detail::ASCII_CLASS[code_point];
+    if (code_point >= 0x4E00 && code_point <= 0x9FA5)
+        return CharClass::Cjk;
+    if (code_point == 0x3000)
+        return CharClass::Space;
+    if ((code_point > 0x3000 && code_point <= 0x303F) || (code_point >= 0xFF00 && code_point <= 0xFFEF))
+        return CharClass::CjkPunct;
+    return CharClass::Other;
+}
+
+inline char32_t to_lower_ascii(char32_t code_point) {
+    return (code_point >= 'A' && code_point <= 'Z') ? code_point + ('a' - 'A') : code_point;
+}
+
+// @brief Decode one character starting at pos. Returns the code point and stores the number of bytes consumed in
+// length. Malformed or truncated sequences decode to U+FFFD and consume one byte, so decoding never stalls.
+inline char32_t decode(std::string_view text, size_t pos, size_t& length) {
+    const auto* s = reinterpret_cast<const unsigned char*>(text.data()) + pos;
+    const size_t remain = text.size() - pos;
+    const unsigned char first_byte = s[0];
+    length = 1;
+    if (first_byte < 0x80)
+        return first_byte;
+    size_t n = 0;
+    char32_t code_point = 0;
+    if ((first_byte & 0xE0) == 0xC0) {
+        n = 2;
+        code_point = first_byte & 0x1F;
+    } else if ((first_byte & 0xF0) == 0xE0) {
+        n = 3;
+        code_point = first_byte & 0x0F;
+    } else if ((first_byte & 0xF8) == 0xF0) {
+        n = 4;
+        code_point = first_byte & 0x07;
+    } else {
+        return REPLACEMENT_CHARACTER;
+    }
+    if (n > remain)
+        return REPLACEMENT_CHARACTER;
+    for (size_t i = 1; i < n; ++i) {
+        if ((s[i] & 0xC0) != 0x80)
+            return REPLACEMENT_CHARACTER;
+        code_point = (code_point << 6) | (s[i] & 0x3F);
+    }
+    length = n;
+    return code_point;
+}
+
+// @brief Append the UTF-8 encoding of code_point to output
+inline void append(std::string& output, char32_t code_point) {
+    if (code_point < 0x80) {
+        output += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        output += static_cast<char>(0xC0 | (code_point >> 6));
+        output += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        output += static_cast<char>(0xE0 | (code_point >> 12));
+        output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        output += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        output += static_cast<char>(0xF0 | (code_point >> 18));
+        output += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        output += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+// @brief Number of leading bytes of text that are ASCII (SIMD)
+size_t ascii_prefix_length(std::string_view text);
+inline bool is_ascii(std::string_view text) {
+    return ascii_prefix_length(text) == text.size();
+}
+
+// @brief Number of characters, mimics Python's len(). Every letter, Chinese character, punctuation and space is
+// one unit of length. Counts the bytes which are not continuation bytes (SIMD).
+size_t length(std::string_view text);
+
+// @brief Call func(code_point, byte_offset, byte_length) for every character of text.
+// Runs of ASCII are detected with ascii_prefix_length and dispatched without decoding.
+template <typename Func>
+void for_each(std::string_view text, Func&& func) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const size_t ascii_end = pos + ascii_prefix_length(text.substr(pos));
+        for (; pos < ascii_end; ++pos)
+            func(static_cast<char32_t>(text[pos]), pos, size_t(1));
+        if (pos >= text.size())
+            break;
+        size_t char_len = 0;
+        const char32_t code_point = decode(text, pos, char_len);
+        func(code_point, pos, char_len);
+        pos += char_len;
+    }
+}
+
+// @brief Split text into characters, e.g. 右值的生命周期 -> {右,值,的,生,命,周,期}
+// The returned views point into text.
+std::vector<std::string_view> split_chars(std::string_view text);
+
+// Conversions for the wregex based text normalizer, replacing the deprecated std::wstring_convert.
+// wchar_t is UTF-32 on Linux and UTF-16 on Windows, surrogate pairs are handled on the latter.
+std::wstring to_wstring(std::string_view text);
+std::string to_string(std::wstring_view text);
+}  // namespace melo::utf8
+
+#endif  // UTF8_UTILS_H
@@ -64,26 +64,6 @@ std::vector<std::string> read_file_lines(const std::filesystem::path& file_path)
     return lines;
 }
 
-/**
- * helper function splits a UTF-8 encoded string containing only Chinese characters
- * e.g. 右值的生命周期 -> {右,值,的,生,命,周,期,}
- * (excluding punctuation and English letters) into individual Chinese characters.
- */
-std::vector<std::string> split_utf8_chinese(const std::string& str) {
-    std::vector<std::string> res;  // chinese characters
-    int strSize = str.size();
-    int i = 0;
-
-    while (i < strSize) {
-        int len = 1;
-        for (int j = 0; j < 6 && (str[i] & (0x80 >> j)); j++) {
-            len = j + 1;
-        }
-        res.push_back(str.substr(i, len));
-        i += len;
-    }
-    return res;
-}
 // torch.mean(res, dim=1)
 // This fuction computes the average of all columns in each row, resulting in a tensor that only has the row dimension
 // remaining
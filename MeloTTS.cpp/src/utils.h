@@ -69,33 +69,6 @@ std::vector<float> cal_row_variance(const ov::Tensor& tensor_2d, bool print_shap
 
 std::vector<std::string> read_file_lines(const std::filesystem::path& file_path);
 
-std::vector<std::string> split_utf8_chinese(const std::string& str);
-
-// This function mimics Python's len() function.
-// It counts each character, treating both letters, Chinese characters and space as 1 unit of length.
-// use utf-8 Chinese characters
-// no punctuation here!
-inline size_t str_len(const std::string& s) {
-    int strSize = s.size();
-    int i = 0;
-    int cnt = 0;
-    while (i < strSize) {
-        // English letters
-        if (s[i] <= 'z' && s[i] >= 'a' || s[i] <= 'Z' && s[i] >= 'A') {
-            ++cnt;
-            ++i;
-        } else {  // Chinese characters
-            int len = 1;
-            for (int j = 0; j < 6 && (s[i] & (0x80 >> j)); j++) {
-                len = j + 1;
-            }
-            ++cnt;
-            i += len;
-        }
-    }
-    return cnt;
-}
-
 // function to get profiling info, used after inference with config "device_config[ov::enable_profiling.name()] =
 // false;" Refer to
 // https://github.com/sammysun0711/ov_llm_bench/blob/6a03a1aacab550ec7e3b84948abf1c7fe186e652/inference_engine.py#L215-L220
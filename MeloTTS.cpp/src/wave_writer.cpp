@@ -0,0 +1,179 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "wave_writer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#ifdef _WIN32
+#    include <fcntl.h>
+#    include <io.h>
+#endif
+
+namespace melo {
+WaveWriter::WaveWriter(const std::filesystem::path& path,
+                       int32_t sample_rate,
+                       Format format,
+                       const pcm::ConvertOptions& options)
+    : _options(options),
+      _format(format),
+      _sample_rate(sample_rate),
+      _path(path.string()) {
+    _to_stdout = _path == STDOUT_PATH;
+    if (_to_stdout) {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        _sink = [](const void* data, size_t size) { return std::fwrite(data, 1, size, stdout) == size; };
+        _open = true;
+    } else {
+        _file.open(path, std::ios::binary | std::ios::trunc);
+        _open = _file.is_open();
+        if (!_open) {
+            std::cerr << "[ERROR] WaveWriter: Failed to create " << _path << "\n";
+            return;
+        }
+    }
+    write_header();
+}
+
+WaveWriter::WaveWriter(Sink sink, int32_t sample_rate, Format format, const pcm::ConvertOptions& options)
+    : _options(options),
+      _sink(std::move(sink)),
+      _open(static_cast<bool>(_sink)),
+      _format(format),
+      _sample_rate(sample_rate),
+      _path("<stream>") {
+    write_header();
+}
+
+WaveWriter::~WaveWriter() {
+    close();
+}
+
+void WaveWriter::write_header() {
+    if (_format == Format::Wav) {
+        // sizes are patched on close, a stream that cannot be seeked keeps the maximum
+        const WaveHeader header = make_header(_sample_rate, _sink ? std::numeric_limits<uint32_t>::max() : 0);
+        write_bytes(&header, sizeof(header));
+    }
+}
+
+WaveHeader WaveWriter::make_header(int32_t sample_rate, uint32_t data_size) {
+    WaveHeader header;
+    header.chunk_id = 0x46464952;      // FFIR
+    header.format = 0x45564157;        // EVAW
+    header.subchunk1_id = 0x20746d66;  // "fmt "
+    header.subchunk1_size = 16;        // 16 for PCM
+    header.audio_format = 1;           // PCM =1
+
+    int32_t num_channels = 1;
+    int32_t bits_per_sample = 16;  // int16_t
+    header.num_channels = num_channels;
+    header.sample_rate = sample_rate;
+    header.byte_rate = sample_rate * num_channels * bits_per_sample / 8;
+    header.block_align = num_channels * bits_per_sample / 8;
+    header.bits_per_sample = bits_per_sample;
+    header.subchunk2_id = 0x61746164;  // atad
+    header.subchunk2_size = static_cast<int32_t>(data_size);
+    header.chunk_size = static_cast<int32_t>(data_size == std::numeric_limits<uint32_t>::max() ? data_size
+                                                                                                : 36 + data_size);
+    return header;
+}
+
+void WaveWriter::write_bytes(const void* data, size_t size) {
+    if (_sink) {
+        if (!_sink(data, size)) {
+            std::cerr << "[ERROR] WaveWriter: Write " << (_to_stdout ? "to stdout" : _path) << " failed.\n";
+            _open = false;
+        }
+    } else if (!_file.write(static_cast<const char*>(data), size)) {
+        std::cerr << "[ERROR] WaveWriter: Write " << _path << " failed.\n";
+        _open = false;
+    }
+}
+
+void WaveWriter::write(std::span<const float> samples) {
+    if (!_open)
+        return;
+    float scale = _options.gain * pcm::INT16_SCALE;
+    if (_options.normalize_peak > 0.0f) {
+        _peak = std::max(_peak, pcm::peak(samples));
+        if (_peak * _options.gain > _options.normalize_peak)
+            scale = _options.normalize_peak / _peak * pcm::INT16_SCALE;
+    }
+    for (size_t offset = 0; offset < samples.size(); offset += BLOCK_SIZE) {
+        const size_t n = std::min(BLOCK_SIZE, samples.size() - offset);
+        const float* noise = nullptr;
+        if (_options.dither) {
+            _dither.fill(std::span<float>(_noise.data(), n));
+            noise = _noise.data();
+        }
+        pcm::float_to_int16(samples.subspan(offset, n), _block, scale, noise);
+        write_bytes(_block.data(), n * sizeof(int16_t));
+    }
+    _num_samples += samples.size();
+}
+
+void WaveWriter::write_silence(size_t num_samples) {
+    if (!_open)
+        return;
+    _block.fill(0);
+    for (size_t remain = num_samples; remain > 0;) {
+        const size_t n = std::min(BLOCK_SIZE, remain);
+        write_bytes(_block.data(), n * sizeof(int16_t));
+        remain -= n;
+    }
+    _num_samples += num_samples;
+}
+
+void WaveWriter::close() {
+    if (!_open)
+        return;
+    _open = false;
+    if (_sink) {
+        if (_to_stdout)
+            std::fflush(stdout);
+        return;
+    }
+    if (_format == Format::Wav) {
+        const uint64_t data_size = static_cast<uint64_t>(_num_samples) * sizeof(int16_t);
+        const WaveHeader header = make_header(
+            _sample_rate,
+            static_cast<uint32_t>(std::min<uint64_t>(data_size, std::numeric_limits<uint32_t>::max() - 36)));
+        _file.seekp(0);
+        _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    _file.close();
+    if (!_file)
+        std::cerr << "[ERROR] WaveWriter: Write " << _path << " failed.\n";
+}
+
+WaveWriter::Format WaveWriter::parse_format(const std::string& name) {
+    if (name == "wav")
+        return Format::Wav;
+    if (name == "pcm")
+        return Format::Pcm;
+    throw std::invalid_argument("Unknown output format: " + name);
+}
+
+const char* WaveWriter::extension(Format format) {
+    return format == Format::Wav ? "wav" : "pcm";
+}
+}  // namespace melo
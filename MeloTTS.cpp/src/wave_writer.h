@@ -0,0 +1,104 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef WAVE_WRITER_H
+#define WAVE_WRITER_H
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <span>
+#include <string>
+
+#include "info_data.h"
+#include "pcm_convert.h"
+
+namespace melo {
+/**
+ * @brief Writes 16-bit mono PCM incrementally, so that only the block being converted is held in memory.
+ *
+ * Wav: a RIFF header with zero sizes is written on open, chunk_size and subchunk2_size are patched on close.
+ * Pcm: headerless little-endian int16 samples, e.g. for a downstream encoder.
+ * The path "-" writes to stdout, a Sink to any byte stream such as a socket. Neither can be seeked, so a WAV header
+ * there carries the maximum sizes, which readers of streamed WAV treat as "until the end of the stream".
+ * Samples are converted by melo::pcm with saturation. The audio is written as it comes, so options.normalize_peak is a
+ * running peak limit rather than a normalization: the scale is options.gain until a sample would exceed the limit,
+ * then normalize_peak over the loudest sample so far. It only ever drops, so the parts of one output never get
+ * different gains from the blocks they happen to be written in and quiet audio is never raised.
+ */
+class WaveWriter {
+public:
+    enum class Format { Wav, Pcm };
+    static constexpr const char* STDOUT_PATH = "-";
+    // receives the bytes as they are produced, returns false when the stream is broken, which closes the writer
+    using Sink = std::function<bool(const void* data, size_t size)>;
+
+    WaveWriter(const std::filesystem::path& path,
+               int32_t sample_rate,
+               Format format = Format::Wav,
+               const pcm::ConvertOptions& options = {});
+    WaveWriter(Sink sink, int32_t sample_rate, Format format = Format::Wav, const pcm::ConvertOptions& options = {});
+    ~WaveWriter();
+    WaveWriter(const WaveWriter&) = delete;
+    WaveWriter& operator=(const WaveWriter&) = delete;
+
+    inline bool is_open() const {
+        return _open;
+    }
+    // append float samples in [-1, 1]
+    void write(std::span<const float> samples);
+    void write_silence(size_t num_samples);
+    // flush, patch the header and close the output; called by the destructor as well
+    void close();
+
+    inline size_t num_samples() const {
+        return _num_samples;
+    }
+    inline int32_t sample_rate() const {
+        return _sample_rate;
+    }
+    inline Format format() const {
+        return _format;
+    }
+    static Format parse_format(const std::string& name);  // "wav" or "pcm"
+    static const char* extension(Format format);
+
+private:
+    static WaveHeader make_header(int32_t sample_rate, uint32_t data_size);
+    void write_header();
+    void write_bytes(const void* data, size_t size);
+
+    static constexpr size_t BLOCK_SIZE = 4096;  // samples converted at a time
+    std::array<int16_t, BLOCK_SIZE> _block;
+    std::array<float, BLOCK_SIZE> _noise;
+    pcm::ConvertOptions _options;
+    float _peak = 0.0f;  // of the samples written so far, for options.normalize_peak
+    pcm::Dither _dither;
+    std::ofstream _file;
+    Sink _sink;  // stdout or a stream, otherwise _file
+    bool _to_stdout = false;
+    bool _open = false;
+    Format _format;
+    int32_t _sample_rate;
+    size_t _num_samples = 0;
+    std::string _path;
+};
+}  // namespace melo
+#endif  // WAVE_WRITER_H
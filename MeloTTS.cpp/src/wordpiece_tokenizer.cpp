@@ -0,0 +1,240 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "wordpiece_tokenizer.h"
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+#include "unicode_data.h"
+#include "utf8_utils.h"
+
+namespace melo {
+WordPieceTokenizer::WordPieceTokenizer(const std::filesystem::path& vocab_path) {
+    std::ifstream file(vocab_path);
+    if (!file.is_open()) {
+        std::cerr << "[ERROR] WordPieceTokenizer: Could not open file " << vocab_path.string() << std::endl;
+        return;
+    }
+    std::vector<std::string> vocab;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        vocab.emplace_back(std::move(line));
+    }
+    build(vocab);
+    auto special_id = [&](std::string_view token, int64_t default_id) {
+        const int32_t id = token_to_id(token);
+        return id >= 0 ? id : default_id;
+    };
+    _unk_id = special_id("[UNK]", _unk_id);
+    _cls_id = special_id("[CLS]", _cls_id);
+    _sep_id = special_id("[SEP]", _sep_id);
+}
+
+void WordPieceTokenizer::build(const std::vector<std::string>& vocab) {
+    // pointer trie first, then flattened breadth first so that the children of a node are contiguous
+    struct TmpNode {
+        std::vector<std::pair<uint8_t, uint32_t>> children;
+        int32_t token_id = -1;
+    };
+    std::vector<TmpNode> nodes(2);  // ROOT, SUFFIX_ROOT
+    for (size_t id = 0; id < vocab.size(); ++id) {
+        std::string_view token = vocab[id];
+        uint32_t node = ROOT;
+        if (token.size() > 2 && token.starts_with("##")) {
+            node = SUFFIX_ROOT;
+            token.remove_prefix(2);
+        }
+        if (token.empty())
+            continue;
+        for (char ch : token) {
+            const uint8_t label = static_cast<uint8_t>(ch);
+            auto& children = nodes[node].children;
+            auto iter = std::find_if(children.begin(), children.end(), [&](const auto& kv) {
+                return kv.first == label;
+            });
+            if (iter != children.end()) {
+                node = iter->second;
+            } else {
+                children.emplace_back(label, static_cast<uint32_t>(nodes.size()));
+                node = static_cast<uint32_t>(nodes.size());
+                nodes.emplace_back();
+            }
+        }
+        if (nodes[node].token_id < 0)  // keep the first id of duplicated lines
+            nodes[node].token_id = static_cast<int32_t>(id);
+    }
+
+    // Breadth first numbering: every node but the two roots has exactly one incoming edge, and edges are numbered in
+    // the same order as the nodes they lead to, so the child reached through edge j is node j + 2.
+    _first_child.assign(1, 0);
+    _labels.clear();
+    _token_id.clear();
+    _first_child.reserve(nodes.size() + 1);
+    _labels.reserve(nodes.size());
+    _token_id.reserve(nodes.size());
+    std::deque<uint32_t> queue{ROOT, SUFFIX_ROOT};
+    while (!queue.empty()) {
+        TmpNode& node = nodes[queue.front()];
+        queue.pop_front();
+        std::sort(node.children.begin(), node.children.end());
+        for (const auto& [label, index] : node.children) {
+            _labels.push_back(label);
+            queue.push_back(index);
+        }
+        _first_child.push_back(static_cast<uint32_t>(_labels.size()));
+        _token_id.push_back(node.token_id);
+        std::vector<std::pair<uint8_t, uint32_t>>().swap(node.children);
+    }
+    _vocab_size = vocab.size();
+}
+
+uint32_t WordPieceTokenizer::child(uint32_t node, uint8_t label) const {
+    const auto begin = _labels.begin() + _first_child[node];
+    const auto end = _labels.begin() + _first_child[node + 1];
+    const auto iter = std::lower_bound(begin, end, label);
+    if (iter == end || *iter != label)
+        return NO_CHILD;
+    return static_cast<uint32_t>(iter - _labels.begin()) + 2;
+}
+
+int32_t WordPieceTokenizer::token_to_id(std::string_view token) const {
+    if (empty())
+        return -1;
+    uint32_t node = ROOT;
+    if (token.size() > 2 && token.starts_with("##")) {
+        node = SUFFIX_ROOT;
+        token.remove_prefix(2);
+    }
+    for (char ch : token) {
+        node = child(node, static_cast<uint8_t>(ch));
+        if (node == NO_CHILD)
+            return -1;
+    }
+    return _token_id[node];
+}
+
+// Greedy longest-match-first, the same as BERT's WordpieceTokenizer. A word that cannot be covered entirely by
+// vocabulary pieces becomes a single [UNK].
+void WordPieceTokenizer::encode_word(std::string_view word,
+                                     std::vector<std::string>& tokens,
+                                     std::vector<int64_t>& ids) const {
+    const size_t tokens_begin = tokens.size();
+    const size_t ids_begin = ids.size();
+    bool is_unknown = utf8::length(word) > MAX_INPUT_CHARS_PER_WORD;
+    size_t start = 0;
+    while (!is_unknown && start < word.size()) {
+        uint32_t node = start == 0 ? ROOT : SUFFIX_ROOT;
+        size_t best_end = 0;
+        int32_t best_id = -1;
+        for (size_t pos = start; pos < word.size(); ++pos) {
+            node = child(node, static_cast<uint8_t>(word[pos]));
+            if (node == NO_CHILD)
+                break;
+            if (_token_id[node] >= 0) {
+                best_end = pos + 1;
+                best_id = _token_id[node];
+            }
+        }
+        if (best_id < 0) {
+            is_unknown = true;
+            break;
+        }
+        std::string& token = tokens.emplace_back(start == 0 ? "" : "##");
+        token.append(word.substr(start, best_end - start));
+        ids.push_back(best_id);
+        start = best_end;
+    }
+    if (is_unknown) {
+        tokens.resize(tokens_begin);
+        ids.resize(ids_begin);
+        tokens.emplace_back("[UNK]");
+        ids.push_back(_unk_id);
+    }
+}
+
+void WordPieceTokenizer::encode(std::string_view text,
+                                std::vector<std::string>& tokens,
+                                std::vector<int64_t>& ids) const {
+    if (empty()) {
+        std::cerr << "[ERROR] WordPieceTokenizer::encode: vocabulary is not loaded\n";
+        return;
+    }
+    std::string word, normalized;
+    auto flush = [&]() {
+        if (!word.empty()) {
+            encode_word(word, tokens, ids);
+            word.clear();
+        }
+    };
+    utf8::for_each(text, [&](char32_t code_point, size_t, size_t) {
+        if (code_point == 0 || code_point == utf8::REPLACEMENT_CHARACTER || unicode::is_control(code_point))
+            return;
+        if (unicode::is_whitespace(code_point)) {
+            flush();
+            return;
+        }
+        normalized.clear();
+        unicode::append_normalized(normalized, code_point);
+        if (unicode::is_chinese_char(code_point)) {
+            flush();
+            encode_word(normalized, tokens, ids);
+            return;
+        }
+        // the punctuation split runs on the normalized characters
+        utf8::for_each(normalized, [&](char32_t ch, size_t offset, size_t char_len) {
+            if (unicode::is_punctuation(ch)) {
+                flush();
+                encode_word(std::string_view(normalized).substr(offset, char_len), tokens, ids);
+            } else {
+                word.append(normalized, offset, char_len);
+            }
+        });
+    });
+    flush();
+}
+
+std::vector<std::string> WordPieceTokenizer::word_segment(std::string_view text) const {
+    std::vector<std::string> tokens;
+    std::vector<int64_t> ids;
+    encode(text, tokens, ids);
+    return tokens;
+}
+
+void WordPieceTokenizer::encode(std::string_view text, TokenizedText& result) const {
+    result.clear();
+    result.tokens.emplace_back("[CLS]");
+    result.ids.push_back(_cls_id);
+    encode(text, result.tokens, result.ids);
+    result.tokens.emplace_back("[SEP]");
+    result.ids.push_back(_sep_id);
+    result.mark_words();
+}
+
+std::vector<int64_t> WordPieceTokenizer::tokenize(std::string_view text) const {
+    std::vector<std::string> tokens;
+    std::vector<int64_t> ids{_cls_id};
+    encode(text, tokens, ids);
+    ids.push_back(_sep_id);
+    return ids;
+}
+}  // namespace melo
@@ -0,0 +1,88 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef WORDPIECE_TOKENIZER_H
+#define WORDPIECE_TOKENIZER_H
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tokenized_text.h"
+
+namespace melo {
+/**
+ * @brief Native WordPiece tokenizer for the uncased BERT vocabularies ('bert-base-uncased',
+ * 'bert-base-multilingual-uncased'), loaded from the Hugging Face vocab.txt (one token per line, id = line number).
+ *
+ * The vocabulary is stored as two byte tries flattened into arrays, one for word-initial pieces and one for "##"
+ * continuation pieces, so greedy longest-match-first WordPiece is a single forward walk per piece and yields the
+ * subword strings and ids together.
+ *
+ * Pre-tokenization is BERT's BasicTokenizer with do_lower_case (see unicode_data.h): control characters are dropped,
+ * the text is split on whitespace, every Unicode punctuation mark and every CJK ideograph is a token of its own, and
+ * the characters are lowercased and NFD decomposed without their accents.
+ *
+ * Example:
+ * Input: 'compiler 世界 Café…'
+ * Output: tokens [comp, ##iler, 世, 界, cafe, …]
+ */
+class WordPieceTokenizer {
+public:
+    WordPieceTokenizer() = default;
+    explicit WordPieceTokenizer(const std::filesystem::path& vocab_path);
+
+    // Append the subwords of text and their ids, without [CLS] and [SEP]
+    void encode(std::string_view text, std::vector<std::string>& tokens, std::vector<int64_t>& ids) const;
+    // Subwords of text, e.g. "compiler" -> [comp, ##iler]
+    std::vector<std::string> word_segment(std::string_view text) const;
+    // Token ids of text as fed to BERT: [CLS] ... [SEP]
+    std::vector<int64_t> tokenize(std::string_view text) const;
+    // Ids, subwords and word boundaries of text, [CLS] and [SEP] included
+    void encode(std::string_view text, TokenizedText& result) const;
+
+    // id of a whole token as written in vocab.txt (e.g. "##iler"), -1 if absent
+    int32_t token_to_id(std::string_view token) const;
+    inline bool empty() const {
+        return _vocab_size == 0;
+    }
+    inline size_t size() const {
+        return _vocab_size;
+    }
+
+    static constexpr size_t MAX_INPUT_CHARS_PER_WORD = 100;  // longer words become [UNK], as in BERT
+
+private:
+    static constexpr uint32_t ROOT = 0;            // root of the word-initial trie
+    static constexpr uint32_t SUFFIX_ROOT = 1;     // root of the "##" continuation trie
+    static constexpr uint32_t NO_CHILD = UINT32_MAX;
+
+    void build(const std::vector<std::string>& vocab);
+    uint32_t child(uint32_t node, uint8_t label) const;
+    void encode_word(std::string_view word, std::vector<std::string>& tokens, std::vector<int64_t>& ids) const;
+
+    // Node i owns the children [_first_child[i], _first_child[i + 1]) of the flat arrays, sorted by label.
+    std::vector<uint32_t> _first_child;
+    std::vector<uint8_t> _labels;      // byte on the edge leading to child j
+    std::vector<int32_t> _token_id;    // token id ending at node i, -1 if none
+    size_t _vocab_size = 0;
+    int64_t _unk_id = 100, _cls_id = 101, _sep_id = 102;
+};
+}  // namespace melo
+#endif  // WORDPIECE_TOKENIZER_H
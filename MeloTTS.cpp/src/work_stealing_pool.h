@@ -0,0 +1,152 @@
+/**
+ * Copyright (C)    2024-2025    Tong Qiu (tong.qiu@intel.com)
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the 'License');
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace melo {
+/**
+ * @brief A thread pool with a task queue per worker, e.g. for the text front end of the sentences of a document.
+ * submit() deals the tasks out to the queues in turn, or onto the own queue of a worker that submits; a worker that
+ * runs out takes the tasks of the others, so that a few expensive sentences do not leave the other threads idle.
+ * Every queue runs its oldest task first, since the results are usually consumed in the order they were submitted.
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t num_threads) : _workers(std::max<size_t>(num_threads, 1)) {
+        _threads.reserve(_workers.size());
+        for (size_t i = 0; i < _workers.size(); ++i)
+            _threads.emplace_back([this, i] { run(i); });
+    }
+    // the tasks submitted already are run first
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(_sleep_mutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto& thread : _threads)
+            thread.join();
+    }
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // the future receives the result of task, or its exception
+    template <typename F>
+    std::future<std::invoke_result_t<std::decay_t<F>&>> submit(F&& task) {
+        using Result = std::invoke_result_t<std::decay_t<F>&>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        auto result = packaged->get_future();
+        push([packaged] { (*packaged)(); });
+        return result;
+    }
+
+    inline size_t size() const {
+        return _workers.size();
+    }
+    // the tasks run by another worker than the one they were given to
+    inline uint64_t num_stolen() const {
+        return _num_stolen.load(std::memory_order_relaxed);
+    }
+
+private:
+    using Task = std::function<void()>;
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task) {
+        const size_t target = _current_pool == this ? _current_worker
+                                                    : _next_worker.fetch_add(1, std::memory_order_relaxed) % size();
+        // counted before it is queued, so that taking it never finds the count at 0
+        {
+            std::lock_guard<std::mutex> lock(_sleep_mutex);
+            ++_num_queued;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_workers[target].mutex);
+            _workers[target].tasks.push_back(std::move(task));
+        }
+        _wake.notify_one();
+    }
+
+    // the own queue first, then the others starting with the next one
+    bool take(size_t self, Task& task) {
+        for (size_t offset = 0; offset < size(); ++offset) {
+            Worker& worker = _workers[(self + offset) % size()];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (worker.tasks.empty())
+                continue;
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+            if (offset > 0)
+                _num_stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void run(size_t self) {
+        _current_pool = this;
+        _current_worker = self;
+        while (true) {
+            Task task;
+            if (take(self, task)) {
+                {
+                    std::lock_guard<std::mutex> lock(_sleep_mutex);
+                    --_num_queued;
+                }
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(_sleep_mutex);
+            // a task counted but not queued yet is picked up on the next round
+            _wake.wait(lock, [this] { return _num_queued > 0 || _stopping; });
+            if (_num_queued == 0 && _stopping)
+                break;
+        }
+    }
+
+    std::vector<Worker> _workers;
+    std::atomic<size_t> _next_worker{0};
+    std::atomic<uint64_t> _num_stolen{0};
+    std::mutex _sleep_mutex;
+    std::condition_variable _wake;
+    size_t _num_queued = 0;  // under _sleep_mutex
+    bool _stopping = false;
+    std::vector<std::thread> _threads;  // last, started once the members above are constructed
+    // the pool and queue of the calling thread when it is a worker
+    static inline thread_local const WorkStealingPool* _current_pool = nullptr;
+    static inline thread_local size_t _current_worker = 0;
+};
+}  // namespace melo
+#endif  // WORK_STEALING_POOL_H
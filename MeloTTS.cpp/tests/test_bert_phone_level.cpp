@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "bert.h"
+#include "openvoice_tts.h"
+
+namespace {
+// [tokens, 768] BERT output, row i filled with i
+ov::Tensor bert_output(size_t tokens) {
+    ov::Tensor tensor(ov::element::f32, {tokens, melo::OpenVoiceTTS::JA_BERT_DIM});
+    const size_t dim = melo::OpenVoiceTTS::JA_BERT_DIM;
+    float* data = tensor.data<float>();
+    for (size_t i = 0; i < tokens; ++i)
+        std::fill_n(data + i * dim, dim, static_cast<float>(i));
+    return tensor;
+}
+}  // namespace
+
+TEST(BertPhoneLevelTest, RepeatsEveryToken) {
+    std::vector<std::vector<float>> feature;
+    melo::Bert::to_phone_level(bert_output(3), {1, 2, 0}, feature);
+    ASSERT_EQ(feature.size(), 3);
+    EXPECT_EQ(feature[0].front(), 0.0f);
+    EXPECT_EQ(feature[1].front(), 1.0f);
+    EXPECT_EQ(feature[2].back(), 1.0f);
+
+    // the padding of a static shape model has no word2ph entries
+    feature.clear();
+    melo::Bert::to_phone_level(bert_output(8), {1, 1}, feature);
+    EXPECT_EQ(feature.size(), 2);
+}
+
+TEST(BertPhoneLevelTest, MismatchedWord2phThrows) {
+    std::vector<std::vector<float>> feature;
+    // one entry more than the tokens of the output
+    EXPECT_THROW(melo::Bert::to_phone_level(bert_output(3), {1, 1, 1, 1}, feature), std::runtime_error);
+    EXPECT_TRUE(feature.empty());
+
+    // phone level features that do not match the phones never reach the ja_bert input
+    std::vector<float> ja_bert;
+    melo::Bert::to_phone_level(bert_output(3), {1, 1, 1}, feature);
+    EXPECT_THROW(melo::OpenVoiceTTS::to_ja_bert(feature, 5, false, ja_bert), std::runtime_error);
+    feature.back().pop_back();
+    EXPECT_THROW(melo::OpenVoiceTTS::to_ja_bert(feature, 3, false, ja_bert), std::runtime_error);
+}
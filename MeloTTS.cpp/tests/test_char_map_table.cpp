@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "char_map_table.h"
+
+using text_normalization::CharMapTable;
+
+TEST(CharMapTableTest, IdentityByDefault) {
+    CharMapTable table;
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_EQ(table.translate(L"abc 中文 😀"), L"abc 中文 😀");
+}
+
+TEST(CharMapTableTest, SingleAndMultiCharReplacement) {
+    CharMapTable table;
+    table.set(L'１', L"1");
+    table.set(L'α', L"阿尔法");
+    table.set(L'@', L" at ");
+    EXPECT_EQ(table.size(), 3u);
+    EXPECT_EQ(table.translate(L"１α@b"), L"1阿尔法 at b");
+    EXPECT_TRUE(table.contains(L'α'));
+    EXPECT_FALSE(table.contains(L'b'));
+}
+
+TEST(CharMapTableTest, OverwriteAndReset) {
+    CharMapTable table;
+    table.set(L'x', L"y");
+    table.set(L'x', L"zz");
+    EXPECT_EQ(table.translate(L"x"), L"zz");
+    EXPECT_EQ(table.size(), 1u);
+    // mapping to itself removes the entry
+    table.set(L'x', L"x");
+    EXPECT_EQ(table.translate(L"x"), L"x");
+    EXPECT_EQ(table.size(), 0u);
+}
+
+TEST(CharMapTableTest, OverwriteReusesTheSlot) {
+    CharMapTable table;
+    table.set(L'x', L"abc");
+    table.set(L'y', L"d");
+    const size_t pool_size = table.pool_size();
+    table.set(L'x', L"zz");
+    table.set(L'x', L"x");
+    table.set(L'x', L"uvw");
+    EXPECT_EQ(table.pool_size(), pool_size);
+    EXPECT_EQ(table.translate(L"xy"), L"uvwd");
+    // a longer replacement moves to the end of the pool
+    table.set(L'y', L"efg");
+    EXPECT_EQ(table.pool_size(), pool_size + 3);
+    EXPECT_EQ(table.translate(L"xy"), L"uvwefg");
+}
+
+TEST(CharMapTableTest, AppendToOutput) {
+    CharMapTable table;
+    table.set(L'Ｂ', L"B");
+    std::wstring output = L"A";
+    table.translate(L"ＢC", output);
+    EXPECT_EQ(output, L"ABC");
+}
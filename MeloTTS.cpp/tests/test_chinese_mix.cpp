@@ -2,6 +2,7 @@
 #include <vector>
 #include <string>
 #include "chinese_mix.h"
+#include "utf8_utils.h"
 
 
 int main() {
@@ -10,7 +11,7 @@ int main() {
         std::cout << x <<' ';
     std::cout << std::endl;
 
-     for(const auto&x: melo::chinese_mix::split_utf8_chinese("右值的生命周期"))
+     for(const auto&x: melo::utf8::split_chars("右值的生命周期"))
 	 std::cout << x << ',';
 	std::cout << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "deepfilternet/deepfilter_native.h"
+
+using melo::ov_deepfilternet::DeepFilter;
+using melo::ov_deepfilternet::DFNetModel;
+namespace dsp = melo::ov_deepfilternet::dsp;
+
+namespace {
+constexpr int64_t LOOKAHEAD = 2;
+constexpr int64_t WINDOW_HOPS = DeepFilter::STREAM_CONTEXT_HOPS + DeepFilter::STREAM_BLOCK_HOPS + LOOKAHEAD;
+constexpr int64_t FREQ_SIZE = 481;
+constexpr int64_t NB_ERB = 32;
+constexpr int64_t NB_DF = 96;
+constexpr int64_t HOP_SIZE = 480;
+
+// Causal like the networks: frame t is scaled by a running mean, from the start of the window, of the features
+// LOOKAHEAD frames ahead, so the output depends on where every window starts
+class StubModel : public DFNetModel {
+public:
+    StubModel(int64_t bucket, bool identity) : DFNetModel(LOOKAHEAD, NB_DF, WINDOW_HOPS), _bucket(bucket),
+                                               _identity(identity) {}
+
+    void forward(const dsp::Complex* spec, const float* feat_erb, const dsp::Complex* feat_spec,
+                 dsp::Complex* enhanced, int64_t hops, bool) override {
+        ++num_runs;
+        double mean = 0.0;
+        for (int64_t t = 0; t < hops; ++t) {
+            const int64_t ahead = t + LOOKAHEAD;
+            const double feature = ahead < hops ? feat_erb[ahead * NB_ERB] + std::abs(feat_spec[ahead * NB_DF]) : 0.0;
+            mean += (feature - mean) / static_cast<double>(t + 1);
+            const float gain = _identity ? 1.f : static_cast<float>(1.0 / (1.0 + std::abs(mean) / 60.0));
+            for (int64_t f = 0; f < FREQ_SIZE; ++f)
+                enhanced[t * FREQ_SIZE + f] = spec[t * FREQ_SIZE + f] * gain;
+        }
+    }
+    // 1: a dynamic shape as on CPU, otherwise static shapes of multiples of bucket hops
+    int64_t num_hops_for(int64_t frames) override {
+        return std::min(WINDOW_HOPS, std::max<int64_t>(1, (frames + _bucket - 1) / _bucket) * _bucket);
+    }
+    void release_infer_memory() override {}
+
+    int num_runs = 0;
+
+private:
+    int64_t _bucket;
+    bool _identity;
+};
+
+std::vector<float> noise(size_t n, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    std::vector<float> values(n);
+    for (auto& value : values)
+        value = dist(gen);
+    return values;
+}
+
+std::vector<float> stream(DeepFilter& filter, std::span<const float> audio, const std::vector<size_t>& blocks) {
+    std::vector<float> output;
+    size_t offset = 0;
+    for (size_t i = 0; offset < audio.size(); ++i) {
+        const size_t n = std::min(blocks[i % blocks.size()], audio.size() - offset);
+        filter.process(audio.subspan(offset, n), output);
+        offset += n;
+    }
+    filter.flush(output);
+    return output;
+}
+
+float max_abs_diff(const std::vector<float>& a, const std::vector<float>& b) {
+    float diff = 0.f;
+    for (size_t i = 0; i < std::min(a.size(), b.size()); ++i)
+        diff = std::max(diff, std::abs(a[i] - b[i]));
+    return diff;
+}
+}  // namespace
+
+TEST(DeepFilterNativeTest, StftRoundTripKeepsTheInput) {
+    DeepFilter filter;
+    filter.Init(std::make_shared<StubModel>(1, true), 48000, 960, HOP_SIZE, NB_ERB, NB_DF);
+    // not a multiple of the hop size, the tail is padded by flush()
+    const auto audio = noise(3 * 48000 + 123, 1);
+    const auto output = filter.filter(audio);
+    ASSERT_EQ(output.size(), audio.size());
+    EXPECT_LT(max_abs_diff(output, audio), 1e-5f);
+}
+
+TEST(DeepFilterNativeTest, AnyBlockSizesMatchFilter) {
+    for (int64_t bucket : {1, 50}) {
+        auto model = std::make_shared<StubModel>(bucket, false);
+        DeepFilter filter;
+        filter.Init(model, 48000, 960, HOP_SIZE, NB_ERB, NB_DF);
+        // 5 runs of the networks, the last one from flush() on a partial hop
+        const auto audio = noise(9 * 48000 + 317, 2);
+        const auto expected = filter.filter(audio);
+        ASSERT_EQ(expected.size(), audio.size());
+        const int num_runs = model->num_runs;
+        EXPECT_EQ(num_runs, 5);
+
+        const std::vector<std::vector<size_t>> block_sizes = {
+            {1, 479, 480, 481},
+            {HOP_SIZE * DeepFilter::STREAM_BLOCK_HOPS},
+            {HOP_SIZE * DeepFilter::STREAM_BLOCK_HOPS * 3 + 7},  // more than a block per call
+            {audio.size()},
+            {4096, 333, 96000, 10, 150001},
+        };
+        for (const auto& blocks : block_sizes) {
+            model->num_runs = 0;
+            const auto output = stream(filter, audio, blocks);
+            ASSERT_EQ(output.size(), audio.size()) << "bucket " << bucket << ", first block " << blocks.front();
+            EXPECT_EQ(max_abs_diff(output, expected), 0.f) << "bucket " << bucket << ", first block " << blocks.front();
+            EXPECT_EQ(model->num_runs, num_runs);
+        }
+    }
+}
+
+TEST(DeepFilterNativeTest, ShortClipIsOnlyFlushed) {
+    DeepFilter filter;
+    filter.Init(std::make_shared<StubModel>(1, false), 48000, 960, HOP_SIZE, NB_ERB, NB_DF);
+    const auto audio = noise(1000, 3);
+    const auto expected = filter.filter(audio);
+    ASSERT_EQ(expected.size(), audio.size());
+    EXPECT_EQ(stream(filter, audio, {1, 2, 3}), expected);
+    std::vector<float> output;
+    filter.flush(output);
+    EXPECT_TRUE(output.empty());
+}
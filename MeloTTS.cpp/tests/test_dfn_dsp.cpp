@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "deepfilternet/dfn_dsp.h"
+
+namespace dsp = melo::ov_deepfilternet::dsp;
+using dsp::Complex;
+
+namespace {
+std::vector<float> noise(size_t n, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    std::vector<float> values(n);
+    for (auto& value : values)
+        value = dist(gen);
+    return values;
+}
+
+std::vector<Complex> naive_rfft(const std::vector<float>& x) {
+    const size_t n = x.size();
+    std::vector<Complex> bins(n / 2 + 1);
+    for (size_t k = 0; k <= n / 2; ++k) {
+        std::complex<double> sum = 0;
+        for (size_t j = 0; j < n; ++j)
+            sum += static_cast<double>(x[j]) * std::polar(1.0, -2 * std::numbers::pi * k * j / n);
+        bins[k] = Complex(sum);
+    }
+    return bins;
+}
+}  // namespace
+
+TEST(DfnDspTest, RealFftMatchesDft) {
+    for (int64_t n : {2, 8, 30, 96, 960, 22}) {
+        dsp::RealFft fft(n);
+        const auto x = noise(n, static_cast<uint32_t>(n));
+        std::vector<Complex> bins(n / 2 + 1);
+        fft.forward(x.data(), bins.data());
+        const auto expected = naive_rfft(x);
+        for (int64_t k = 0; k <= n / 2; ++k)
+            EXPECT_LT(std::abs(bins[k] - expected[k]), 2e-5f * n) << "n " << n << " bin " << k;
+    }
+}
+
+TEST(DfnDspTest, InverseIsUnnormalized) {
+    dsp::RealFft fft(960);
+    const auto x = noise(960, 1);
+    std::vector<Complex> bins(481);
+    fft.forward(x.data(), bins.data());
+    // irfft ignores the imaginary parts of DC and Nyquist
+    bins[0] += Complex(0.f, 3.f);
+    bins[480] += Complex(0.f, -2.f);
+    std::vector<float> y(960);
+    fft.inverse(bins.data(), y.data());
+    for (size_t i = 0; i < x.size(); ++i)
+        EXPECT_NEAR(y[i] / 960, x[i], 1e-5f) << i;
+}
+
+TEST(DfnDspTest, RealFftRejectsOddLength) {
+    EXPECT_THROW(dsp::RealFft(15), std::invalid_argument);
+}
+
+TEST(DfnDspTest, LerpScanMatchesRecursion) {
+    const int64_t frames = 7, bands = 21;
+    const auto x = noise(frames * bands, 2);
+    for (float alpha : {0.99f, 0.3f}) {
+        std::vector<float> state(bands, 0.5f), expected_state(bands, 0.5f), out(frames * bands);
+        dsp::lerp_scan(x.data(), state.data(), out.data(), frames, bands, alpha);
+        for (int64_t t = 0; t < frames; ++t) {
+            for (int64_t b = 0; b < bands; ++b) {
+                float& s = expected_state[b];
+                s = x[t * bands + b] + alpha * (s - x[t * bands + b]);
+                EXPECT_NEAR(out[t * bands + b], s, 1e-6f);
+            }
+        }
+        for (int64_t b = 0; b < bands; ++b)
+            EXPECT_NEAR(state[b], expected_state[b], 1e-6f);
+    }
+}
+
+TEST(DfnDspTest, ErbFeaturesAreBandMeans) {
+    const std::vector<int64_t> offsets = dsp::erb_offsets({1, 2, 3});
+    ASSERT_EQ(offsets, (std::vector<int64_t>{0, 1, 3, 6}));
+    const std::vector<Complex> spec = {{1, 0}, {0, 1}, {1, 1}, {2, 0}, {0, 0}, {0, 0}};
+    std::vector<float> db(3);
+    dsp::erb_db(spec.data(), offsets, db.data(), 1);
+    EXPECT_NEAR(db[0], 10 * std::log10(1.f + 1e-10f), 1e-5f);
+    EXPECT_NEAR(db[1], 10 * std::log10(1.5f), 1e-5f);
+    EXPECT_NEAR(db[2], 10 * std::log10(4.f / 3), 1e-5f);
+}
+
+TEST(DfnDspTest, DeepFilterUsesPastAndFutureFrames) {
+    // order 3, lookahead 1: enhanced[t] = spec[t - 1] c0 + spec[t] c1 + spec[t + 1] c2
+    const int64_t frames = 4, stride = 3, nb_df = 2, order = 3;
+    std::vector<Complex> spec(frames * stride);
+    for (int64_t i = 0; i < frames * stride; ++i)
+        spec[i] = Complex(static_cast<float>(i), 1.f);
+    const auto raw = noise(frames * nb_df * order * 2, 3);
+    std::vector<Complex> enhanced(frames * stride, Complex(9.f, 9.f));
+    dsp::deep_filter(spec.data(), stride, raw.data(), enhanced.data(), frames, nb_df, order, 1);
+    for (int64_t t = 0; t < frames; ++t) {
+        for (int64_t f = 0; f < nb_df; ++f) {
+            Complex expected;
+            for (int64_t n = 0; n < order; ++n) {
+                const int64_t source = t + n - 1;
+                if (source < 0 || source >= frames)
+                    continue;
+                const float* c = raw.data() + ((t * nb_df + f) * order + n) * 2;
+                expected += spec[source * stride + f] * Complex(c[0], c[1]);
+            }
+            EXPECT_LT(std::abs(enhanced[t * stride + f] - expected), 1e-5f) << t << " " << f;
+        }
+        EXPECT_EQ(enhanced[t * stride + 2], Complex(9.f, 9.f));  // above nb_df: untouched
+    }
+}
+
+TEST(DfnDspTest, ErbMaskSkipsDeepFilterBins) {
+    const std::vector<int64_t> offsets = dsp::erb_offsets({2, 2});
+    const std::vector<Complex> spec(4, Complex(1.f, -1.f));
+    const std::vector<float> gains = {0.5f, 0.25f};
+    std::vector<Complex> enhanced(4);
+    dsp::apply_erb_mask(spec.data(), gains.data(), offsets, enhanced.data(), 1, 1);
+    EXPECT_EQ(enhanced[0], Complex());
+    EXPECT_EQ(enhanced[1], Complex(0.5f, -0.5f));
+    EXPECT_EQ(enhanced[2], Complex(0.25f, -0.25f));
+    EXPECT_EQ(enhanced[3], Complex(0.25f, -0.25f));
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "server/http.h"
+
+using namespace melo;
+
+TEST(HttpTest, ParsesRequestLineQueryAndHeaders) {
+    const auto request = http::parse_head(
+        "POST /tts?speaker=1&speed=0.9&text=a+b%2Cc HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Length:  12 \r\n"
+        "X-Mixed-Case: Value");
+    EXPECT_EQ(request.method, "POST");
+    EXPECT_EQ(request.path, "/tts");
+    EXPECT_EQ(request.param("speaker"), "1");
+    EXPECT_EQ(request.param("speed"), "0.9");
+    EXPECT_EQ(request.param("text"), "a b,c");
+    EXPECT_FALSE(request.param("rate").has_value());
+    EXPECT_EQ(request.header("host"), "localhost");
+    EXPECT_EQ(request.header("x-mixed-case"), "Value");
+    EXPECT_EQ(http::content_length(request, 100), 12);
+}
+
+TEST(HttpTest, RejectsMalformedRequests) {
+    auto status_of = [](const std::string& head) {
+        try {
+            http::parse_head(head);
+        } catch (const http::Error& e) {
+            return e.status();
+        }
+        return 0;
+    };
+    EXPECT_EQ(status_of("GET / HTTP/1.1"), 0);
+    EXPECT_EQ(status_of("GARBAGE"), 400);
+    EXPECT_EQ(status_of("GET HTTP/1.1"), 400);
+    EXPECT_EQ(status_of("GET relative HTTP/1.1"), 400);
+    EXPECT_EQ(status_of("GET / HTTP/1.1\r\nno colon"), 400);
+}
+
+TEST(HttpTest, ContentLength) {
+    auto length_status = [](const std::string& head) {
+        try {
+            http::content_length(http::parse_head(head), 1000);
+        } catch (const http::Error& e) {
+            return e.status();
+        }
+        return 0;
+    };
+    EXPECT_EQ(http::content_length(http::parse_head("GET / HTTP/1.1"), 1000), 0);
+    EXPECT_EQ(length_status("POST / HTTP/1.1\r\nContent-Length: 1001"), 413);
+    EXPECT_EQ(length_status("POST / HTTP/1.1\r\nContent-Length: 12a"), 400);
+    EXPECT_EQ(length_status("POST / HTTP/1.1\r\nTransfer-Encoding: chunked"), 501);
+}
+
+TEST(HttpTest, UrlDecode) {
+    EXPECT_EQ(http::url_decode("%E4%BD%A0%e5%a5%bd", false), "你好");
+    EXPECT_EQ(http::url_decode("a+b", true), "a b");
+    EXPECT_EQ(http::url_decode("a+b", false), "a+b");
+    EXPECT_EQ(http::url_decode("100%", false), "100%");   // an incomplete escape is kept
+    EXPECT_EQ(http::url_decode("%zz", false), "%zz");
+    EXPECT_EQ(http::parse_query("a&b=&=c&&d=1").size(), 4);
+}
+
+TEST(HttpTest, Responses) {
+    EXPECT_EQ(http::response_head(503, {{"Retry-After", "1"}}),
+              "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 1\r\n\r\n");
+    EXPECT_EQ(http::chunk(std::string(26, 'x')), "1a\r\n" + std::string(26, 'x') + "\r\n");
+    EXPECT_EQ(http::LAST_CHUNK, "0\r\n\r\n");
+}
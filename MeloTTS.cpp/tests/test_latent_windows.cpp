@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include "latent_windows.h"
+
+TEST(LatentWindowsTest, KeptFramesTileTheSentence) {
+    const auto windows = melo::latent_windows(20, 6, 3);
+    ASSERT_EQ(windows.size(), 4);
+    size_t next = 0;
+    for (const auto& window : windows) {
+        EXPECT_EQ(window.first + window.offset, next);
+        EXPECT_LE(window.first + window.width, 20);
+        next += window.kept;
+    }
+    EXPECT_EQ(next, 20);
+    EXPECT_EQ(windows.back().kept, 2);
+    EXPECT_TRUE(windows.back().last);
+    EXPECT_FALSE(windows.front().last);
+}
+
+TEST(LatentWindowsTest, ContextIsCutAtTheEnds) {
+    const auto windows = melo::latent_windows(20, 6, 3);
+    // no context before the first frame, none after the last one
+    EXPECT_EQ(windows[0].first, 0);
+    EXPECT_EQ(windows[0].offset, 0);
+    EXPECT_EQ(windows[0].width, 9);
+    EXPECT_EQ(windows[1].first, 3);
+    EXPECT_EQ(windows[1].offset, 3);
+    EXPECT_EQ(windows[1].width, 12);
+    EXPECT_EQ(windows[3].first, 15);
+    EXPECT_EQ(windows[3].width, 5);
+}
+
+TEST(LatentWindowsTest, WholeSentence) {
+    for (size_t chunk_frames : {0, 8, 100}) {
+        const auto windows = melo::latent_windows(8, chunk_frames, 4);
+        ASSERT_EQ(windows.size(), 1);
+        EXPECT_EQ(windows[0].first, 0);
+        EXPECT_EQ(windows[0].width, 8);
+        EXPECT_EQ(windows[0].kept, 8);
+        EXPECT_TRUE(windows[0].last);
+    }
+    EXPECT_TRUE(melo::latent_windows(0, 8, 4).empty());
+}
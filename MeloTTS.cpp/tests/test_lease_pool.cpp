@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "server/lease_pool.h"
+
+TEST(LeasePoolTest, LendsEveryObjectOnce) {
+    std::vector<std::unique_ptr<int>> objects;
+    objects.push_back(std::make_unique<int>(7));
+    objects.push_back(std::make_unique<int>(8));
+    melo::LeasePool<int> pool(std::move(objects), 0);
+    {
+        auto first = pool.acquire();
+        auto second = pool.acquire();
+        ASSERT_TRUE(first && second);
+        EXPECT_NE(&**first, &**second);
+        EXPECT_EQ(pool.num_busy(), 2);
+        // max_queue 0: nobody may wait
+        EXPECT_FALSE(pool.acquire().has_value());
+    }
+    EXPECT_EQ(pool.num_busy(), 0);
+    EXPECT_TRUE(pool.acquire().has_value());
+}
+
+TEST(LeasePoolTest, WaitersAreBoundedAndServedInOrder) {
+    std::vector<std::unique_ptr<int>> objects;
+    objects.push_back(std::make_unique<int>(0));
+    melo::LeasePool<int> pool(std::move(objects), 2);
+    auto held = pool.acquire();
+    ASSERT_TRUE(held);
+
+    std::vector<int> order;
+    std::mutex order_mutex;
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 2; ++i) {
+        waiters.emplace_back([&, i] {
+            auto lease = pool.acquire();
+            ASSERT_TRUE(lease);
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(i);
+        });
+        // let waiter i take its ticket before the next one
+        while (pool.num_waiting() < static_cast<size_t>(i + 1))
+            std::this_thread::yield();
+    }
+    EXPECT_FALSE(pool.acquire().has_value());  // two are waiting already
+    held.reset();
+    for (auto& waiter : waiters)
+        waiter.join();
+    EXPECT_EQ(order, (std::vector<int>{0, 1}));
+    EXPECT_EQ(pool.num_waiting(), 0);
+}
+
+TEST(LeasePoolTest, InteractiveCallersPassBulkOnes) {
+    std::vector<std::unique_ptr<int>> objects;
+    objects.push_back(std::make_unique<int>(0));
+    melo::LeasePool<int> pool(std::move(objects), 4);
+    auto held = pool.acquire();
+    ASSERT_TRUE(held);
+
+    std::vector<melo::Priority> order;
+    std::mutex order_mutex;
+    std::vector<std::thread> waiters;
+    for (melo::Priority priority : {melo::Priority::Bulk, melo::Priority::Interactive}) {
+        const size_t num_waiting = waiters.size() + 1;
+        waiters.emplace_back([&, priority] {
+            melo::RequestControl control;
+            control.priority = priority;
+            auto lease = pool.acquire(control);
+            ASSERT_TRUE(lease);
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(priority);
+        });
+        while (pool.num_waiting() < num_waiting)
+            std::this_thread::yield();
+    }
+    held.reset();
+    for (auto& waiter : waiters)
+        waiter.join();
+    EXPECT_EQ(order, (std::vector<melo::Priority>{melo::Priority::Interactive, melo::Priority::Bulk}));
+}
+
+TEST(LeasePoolTest, CancelledWaiterLeavesTheQueue) {
+    std::vector<std::unique_ptr<int>> objects;
+    objects.push_back(std::make_unique<int>(0));
+    melo::LeasePool<int> pool(std::move(objects), 2);
+    auto held = pool.acquire();
+    ASSERT_TRUE(held);
+
+    auto token = std::make_shared<melo::CancellationToken>();
+    std::atomic<bool> cancelled{false};
+    std::thread waiter([&] {
+        melo::RequestControl control;
+        control.token = token;
+        try {
+            pool.acquire(control);
+        } catch (const melo::Cancelled&) {
+            cancelled = true;
+        }
+    });
+    while (pool.num_waiting() < 1)
+        std::this_thread::yield();
+    // the object is still held: only the cancellation can wake the waiter
+    token->cancel();
+    waiter.join();
+    EXPECT_TRUE(cancelled);
+    EXPECT_EQ(pool.num_waiting(), 0);
+    EXPECT_EQ(pool.num_busy(), 1);
+
+    // a cancelled token does not even queue
+    melo::RequestControl control;
+    control.token = token;
+    EXPECT_THROW(pool.acquire(control), melo::Cancelled);
+    EXPECT_EQ(pool.num_waiting(), 0);
+}
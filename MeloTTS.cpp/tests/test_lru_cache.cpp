@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lru_cache.h"
+
+TEST(ShardedLruCacheTest, GetAndPut) {
+    melo::ShardedLruCache<std::string, int> cache(8, 1);
+    EXPECT_FALSE(cache.get("一").has_value());
+    cache.put("一", 1);
+    cache.put("二", 2);
+    EXPECT_EQ(cache.get("一"), 1);
+    EXPECT_EQ(cache.get("二"), 2);
+    cache.put("一", 11);  // overwrite
+    EXPECT_EQ(cache.get("一"), 11);
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.hits(), 3);
+    EXPECT_EQ(cache.misses(), 1);
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_FALSE(cache.get("一").has_value());
+}
+
+TEST(ShardedLruCacheTest, EvictsLeastRecentlyUsed) {
+    melo::ShardedLruCache<int, int> cache(3, 1);
+    cache.put(1, 1);
+    cache.put(2, 2);
+    cache.put(3, 3);
+    EXPECT_TRUE(cache.get(1).has_value());  // 2 is now the least recently used
+    cache.put(4, 4);
+    EXPECT_EQ(cache.size(), 3);
+    EXPECT_FALSE(cache.get(2).has_value());
+    EXPECT_TRUE(cache.get(1).has_value());
+    EXPECT_TRUE(cache.get(3).has_value());
+    EXPECT_TRUE(cache.get(4).has_value());
+}
+
+TEST(ShardedLruCacheTest, BoundedAcrossShards) {
+    melo::ShardedLruCache<int, std::shared_ptr<const std::string>> cache(64, 8);
+    for (int i = 0; i < 1000; ++i)
+        cache.put(i, std::make_shared<const std::string>(std::to_string(i)));
+    EXPECT_LE(cache.size(), 64);
+    EXPECT_EQ(*cache.get(999).value(), "999");
+}
+
+TEST(ShardedLruCacheTest, ConcurrentAccess) {
+    melo::ShardedLruCache<int, int> cache(256);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, t] {
+            for (int i = 0; i < 10000; ++i) {
+                const int key = (i * 7 + t) % 512;
+                if (auto value = cache.get(key))
+                    EXPECT_EQ(*value, key * 2);
+                else
+                    cache.put(key, key * 2);
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_LE(cache.size(), 256);
+    EXPECT_EQ(cache.hits() + cache.misses(), 40000);
+}
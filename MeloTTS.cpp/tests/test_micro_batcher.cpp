@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "micro_batcher.h"
+
+namespace {
+using Batcher = melo::MicroBatcher<int, int>;
+
+// doubles every item and records the batch sizes
+struct Doubler {
+    std::mutex mutex;
+    std::vector<std::vector<int>> batches;
+
+    Batcher::RunBatch run() {
+        return [this](std::vector<int>& items, std::vector<int>& results) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                batches.push_back(items);
+            }
+            for (int item : items)
+                results.push_back(item * 2);
+        };
+    }
+};
+}  // namespace
+
+TEST(MicroBatcherTest, FullBucketRunsWithoutWaiting) {
+    Doubler doubler;
+    // a window far longer than the test: only a full bucket can run
+    Batcher batcher(doubler.run(), {.max_batch = 3, .max_wait = std::chrono::seconds(60), .bucket_width = 10});
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 3; ++i)
+        results.push_back(batcher.submit(i, 5));
+    for (int i = 0; i < 3; ++i)
+        EXPECT_EQ(results[i].get(), i * 2);
+    ASSERT_EQ(doubler.batches.size(), 1);
+    EXPECT_EQ(doubler.batches[0], (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(batcher.stats().num_batches, 1);
+    EXPECT_EQ(batcher.stats().num_items, 3);
+}
+
+TEST(MicroBatcherTest, LoneItemRunsAfterMaxWait) {
+    Doubler doubler;
+    Batcher batcher(doubler.run(), {.max_batch = 8, .max_wait = std::chrono::milliseconds(20), .bucket_width = 10});
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(batcher.submit(21, 5).get(), 42);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+}
+
+TEST(MicroBatcherTest, LengthsOfDifferentBucketsAreNotMixed) {
+    Doubler doubler;
+    Batcher batcher(doubler.run(), {.max_batch = 2, .max_wait = std::chrono::milliseconds(50), .bucket_width = 10});
+    auto short_1 = batcher.submit(1, 3);
+    auto long_1 = batcher.submit(2, 35);
+    auto short_2 = batcher.submit(3, 9);
+    EXPECT_EQ(short_1.get(), 2);
+    EXPECT_EQ(short_2.get(), 6);
+    EXPECT_EQ(long_1.get(), 4);
+    ASSERT_EQ(doubler.batches.size(), 2);
+    EXPECT_EQ(doubler.batches[0], (std::vector<int>{1, 3}));  // full, it does not wait for the older long item
+    EXPECT_EQ(doubler.batches[1], (std::vector<int>{2}));
+}
+
+TEST(MicroBatcherTest, ErrorReachesEveryItemOfTheBatch) {
+    Batcher batcher([](std::vector<int>&, std::vector<int>&) { throw std::runtime_error("model failed"); },
+                    {.max_batch = 2, .max_wait = std::chrono::seconds(60), .bucket_width = 10});
+    auto first = batcher.submit(1, 1);
+    auto second = batcher.submit(2, 2);
+    EXPECT_THROW(first.get(), std::runtime_error);
+    EXPECT_THROW(second.get(), std::runtime_error);
+}
+
+TEST(MicroBatcherTest, DestructionRunsThePendingItems) {
+    Doubler doubler;
+    std::future<int> result;
+    {
+        Batcher batcher(doubler.run(), {.max_batch = 8, .max_wait = std::chrono::seconds(60), .bucket_width = 10});
+        result = batcher.submit(5, 1);
+    }
+    EXPECT_EQ(result.get(), 10);
+}
+
+TEST(MicroBatcherTest, InteractiveItemsPassQueuedBulkItems) {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool release = false;
+    std::vector<int> order;
+    Batcher batcher(
+        [&](std::vector<int>& items, std::vector<int>& results) {
+            std::unique_lock<std::mutex> lock(mutex);
+            order.push_back(items[0]);
+            changed.wait(lock, [&] { return release; });
+            results = items;
+        },
+        {.max_batch = 1, .max_wait = std::chrono::milliseconds(0), .bucket_width = 10});
+    melo::RequestControl bulk_control;
+    bulk_control.priority = melo::Priority::Bulk;
+    auto busy = batcher.submit(0, 1, bulk_control);
+    // the dispatcher is held by the first item while the others queue up
+    while (true) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!order.empty())
+            break;
+    }
+    melo::RequestControl interactive;
+    interactive.deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    auto bulk = batcher.submit(1, 1, bulk_control);
+    auto late = batcher.submit(2, 1, interactive);
+    interactive.deadline -= std::chrono::seconds(1);
+    auto soon = batcher.submit(3, 1, interactive);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    changed.notify_all();
+    busy.get();
+    bulk.get();
+    late.get();
+    soon.get();
+    EXPECT_EQ(order, (std::vector<int>{0, 3, 2, 1}));
+}
+
+TEST(MicroBatcherTest, CancelledItemsAreDroppedBeforeTheyRun) {
+    Doubler doubler;
+    Batcher batcher(doubler.run(), {.max_batch = 2, .max_wait = std::chrono::milliseconds(20), .bucket_width = 10});
+    auto token = std::make_shared<melo::CancellationToken>();
+    token->cancel();
+    auto cancelled = batcher.submit(1, 1, {.token = token});
+    auto kept = batcher.submit(2, 1);
+    EXPECT_THROW(cancelled.get(), melo::Cancelled);
+    EXPECT_EQ(kept.get(), 4);
+    ASSERT_EQ(doubler.batches.size(), 1);
+    EXPECT_EQ(doubler.batches[0], (std::vector<int>{2}));
+    EXPECT_EQ(batcher.stats().num_cancelled, 1);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "openvoice_tts.h"
+#define OV_MODEL_PATH "ov_models"
+
+namespace {
+// phones x 768 features, every value distinct per sentence
+std::vector<std::vector<float>> features(size_t phones, float base) {
+    std::vector<std::vector<float>> feature(phones, std::vector<float>(melo::OpenVoiceTTS::JA_BERT_DIM));
+    for (size_t j = 0; j < phones; ++j)
+        for (size_t k = 0; k < feature[j].size(); ++k)
+            feature[j][k] = base + j + k * 0.001f;
+    return feature;
+}
+
+melo::OpenVoiceTTS::Input sentence(const std::vector<int64_t>& phones, float base) {
+    melo::OpenVoiceTTS::Input input;
+    input.phones = phones;
+    input.tones.assign(phones.size(), 0);
+    input.lang_ids.assign(phones.size(), 3);
+    input.phone_level_feature = features(phones.size(), base);
+    input.sdp_ratio = 0.0f;
+    input.noise_scale = 0.0f;
+    input.noise_scale_w = 0.0f;
+    return input;
+}
+}  // namespace
+
+TEST(OpenVoiceTTSSlotTest, JaBertReplacesThePreviousSentence) {
+    std::vector<float> ja_bert;
+    melo::OpenVoiceTTS::to_ja_bert(features(3, 1.0f), 3, false, ja_bert);
+    ASSERT_EQ(ja_bert.size(), 3 * melo::OpenVoiceTTS::JA_BERT_DIM);
+
+    // a shorter sentence on the same buffers
+    const auto second = features(2, 5.0f);
+    melo::OpenVoiceTTS::to_ja_bert(second, 2, false, ja_bert);
+    ASSERT_EQ(ja_bert.size(), 2 * melo::OpenVoiceTTS::JA_BERT_DIM);
+    for (size_t k = 0; k < melo::OpenVoiceTTS::JA_BERT_DIM; ++k)
+        for (size_t j = 0; j < 2; ++j)
+            ASSERT_EQ(ja_bert[k * 2 + j], second[j][k]);
+
+    melo::OpenVoiceTTS::to_ja_bert({}, 4, true, ja_bert);
+    EXPECT_EQ(ja_bert, std::vector<float>(4 * melo::OpenVoiceTTS::JA_BERT_DIM, 0.0f));
+}
+
+// without noise the synthesis is deterministic: the second sentence on a slot sounds as on a fresh request
+TEST(OpenVoiceTTSSlotTest, SecondSentenceOnTheSameSlot) {
+    const std::filesystem::path model_path = std::filesystem::path(OV_MODEL_PATH) / "tts_zn_mix_en_int8.xml";
+    const std::filesystem::path weights_path = std::filesystem::path(model_path).replace_extension(".bin");
+    if (!std::filesystem::exists(model_path) || !std::filesystem::exists(weights_path))
+        GTEST_SKIP() << "no TTS model in " << OV_MODEL_PATH;
+    auto core = std::make_unique<ov::Core>();
+    melo::OpenVoiceTTS model(core, model_path, "CPU", "ZH");
+
+    model.start_infer(0, sentence({0, 19, 0, 44, 0, 99, 0, 40, 0, 73, 0}, 1.0f));
+    model.wait_infer(0);
+    auto second = sentence({0, 57, 0, 12, 0, 60, 0}, -1.0f);
+    model.start_infer(0, second);
+    const std::vector<float> on_slot = model.wait_infer(0);
+    const std::vector<float> fresh = model.tts_infer(second.phones,
+                                                     second.tones,
+                                                     second.lang_ids,
+                                                     second.phone_level_feature,
+                                                     second.speed,
+                                                     second.speaker_id,
+                                                     second.disable_bert,
+                                                     second.sdp_ratio,
+                                                     second.noise_scale,
+                                                     second.noise_scale_w);
+    ASSERT_EQ(on_slot.size(), fresh.size());
+    for (size_t i = 0; i < fresh.size(); ++i)
+        ASSERT_NEAR(on_slot[i], fresh[i], 1e-4f) << "sample " << i;
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "pcm_convert.h"
+
+namespace pcm = melo::pcm;
+
+TEST(PcmConvertTest, SaturatesInsteadOfWrapping) {
+    // 37 samples, so that both the vector loop and the scalar tail are used
+    std::vector<float> in(37);
+    for (size_t i = 0; i < in.size(); ++i)
+        in[i] = (i % 2 ? -1.0f : 1.0f) * (0.5f + 0.1f * i);
+    in[3] = std::numeric_limits<float>::infinity();
+    std::vector<int16_t> out(in.size());
+    pcm::float_to_int16(in, out, pcm::INT16_SCALE);
+    for (size_t i = 0; i < in.size(); ++i) {
+        const float expected = std::clamp(std::nearbyint(in[i] * pcm::INT16_SCALE), -32768.0f, 32767.0f);
+        EXPECT_EQ(out[i], static_cast<int16_t>(expected)) << "index " << i << " kernel " << pcm::kernel_name();
+    }
+    EXPECT_EQ(out[0], 16384);  // 0.5 * 32767 = 16383.5, rounded to even
+    EXPECT_EQ(out[1], -19660);
+    EXPECT_EQ(out[6], 32767);
+    EXPECT_EQ(out[7], -32768);
+}
+
+TEST(PcmConvertTest, GainAndPeakNormalization) {
+    const std::vector<float> in{0.1f, -0.25f, 0.2f};
+    EXPECT_FLOAT_EQ(pcm::peak(in), 0.25f);
+    EXPECT_FLOAT_EQ(pcm::scale_for(in, {.gain = 2.0f}), 2.0f * pcm::INT16_SCALE);
+    const float scale = pcm::scale_for(in, {.normalize_peak = 0.5f});
+    std::vector<int16_t> out(in.size());
+    pcm::float_to_int16(in, out, scale);
+    EXPECT_EQ(out[1], static_cast<int16_t>(std::lrintf(-0.5f * pcm::INT16_SCALE)));
+    // silence is not amplified
+    EXPECT_FLOAT_EQ(pcm::scale_for(std::vector<float>(4, 0.0f), {.normalize_peak = 0.5f}), pcm::INT16_SCALE);
+}
+
+TEST(PcmConvertTest, TpdfDither) {
+    pcm::Dither dither;
+    std::vector<float> noise(10000);
+    dither.fill(noise);
+    double sum = 0;
+    for (float value : noise) {
+        EXPECT_GT(value, -1.0f);
+        EXPECT_LT(value, 1.0f);
+        sum += value;
+    }
+    EXPECT_NEAR(sum / noise.size(), 0.0, 0.05);
+
+    // dither moves a sample by at most one LSB
+    std::vector<float> in(noise.size(), 1000.25f / pcm::INT16_SCALE);
+    std::vector<int16_t> out(in.size());
+    pcm::float_to_int16(in, out, pcm::INT16_SCALE, noise.data());
+    for (int16_t value : out) {
+        EXPECT_GE(value, 999);
+        EXPECT_LE(value, 1001);
+    }
+}
@@ -0,0 +1,25 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "perfect_hash_set.h"
+
+namespace {
+constexpr auto words = melo::make_perfect_hash_set({"男子", "女子", "分子", "原子", "量子", "莲子", "石子", "瓜子",
+                                                    "电子", "人人", "虎虎", "a", "", "longer key"});
+}
+
+TEST(PerfectHashSetTest, ContainsEveryKey) {
+    for (const char* key :
+         {"男子", "女子", "分子", "原子", "量子", "莲子", "石子", "瓜子", "电子", "人人", "虎虎", "a", "", "longer key"})
+        EXPECT_TRUE(words.contains(key)) << key;
+    static_assert(words.contains("男子"));
+}
+
+TEST(PerfectHashSetTest, RejectsOtherKeys) {
+    for (const char* key : {"男", "子", "男子 ", "b", "longer", "麻烦"})
+        EXPECT_FALSE(words.contains(key)) << key;
+    std::string dynamic = "电";
+    dynamic += "子";
+    EXPECT_TRUE(words.contains(dynamic));
+}
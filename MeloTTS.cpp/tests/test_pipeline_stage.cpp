@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "pipeline_stage.h"
+
+TEST(PipelineStageTest, ConsumesInOrderOnAnotherThread) {
+    std::vector<int> consumed;
+    std::thread::id consumer_thread;
+    melo::PipelineStage<int> stage([&](int& item) {
+        consumer_thread = std::this_thread::get_id();
+        consumed.push_back(item);
+    });
+    for (int i = 0; i < 100; ++i)
+        stage.push(i);
+    stage.finish();
+    ASSERT_EQ(consumed.size(), 100);
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(consumed[i], i);
+    EXPECT_NE(consumer_thread, std::this_thread::get_id());
+    EXPECT_FALSE(stage.failed());
+}
+
+TEST(PipelineStageTest, PushBlocksAtCapacity) {
+    std::atomic<bool> release{false};
+    std::atomic<int> pushed{0};
+    melo::PipelineStage<int> stage(
+        [&](int&) {
+            while (!release)
+                std::this_thread::yield();
+        },
+        2);
+    std::thread producer([&] {
+        for (int i = 0; i < 5; ++i) {
+            stage.push(i);
+            ++pushed;
+        }
+    });
+    // one item is being consumed and two are waiting
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(pushed, 3);
+    release = true;
+    producer.join();
+    stage.finish();
+    EXPECT_EQ(pushed, 5);
+}
+
+TEST(PipelineStageTest, RethrowsTheConsumerExceptionOnce) {
+    std::vector<int> consumed;
+    melo::PipelineStage<int> stage([&](int& item) {
+        if (item == 3)
+            throw std::runtime_error("consumer failed");
+        consumed.push_back(item);
+    });
+    bool thrown = false;
+    for (int i = 0; i < 100; ++i) {
+        try {
+            stage.push(i);
+        } catch (const std::runtime_error&) {
+            EXPECT_FALSE(thrown);
+            thrown = true;
+        }
+    }
+    if (thrown)
+        EXPECT_NO_THROW(stage.finish());
+    else
+        EXPECT_THROW(stage.finish(), std::runtime_error);
+    EXPECT_TRUE(stage.failed());
+    EXPECT_EQ(consumed, (std::vector<int>{0, 1, 2}));
+}
+
+TEST(PipelineStageTest, DestructorDropsPendingItems) {
+    std::atomic<int> consumed{0};
+    {
+        melo::PipelineStage<int> stage(
+            [&](int&) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                ++consumed;
+            },
+            4);
+        for (int i = 0; i < 4; ++i)
+            stage.push(i);
+    }
+    EXPECT_LT(consumed, 4);
+}
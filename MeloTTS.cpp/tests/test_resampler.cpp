@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+#include "resampler.h"
+
+using melo::Resampler;
+
+namespace {
+std::vector<float> sine(double frequency, int32_t rate, size_t n, double amplitude = 0.5) {
+    std::vector<float> wave(n);
+    for (size_t i = 0; i < n; ++i)
+        wave[i] = static_cast<float>(amplitude * std::sin(2 * std::numbers::pi * frequency * i / rate));
+    return wave;
+}
+// largest difference, ignoring margin samples at both ends
+double max_error(const std::vector<float>& a, const std::vector<float>& b, size_t margin) {
+    double error = 0;
+    for (size_t i = margin; i + margin < std::min(a.size(), b.size()); ++i)
+        error = std::max(error, std::abs(static_cast<double>(a[i]) - b[i]));
+    return error;
+}
+double rms(const std::vector<float>& wave, size_t margin) {
+    double sum = 0;
+    for (size_t i = margin; i + margin < wave.size(); ++i)
+        sum += static_cast<double>(wave[i]) * wave[i];
+    return std::sqrt(sum / (wave.size() - 2 * margin));
+}
+}  // namespace
+
+TEST(ResamplerTest, SineKeepsShapeAndLength) {
+    for (int32_t out_rate : {8000, 16000, 22050, 24000, 48000}) {
+        const auto input = sine(1000, 44100, 44100);
+        const auto output = Resampler::resample(input, 44100, out_rate);
+        EXPECT_EQ(output.size(), static_cast<size_t>(out_rate));
+        EXPECT_LT(max_error(output, sine(1000, out_rate, out_rate), 64), 2e-3) << out_rate;
+    }
+}
+
+TEST(ResamplerTest, RejectsAliases) {
+    // 10 kHz is above the Nyquist frequency of 16 kHz
+    const auto output = Resampler::resample(sine(10000, 44100, 44100), 44100, 16000);
+    EXPECT_LT(rms(output, 64), 1e-3);
+}
+
+TEST(ResamplerTest, StreamingMatchesOneShot) {
+    const auto input = sine(440, 44100, 20000);
+    const auto expected = Resampler::resample(input, 44100, 48000);
+    Resampler resampler(44100, 48000);
+    std::vector<float> output;
+    size_t offset = 0, block = 1;
+    while (offset < input.size()) {
+        const size_t n = std::min(block, input.size() - offset);
+        resampler.process(std::span<const float>(input).subspan(offset, n), output);
+        offset += n;
+        block = block * 3 % 1000 + 1;
+    }
+    resampler.flush(output);
+    ASSERT_EQ(output.size(), expected.size());
+    for (size_t i = 0; i < output.size(); ++i)
+        ASSERT_FLOAT_EQ(output[i], expected[i]) << i;
+}
+
+TEST(ResamplerTest, Passthrough) {
+    Resampler resampler(44100, 44100);
+    EXPECT_TRUE(resampler.is_passthrough());
+    std::vector<float> output;
+    resampler.process(std::vector<float>{0.1f, 0.2f}, output);
+    resampler.flush(output);
+    EXPECT_EQ(output, (std::vector<float>{0.1f, 0.2f}));
+    EXPECT_THROW(Resampler(0, 16000), std::invalid_argument);
+    EXPECT_TRUE(Resampler::supports(44100, 48000));
+    // 44100 -> 44101 needs 44101 phases
+    EXPECT_FALSE(Resampler::supports(44100, 44101));
+    EXPECT_THROW(Resampler(44100, 44101), std::invalid_argument);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sentence_splitter.h"
+
+using melo::ChunkPolicy;
+using melo::SentenceSplitter;
+
+TEST(SentenceSplitterTest, SplitKeepsViewsIntoInput) {
+    const std::string text = "你好，世界。How are you? 3.14和1,000不拆分.com也不拆";
+    auto sentences = SentenceSplitter::split(text);
+    ASSERT_EQ(sentences.size(), 4);
+    EXPECT_EQ(sentences[0], "你好，");
+    EXPECT_EQ(sentences[1], "世界。");
+    EXPECT_EQ(sentences[2], "How are you?");
+    EXPECT_EQ(sentences[3], " 3.14和1,000不拆分.com也不拆");
+    for (auto sentence : sentences) {
+        EXPECT_GE(sentence.data(), text.data());
+        EXPECT_LE(sentence.data() + sentence.size(), text.data() + text.size());
+    }
+}
+
+TEST(SentenceSplitterTest, Clean) {
+    EXPECT_EQ(SentenceSplitter::clean("你好，世界（hello）。"), "你好, 世界 hello .");
+    EXPECT_EQ(SentenceSplitter::clean("3.14和1,000"), "3.14和1000");
+    EXPECT_EQ(SentenceSplitter::clean("intel.com"), "intel.com");
+    EXPECT_EQ(SentenceSplitter::clean("“引号”——破折号～"), " 引号 --破折号-");
+    EXPECT_EQ(SentenceSplitter::clean("a\"b\"c:d"), "a b c d");
+}
+
+TEST(SentenceSplitterTest, EllipsisIsOneFullStop) {
+    auto sentences = SentenceSplitter::split("Wait... what…… 好吧…然后");
+    ASSERT_EQ(sentences.size(), 3);
+    EXPECT_EQ(sentences[0], "Wait...");
+    EXPECT_EQ(sentences[1], " what…… 好吧…");
+    EXPECT_EQ(sentences[2], "然后");
+    EXPECT_EQ(SentenceSplitter::clean("Wait...what"), "Wait. what");
+    EXPECT_EQ(SentenceSplitter::clean("嗯..好吧…然后"), "嗯. 好吧. 然后");
+    EXPECT_EQ(SentenceSplitter::clean("3...14"), "3. 14");
+}
+
+TEST(SentenceSplitterTest, EstimatePhonemes) {
+    EXPECT_EQ(SentenceSplitter::estimate_phonemes("你好"), 4);
+    EXPECT_EQ(SentenceSplitter::estimate_phonemes("hello world"), 8);
+    EXPECT_EQ(SentenceSplitter::estimate_phonemes("，"), 1);
+    EXPECT_EQ(SentenceSplitter::estimate_phonemes("  "), 0);
+}
+
+TEST(SentenceSplitterTest, SmallFirstChunk) {
+    const std::string text = "今天天气很好。我们去公园散步吧，顺便买一些水果和零食。晚上回家以后一起做饭，然后看一部电影。好的";
+    ChunkPolicy policy{.first_chunk_phonemes = 10, .chunk_phonemes = 40, .min_tail_phonemes = 5};
+    auto chunks = SentenceSplitter::chunk(text, policy);
+    ASSERT_EQ(chunks.size(), 3);
+    EXPECT_EQ(chunks[0], "今天天气很好。");
+    EXPECT_EQ(chunks[1], "我们去公园散步吧，顺便买一些水果和零食。晚上回家以后一起做饭，");
+    EXPECT_EQ(chunks[2], "然后看一部电影。好的");
+    // the chunks cover the whole input
+    std::string joined;
+    for (auto chunk : chunks)
+        joined += chunk;
+    EXPECT_EQ(joined, text);
+}
+
+TEST(SentenceSplitterTest, ShortTailIsMerged) {
+    auto chunks = SentenceSplitter::chunk("今天天气很好，我们去公园散步吧。好", {8, 8, 5});
+    ASSERT_EQ(chunks.size(), 2);
+    EXPECT_EQ(chunks[1], "我们去公园散步吧。好");
+    EXPECT_TRUE(SentenceSplitter::chunk("   ").empty());
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "sentence_writer.h"
+#include "wave_writer.h"
+
+using melo::SentenceWriter;
+using melo::WaveWriter;
+
+namespace {
+constexpr int32_t MODEL_RATE = 44100;
+constexpr int32_t STAGE_RATE = 48000;
+constexpr size_t SILENCE = 2400;
+
+// A filter with latency like the noise filter: it halves the input but hands it on in blocks of BLOCK samples only,
+// the rest when flushed. Over the whole stream the output stays aligned with the input.
+class BlockFilter {
+public:
+    static constexpr size_t BLOCK = 1000;
+
+    void operator()(std::span<const float> input, std::vector<float>& output, bool last) {
+        _pending.insert(_pending.end(), input.begin(), input.end());
+        const size_t n = last ? _pending.size() : _pending.size() / BLOCK * BLOCK;
+        for (size_t i = 0; i < n; ++i)
+            output.push_back(_pending[i] * 0.5f);
+        _pending.erase(_pending.begin(), _pending.begin() + n);
+    }
+
+private:
+    std::vector<float> _pending;
+};
+
+struct Pcm {
+    std::vector<int16_t> samples;
+    WaveWriter::Sink sink() {
+        return [this](const void* data, size_t size) {
+            const size_t first = samples.size();
+            samples.resize(first + size / sizeof(int16_t));
+            std::memcpy(samples.data() + first, data, size);
+            return true;
+        };
+    }
+};
+
+// (length in model samples, sentence_end) of every write(): a sentence written in two parts, a long one, a short one
+const std::vector<std::pair<size_t, bool>> WRITES = {{1000, false}, {3410, true}, {22050, true}, {7, true}};
+
+// where every sentence ends at the stage rate, without the silence
+std::vector<int64_t> stage_sentence_ends(int32_t stage_rate) {
+    std::vector<int64_t> ends;
+    int64_t num_model_samples = 0;
+    for (const auto& [length, sentence_end] : WRITES) {
+        num_model_samples += length;
+        if (sentence_end)
+            ends.push_back((num_model_samples * stage_rate + MODEL_RATE / 2) / MODEL_RATE);
+    }
+    return ends;
+}
+
+void write_all(SentenceWriter& sentences) {
+    for (const auto& [length, sentence_end] : WRITES)
+        sentences.write(std::vector<float>(length, 0.5f), sentence_end);
+    sentences.finish();
+}
+}  // namespace
+
+TEST(SentenceWriterTest, SilenceFollowsEverySentenceEnd) {
+    Pcm pcm;
+    WaveWriter writer(pcm.sink(), STAGE_RATE, WaveWriter::Format::Pcm);
+    SentenceWriter sentences(writer, MODEL_RATE, STAGE_RATE, SILENCE, BlockFilter());
+    write_all(sentences);
+    writer.close();
+
+    const auto ends = stage_sentence_ends(STAGE_RATE);
+    ASSERT_EQ(ends.size(), 3);
+    // the whole input resampled, 26467 samples at 44.1 kHz, plus the silence of every sentence
+    const int64_t num_staged = (26467LL * STAGE_RATE + MODEL_RATE / 2) / MODEL_RATE;
+    ASSERT_EQ(pcm.samples.size(), num_staged + 3 * SILENCE);
+
+    // the silence of sentence i starts after the audio of sentences 0..i and the silence of the ones before
+    for (size_t i = 0; i < ends.size(); ++i) {
+        const size_t begin = ends[i] + i * SILENCE;
+        SCOPED_TRACE(i);
+        EXPECT_NE(pcm.samples[begin - 1], 0);
+        EXPECT_TRUE(std::all_of(pcm.samples.begin() + begin, pcm.samples.begin() + begin + SILENCE,
+                                [](int16_t sample) { return sample == 0; }));
+        if (i + 1 < ends.size()) {
+            EXPECT_NE(pcm.samples[begin + SILENCE], 0);
+        }
+    }
+    // the audio went through the filter, halved
+    EXPECT_NEAR(pcm.samples[ends[1] + SILENCE - 1000], 0.25 * 32767, 100);
+}
+
+TEST(SentenceWriterTest, ResampledToTheWriterRate) {
+    for (const bool filtered : {true, false}) {
+        SCOPED_TRACE(filtered);
+        constexpr int32_t writer_rate = 16000;
+        const int32_t stage_rate = filtered ? STAGE_RATE : writer_rate;
+        const size_t silence = SILENCE * stage_rate / STAGE_RATE;
+        Pcm pcm;
+        WaveWriter writer(pcm.sink(), writer_rate, WaveWriter::Format::Pcm);
+        SentenceWriter sentences(writer, MODEL_RATE, stage_rate, silence,
+                                 filtered ? SentenceWriter::Filter(BlockFilter()) : SentenceWriter::Filter());
+        write_all(sentences);
+        writer.close();
+
+        const int64_t num_staged = (26467LL * stage_rate + MODEL_RATE / 2) / MODEL_RATE;
+        const int64_t num_spliced = num_staged + 3 * silence;
+        EXPECT_EQ(pcm.samples.size(), (num_spliced * writer_rate + stage_rate / 2) / stage_rate);
+
+        // the middle of every silence is quiet, the middle of the long sentence is not
+        const auto ends = stage_sentence_ends(stage_rate);
+        for (size_t i = 0; i < ends.size(); ++i) {
+            const int64_t middle = (ends[i] + i * silence + silence / 2) * writer_rate / stage_rate;
+            EXPECT_LE(std::abs(pcm.samples[middle]), 10) << "sentence " << i;
+        }
+        const int64_t long_sentence = ((ends[0] + ends[1]) / 2 + silence) * writer_rate / stage_rate;
+        EXPECT_NEAR(pcm.samples[long_sentence], (filtered ? 0.25 : 0.5) * 32767, 100);
+    }
+}
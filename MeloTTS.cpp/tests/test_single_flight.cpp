@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "server/single_flight.h"
+
+TEST(SingleFlightTest, SameKeyJoinsUntilTheLeaderLands) {
+    melo::SingleFlight<std::string> flights;
+    bool leader = false;
+    auto first = flights.join("hello", leader);
+    EXPECT_TRUE(leader);
+    auto second = flights.join("hello", leader);
+    EXPECT_FALSE(leader);
+    EXPECT_EQ(first, second);
+    auto other = flights.join("world", leader);
+    EXPECT_TRUE(leader);
+    EXPECT_NE(first, other);
+    EXPECT_EQ(flights.size(), 2);
+    EXPECT_EQ(flights.num_coalesced(), 1);
+
+    // not a cache: a request after the landing starts over
+    flights.land("hello", first);
+    auto third = flights.join("hello", leader);
+    EXPECT_TRUE(leader);
+    EXPECT_NE(first, third);
+}
+
+TEST(SingleFlightTest, ReadersShareEveryChunk) {
+    auto broadcast = std::make_shared<melo::Broadcast>();
+    melo::Broadcast::Listener producer(broadcast);
+    auto early = std::make_shared<const std::string>("RIFF");
+    broadcast->publish(early);
+
+    std::vector<melo::Broadcast::Chunk> received;
+    std::thread reader([&] {
+        melo::Broadcast::Listener listener(broadcast);
+        melo::Broadcast::Chunk chunk;
+        for (size_t i = 0; broadcast->read(i, chunk, listener); ++i)
+            received.push_back(chunk);
+    });
+    auto late = std::make_shared<const std::string>("data");
+    broadcast->publish(late);
+    broadcast->finish(true, 200);
+    reader.join();
+
+    ASSERT_EQ(received.size(), 2);
+    EXPECT_EQ(received[0].get(), early.get());  // the same buffer, not a copy
+    EXPECT_EQ(received[1].get(), late.get());
+    EXPECT_TRUE(broadcast->ok());
+    EXPECT_FALSE(broadcast->token()->is_cancelled());
+}
+
+TEST(SingleFlightTest, CancelledOnlyWhenEveryListenerLeft) {
+    auto broadcast = std::make_shared<melo::Broadcast>();
+    auto first = std::make_unique<melo::Broadcast::Listener>(broadcast);
+    auto second = std::make_unique<melo::Broadcast::Listener>(broadcast);
+    first->leave();
+    first->leave();  // once only
+    EXPECT_FALSE(broadcast->token()->is_cancelled());
+
+    // leaving wakes the read of that listener
+    std::thread reader([&] {
+        melo::Broadcast::Chunk chunk;
+        EXPECT_FALSE(broadcast->read(0, chunk, *second));
+    });
+    second->leave();
+    reader.join();
+    EXPECT_TRUE(broadcast->token()->is_cancelled());
+}
+
+TEST(SingleFlightTest, ReadChunksAreDroppedPastTheReplayWindow) {
+    auto broadcast = std::make_shared<melo::Broadcast>(4);
+    melo::Broadcast::Listener producer(broadcast, false);
+    // without readers nothing is kept once the window is full
+    broadcast->publish(std::make_shared<const std::string>("ab"));
+    broadcast->publish(std::make_shared<const std::string>("cd"));
+    EXPECT_EQ(broadcast->num_retained(), 2);
+    broadcast->publish(std::make_shared<const std::string>("ef"));
+    EXPECT_EQ(broadcast->num_retained(), 0);
+
+    // a reader attached later starts at the oldest chunk kept, which stays until it is read
+    melo::Broadcast::Listener reader(broadcast);
+    broadcast->publish(std::make_shared<const std::string>("gh"));
+    broadcast->publish(std::make_shared<const std::string>("ij"));
+    EXPECT_EQ(broadcast->num_retained(), 2);
+    melo::Broadcast::Chunk chunk;
+    ASSERT_TRUE(broadcast->read(3, chunk, reader));
+    EXPECT_EQ(*chunk, "gh");
+    EXPECT_EQ(broadcast->num_retained(), 1);
+    ASSERT_TRUE(broadcast->read(4, chunk, reader));
+    EXPECT_EQ(*chunk, "ij");
+    EXPECT_EQ(broadcast->num_retained(), 0);
+}
+
+TEST(SingleFlightTest, StalledReaderIsCutOff) {
+    auto broadcast = std::make_shared<melo::Broadcast>(4, 6);
+    melo::Broadcast::Listener producer(broadcast, false);
+    melo::Broadcast::Listener stalled(broadcast);
+    melo::Broadcast::Listener reader(broadcast);
+    melo::Broadcast::Chunk chunk;
+    // the stalled reader keeps the chunks while it is at most 6 bytes behind
+    for (size_t i = 0; i < 3; ++i) {
+        broadcast->publish(std::make_shared<const std::string>("ab"));
+        ASSERT_TRUE(broadcast->read(i, chunk, reader));
+    }
+    EXPECT_EQ(broadcast->num_retained(), 3);
+    EXPECT_FALSE(stalled.fell_behind());
+
+    // one chunk more and it is cut off, the chunks the other reader has read go
+    broadcast->publish(std::make_shared<const std::string>("cd"));
+    EXPECT_TRUE(stalled.fell_behind());
+    EXPECT_EQ(broadcast->num_retained(), 1);
+    EXPECT_FALSE(broadcast->read(0, chunk, stalled));
+    ASSERT_TRUE(broadcast->read(3, chunk, reader));
+    EXPECT_EQ(*chunk, "cd");
+    for (size_t i = 4; i < 100; ++i) {
+        broadcast->publish(std::make_shared<const std::string>("ef"));
+        ASSERT_TRUE(broadcast->read(i, chunk, reader));
+        EXPECT_EQ(broadcast->num_retained(), 0);
+    }
+    EXPECT_FALSE(reader.fell_behind());
+}
+
+TEST(SingleFlightTest, LateRequestStartsItsOwnFlight) {
+    melo::SingleFlight<std::string> flights(4);
+    bool leader = false;
+    auto first = flights.join("hello", leader);
+    ASSERT_TRUE(leader);
+    melo::Broadcast::Listener producer(first, false);
+    first->publish(std::make_shared<const std::string>("RIFF"));
+
+    // within the window a request joins and replays from the first chunk, which is kept until it reads it
+    auto joined = flights.join("hello", leader);
+    EXPECT_FALSE(leader);
+    EXPECT_EQ(joined, first);
+    first->publish(std::make_shared<const std::string>("data"));
+    EXPECT_EQ(first->num_retained(), 2);
+    melo::Broadcast::Listener reader(joined);
+    melo::Broadcast::Chunk chunk;
+    ASSERT_TRUE(joined->read(0, chunk, reader));
+    EXPECT_EQ(*chunk, "RIFF");
+
+    // past the window the first chunk is gone
+    auto late = flights.join("hello", leader);
+    EXPECT_TRUE(leader);
+    EXPECT_NE(late, first);
+    EXPECT_EQ(flights.num_coalesced(), 1);
+    // the first flight lands without taking the new one off the table
+    flights.land("hello", first);
+    EXPECT_EQ(flights.size(), 1);
+}
@@ -11,6 +11,11 @@ int main() {
 	output = text_normalization::normalize_numbers(input);
 	std::cout << output << std::endl;
 
+	// 64-bit range, beyond it the digits are read one by one
+	input = "18446744073709551615 and 99999999999999999999 and 3,000,000,000 and -42 and 2020-2021 and 22nd 111th";
+	output = text_normalization::normalize_numbers(input);
+	std::cout << output << std::endl;
+
 
 	input = "Dr. Smith went to St. John's Church with Mr. Brown";
 	output = text_normalization::expand_abbreviations(input);
@@ -25,5 +30,11 @@ int main() {
 	output = text_normalization::expand_time_english(input);
 	std::cout << output << std::endl;
 
+	// all rules in one pass
+	input = "Mr. Brown paid $1,250.75 at 9:05 AM on the 3rd";
+	output.clear();
+	text_normalization::normalize_english(input, output);
+	std::cout << output << std::endl;
+
 	return 0;
-}
\ No newline at end of file
+}
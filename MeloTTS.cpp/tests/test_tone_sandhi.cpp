@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "language_modules/tone_sandhi.h"
+
+using melo::ToneSandhi::Segment;
+
+namespace {
+// The merges as they were before they worked in place, each building a new vector
+std::vector<Segment> reference_merge_yi(const std::vector<Segment>& seg) {
+    std::vector<Segment> new_seg;
+    const int n = seg.size();
+    bool if_continue = false;  // skip second "听", of "听一听"
+    for (int i = 0; i < n; ++i) {
+        if (if_continue) {
+            if_continue = false;
+            continue;
+        }
+        const auto& [word, pos] = seg[i];
+        if (i >= 1 && word == "一" && i + 1 < n && seg[i - 1].first == seg[i + 1].first && seg[i - 1].second == "v") {
+            new_seg.back().first += "一" + seg[i + 1].first;
+            if_continue = true;
+        } else if (new_seg.size() && new_seg.back().first == "一") {
+            new_seg.back().first += word;
+        } else {
+            new_seg.emplace_back(word, pos);
+        }
+    }
+    return new_seg;
+}
+
+std::vector<Segment> reference_merge_chinese_patterns(const std::vector<Segment>& seg) {
+    std::vector<Segment> new_seg;
+    for (const auto& [word, pos] : seg) {
+        const bool punctuation = std::string_view(",.!?;-'").find(word.front()) != std::string_view::npos;
+        if (new_seg.size() && (word == new_seg.back().first && !punctuation || new_seg.back().first == "不"))
+            new_seg.back().first += word;
+        else if (new_seg.size() && word == "儿")
+            new_seg.back().first += "儿";
+        else
+            new_seg.emplace_back(word, pos);
+    }
+    if (new_seg.size() && new_seg.back().first == "不")
+        new_seg.back().second = "d";
+    return new_seg;
+}
+
+std::vector<Segment> merge_yi(std::vector<Segment> seg) {
+    seg.resize(melo::ToneSandhi::_merge_yi(seg));
+    return seg;
+}
+
+std::vector<Segment> merge_chinese_patterns(std::vector<Segment> seg) {
+    seg.resize(melo::ToneSandhi::_merge_chinese_patterns(seg));
+    return seg;
+}
+}  // namespace
+
+TEST(ToneSandhiTest, MergeYi) {
+    // reduplication around "一", also chained and after a merged "一"
+    EXPECT_EQ(merge_yi({{"听", "v"}, {"一", "m"}, {"听", "v"}}), (std::vector<Segment>{{"听一听", "v"}}));
+    EXPECT_EQ(merge_yi({{"听", "v"}, {"一", "m"}, {"听", "v"}, {"一", "m"}, {"听", "v"}, {"吧", "y"}}),
+              (std::vector<Segment>{{"听一听一听", "v"}, {"吧", "y"}}));
+    EXPECT_EQ(merge_yi({{"一", "m"}, {"看", "v"}, {"一", "m"}, {"看", "v"}}),
+              (std::vector<Segment>{{"一看一看", "m"}}));
+    // only between verbs, otherwise "一" takes the word behind it
+    EXPECT_EQ(merge_yi({{"人", "n"}, {"一", "m"}, {"人", "n"}}),
+              (std::vector<Segment>{{"人", "n"}, {"一人", "m"}}));
+    EXPECT_EQ(merge_yi({{"第", "m"}, {"一", "m"}, {"个", "q"}, {"一", "m"}}),
+              (std::vector<Segment>{{"第", "m"}, {"一个", "m"}, {"一", "m"}}));
+}
+
+TEST(ToneSandhiTest, MergeChinesePatterns) {
+    // "不" with the word behind it, reduplication, "儿", but not repeated punctuation
+    EXPECT_EQ(merge_chinese_patterns({{"不", "d"}, {"好", "a"}, {"看看", "v"}, {"看看", "v"}, {"玩", "v"},
+                                      {"儿", "n"}, {",", "x"}, {",", "x"}}),
+              (std::vector<Segment>{{"不好", "d"}, {"看看看看", "v"}, {"玩儿", "v"}, {",", "x"}, {",", "x"}}));
+    // a "不" at the end is an adverb
+    EXPECT_EQ(merge_chinese_patterns({{"好", "a"}, {"不", "x"}}), (std::vector<Segment>{{"好", "a"}, {"不", "d"}}));
+    EXPECT_TRUE(merge_chinese_patterns({}).empty());
+}
+
+TEST(ToneSandhiTest, InPlaceMergesMatchTheReference) {
+    const std::vector<Segment> vocabulary = {{"一", "m"}, {"听", "v"}, {"听", "n"}, {"不", "d"}, {"儿", "n"},
+                                             {"好", "a"}, {",", "x"}, {"看看", "v"}};
+    std::mt19937 gen(29);
+    std::uniform_int_distribution<size_t> word(0, vocabulary.size() - 1);
+    std::uniform_int_distribution<size_t> length(0, 12);
+    for (int round = 0; round < 20000; ++round) {
+        std::vector<Segment> seg(length(gen));
+        for (auto& segment : seg)
+            segment = vocabulary[word(gen)];
+        ASSERT_EQ(merge_yi(seg), reference_merge_yi(seg)) << "round " << round;
+        ASSERT_EQ(merge_chinese_patterns(seg), reference_merge_chinese_patterns(seg)) << "round " << round;
+        const auto merged = merge_yi(seg);
+        ASSERT_EQ(merge_chinese_patterns(merged), reference_merge_chinese_patterns(reference_merge_yi(seg)));
+    }
+}
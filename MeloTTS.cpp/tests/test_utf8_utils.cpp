@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "utf8_utils.h"
+
+using namespace melo;
+
+TEST(Utf8UtilsTest, Length) {
+    EXPECT_EQ(utf8::length(""), 0u);
+    EXPECT_EQ(utf8::length("hello world"), 11u);
+    EXPECT_EQ(utf8::length("右值的生命周期"), 7u);
+    // long enough to go through the SIMD loop and the tail
+    EXPECT_EQ(utf8::length("mixed 中文 and English, 还有标点。😀 done"), 33u);
+}
+
+TEST(Utf8UtilsTest, AsciiPrefix) {
+    EXPECT_EQ(utf8::ascii_prefix_length("abcdefghijklmnopqrstuvwxyz中"), 26u);
+    EXPECT_EQ(utf8::ascii_prefix_length("ab中"), 2u);
+    EXPECT_TRUE(utf8::is_ascii("The quick brown fox jumps over the lazy dog"));
+    EXPECT_FALSE(utf8::is_ascii("The quick brown fox jumps over the lazy 狗"));
+}
+
+TEST(Utf8UtilsTest, DecodeAndMalformed) {
+    size_t len = 0;
+    EXPECT_EQ(utf8::decode("一", 0, len), U'一');
+    EXPECT_EQ(len, 3u);
+    // truncated sequence consumes one byte
+    EXPECT_EQ(utf8::decode("\xE4\xB8", 0, len), utf8::REPLACEMENT_CHARACTER);
+    EXPECT_EQ(len, 1u);
+    EXPECT_EQ(utf8::decode("\x80" "a", 0, len), utf8::REPLACEMENT_CHARACTER);
+    EXPECT_EQ(len, 1u);
+}
+
+TEST(Utf8UtilsTest, SplitChars) {
+    auto chars = utf8::split_chars("右值a的");
+    ASSERT_EQ(chars.size(), 4u);
+    EXPECT_EQ(chars[0], "右");
+    EXPECT_EQ(chars[2], "a");
+    EXPECT_EQ(chars[3], "的");
+}
+
+TEST(Utf8UtilsTest, Classify) {
+    EXPECT_EQ(utf8::classify(U'a'), utf8::CharClass::Lower);
+    EXPECT_EQ(utf8::classify(U'Q'), utf8::CharClass::Upper);
+    EXPECT_EQ(utf8::classify(U'7'), utf8::CharClass::Digit);
+    EXPECT_EQ(utf8::classify(U','), utf8::CharClass::Punct);
+    EXPECT_EQ(utf8::classify(U' '), utf8::CharClass::Space);
+    EXPECT_EQ(utf8::classify(U'中'), utf8::CharClass::Cjk);
+    EXPECT_EQ(utf8::classify(U'。'), utf8::CharClass::CjkPunct);
+    EXPECT_EQ(utf8::classify(U'，'), utf8::CharClass::CjkPunct);
+    EXPECT_EQ(utf8::classify(U'α'), utf8::CharClass::Other);
+}
+
+TEST(Utf8UtilsTest, WideRoundTrip) {
+    const std::string text = "Uber营收109.8亿美元😀";
+    const std::wstring wide = utf8::to_wstring(text);
+    EXPECT_EQ(wide, L"Uber营收109.8亿美元😀");
+    EXPECT_EQ(utf8::to_string(wide), text);
+}
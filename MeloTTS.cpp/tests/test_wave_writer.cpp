@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "info_data.h"
+#include "wave_writer.h"
+
+using melo::WaveWriter;
+
+namespace {
+std::vector<char> read_all(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+}  // namespace
+
+TEST(WaveWriterTest, PatchesHeaderOnClose) {
+    const auto path = std::filesystem::temp_directory_path() / "test_wave_writer.wav";
+    {
+        WaveWriter writer(path, 44100);
+        ASSERT_TRUE(writer.is_open());
+        std::vector<float> samples(5000, 0.5f);
+        writer.write(samples);
+        writer.write_silence(100);
+        writer.write(std::vector<float>{-0.5f, 0.0f});
+        EXPECT_EQ(writer.num_samples(), 5102);
+    }  // closed by the destructor
+    const auto bytes = read_all(path);
+    ASSERT_EQ(bytes.size(), sizeof(melo::WaveHeader) + 5102 * sizeof(int16_t));
+    melo::WaveHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    EXPECT_EQ(header.subchunk2_size, 5102 * 2);
+    EXPECT_EQ(header.chunk_size, 36 + 5102 * 2);
+    EXPECT_EQ(header.sample_rate, 44100);
+    EXPECT_EQ(header.num_channels, 1);
+    EXPECT_EQ(header.bits_per_sample, 16);
+
+    const int16_t* data = reinterpret_cast<const int16_t*>(bytes.data() + sizeof(header));
+    EXPECT_GT(data[0], 0);
+    EXPECT_EQ(data[5000], 0);
+    EXPECT_LT(data[5100], 0);
+    std::filesystem::remove(path);
+}
+
+TEST(WaveWriterTest, PcmHasNoHeader) {
+    const auto path = std::filesystem::temp_directory_path() / "test_wave_writer.pcm";
+    WaveWriter writer(path, 16000, WaveWriter::parse_format("pcm"));
+    writer.write(std::vector<float>(10, 0.1f));
+    writer.close();
+    EXPECT_FALSE(writer.is_open());
+    EXPECT_EQ(std::filesystem::file_size(path), 10 * sizeof(int16_t));
+    std::filesystem::remove(path);
+}
+
+TEST(WaveWriterTest, SinkStreamsWithMaximumSizes) {
+    std::vector<char> bytes;
+    bool broken = false;
+    WaveWriter writer(
+        [&](const void* data, size_t size) {
+            const char* begin = static_cast<const char*>(data);
+            bytes.insert(bytes.end(), begin, begin + size);
+            return !broken;
+        },
+        16000);
+    ASSERT_TRUE(writer.is_open());
+    writer.write(std::vector<float>(100, 0.25f));
+    ASSERT_EQ(bytes.size(), sizeof(melo::WaveHeader) + 100 * sizeof(int16_t));
+    melo::WaveHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    EXPECT_EQ(static_cast<uint32_t>(header.subchunk2_size), 0xffffffffu);
+    EXPECT_EQ(header.sample_rate, 16000);
+
+    // a broken stream closes the writer, nothing more is written
+    broken = true;
+    writer.write(std::vector<float>(10, 0.25f));
+    EXPECT_FALSE(writer.is_open());
+    const size_t size = bytes.size();
+    writer.write(std::vector<float>(10, 0.25f));
+    EXPECT_EQ(bytes.size(), size);
+}
+
+// the blocks of a streamed output share one gain: a quiet tail is not raised, a loud block lowers it from then on
+TEST(WaveWriterTest, NormalizePeakLimitsTheRunningPeak) {
+    std::vector<int16_t> out;
+    WaveWriter writer(
+        [&](const void* data, size_t size) {
+            const int16_t* begin = static_cast<const int16_t*>(data);
+            out.insert(out.end(), begin, begin + size / sizeof(int16_t));
+            return true;
+        },
+        16000,
+        WaveWriter::Format::Pcm,
+        {.gain = 1.0f, .normalize_peak = 0.5f, .dither = false});
+    writer.write(std::vector<float>{0.25f, -0.25f});  // below the limit: gain 1
+    writer.write(std::vector<float>{1.0f, 0.5f});     // the limit: gain 0.5
+    writer.write(std::vector<float>{0.1f});           // a quiet tail keeps gain 0.5
+    ASSERT_EQ(out.size(), 5);
+    EXPECT_EQ(out[0], 8192);
+    EXPECT_EQ(out[1], -8192);
+    EXPECT_EQ(out[2], 16384);
+    EXPECT_EQ(out[3], 8192);
+    EXPECT_EQ(out[4], 1638);
+}
+
+TEST(WaveWriterTest, ParseFormat) {
+    EXPECT_EQ(WaveWriter::parse_format("wav"), WaveWriter::Format::Wav);
+    EXPECT_STREQ(WaveWriter::extension(WaveWriter::Format::Pcm), "pcm");
+    EXPECT_THROW(WaveWriter::parse_format("mp3"), std::invalid_argument);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "wordpiece_tokenizer.h"
+#define OV_MODEL_PATH "ov_models"
+
+// The expected values are the ones of transformers' AutoTokenizer.from_pretrained('bert-base-multilingual-uncased'),
+// see test_tokenizer.cpp.
+class WordPieceTokenizerTestSuit : public ::testing::Test {
+public:
+    WordPieceTokenizerTestSuit() : tokenizer(std::filesystem::path(OV_MODEL_PATH) / "vocab.txt") {}
+
+protected:
+    melo::WordPieceTokenizer tokenizer;
+};
+
+TEST_F(WordPieceTokenizerTestSuit, MixedChineseEnglish) {
+    std::string text = "编译器compiler会尽可能从函数实参function arguments推导缺失的模板实参template arguments";
+    std::vector<std::string> correct_tokens = {"编", "译", "器", "comp", "##iler", "会", "尽", "可", "能", "从",
+                                               "函", "数", "实", "参", "function", "arguments", "推", "导", "缺",
+                                               "失", "的", "模", "板", "实", "参", "temp", "##late", "arguments"};
+    std::vector<int64_t> correct_ids = {101,  6784, 7984, 2693, 85065, 33719, 1817, 3295, 2415,  6990,
+                                        1776, 2160, 4270, 3203, 2383,  18958, 59242, 4108, 3259,  6805,
+                                        2981, 5975, 4767, 4508, 3203,  2383,  79947, 20849, 59242, 102};
+    EXPECT_EQ(tokenizer.word_segment(text), correct_tokens);
+    EXPECT_EQ(tokenizer.tokenize(text), correct_ids);
+}
+
+TEST_F(WordPieceTokenizerTestSuit, PunctuationAndCase) {
+    std::vector<std::string> tokens;
+    std::vector<int64_t> ids;
+    tokenizer.encode("Hello, World!", tokens, ids);
+    EXPECT_EQ(tokens, (std::vector<std::string>{"hello", ",", "world", "!"}));
+    EXPECT_EQ(ids.size(), tokens.size());
+    EXPECT_EQ(ids[0], tokenizer.token_to_id("hello"));
+    EXPECT_EQ(ids[1], tokenizer.token_to_id(","));
+}
+
+TEST_F(WordPieceTokenizerTestSuit, UnknownWord) {
+    EXPECT_EQ(tokenizer.word_segment(std::string(120, 'a')), std::vector<std::string>{"[UNK]"});
+    EXPECT_EQ(tokenizer.tokenize("\xF0\x9F\x98\x80"), (std::vector<int64_t>{101, 100, 102}));
+    EXPECT_EQ(tokenizer.token_to_id("##iler"), 33719);
+    EXPECT_EQ(tokenizer.token_to_id("not-a-token"), -1);
+}
+
+TEST_F(WordPieceTokenizerTestSuit, TokenizedTextWords) {
+    melo::TokenizedText tokenized;
+    tokenizer.encode("编译器compiler, ok", tokenized);
+    EXPECT_EQ(tokenized.ids.size(), tokenized.tokens.size());
+    EXPECT_EQ(tokenized.tokens.front(), "[CLS]");
+    EXPECT_EQ(tokenized.tokens.back(), "[SEP]");
+    ASSERT_EQ(tokenized.num_words(), 6);
+    EXPECT_EQ(tokenized.word_tokens(0).front(), "编");
+    auto compiler = tokenized.word_tokens(3);
+    EXPECT_EQ(std::vector<std::string>(compiler.begin(), compiler.end()), (std::vector<std::string>{"comp", "##iler"}));
+    EXPECT_EQ(tokenized.word_tokens(4).front(), ",");
+    EXPECT_EQ(tokenized.subwords().size(), tokenized.tokens.size() - 2);
+    EXPECT_EQ(tokenized.ids, tokenizer.tokenize("编译器compiler, ok"));
+}
+
+// bert-base-uncased, whose vocab.txt is exported from the detokenizer IR by scripts/export_vocab.py
+TEST(WordPieceTokenizerEnTest, BertBaseUncased) {
+    melo::WordPieceTokenizer tokenizer(std::filesystem::path(OV_MODEL_PATH) / "bert-base-uncased" / "vocab.txt");
+    ASSERT_EQ(tokenizer.size(), 30522);
+    EXPECT_EQ(tokenizer.word_segment("Hello, tokenization world!"),
+              (std::vector<std::string>{"hello", ",", "token", "##ization", "world", "!"}));
+    EXPECT_EQ(tokenizer.tokenize("Hello, tokenization world!"),
+              (std::vector<int64_t>{101, 7592, 1010, 19204, 3989, 2088, 999, 102}));
+}
+
+// BasicTokenizer: accents are stripped and Unicode punctuation is split off, as AutoTokenizer('bert-base-uncased') does
+TEST(WordPieceTokenizerEnTest, AccentsAndUnicodePunctuation) {
+    melo::WordPieceTokenizer tokenizer(std::filesystem::path(OV_MODEL_PATH) / "bert-base-uncased" / "vocab.txt");
+    EXPECT_EQ(tokenizer.word_segment("Café naïve Résumé"), (std::vector<std::string>{"cafe", "naive", "resume"}));
+    EXPECT_EQ(tokenizer.tokenize("Café naïve Résumé"), (std::vector<int64_t>{101, 7668, 15743, 13746, 102}));
+    // a combining accent (e + U+0301) is dropped the same way
+    EXPECT_EQ(tokenizer.word_segment("Cafe\xCC\x81"), std::vector<std::string>{"cafe"});
+
+    EXPECT_EQ(tokenizer.word_segment("“Hello”—world…"),
+              (std::vector<std::string>{"“", "hello", "”", "—", "world", "…"}));
+    EXPECT_EQ(tokenizer.tokenize("“Hello”—world…"),
+              (std::vector<int64_t>{101, 1523, 7592, 1524, 1517, 2088, 1529, 102}));
+
+    // no-break space splits, control characters are dropped
+    EXPECT_EQ(tokenizer.word_segment("hello\xC2\xA0wor\x01ld\xE2\x80\x8B"),
+              (std::vector<std::string>{"hello", "world"}));
+}
+
+TEST_F(WordPieceTokenizerTestSuit, CompatibilityIdeographsAndHangul) {
+    // U+F900 decomposes to U+8C48
+    EXPECT_EQ(tokenizer.tokenize("\xEF\xA4\x80"), tokenizer.tokenize("豈"));
+    // Hangul syllables become their jamo before the WordPiece split
+    std::vector<std::string> tokens;
+    std::vector<int64_t> ids;
+    tokenizer.encode("한", tokens, ids);
+    ASSERT_FALSE(tokens.empty());
+    EXPECT_NE(tokens.front(), "[UNK]");
+    EXPECT_EQ(tokens.front().substr(0, 3), "\xE1\x84\x92");  // U+1112 HANGUL CHOSEONG HIEUH
+}
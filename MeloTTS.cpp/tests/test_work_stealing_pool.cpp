@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include "work_stealing_pool.h"
+
+TEST(WorkStealingPoolTest, EveryResultReachesItsFuture) {
+    melo::WorkStealingPool pool(4);
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; ++i)
+        results.push_back(pool.submit([i] { return i * i; }));
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(results[i].get(), i * i);
+}
+
+TEST(WorkStealingPoolTest, IdleWorkerTakesTheTasksOfABusyOne) {
+    melo::WorkStealingPool pool(2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    // the first task goes to the first worker and holds it, every second task after it is queued behind
+    auto busy = pool.submit([released] { released.wait(); });
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 8; ++i)
+        results.push_back(pool.submit([i] { return i; }));
+    for (int i = 0; i < 8; ++i)
+        EXPECT_EQ(results[i].get(), i);
+    EXPECT_GE(pool.num_stolen(), 4);
+    release.set_value();
+    busy.get();
+}
+
+TEST(WorkStealingPoolTest, ErrorReachesTheFuture) {
+    melo::WorkStealingPool pool(1);
+    auto failed = pool.submit([]() -> int { throw std::runtime_error("g2p failed"); });
+    auto next = pool.submit([] { return 1; });
+    EXPECT_THROW(failed.get(), std::runtime_error);
+    EXPECT_EQ(next.get(), 1);
+}
+
+TEST(WorkStealingPoolTest, DestructionRunsTheQueuedTasks) {
+    std::atomic<int> done{0};
+    {
+        melo::WorkStealingPool pool(2);
+        for (int i = 0; i < 50; ++i)
+            pool.submit([&done] { ++done; });
+    }
+    EXPECT_EQ(done.load(), 50);
+}